@@ -0,0 +1,167 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * ART vs HashMap_string_int vs a strcmp-ordered Set: insert, lookup,
+ * prefix scan (autocomplete) and longest-prefix match (routing). The hash
+ * map stays ahead on point lookups; ART wins the other three.
+ * usage: art_bench [n]   (n generated path-like keys, default 500000)
+ */
+
+HASHMAP_STRING_INT
+
+static int cstr_cmp(char* a, char* b) { return strcmp(a, b); }
+#define CSTR_EQ(a, b) (strcmp((a), (b)) == 0)
+#define CSTR_PRINT(s) printf("%s", (s))
+DEFINE_SET_CUSTOM(char*, cstr, cstr_cmp, CSTR_EQ, CSTR_PRINT)
+
+DEFINE_ART(int, int)
+
+static const char* segments[] = { "api", "v1", "v2", "users", "orders", "items", "search", "static", "img", "admin" };
+
+static char* make_key(uint64_t* seed) {
+    char buf[96];
+    size_t len = 0;
+    int depth = 2 + (int)(bench_rand(seed) % 3);
+    for (int d = 0; d < depth; d++)
+        len += (size_t)snprintf(buf + len, sizeof(buf) - len, "/%s", segments[bench_rand(seed) % 10]);
+    snprintf(buf + len, sizeof(buf) - len, "/%u", (unsigned)(bench_rand(seed) % 1000000));
+    char* key = malloc(strlen(buf) + 1);
+    strcpy(key, buf);
+    return key;
+}
+
+static bool count_entry(const unsigned char* key, size_t len, int* value, void* ctx) {
+    (void)key; (void)len; (void)value;
+    (*(size_t*)ctx)++;
+    return true;
+}
+
+typedef struct {
+    const unsigned char* prev;
+    size_t prev_len;
+    bool ordered;
+} OrderCheck;
+
+static bool check_order(const unsigned char* key, size_t len, int* value, void* ctx) {
+    (void)value;
+    OrderCheck* oc = ctx;
+    if (oc->prev) {
+        size_t m = len < oc->prev_len ? len : oc->prev_len;
+        int c = memcmp(oc->prev, key, m);
+        if (c > 0 || (c == 0 && oc->prev_len >= len)) oc->ordered = false;
+    }
+    oc->prev = key;
+    oc->prev_len = len;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 500000);
+    uint64_t seed = 7;
+    char** keys = malloc(n * sizeof(char*));
+    char** probes = malloc(n * sizeof(char*));
+    for (size_t i = 0; i < n; i++) keys[i] = make_key(&seed);
+    for (size_t i = 0; i < n; i++) probes[i] = (i & 1) ? keys[bench_rand(&seed) % n] : make_key(&seed);
+    printf("ART vs HashMap_string_int vs Set_cstr, %zu path keys\n", n);
+
+    HashMap_string_int hm;
+    hashmap_init_string_int(&hm);
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) hashmap_put_string_int(&hm, keys[i], (int)i);
+    bench_report("HashMap insert", bench_now() - t, (double)n);
+
+    Set_cstr set;
+    set_init_cstr(&set);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) set_add_cstr(&set, keys[i]);
+    bench_report("Set_cstr insert", bench_now() - t, (double)n);
+
+    Art_int art;
+    art_init_int(&art);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) art_insert_str_int(&art, keys[i], (int)i);
+    bench_report("ART insert", bench_now() - t, (double)n);
+    BENCH_CHECK(art_size_int(&art) == hm.size && set.size == hm.size, "size");
+
+    size_t hits_hm = 0, hits_set = 0, hits_art = 0;
+    int v;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) hits_hm += hashmap_get_string_int(&hm, probes[i], &v);
+    bench_report("HashMap find", bench_now() - t, (double)n);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) hits_set += set_contains_cstr(&set, probes[i]);
+    bench_report("Set_cstr find", bench_now() - t, (double)n);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) hits_art += art_find_str_int(&art, probes[i], &v);
+    bench_report("ART find", bench_now() - t, (double)n);
+    BENCH_CHECK(hits_hm == hits_art && hits_set == hits_art, "find");
+    for (size_t i = 0; i < n; i += 97) {
+        int a, b;
+        BENCH_CHECK(art_find_str_int(&art, keys[i], &a) && hashmap_get_string_int(&hm, keys[i], &b) && a == b, "value");
+    }
+
+    OrderCheck oc = { NULL, 0, true };
+    art_foreach_int(&art, check_order, &oc);
+    BENCH_CHECK(oc.ordered, "ordered iteration");
+
+    /* Autocomplete: the hash map has to scan every bucket per query */
+    const char* prefixes[] = { "/api/v1/users", "/static/img", "/admin/search/1", "/v2/orders/items/9" };
+    size_t queries = 200;
+    size_t total_art = 0, total_hm = 0;
+    t = bench_now();
+    for (size_t q = 0; q < queries; q++) {
+        const char* p = prefixes[q % 4];
+        art_prefix_foreach_int(&art, p, strlen(p), count_entry, &total_art);
+    }
+    bench_report("ART prefix scan", bench_now() - t, (double)queries);
+    t = bench_now();
+    for (size_t q = 0; q < queries; q++) {
+        const char* p = prefixes[q % 4];
+        size_t plen = strlen(p);
+        for (size_t b = 0; b < hm.capacity; b++)
+            for (HashNode_string_int* e = hm.buckets[b]; e; e = e->next)
+                total_hm += strncmp(e->key, p, plen) == 0;
+    }
+    bench_report("HashMap prefix scan", bench_now() - t, (double)queries);
+    BENCH_CHECK(total_art == total_hm, "prefix scan");
+
+    /* Routing: longest registered route that prefixes the request path */
+    Art_int routes;
+    art_init_int(&routes);
+    for (int a = 0; a < 10; a++) {
+        char r[64];
+        snprintf(r, sizeof(r), "/%s", segments[a]);
+        art_insert_str_int(&routes, r, a);
+        for (int b = 0; b < 10; b++) {
+            snprintf(r, sizeof(r), "/%s/%s", segments[a], segments[b]);
+            art_insert_str_int(&routes, r, a * 10 + b);
+        }
+    }
+    size_t routed = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        size_t mlen;
+        routed += art_longest_prefix_int(&routes, probes[i], strlen(probes[i]), &mlen, &v);
+    }
+    bench_report("ART longest prefix", bench_now() - t, (double)n);
+    BENCH_CHECK(routed == n, "every path has a route");
+
+    for (size_t i = 0; i < n; i += 2) {
+        bool in_hm = hashmap_remove_string_int(&hm, keys[i]);
+        BENCH_CHECK(art_erase_str_int(&art, keys[i]) == in_hm, "erase");
+    }
+    BENCH_CHECK(art_size_int(&art) == hm.size, "size after erase");
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(art_find_str_int(&art, keys[i], NULL) == hashmap_contains_string_int(&hm, keys[i]), "find after erase");
+    }
+
+    art_destroy_int(&routes);
+    art_destroy_int(&art);
+    hashmap_destroy_string_int(&hm);
+    for (size_t i = 0; i < n; i++) free(keys[i]);
+    for (size_t i = 0; i < n; i += 2) free(probes[i]);
+    free(keys);
+    free(probes);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * Shared helpers for the programs in bench/.
+ * Build with `make bench`; each program takes an optional size argument.
+ */
+
+#include <time.h>
+#include "common.h"
+
+static inline double bench_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64* generator, deterministic across runs
+static inline uint64_t bench_rand(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline size_t bench_arg(int argc, char** argv, size_t fallback) {
+    if (argc > 1) {
+        long long v = atoll(argv[1]);
+        if (v > 0) return (size_t)v;
+    }
+    return fallback;
+}
+
+// Prints "label: seconds (Mops/s)"
+static inline void bench_report(const char* label, double seconds, double ops) {
+    printf("  %-36s %9.4f s  %10.2f Mops/s\n", label, seconds, seconds > 0 ? ops / seconds / 1e6 : 0.0);
+}
+
+// Aborts the benchmark if two implementations disagree
+#define BENCH_CHECK(cond, msg) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "MISMATCH: %s\n", msg); \
+            exit(1); \
+        } \
+    } while (0)
+
+#endif // BENCH_H
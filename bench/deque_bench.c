@@ -0,0 +1,204 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * deque_int against IntList (one malloc per node) and queue_int (ring
+ * buffer, back-only push): FIFO push_back / pop_front, LIFO at the front,
+ * a sliding window that pushes and pops at both ends, indexed reads, and
+ * the list / queue conversions. Also checks that element addresses survive
+ * pushes at both ends.
+ * usage: deque_bench [n]   (default 10000000)
+ */
+
+DEFINE_LIST(int, IntList)
+DEFINE_QUEUE(int)
+DEFINE_DEQUE(int)
+DEFINE_DEQUE_LIST(int, IntList)
+DEFINE_DEQUE_QUEUE(int)
+
+#define WINDOW 1000
+
+static long long expect_sum(size_t n) {
+    return (long long)n * ((long long)n - 1) / 2;
+}
+
+static void fifo(size_t n) {
+    printf("FIFO: push_back %zu, then pop_front them all\n", n);
+    IntList l;
+    IntList_init(&l);
+    long long sum = 0;
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) IntList_push_back(&l, (int)i);
+    while (!IntList_empty(&l)) sum += IntList_pop_front(&l);
+    bench_report("  IntList", bench_now() - t, (double)n);
+    BENCH_CHECK(sum == expect_sum(n), "list sum");
+
+    queue_int q;
+    queue_int_init(&q);
+    sum = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) queue_int_enqueue(&q, (int)i);
+    while (!queue_int_empty(&q)) sum += queue_int_dequeue(&q);
+    bench_report("  queue_int", bench_now() - t, (double)n);
+    BENCH_CHECK(sum == expect_sum(n), "queue sum");
+    queue_int_free(&q);
+
+    deque_int d;
+    deque_int_init(&d);
+    sum = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) deque_int_push_back(&d, (int)i);
+    while (!deque_int_empty(&d)) sum += deque_int_pop_front(&d);
+    bench_report("  deque_int", bench_now() - t, (double)n);
+    BENCH_CHECK(sum == expect_sum(n), "deque sum");
+    deque_int_free(&d);
+}
+
+static void lifo_front(size_t n) {
+    printf("Front only: push_front %zu, then pop_front them all (queue_int cannot)\n", n);
+    IntList l;
+    IntList_init(&l);
+    long long sum = 0;
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) IntList_push_front(&l, (int)i);
+    while (!IntList_empty(&l)) sum += IntList_pop_front(&l);
+    bench_report("  IntList", bench_now() - t, (double)n);
+    BENCH_CHECK(sum == expect_sum(n), "list sum");
+
+    deque_int d;
+    deque_int_init(&d);
+    sum = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) deque_int_push_front(&d, (int)i);
+    for (size_t i = n; i-- > 0;) {
+        int v = deque_int_pop_front(&d);
+        BENCH_CHECK(v == (int)i, "front order");
+        sum += v;
+    }
+    bench_report("  deque_int", bench_now() - t, (double)n);
+    BENCH_CHECK(sum == expect_sum(n), "deque sum");
+    deque_int_free(&d);
+}
+
+// WINDOW items in flight; each step pushes at a random end and pops at a random end
+static void window(size_t n) {
+    printf("Sliding window of %d: push and pop at random ends, %zu steps\n", WINDOW, n);
+    IntList l;
+    IntList_init(&l);
+    deque_int d;
+    deque_int_init(&d);
+    for (int i = 0; i < WINDOW; i++) {
+        IntList_push_back(&l, i);
+        deque_int_push_back(&d, i);
+    }
+    uint64_t s = 1;
+    long long sum = 0;
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = bench_rand(&s);
+        if (r & 1) IntList_push_back(&l, (int)i);
+        else IntList_push_front(&l, (int)i);
+        sum += (r & 2) ? IntList_pop_back(&l) : IntList_pop_front(&l);
+    }
+    bench_report("  IntList", bench_now() - t, (double)n);
+    long long list_sum = sum;
+    IntList_clear(&l);
+
+    s = 1;
+    sum = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = bench_rand(&s);
+        if (r & 1) deque_int_push_back(&d, (int)i);
+        else deque_int_push_front(&d, (int)i);
+        sum += (r & 2) ? deque_int_pop_back(&d) : deque_int_pop_front(&d);
+    }
+    bench_report("  deque_int", bench_now() - t, (double)n);
+    BENCH_CHECK(sum == list_sum && deque_int_size(&d) == WINDOW, "window");
+    deque_int_free(&d);
+}
+
+static void indexed(size_t n) {
+    printf("Indexed reads: %zu random deque_int_get after pushes at both ends\n", n);
+    deque_int d;
+    deque_int_init(&d);
+    for (size_t i = 0; i < n / 2; i++) {
+        deque_int_push_back(&d, (int)(n / 2 + i));
+        deque_int_push_front(&d, (int)(n / 2 - 1 - i));
+    }
+    uint64_t s = 2;
+    long long sum = 0, expect = 0;
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        size_t k = bench_rand(&s) % d.len;
+        sum += deque_int_get(&d, k);
+        expect += (long long)k;
+    }
+    bench_report("  deque_int_get", bench_now() - t, (double)n);
+    BENCH_CHECK(sum == expect, "get");
+    deque_int_free(&d);
+}
+
+static void conversions(size_t n) {
+    printf("Conversions: %zu elements\n", n);
+    IntList l;
+    IntList_init(&l);
+    for (size_t i = 0; i < n; i++) IntList_push_back(&l, (int)i);
+    deque_int d;
+    double t = bench_now();
+    BENCH_CHECK(deque_int_from_IntList(&d, &l), "from list");
+    bench_report("  deque_int_from_IntList", bench_now() - t, (double)n);
+    IntList_clear(&l);
+
+    queue_int q;
+    queue_int_init(&q);
+    t = bench_now();
+    BENCH_CHECK(deque_int_to_queue(&d, &q) && queue_int_size(&q) == n, "to queue");
+    bench_report("  deque_int_to_queue", bench_now() - t, (double)n);
+    deque_int_free(&d);
+
+    queue_int_dequeue_n(&q, NULL, n / 3);     /* wrap the ring so the copy splits */
+    for (size_t i = 0; i < n / 3; i++) queue_int_enqueue(&q, (int)(n + i));
+    t = bench_now();
+    BENCH_CHECK(deque_int_from_queue(&d, &q) && deque_int_size(&d) == n, "from queue");
+    bench_report("  deque_int_from_queue", bench_now() - t, (double)n);
+    for (size_t i = 0; i < n; i++) BENCH_CHECK(deque_int_get(&d, i) == (int)(n / 3 + i), "from queue order");
+
+    deque_int_to_IntList(&d, &l);
+    BENCH_CHECK(IntList_size(&l) == n && l.head->data == (int)(n / 3) && l.tail->data == (int)(n + n / 3 - 1), "to list");
+    IntList_clear(&l);
+    queue_int_free(&q);
+    deque_int_free(&d);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 10000000);
+    fifo(n);
+    lifo_front(n);
+    window(n);
+    indexed(n);
+    conversions(n / 10);
+
+    /* Addresses stay put while pushing at both ends; extend_back / copy_out across blocks */
+    deque_int d;
+    deque_int_init(&d);
+    deque_int_push_back(&d, 42);
+    int* p = deque_int_front_ptr(&d);
+    for (int i = 0; i < 100000; i++) {
+        deque_int_push_back(&d, i);
+        deque_int_push_front(&d, -i);
+    }
+    BENCH_CHECK(*p == 42 && deque_int_at_ptr(&d, 100000) == p, "stable address");
+    int buf[5000], out[5000];
+    for (int i = 0; i < 5000; i++) buf[i] = i * 3;
+    deque_int_clear(&d);
+    deque_int_push_front(&d, -1);
+    BENCH_CHECK(deque_int_extend_back(&d, buf, 5000) && deque_int_size(&d) == 5001, "extend_back");
+    BENCH_CHECK(deque_int_copy_out(&d, 1, out, 5000) && memcmp(out, buf, sizeof(buf)) == 0, "copy_out");
+    BENCH_CHECK(deque_int_front(&d) == -1 && deque_int_back(&d) == 4999 * 3, "front/back");
+    BENCH_CHECK(!deque_int_copy_out(&d, 2, out, 5000), "copy_out range");
+    while (!deque_int_empty(&d)) deque_int_pop_back(&d);
+    BENCH_CHECK(deque_int_front_ptr(&d) == NULL && !deque_int_pop_front_into(&d, NULL), "empty");
+    deque_int_free(&d);
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "ext_sort.h"
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * External sort of n random uint64_t values under a memory limit of one
+ * fifth of the data (10 runs of half the limit, one merge), against
+ * vec_T_sort with the whole array in memory. Then a 256 KiB limit on n / 8
+ * values, which allows a fan-in of 2 and forces several merge passes, and
+ * the vec/file/custom-comparator paths.
+ * usage: ext_sort_bench [n]   (default 33554432: 256 MiB of data)
+ */
+
+typedef uint64_t u64;
+typedef struct {
+    uint32_t key;
+    uint32_t seq;
+} Rec;
+
+#define REC_DESC(a, b) ((a).key > (b).key ? -1 : (a).key < (b).key ? 1 : 0)
+
+DEFINE_VEC(u64)
+DEFINE_VEC_SORT(u64)
+DEFINE_EXT_SORT(u64)
+DEFINE_VEC(Rec)
+DEFINE_VEC_SORT_CUSTOM(Rec, REC_DESC)
+DEFINE_EXT_SORT_CUSTOM(Rec, REC_DESC)
+
+typedef struct {
+    uint64_t count, sum, last;
+    bool sorted;
+} Check;
+
+static bool check_emit(const u64* items, size_t n, void* ctx) {
+    Check* c = (Check*)ctx;
+    for (size_t i = 0; i < n; i++) {
+        if (items[i] < c->last) c->sorted = false;
+        c->last = items[i];
+        c->sum += items[i];
+    }
+    c->count += n;
+    return true;
+}
+
+// Pushes n values from seed into s and returns their sum
+static uint64_t feed(ext_sort_u64* s, size_t n, uint64_t seed) {
+    uint64_t sum = 0;
+    u64 chunk[4096];
+    for (size_t i = 0; i < n;) {
+        size_t k = n - i < 4096 ? n - i : 4096;
+        for (size_t j = 0; j < k; j++) sum += chunk[j] = bench_rand(&seed);
+        BENCH_CHECK(ext_sort_u64_push_array(s, chunk, k), "push");
+        i += k;
+    }
+    return sum;
+}
+
+static void run_external(const char* label, size_t n, size_t mem_limit) {
+    ExtSortConfig cfg = { mem_limit, NULL };
+    ext_sort_u64 s;
+    BENCH_CHECK(ext_sort_u64_init(&s, &cfg), "init");
+    double t = bench_now();
+    uint64_t sum = feed(&s, n, 7);
+    double t_runs = bench_now() - t;
+    size_t nruns = s.nruns + (s.len > 0);
+    Check c = { 0, 0, 0, true };
+    BENCH_CHECK(ext_sort_u64_finish(&s, check_emit, &c), "finish");
+    double total = bench_now() - t;
+    printf("%s: %zu MiB of data, %zu KiB limit, %zu runs\n", label, n * sizeof(u64) >> 20, mem_limit >> 10, nruns);
+    bench_report("  generate + sort + write runs", t_runs, (double)n);
+    bench_report("  merge", total - t_runs, (double)n);
+    bench_report("  total", total, (double)n);
+    BENCH_CHECK(c.sorted && c.count == n && c.sum == sum, "external sort output");
+    ext_sort_u64_free(&s);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, (size_t)1 << 25);
+
+    /* Everything in memory, for reference */
+    vec_u64 v;
+    vec_u64_init(&v);
+    BENCH_CHECK(vec_u64_resize(&v, n), "resize");
+    uint64_t seed = 7;
+    for (size_t i = 0; i < n; i++) v.data[i] = bench_rand(&seed);
+    double t = bench_now();
+    vec_u64_sort(&v);
+    printf("In memory: %zu MiB\n", n * sizeof(u64) >> 20);
+    bench_report("  vec_u64_sort", bench_now() - t, (double)n);
+    vec_u64_free(&v);
+
+    run_external("External", n, n * sizeof(u64) / 5);
+    run_external("External, multi-pass", n / 8, (size_t)256 << 10);
+
+    /* Small inputs: the in-memory path, vec and file output, and a file round trip */
+    ExtSortConfig small = { (size_t)1 << 20, "." };
+    ext_sort_u64 s;
+    ext_sort_u64_init(&s, &small);
+    uint64_t sum = feed(&s, 1000, 3);
+    BENCH_CHECK(s.nruns == 0, "fits in one buffer");
+    vec_u64 out;
+    vec_u64_init(&out);
+    BENCH_CHECK(ext_sort_u64_finish_vec(&s, &out) && out.len == 1000 && vec_u64_is_sorted(&out), "finish_vec");
+    for (size_t i = 0; i < out.len; i++) sum -= out.data[i];
+    BENCH_CHECK(sum == 0, "finish_vec contents");
+    ext_sort_u64_free(&s);
+
+    const char* in_path = "ext_sort_bench.in";
+    const char* out_path = "ext_sort_bench.out";
+    ext_sort_u64_init(&s, &small);
+    feed(&s, 300000, 5);
+    BENCH_CHECK(ext_sort_u64_finish_file(&s, in_path), "finish_file");
+    ext_sort_u64_free(&s);
+    BENCH_CHECK(ext_sort_u64_sort_file(in_path, out_path, &small), "sort_file");
+    FILE* f = fopen(out_path, "rb");
+    BENCH_CHECK(f != NULL, "open output");
+    vec_u64_resize(&out, 300001);
+    BENCH_CHECK(fread(out.data, sizeof(u64), 300001, f) == 300000, "output size");
+    out.len = 300000;
+    BENCH_CHECK(vec_u64_is_sorted(&out), "sort_file output");
+    fclose(f);
+    remove(in_path);
+    remove(out_path);
+    vec_u64_free(&out);
+
+    ext_sort_Rec r;
+    ext_sort_Rec_init(&r, &small);
+    for (uint32_t i = 0; i < 400000; i++) ext_sort_Rec_push(&r, (Rec){ (uint32_t)(bench_rand(&seed) % 1000), i });
+    vec_Rec recs;
+    vec_Rec_init(&recs);
+    BENCH_CHECK(r.nruns > 1 && ext_sort_Rec_finish_vec(&r, &recs) && recs.len == 400000, "custom comparator");
+    for (size_t i = 1; i < recs.len; i++) BENCH_CHECK(recs.data[i - 1].key >= recs.data[i].key, "descending");
+    vec_Rec_free(&recs);
+    ext_sort_Rec_free(&r);
+    return 0;
+}
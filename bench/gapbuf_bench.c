@@ -0,0 +1,195 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Mid-sequence edits on a long int sequence: vec_int_insert/remove vs
+ * gapbuf_int vs rope_int, for edits clustered around a moving cursor and
+ * for edits at uniformly random positions. Each edit is an insert (2/3)
+ * or a remove (1/3). Containers given the same edits must end up equal.
+ * Also builds a rope by push alone and checks its depth stays logarithmic.
+ * usage: gapbuf_bench [n]   (n initial elements, default 10000000)
+ */
+
+DEFINE_VEC(int)
+DEFINE_GAPBUF(int)
+DEFINE_ROPE(int)
+
+// Prints microseconds per edit
+static void report_edits(const char* label, double seconds, size_t count) {
+    printf("  %-36s %9.4f s  %10.3f us/edit\n", label, seconds, seconds * 1e6 / (double)count);
+}
+
+typedef struct {
+    uint64_t seed;
+    size_t cursor;
+    bool clustered;
+} Edits;
+
+// Next edit against a sequence of length len: returns the position, sets *insert
+static size_t next_edit(Edits* e, size_t len, bool* insert) {
+    uint64_t r = bench_rand(&e->seed);
+    size_t pos;
+    if (e->clustered) {
+        long step = (long)(r % 129) - 64;
+        pos = (long)e->cursor + step < 0 ? 0 : (size_t)((long)e->cursor + step);
+    } else {
+        pos = (size_t)(r % (len + 1));
+    }
+    if (pos > len) pos = len;
+    *insert = len == 0 || (r >> 40) % 3 != 0;
+    if (!*insert && pos == len) pos = len - 1;
+    e->cursor = pos;
+    return pos;
+}
+
+static void run_vec(vec_int* v, Edits e, size_t count) {
+    bool insert;
+    for (size_t i = 0; i < count; i++) {
+        size_t pos = next_edit(&e, v->len, &insert);
+        if (insert) vec_int_insert(v, pos, (int)i);
+        else vec_int_remove(v, pos);
+    }
+}
+
+static void run_gapbuf(gapbuf_int* g, Edits e, size_t count) {
+    bool insert;
+    for (size_t i = 0; i < count; i++) {
+        size_t pos = next_edit(&e, gapbuf_int_len(g), &insert);
+        if (insert) gapbuf_int_insert(g, pos, (int)i);
+        else gapbuf_int_remove(g, pos);
+    }
+}
+
+static void run_rope(rope_int* r, Edits e, size_t count) {
+    bool insert;
+    for (size_t i = 0; i < count; i++) {
+        size_t pos = next_edit(&e, rope_int_len(r), &insert);
+        if (insert) rope_int_insert(r, pos, (int)i);
+        else rope_int_remove(r, pos);
+    }
+}
+
+static bool same(const vec_int* v, const gapbuf_int* g, const rope_int* r) {
+    vec_int a, b;
+    vec_int_init(&a);
+    vec_int_init(&b);
+    gapbuf_int_to_vec(g, &a);
+    rope_int_to_vec(r, &b);
+    bool eq = a.len == b.len && memcmp(a.data, b.data, a.len * sizeof(int)) == 0;
+    if (v) eq = eq && v->len == a.len && memcmp(v->data, a.data, a.len * sizeof(int)) == 0;
+    vec_int_free(&a);
+    vec_int_free(&b);
+    return eq;
+}
+
+static void pattern(const char* name, const vec_int* base, bool clustered, size_t slow, size_t fast) {
+    size_t n = base->len;
+    printf("%s edits on %zu elements\n", name, n);
+    Edits e = { 99, n / 3, clustered };
+
+    /* All three containers, the same `slow` edits */
+    vec_int v;
+    vec_int_init(&v);
+    vec_int_extend(&v, base->data, n);
+    gapbuf_int g;
+    rope_int r;
+    BENCH_CHECK(gapbuf_int_from_vec(&g, base) && rope_int_from_vec(&r, base), "from_vec");
+    double t = bench_now();
+    run_vec(&v, e, slow);
+    report_edits("vec_int_insert / remove", bench_now() - t, slow);
+    t = bench_now();
+    run_gapbuf(&g, e, slow);
+    report_edits("gapbuf_int", bench_now() - t, slow);
+    t = bench_now();
+    run_rope(&r, e, slow);
+    report_edits("rope_int", bench_now() - t, slow);
+    BENCH_CHECK(same(&v, &g, &r), "same contents");
+    vec_int_free(&v);
+    gapbuf_int_free(&g);
+    rope_int_free(&r);
+
+    /* Gap buffer and rope only, many more edits */
+    BENCH_CHECK(gapbuf_int_from_vec(&g, base) && rope_int_from_vec(&r, base), "from_vec");
+    t = bench_now();
+    run_gapbuf(&g, e, fast);
+    report_edits("gapbuf_int (longer run)", bench_now() - t, fast);
+    t = bench_now();
+    run_rope(&r, e, fast);
+    report_edits("rope_int (longer run)", bench_now() - t, fast);
+    BENCH_CHECK(same(NULL, &g, &r), "same contents (longer run)");
+    gapbuf_int_free(&g);
+    rope_int_free(&r);
+
+    /* Rope alone at scale */
+    BENCH_CHECK(rope_int_from_vec(&r, base), "from_vec");
+    t = bench_now();
+    run_rope(&r, e, 200000);
+    report_edits("rope_int (200000 edits)", bench_now() - t, 200000);
+    BENCH_CHECK(rope_int_len(&r) > n, "rope length");
+    rope_int_free(&r);
+}
+
+static size_t rope_depth(const rope_int_node* t) {
+    if (!t) return 0;
+    size_t l = rope_depth(t->left), r = rope_depth(t->right);
+    return 1 + (l > r ? l : r);
+}
+
+// Builds a rope of n elements by push alone; the treap must stay logarithmic
+static void push_build(size_t n) {
+    printf("Build by push: %zu rope_int_push\n", n);
+    rope_int r;
+    rope_int_init(&r);
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) rope_int_push(&r, (int)i);
+    report_edits("rope_int_push", bench_now() - t, n);
+    size_t chunks = n / ROPE_CHUNK + 1, lg = 0;
+    while ((size_t)1 << lg < chunks) lg++;
+    size_t depth = rope_depth(r.root);
+    printf("  depth %zu for %zu chunks\n", depth, chunks);
+    BENCH_CHECK(depth <= 4 * lg + 4, "push depth");
+    BENCH_CHECK(rope_int_len(&r) == n && rope_int_get(&r, n / 2) == (int)(n / 2), "push contents");
+    rope_int_free(&r);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 10000000);
+    vec_int base;
+    vec_int_init(&base);
+    for (size_t i = 0; i < n; i++) vec_int_push(&base, (int)i);
+
+    pattern("Clustered", &base, true, 200, 1000000);
+    pattern("Scattered", &base, false, 200, 500);
+    push_build(n);
+
+    /* Range operations and conversions */
+    rope_int r, tail;
+    BENCH_CHECK(rope_int_from_vec(&r, &base), "from_vec");
+    int block[1000];
+    for (int i = 0; i < 1000; i++) block[i] = -i;
+    BENCH_CHECK(rope_int_insert_n(&r, n / 2, block, 1000), "insert_n");
+    BENCH_CHECK(rope_int_get(&r, n / 2 + 999) == -999 && rope_int_get(&r, n / 2 + 1000) == (int)(n / 2), "insert_n contents");
+    rope_int_erase(&r, n / 2, 1000);
+    BENCH_CHECK(rope_int_len(&r) == n && rope_int_get(&r, n / 2) == (int)(n / 2), "erase");
+    BENCH_CHECK(rope_int_split(&r, n / 3, &tail) && rope_int_len(&tail) == n - n / 3 && *rope_int_at_ptr(&tail, 0) == (int)(n / 3),
+                "split");
+    rope_int_concat(&r, &tail);
+    vec_int back;
+    vec_int_init(&back);
+    BENCH_CHECK(rope_int_to_vec(&r, &back) && memcmp(back.data, base.data, n * sizeof(int)) == 0, "concat");
+    rope_int_free(&r);
+
+    gapbuf_int g;
+    gapbuf_int_init(&g);
+    for (int i = 0; i < 100; i++) gapbuf_int_push(&g, i);
+    gapbuf_int_insert_n(&g, 10, block, 5);
+    gapbuf_int_erase(&g, 50, 20);
+    gapbuf_int_set(&g, 0, 42);
+    BENCH_CHECK(gapbuf_int_len(&g) == 85 && gapbuf_int_get(&g, 0) == 42 && gapbuf_int_get(&g, 11) == -1 &&
+                    gapbuf_int_get(&g, 50) == 65 && gapbuf_int_cursor(&g) == 50,
+                "gapbuf ranges");
+    gapbuf_int_free(&g);
+    vec_int_free(&back);
+    vec_int_free(&base);
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * The vec_vec_float pattern from req1.c (one heap block per row, rows
+ * fetched by value with vec_vec_float_get) vs matrix_float: full sum,
+ * column sum, element-wise add, transpose and multiply.
+ * usage: matrix_bench [n]   (n x n matrices, default 512)
+ */
+
+DEFINE_VEC(float)
+DEFINE_VEC(vec_float)
+DEFINE_MATRIX(float)
+DEFINE_MATRIX_NUMERIC(float)
+DEFINE_MATRIX_CONVERT(float)
+DEFINE_MATRIX(int)
+DEFINE_MATRIX_NUMERIC(int)
+
+#define ROUNDS 10
+
+static void vv_init(vec_vec_float* m, size_t rows, size_t cols, unsigned salt) {
+    vec_vec_float_init(m);
+    for (size_t r = 0; r < rows; r++) {
+        vec_float row;
+        vec_float_init(&row);
+        for (size_t c = 0; c < cols; c++) vec_float_push(&row, (float)((r * 3 + c * salt) % 7));
+        vec_vec_float_push(m, row);
+    }
+}
+
+static void vv_free(vec_vec_float* m) {
+    for (size_t r = 0; r < m->len; r++) vec_float_free(&m->data[r]);
+    vec_vec_float_free(m);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 512);
+    printf("%zu x %zu float\n", n, n);
+
+    vec_vec_float va, vb;
+    double t = bench_now();
+    vv_init(&va, n, n, 1);
+    bench_report("build vec_vec_float", bench_now() - t, (double)n * n);
+    vv_init(&vb, n, n, 5);
+    matrix_float a, b;
+    t = bench_now();
+    BENCH_CHECK(matrix_float_from_vec_vec(&a, &va), "convert");
+    bench_report("matrix_float_from_vec_vec", bench_now() - t, (double)n * n);
+    BENCH_CHECK(matrix_float_from_vec_vec(&b, &vb), "convert");
+    BENCH_CHECK(((uintptr_t)a.data % MATRIX_ALIGN) == 0 && a.stride % 16 == 0, "alignment");
+
+    /* Sum of all elements */
+    double s1 = 0, s2 = 0;
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++)
+        for (size_t i = 0; i < va.len; i++) {
+            vec_float row = vec_vec_float_get(&va, i);
+            for (size_t j = 0; j < row.len; j++) s1 += vec_float_get(&row, j);
+        }
+    bench_report("sum: vec_vec_float_get rows", bench_now() - t, (double)n * n * ROUNDS);
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++) s2 += matrix_float_sum(&a);
+    bench_report("sum: matrix_float_sum", bench_now() - t, (double)n * n * ROUNDS);
+    BENCH_CHECK(s1 == s2, "sum");
+
+    /* Column sums: one element per row (after one untimed column walk over each) */
+    for (int warm = 0; warm < 2; warm++) {
+        s1 = s2 = 0;
+        t = bench_now();
+        for (size_t j = 0; j < n; j++)
+            for (size_t i = 0; i < va.len; i++) s1 += vec_vec_float_get(&va, i).data[j];
+        double t_vv = bench_now() - t;
+        t = bench_now();
+        for (size_t j = 0; j < n; j++) {
+            matrix_float_col_view col = matrix_float_col(&a, j);
+            for (size_t i = 0; i < col.len; i++) s2 += col.data[i * col.stride];
+        }
+        double t_m = bench_now() - t;
+        if (warm) {
+            bench_report("column sums: vec_vec_float", t_vv, (double)n * n);
+            bench_report("column sums: matrix_float_col", t_m, (double)n * n);
+        }
+    }
+    BENCH_CHECK(s1 == s2, "columns");
+
+    /* Element-wise add */
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++)
+        for (size_t i = 0; i < va.len; i++) {
+            vec_float row = vec_vec_float_get(&va, i), other = vec_vec_float_get(&vb, i);
+            for (size_t j = 0; j < row.len; j++) vec_float_set(&row, j, vec_float_get(&row, j) + vec_float_get(&other, j));
+        }
+    bench_report("add: vec_vec_float get/set", bench_now() - t, (double)n * n * ROUNDS);
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++) matrix_float_add(&a, &b);
+    bench_report("add: matrix_float_add", bench_now() - t, (double)n * n * ROUNDS);
+    for (size_t i = 0; i < n; i += 7)
+        for (size_t j = 0; j < n; j += 5) BENCH_CHECK(va.data[i].data[j] == matrix_float_get(&a, i, j), "add");
+
+    /* Transpose */
+    vec_vec_float vt;
+    t = bench_now();
+    vec_vec_float_init(&vt);
+    for (size_t j = 0; j < n; j++) {
+        vec_float row;
+        vec_float_init(&row);
+        for (size_t i = 0; i < n; i++) vec_float_push(&row, vec_vec_float_get(&va, i).data[j]);
+        vec_vec_float_push(&vt, row);
+    }
+    bench_report("transpose: vec_vec_float", bench_now() - t, (double)n * n);
+    matrix_float at;
+    t = bench_now();
+    BENCH_CHECK(matrix_float_transpose(&a, &at), "transpose");
+    bench_report("transpose: matrix_float (blocked)", bench_now() - t, (double)n * n);
+    for (size_t i = 0; i < n; i += 3)
+        for (size_t j = 0; j < n; j += 11) BENCH_CHECK(vt.data[i].data[j] == *matrix_float_at_ptr(&at, i, j), "transpose");
+    vv_free(&vt);
+
+    /* Multiply: textbook triple loop vs blocked axpy */
+    vec_vec_float vc;
+    vec_vec_float_init(&vc);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        vec_float row;
+        vec_float_init(&row);
+        vec_float_resize(&row, n);
+        vec_float ai = vec_vec_float_get(&va, i);
+        for (size_t j = 0; j < n; j++) {
+            float acc = 0;
+            for (size_t k = 0; k < n; k++) acc += vec_float_get(&ai, k) * vec_vec_float_get(&vb, k).data[j];
+            row.data[j] = acc;
+        }
+        vec_vec_float_push(&vc, row);
+    }
+    bench_report("mul: vec_vec_float i-j-k", bench_now() - t, (double)n * n * n);
+    matrix_float c;
+    t = bench_now();
+    BENCH_CHECK(matrix_float_mul(&a, &b, &c), "mul");
+    bench_report("mul: matrix_float_mul", bench_now() - t, (double)n * n * n);
+    /* Inputs are small integers, so both orders give exact results */
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) BENCH_CHECK(vc.data[i].data[j] == c.data[i * c.stride + j], "mul");
+    vv_free(&vc);
+
+    /* Growth, views and conversion back */
+    matrix_float g;
+    matrix_float_init(&g, 0, 3);
+    float row[3] = { 1, 2, 3 };
+    for (int i = 0; i < 100; i++) {
+        row[0] = (float)i;
+        matrix_float_append_row(&g, row);
+    }
+    BENCH_CHECK(g.rows == 100 && matrix_float_row(&g, 42)[0] == 42.0f && *matrix_float_col_at_ptr(matrix_float_col(&g, 2), 99) == 3.0f,
+                "append_row / views");
+    vec_vec_float back;
+    vec_vec_float_init(&back);
+    BENCH_CHECK(matrix_float_to_vec_vec(&g, &back) && back.len == 100 && back.data[7].data[0] == 7.0f, "to_vec_vec");
+    vv_free(&back);
+    matrix_float bad;
+    vec_float_push(&va.data[3], 1.0f);
+    BENCH_CHECK(!matrix_float_from_vec_vec(&bad, &va), "ragged rows refused");
+
+    matrix_int mi, ni, pi;
+    matrix_int_init(&mi, 3, 2);
+    matrix_int_init(&ni, 2, 3);
+    for (int i = 0; i < 6; i++) {
+        mi.data[(size_t)i / 2 * mi.stride + (size_t)i % 2] = i + 1;
+        ni.data[(size_t)i / 3 * ni.stride + (size_t)i % 3] = i + 1;
+    }
+    BENCH_CHECK(matrix_int_mul(&mi, &ni, &pi) && matrix_int_get(&pi, 2, 2) == 5 * 3 + 6 * 6, "int mul");
+    matrix_int_free(&pi);
+    BENCH_CHECK(!matrix_int_mul(&mi, &mi, &pi), "shape mismatch");
+
+    matrix_int_free(&mi);
+    matrix_int_free(&ni);
+    matrix_float_free(&g);
+    matrix_float_free(&a);
+    matrix_float_free(&b);
+    matrix_float_free(&at);
+    matrix_float_free(&c);
+    vv_free(&va);
+    vv_free(&vb);
+    return 0;
+}
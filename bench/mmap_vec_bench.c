@@ -0,0 +1,106 @@
+#define _GNU_SOURCE
+#include "mmap_vec.h"
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * File-backed mmap_vec_double vs rebuilding a vec_double from a binary
+ * file at startup: build, reopen read-only, first full scan, reopen and
+ * append, plus rejection of files written for another type or version.
+ * usage: mmap_vec_bench [n]   (n doubles, default 10000000)
+ */
+
+DEFINE_VEC(double)
+DEFINE_MMAP_VEC(double)
+DEFINE_MMAP_VEC(long)
+
+#define MAPPED_PATH "/tmp/stl_mmap_vec_bench.vec"
+#define RAW_PATH "/tmp/stl_mmap_vec_bench.raw"
+
+static double value_at(size_t i) {
+    return (double)i * 0.5 - 3.0;
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 10000000);
+    printf("%zu doubles (%.1f MB)\n", n, (double)n * sizeof(double) / 1e6);
+
+    /* ---- build ---- */
+    double t = bench_now();
+    vec_double v;
+    vec_double_init(&v);
+    for (size_t i = 0; i < n; i++) vec_double_push(&v, value_at(i));
+    FILE* raw = fopen(RAW_PATH, "wb");
+    BENCH_CHECK(raw && fwrite(v.data, sizeof(double), n, raw) == n, "write raw file");
+    fclose(raw);
+    bench_report("vec_double push + fwrite", bench_now() - t, (double)n);
+    vec_double_free(&v);
+
+    mmap_vec_double m;
+    t = bench_now();
+    BENCH_CHECK(mmap_vec_double_open(&m, MAPPED_PATH, MMAP_VEC_TRUNCATE), "create");
+    for (size_t i = 0; i < n; i++) mmap_vec_double_push(&m, value_at(i));
+    mmap_vec_double_flush(&m, false);
+    mmap_vec_double_close(&m);
+    bench_report("mmap_vec_double push + close", bench_now() - t, (double)n);
+
+    /* ---- startup: load everything vs map it ---- */
+    t = bench_now();
+    vec_double_init(&v);
+    raw = fopen(RAW_PATH, "rb");
+    BENCH_CHECK(raw != NULL, "open raw file");
+    vec_double_resize(&v, n);
+    BENCH_CHECK(fread(v.data, sizeof(double), n, raw) == n, "read raw file");
+    fclose(raw);
+    double load_time = bench_now() - t;
+    bench_report("startup: fread into vec_double", load_time, (double)n);
+
+    t = bench_now();
+    BENCH_CHECK(mmap_vec_double_open(&m, MAPPED_PATH, MMAP_VEC_READ_ONLY), "open read-only");
+    double map_time = bench_now() - t;
+    bench_report("startup: mmap_vec_double_open", map_time, (double)n);
+    printf("  startup speedup: %.0fx\n", map_time > 0 ? load_time / map_time : 0.0);
+    BENCH_CHECK(m.len == n, "length persisted");
+
+    double s1 = 0, s2 = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) s1 += v.data[i];
+    bench_report("scan vec_double", bench_now() - t, (double)n);
+    mmap_vec_double_advise(&m, MMAP_VEC_ADVISE_SEQUENTIAL);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) s2 += m.data[i];
+    bench_report("first scan of mapped file", bench_now() - t, (double)n);
+    BENCH_CHECK(s1 == s2, "mapped contents");
+    BENCH_CHECK(mmap_vec_double_get(&m, n / 2) == value_at(n / 2), "get");
+    mmap_vec_double_set(&m, 0, 1.0);     // read-only: refused
+    BENCH_CHECK(m.data[0] == value_at(0), "read-only set refused");
+    mmap_vec_double_close(&m);
+    vec_double_free(&v);
+
+    /* ---- reopen read-write, append, modify ---- */
+    BENCH_CHECK(mmap_vec_double_open(&m, MAPPED_PATH, 0), "reopen");
+    mmap_vec_double_advise(&m, MMAP_VEC_ADVISE_RANDOM);
+    for (size_t i = 0; i < 1000; i++) mmap_vec_double_push(&m, -1.0);
+    mmap_vec_double_set(&m, 5, 42.0);
+    *mmap_vec_double_at_ptr(&m, 6) = 43.0;
+    BENCH_CHECK(mmap_vec_double_flush(&m, true), "flush");
+    mmap_vec_double_close(&m);
+    BENCH_CHECK(mmap_vec_double_open(&m, MAPPED_PATH, MMAP_VEC_READ_ONLY), "reopen read-only");
+    BENCH_CHECK(m.len == n + 1000 && m.data[5] == 42.0 && m.data[6] == 43.0 && m.data[n + 999] == -1.0, "append persisted");
+    mmap_vec_double_close(&m);
+
+    /* ---- files for another type or format are rejected ---- */
+    mmap_vec_long wrong;
+    BENCH_CHECK(!mmap_vec_long_open(&wrong, MAPPED_PATH, MMAP_VEC_READ_ONLY), "type mismatch rejected");
+    BENCH_CHECK(!mmap_vec_double_open(&m, RAW_PATH, MMAP_VEC_READ_ONLY), "headerless file rejected");
+    FILE* f = fopen(MAPPED_PATH, "r+b");
+    uint32_t bad_version = MMAP_VEC_VERSION + 1;
+    fseek(f, offsetof(MmapVecHeader, version), SEEK_SET);
+    fwrite(&bad_version, sizeof(bad_version), 1, f);
+    fclose(f);
+    BENCH_CHECK(!mmap_vec_double_open(&m, MAPPED_PATH, MMAP_VEC_READ_ONLY), "version mismatch rejected");
+
+    remove(MAPPED_PATH);
+    remove(RAW_PATH);
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include "stl.h"
+#include "bench.h"
+#include <threads.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+/*
+ * Several producer threads feeding a pool of consumer threads: queue_int
+ * behind a mutex and two condition variables vs mpmc_queue_int with
+ * blocking enqueue/dequeue (one at a time and in batches), for a range of
+ * producer x consumer counts. Each producer sends its share of 0..n-1, then
+ * one -1 per consumer tells the pool to stop.
+ * usage: mpmc_queue_bench [n]   (n items per configuration, default 4000000)
+ */
+
+DEFINE_QUEUE(int)
+DEFINE_MPMC_QUEUE(int)
+
+#define CAPACITY 4096
+#define BATCH 32
+#define MAX_THREADS 8
+
+/* ---------- Mutex + condition variables around queue_int ---------- */
+
+typedef struct {
+    queue_int q;
+    mtx_t mu;
+    cnd_t not_empty, not_full;
+} LockedQueue;
+
+static void locked_init(LockedQueue* l) {
+    queue_int_init(&l->q);
+    mtx_init(&l->mu, mtx_plain);
+    cnd_init(&l->not_empty);
+    cnd_init(&l->not_full);
+}
+
+static void locked_push(LockedQueue* l, int v) {
+    mtx_lock(&l->mu);
+    while (queue_int_size(&l->q) >= CAPACITY) cnd_wait(&l->not_full, &l->mu);
+    queue_int_enqueue(&l->q, v);
+    cnd_signal(&l->not_empty);
+    mtx_unlock(&l->mu);
+}
+
+static int locked_pop(LockedQueue* l) {
+    mtx_lock(&l->mu);
+    while (queue_int_empty(&l->q)) cnd_wait(&l->not_empty, &l->mu);
+    int v = queue_int_dequeue(&l->q);
+    cnd_signal(&l->not_full);
+    mtx_unlock(&l->mu);
+    return v;
+}
+
+static void locked_free(LockedQueue* l) {
+    queue_int_free(&l->q);
+    mtx_destroy(&l->mu);
+    cnd_destroy(&l->not_empty);
+    cnd_destroy(&l->not_full);
+}
+
+/* ---------- Producers and consumers ---------- */
+
+typedef enum { MODE_LOCKED, MODE_MPMC, MODE_MPMC_BATCH } Mode;
+
+static size_t g_n;
+static int g_producers;
+static Mode g_mode;
+static LockedQueue g_locked;
+static mpmc_queue_int g_mpmc;
+
+typedef struct {
+    int id;
+    long long sum;
+    size_t count;
+} Worker;
+
+static void put(int v) {
+    if (g_mode == MODE_LOCKED) locked_push(&g_locked, v);
+    else mpmc_queue_int_enqueue_wait(&g_mpmc, v);
+}
+
+// Producer id sends i = id, id + P, id + 2P, ... below n
+static int producer(void* arg) {
+    Worker* w = (Worker*)arg;
+    size_t step = (size_t)g_producers;
+    if (g_mode == MODE_MPMC_BATCH) {
+        int buf[BATCH];
+        size_t k = 0;
+        for (size_t i = (size_t)w->id; i < g_n; i += step) {
+            buf[k++] = (int)i;
+            if (k == BATCH) {
+                mpmc_queue_int_enqueue_n_wait(&g_mpmc, buf, k);
+                k = 0;
+            }
+        }
+        mpmc_queue_int_enqueue_n_wait(&g_mpmc, buf, k);
+    } else {
+        for (size_t i = (size_t)w->id; i < g_n; i += step) put((int)i);
+    }
+    return 0;
+}
+
+// Consumes until it takes a -1; surplus -1s from a batch go back for the others
+static int consumer(void* arg) {
+    Worker* w = (Worker*)arg;
+    if (g_mode == MODE_MPMC_BATCH) {
+        int buf[BATCH];
+        for (;;) {
+            size_t k = mpmc_queue_int_dequeue_n_wait(&g_mpmc, buf, BATCH);
+            int stops = 0;
+            for (size_t j = 0; j < k; j++) {
+                if (buf[j] < 0) stops++;
+                else {
+                    w->sum += buf[j];
+                    w->count++;
+                }
+            }
+            if (stops > 0) {
+                while (--stops > 0) mpmc_queue_int_enqueue_wait(&g_mpmc, -1);
+                return 0;
+            }
+        }
+    }
+    for (;;) {
+        int v = g_mode == MODE_LOCKED ? locked_pop(&g_locked) : mpmc_queue_int_dequeue_wait(&g_mpmc);
+        if (v < 0) return 0;
+        w->sum += v;
+        w->count++;
+    }
+}
+
+static void run(const char* label, Mode mode, int producers, int consumers) {
+    g_mode = mode;
+    g_producers = producers;
+    if (mode == MODE_LOCKED) locked_init(&g_locked);
+    else BENCH_CHECK(mpmc_queue_int_init(&g_mpmc, CAPACITY, MPMC_QUEUE_BLOCKING), "init");
+    thrd_t pt[MAX_THREADS], ct[MAX_THREADS];
+    Worker pw[MAX_THREADS], cw[MAX_THREADS];
+    double start = bench_now();
+    for (int i = 0; i < consumers; i++) {
+        cw[i] = (Worker){ i, 0, 0 };
+        thrd_create(&ct[i], consumer, &cw[i]);
+    }
+    for (int i = 0; i < producers; i++) {
+        pw[i] = (Worker){ i, 0, 0 };
+        thrd_create(&pt[i], producer, &pw[i]);
+    }
+    for (int i = 0; i < producers; i++) thrd_join(pt[i], NULL);
+    for (int i = 0; i < consumers; i++) put(-1);
+    long long sum = 0;
+    size_t count = 0;
+    for (int i = 0; i < consumers; i++) {
+        thrd_join(ct[i], NULL);
+        sum += cw[i].sum;
+        count += cw[i].count;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "  %dx%d %s", producers, consumers, label);
+    bench_report(name, bench_now() - start, (double)g_n);
+    BENCH_CHECK(count == g_n && sum == (long long)g_n * ((long long)g_n - 1) / 2, "items lost or duplicated");
+    if (mode == MODE_LOCKED) locked_free(&g_locked);
+    else mpmc_queue_int_free(&g_mpmc);
+}
+
+int main(int argc, char** argv) {
+    g_n = bench_arg(argc, argv, 4000000);
+    int ncpu = 1;
+#ifdef __linux__
+    long c = sysconf(_SC_NPROCESSORS_ONLN);
+    ncpu = c > 0 ? (int)c : 1;
+#endif
+    printf("%zu items, capacity %d, %d CPU(s); producers x consumers\n", g_n, CAPACITY, ncpu);
+
+    static const int configs[][2] = { { 1, 1 }, { 2, 2 }, { 4, 4 }, { 8, 8 }, { 1, 4 }, { 4, 1 } };
+    for (size_t i = 0; i < ARRAY_SIZE(configs); i++) {
+        int p = configs[i][0], cs = configs[i][1];
+        run("queue_int + mutex/condvar", MODE_LOCKED, p, cs);
+        run("mpmc_queue_int enqueue/dequeue_wait", MODE_MPMC, p, cs);
+        run("mpmc_queue_int batches of 32", MODE_MPMC_BATCH, p, cs);
+    }
+
+    /* Single-threaded edge cases: full, empty, partial batches, wrap-around */
+    mpmc_queue_int q;
+    BENCH_CHECK(mpmc_queue_int_init(&q, 5, 0) && mpmc_queue_int_capacity(&q) == 8, "capacity");
+    int v, in[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }, out[10];
+    BENCH_CHECK(!mpmc_queue_int_try_dequeue(&q, &v) && !mpmc_queue_int_has_items(&q), "empty");
+    BENCH_CHECK(mpmc_queue_int_try_enqueue_n(&q, in, 10) == 8 && !mpmc_queue_int_try_enqueue(&q, 8) && !mpmc_queue_int_has_space(&q),
+                "full");
+    BENCH_CHECK(mpmc_queue_int_size(&q) == 8 && mpmc_queue_int_try_dequeue_n(&q, out, 3) == 3 && out[0] == 0 && out[2] == 2, "dequeue_n");
+    BENCH_CHECK(mpmc_queue_int_try_enqueue_n(&q, in + 8, 2) == 2 && mpmc_queue_int_try_enqueue(&q, 10) && !mpmc_queue_int_try_enqueue(&q, 11),
+                "wrap");
+    BENCH_CHECK(mpmc_queue_int_try_dequeue_n(&q, out, 10) == 8, "drain");
+    for (int i = 0; i < 8; i++) BENCH_CHECK(out[i] == i + 3, "order");
+    BENCH_CHECK(mpmc_queue_int_size(&q) == 0 && !mpmc_queue_int_try_dequeue(&q, &v), "empty again");
+    mpmc_queue_int_free(&q);
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Compression ratio and decode speed of packed_vec_long (fixed width) and
+ * delta_vec_long (delta blocks) against a plain vec_long, on sorted IDs
+ * and on small counters. Decode speed is output bytes per second.
+ * usage: packed_vec_bench [n]   (n values, default 10000000)
+ */
+
+typedef unsigned int uint;
+
+DEFINE_VEC(long)
+DEFINE_PACKED_VEC(long)
+DEFINE_PACKED_VEC(int)
+DEFINE_PACKED_VEC(uint)
+DEFINE_DELTA_VEC(long)
+
+#define ROUNDS 5
+#define PROBES 1000000
+
+static void report_decode(const char* label, double seconds, size_t n) {
+    double gb = (double)n * sizeof(long) * ROUNDS / 1e9;
+    printf("  %-36s %9.4f s  %8.2f GB/s\n", label, seconds, seconds > 0 ? gb / seconds : 0.0);
+}
+
+static void run(const char* name, const vec_long* src, long* out) {
+    size_t n = src->len;
+    double raw = (double)n * sizeof(long);
+    printf("%s: %zu values\n", name, n);
+
+    packed_vec_long p;
+    double t = bench_now();
+    BENCH_CHECK(packed_vec_long_from_array(&p, src->data, n), "pack");
+    bench_report("packed_vec_long_from_array", bench_now() - t, (double)n);
+    delta_vec_long d;
+    delta_vec_long_init(&d);
+    t = bench_now();
+    BENCH_CHECK(delta_vec_long_push_array(&d, src->data, n), "delta");
+    bench_report("delta_vec_long_push_array", bench_now() - t, (double)n);
+    printf("  packed: %u bits, %.1fx smaller; delta: %.2f bits/value, %.1fx smaller\n", p.bits,
+           raw / (double)packed_vec_long_bytes(&p), (double)delta_vec_long_bytes(&d) * 8 / (double)n,
+           raw / (double)delta_vec_long_bytes(&d));
+
+    /* Sequential decode: copying the plain vector is the baseline */
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) memcpy(out, src->data, n * sizeof(long));
+    report_decode("vec_long memcpy", bench_now() - t, n);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) packed_vec_long_to_array(&p, out);
+    report_decode("packed_vec_long_to_array", bench_now() - t, n);
+    BENCH_CHECK(memcmp(out, src->data, n * sizeof(long)) == 0, "packed decode");
+
+    numeric_use_simd(false);
+    memset(out, 0, n * sizeof(long));
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) packed_vec_long_to_array(&p, out);
+    report_decode("packed_vec_long_to_array (scalar)", bench_now() - t, n);
+    numeric_use_simd(true);
+    BENCH_CHECK(memcmp(out, src->data, n * sizeof(long)) == 0, "packed scalar decode");
+
+    memset(out, 0, n * sizeof(long));
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) delta_vec_long_to_array(&d, out);
+    report_decode("delta_vec_long_to_array", bench_now() - t, n);
+    BENCH_CHECK(memcmp(out, src->data, n * sizeof(long)) == 0, "delta decode");
+
+    /* Streaming iterators, summing as they go */
+    long s0 = 0, s1 = 0, s2 = 0, x;
+    for (size_t i = 0; i < n; i++) s0 += src->data[i];
+    packed_vec_long_iter pi;
+    t = bench_now();
+    packed_vec_long_iter_init(&pi, &p, 0);
+    while (packed_vec_long_iter_next(&pi, &x)) s1 += x;
+    bench_report("packed_vec_long_iter", bench_now() - t, (double)n);
+    delta_vec_long_iter di;
+    t = bench_now();
+    delta_vec_long_iter_init(&di, &d, 0);
+    while (delta_vec_long_iter_next(&di, &x)) s2 += x;
+    bench_report("delta_vec_long_iter", bench_now() - t, (double)n);
+    BENCH_CHECK(s0 == s1 && s0 == s2, "iterators");
+    delta_vec_long_iter_init(&di, &d, n - 3);
+    BENCH_CHECK(delta_vec_long_iter_next(&di, &x) && x == src->data[n - 3], "iterator seek");
+    delta_vec_long_iter_init(&di, &d, n + 5);
+    BENCH_CHECK(!delta_vec_long_iter_next(&di, &x), "iterator past end");
+
+    /* Random access */
+    uint64_t seed = 7;
+    long g0 = 0, g1 = 0, g2 = 0;
+    size_t* idx = malloc(PROBES * sizeof(size_t));
+    for (size_t i = 0; i < PROBES; i++) idx[i] = (size_t)(bench_rand(&seed) % n);
+    t = bench_now();
+    for (size_t i = 0; i < PROBES; i++) g0 += src->data[idx[i]];
+    bench_report("vec_long random get", bench_now() - t, PROBES);
+    t = bench_now();
+    for (size_t i = 0; i < PROBES; i++) g1 += packed_vec_long_get(&p, idx[i]);
+    bench_report("packed_vec_long_get", bench_now() - t, PROBES);
+    t = bench_now();
+    for (size_t i = 0; i < PROBES; i++) g2 += delta_vec_long_get(&d, idx[i]);
+    bench_report("delta_vec_long_get", bench_now() - t, PROBES);
+    BENCH_CHECK(g0 == g1 && g0 == g2, "random access");
+    free(idx);
+
+    packed_vec_long_free(&p);
+    delta_vec_long_free(&d);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 10000000);
+    long* out = malloc(n * sizeof(long));
+    memset(out, 0, n * sizeof(long));     // fault the pages in before timing
+    uint64_t seed = 42;
+
+    vec_long ids;
+    vec_long_init(&ids);
+    long id = 1000000000L;
+    for (size_t i = 0; i < n; i++) vec_long_push(&ids, id += 1 + (long)(bench_rand(&seed) % 16));
+    run("sorted IDs (gaps 1..16)", &ids, out);
+
+    vec_long counters;
+    vec_long_init(&counters);
+    for (size_t i = 0; i < n; i++) vec_long_push(&counters, (long)(bench_rand(&seed) % 1000));
+    run("counters (0..999)", &counters, out);
+
+    /* Signed and 32-bit element types, odd widths, set */
+    packed_vec_int s;
+    BENCH_CHECK(packed_vec_int_init(&s, 7), "init");
+    for (int i = -64; i < 64; i++) packed_vec_int_push(&s, i);
+    packed_vec_int_push(&s, 64);     // does not fit: refused
+    BENCH_CHECK(s.len == 128 && packed_vec_int_get(&s, 0) == -64 && packed_vec_int_get(&s, 127) == 63, "signed");
+    packed_vec_int_set(&s, 5, -1);
+    int buf[128];
+    packed_vec_int_to_array(&s, buf);
+    BENCH_CHECK(buf[5] == -1 && buf[6] == -58 && buf[100] == 36, "signed unpack");
+    packed_vec_int_free(&s);
+    for (unsigned bits = 1; bits <= 32; bits++) {
+        packed_vec_uint u;
+        packed_vec_uint_init(&u, bits);
+        for (size_t i = 0; i < 1000; i++) packed_vec_uint_push(&u, (uint)(i * 2654435761u) & (uint)packed_mask(bits));
+        uint got[1000];
+        packed_vec_uint_unpack(&u, 3, 1000, got + 3);
+        for (size_t i = 3; i < 1000; i++)
+            BENCH_CHECK(got[i] == ((uint)(i * 2654435761u) & (uint)packed_mask(bits)), "width sweep");
+        packed_vec_uint_free(&u);
+    }
+
+    vec_long_free(&ids);
+    vec_long_free(&counters);
+    free(out);
+    return 0;
+}
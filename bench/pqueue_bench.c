@@ -0,0 +1,282 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * A scheduler loop (pop the earliest deadline, push a later one) over n
+ * pending deadlines: a vec_long kept sorted with vec_long_insert vs
+ * pqueue_long (binary) and pqueue4_long (4-ary). Then heapify vs n pushes
+ * and draining the heap, and Dijkstra on a random graph with ipqueue_long
+ * decrease_key vs a plain heap with lazy deletion.
+ * usage: pqueue_bench [n]   (default 1000000)
+ */
+
+typedef struct {
+    long dist;
+    int node;
+} Item;
+
+#define ITEM_CMP(a, b) PQUEUE_MIN((a).dist, (b).dist)
+
+DEFINE_VEC(long)
+DEFINE_VEC(Item)
+DEFINE_PQUEUE(long, PQUEUE_MIN)
+DEFINE_PQUEUE_NAMED(long, pqueue4_long, PQUEUE_MIN, 4)
+DEFINE_PQUEUE_NAMED(long, pqueue_max_long, PQUEUE_MAX, 2)
+DEFINE_PQUEUE(Item, ITEM_CMP)
+DEFINE_IPQUEUE(long, PQUEUE_MIN)
+DEFINE_IPQUEUE_NAMED(long, ipqueue4_long, PQUEUE_MIN, 4)
+
+#define SORTED_OPS 20000
+#define HEAP_OPS 4000000
+#define DEGREE 8
+
+/* ---------- Scheduler loop ---------- */
+
+// Inserts x into v, kept in descending order (the earliest deadline is at the back)
+static void sorted_insert(vec_long* v, long x) {
+    size_t lo = 0, hi = v->len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (v->data[mid] > x) lo = mid + 1;
+        else hi = mid;
+    }
+    vec_long_insert(v, lo, x);
+}
+
+static void scheduler(size_t n) {
+    uint64_t seed = 1;
+    vec_long init;
+    vec_long_init(&init);
+    for (size_t i = 0; i < n; i++) vec_long_push(&init, (long)(bench_rand(&seed) % 1000000));
+    printf("Scheduler: %zu pending deadlines, pop earliest + push a later one\n", n);
+
+    vec_long sorted;
+    vec_long_init(&sorted);
+    for (size_t i = 0; i < n; i++) sorted_insert(&sorted, init.data[i]);
+    uint64_t s = 2;
+    long sum = 0;
+    double t = bench_now();
+    for (int k = 0; k < SORTED_OPS; k++) {
+        long x = sorted.data[--sorted.len];
+        sum += x;
+        sorted_insert(&sorted, x + 1 + (long)(bench_rand(&s) % 1000000));
+    }
+    bench_report("  sorted vec_long + vec_long_insert", bench_now() - t, SORTED_OPS);
+    long expect = sum;
+
+    pqueue_long pq;
+    BENCH_CHECK(pqueue_long_from_array(&pq, init.data, n), "from_array");
+    s = 2;
+    sum = 0;
+    t = bench_now();
+    for (int k = 0; k < HEAP_OPS; k++) {
+        long x = pqueue_long_top(&pq);
+        sum += x;
+        pqueue_long_replace_top(&pq, x + 1 + (long)(bench_rand(&s) % 1000000));
+        if (k == SORTED_OPS - 1) BENCH_CHECK(sum == expect, "pqueue vs sorted vector");
+    }
+    bench_report("  pqueue_long top + replace_top", bench_now() - t, HEAP_OPS);
+    long heap_sum = sum;
+
+    pqueue4_long pq4;
+    BENCH_CHECK(pqueue4_long_from_array(&pq4, init.data, n), "from_array");
+    s = 2;
+    sum = 0;
+    t = bench_now();
+    for (int k = 0; k < HEAP_OPS; k++) {
+        long x = pqueue4_long_pop(&pq4);
+        sum += x;
+        pqueue4_long_push(&pq4, x + 1 + (long)(bench_rand(&s) % 1000000));
+    }
+    bench_report("  pqueue4_long pop + push", bench_now() - t, HEAP_OPS);
+    BENCH_CHECK(sum == heap_sum, "4-ary vs binary");
+
+    pqueue_long_free(&pq);
+    pqueue4_long_free(&pq4);
+    vec_long_free(&sorted);
+    vec_long_free(&init);
+}
+
+/* ---------- Build and drain ---------- */
+
+static void build_and_drain(size_t n) {
+    printf("Build and drain: %zu random longs\n", n);
+    vec_long v;
+    vec_long_init(&v);
+    uint64_t seed = 3;
+    for (size_t i = 0; i < n; i++) vec_long_push(&v, (long)(bench_rand(&seed) >> 1));
+
+    pqueue_long a;
+    pqueue_long_init(&a);
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) pqueue_long_push(&a, v.data[i]);
+    bench_report("  pqueue_long: n pushes", bench_now() - t, (double)n);
+
+    vec_long copy;
+    vec_long_init(&copy);
+    BENCH_CHECK(vec_long_extend(&copy, v.data, n), "copy");
+    pqueue_long b;
+    t = bench_now();
+    pqueue_long_from_vec(&b, &copy);
+    bench_report("  pqueue_long_from_vec (heapify)", bench_now() - t, (double)n);
+    BENCH_CHECK(copy.data == NULL && pqueue_long_size(&b) == n, "from_vec takes the buffer");
+
+    pqueue4_long c;
+    t = bench_now();
+    BENCH_CHECK(pqueue4_long_from_array(&c, v.data, n), "from_array");
+    bench_report("  pqueue4_long_from_array (heapify)", bench_now() - t, (double)n);
+
+    long prev = LONG_MIN;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        long x = pqueue_long_pop(&b);
+        BENCH_CHECK(x >= prev, "pop order");
+        prev = x;
+    }
+    bench_report("  pqueue_long: pop all", bench_now() - t, (double)n);
+    prev = LONG_MIN;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        long x = pqueue4_long_pop(&c);
+        BENCH_CHECK(x >= prev, "4-ary pop order");
+        prev = x;
+    }
+    bench_report("  pqueue4_long: pop all", bench_now() - t, (double)n);
+    BENCH_CHECK(pqueue_long_empty(&b) && pqueue4_long_empty(&c), "drained");
+
+    pqueue_long_free(&a);
+    pqueue_long_free(&b);
+    pqueue4_long_free(&c);
+    vec_long_free(&v);
+}
+
+/* ---------- Dijkstra ---------- */
+
+typedef struct {
+    int nodes;
+    int* to;            /* DEGREE edges per node */
+    long* weight;
+} Graph;
+
+static void dijkstra_lazy(const Graph* g, long* dist) {
+    pqueue_Item pq;
+    pqueue_Item_init(&pq);
+    for (int i = 0; i < g->nodes; i++) dist[i] = LONG_MAX;
+    dist[0] = 0;
+    pqueue_Item_push(&pq, (Item){ 0, 0 });
+    while (!pqueue_Item_empty(&pq)) {
+        Item it = pqueue_Item_pop(&pq);
+        if (it.dist > dist[it.node]) continue;   /* stale entry */
+        for (int e = it.node * DEGREE; e < (it.node + 1) * DEGREE; e++) {
+            long d = it.dist + g->weight[e];
+            if (d < dist[g->to[e]]) {
+                dist[g->to[e]] = d;
+                pqueue_Item_push(&pq, (Item){ d, g->to[e] });
+            }
+        }
+    }
+    pqueue_Item_free(&pq);
+}
+
+#define DEFINE_DIJKSTRA_INDEXED(NAME) \
+static void dijkstra_##NAME(const Graph* g, long* dist, size_t* handle, int* node_of) { \
+    NAME pq; \
+    NAME##_init(&pq); \
+    for (int i = 0; i < g->nodes; i++) { \
+        dist[i] = LONG_MAX; \
+        handle[i] = IPQUEUE_NONE; \
+    } \
+    dist[0] = 0; \
+    handle[0] = NAME##_push(&pq, 0); \
+    node_of[handle[0]] = 0; \
+    while (!NAME##_empty(&pq)) { \
+        long du; \
+        size_t h = NAME##_pop(&pq, &du); \
+        int u = node_of[h]; \
+        handle[u] = IPQUEUE_NONE; \
+        for (int e = u * DEGREE; e < (u + 1) * DEGREE; e++) { \
+            int v = g->to[e]; \
+            long d = du + g->weight[e]; \
+            if (d >= dist[v]) continue; \
+            dist[v] = d; \
+            if (handle[v] != IPQUEUE_NONE) { \
+                NAME##_decrease_key(&pq, handle[v], d); \
+            } else { \
+                handle[v] = NAME##_push(&pq, d); \
+                node_of[handle[v]] = v; \
+            } \
+        } \
+    } \
+    NAME##_free(&pq); \
+}
+
+DEFINE_DIJKSTRA_INDEXED(ipqueue_long)
+DEFINE_DIJKSTRA_INDEXED(ipqueue4_long)
+
+static void shortest_paths(int nodes) {
+    Graph g = { nodes, (int*)malloc((size_t)nodes * DEGREE * sizeof(int)), (long*)malloc((size_t)nodes * DEGREE * sizeof(long)) };
+    uint64_t seed = 4;
+    for (size_t e = 0; e < (size_t)nodes * DEGREE; e++) {
+        g.to[e] = (int)(bench_rand(&seed) % (uint64_t)nodes);
+        g.weight[e] = 1 + (long)(bench_rand(&seed) % 1000);
+    }
+    long* d1 = (long*)malloc((size_t)nodes * sizeof(long));
+    long* d2 = (long*)malloc((size_t)nodes * sizeof(long));
+    size_t* handle = (size_t*)malloc((size_t)nodes * sizeof(size_t));
+    int* node_of = (int*)malloc((size_t)nodes * sizeof(int));
+    printf("Dijkstra: %d nodes, %d edges each\n", nodes, DEGREE);
+
+    double t = bench_now();
+    dijkstra_lazy(&g, d1);
+    bench_report("  pqueue_Item, lazy deletion (nodes/s)", bench_now() - t, nodes);
+    t = bench_now();
+    dijkstra_ipqueue_long(&g, d2, handle, node_of);
+    bench_report("  ipqueue_long decrease_key (nodes/s)", bench_now() - t, nodes);
+    BENCH_CHECK(memcmp(d1, d2, (size_t)nodes * sizeof(long)) == 0, "distances");
+    t = bench_now();
+    dijkstra_ipqueue4_long(&g, d2, handle, node_of);
+    bench_report("  ipqueue4_long decrease_key (nodes/s)", bench_now() - t, nodes);
+    BENCH_CHECK(memcmp(d1, d2, (size_t)nodes * sizeof(long)) == 0, "4-ary distances");
+
+    free(g.to);
+    free(g.weight);
+    free(d1);
+    free(d2);
+    free(handle);
+    free(node_of);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 1000000);
+    scheduler(n / 10);
+    build_and_drain(n);
+    shortest_paths((int)n);
+
+    /* Max-heap, push_array, replace_top on an empty heap */
+    pqueue_max_long mx;
+    pqueue_max_long_init(&mx);
+    long small[7] = { 3, 1, 4, 1, 5, 9, 2 };
+    BENCH_CHECK(pqueue_max_long_replace_top(&mx, 7) == 7 && pqueue_max_long_top_ptr(&mx) == NULL, "replace_top on empty");
+    BENCH_CHECK(pqueue_max_long_push_array(&mx, small, 7) && pqueue_max_long_top(&mx) == 9, "max push_array");
+    BENCH_CHECK(pqueue_max_long_push_array(&mx, small, 1) && pqueue_max_long_size(&mx) == 8, "push_array, few");
+    BENCH_CHECK(pqueue_max_long_pop(&mx) == 9 && pqueue_max_long_pop(&mx) == 5 && pqueue_max_long_pop(&mx) == 4, "max order");
+    pqueue_max_long_free(&mx);
+
+    /* Indexed: remove and update by handle, handle reuse */
+    ipqueue_long ip;
+    ipqueue_long_init(&ip);
+    size_t h[7];
+    for (int i = 0; i < 7; i++) h[i] = ipqueue_long_push(&ip, small[i] * 10);
+    BENCH_CHECK(ipqueue_long_top(&ip) == 10 && ipqueue_long_get(&ip, h[5]) == 90, "ipqueue top/get");
+    long out;
+    BENCH_CHECK(ipqueue_long_remove(&ip, h[1], &out) && out == 10 && !ipqueue_long_contains(&ip, h[1]), "remove");
+    BENCH_CHECK(ipqueue_long_update(&ip, h[5], 0) && ipqueue_long_top_handle(&ip) == h[5], "update up");
+    BENCH_CHECK(ipqueue_long_update(&ip, h[5], 100) && ipqueue_long_top(&ip) == 10 && ipqueue_long_top_handle(&ip) == h[3], "update down");
+    BENCH_CHECK(!ipqueue_long_decrease_key(&ip, h[6], 50), "decrease_key rejects an increase");
+    BENCH_CHECK(ipqueue_long_push(&ip, 15) == h[1], "handle reuse");
+    long expect[7] = { 10, 15, 20, 30, 40, 50, 100 };
+    for (int i = 0; i < 7; i++) BENCH_CHECK(ipqueue_long_pop(&ip, &out) != IPQUEUE_NONE && out == expect[i], "ipqueue order");
+    BENCH_CHECK(ipqueue_long_empty(&ip), "ipqueue empty");
+    ipqueue_long_free(&ip);
+    return 0;
+}
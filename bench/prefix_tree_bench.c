@@ -0,0 +1,185 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Per-bucket counts in a vec_long that keep changing: prefix and range sums
+ * by scanning with vec_long_get vs fenwick_long vs segtree_long, each under
+ * a mix of point updates and queries. Then lower_bound, batch updates, and
+ * a min segment tree over the same counts.
+ * usage: prefix_tree_bench [n]   (n buckets, default 1048576)
+ */
+
+DEFINE_VEC(long)
+DEFINE_FENWICK(long)
+DEFINE_SEGTREE(long, SEGTREE_SUM)
+DEFINE_SEGTREE_NAMED(long, segtree_min_long, SEGTREE_MIN)
+
+#define SCAN_OPS 200
+#define TREE_OPS 2000000
+
+static long scan_range(vec_long* v, size_t lo, size_t hi) {
+    long sum = 0;
+    for (size_t i = lo; i < hi; i++) sum += vec_long_get(v, i);
+    return sum;
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, (size_t)1 << 20);
+    uint64_t seed = 11;
+    vec_long counts;
+    vec_long_init(&counts);
+    for (size_t i = 0; i < n; i++) vec_long_push(&counts, (long)(bench_rand(&seed) % 100));
+    printf("%zu buckets\n", n);
+
+    fenwick_long f;
+    segtree_long st;
+    double t = bench_now();
+    BENCH_CHECK(fenwick_long_from_vec(&f, &counts), "fenwick build");
+    bench_report("fenwick_long_from_vec", bench_now() - t, (double)n);
+    t = bench_now();
+    BENCH_CHECK(segtree_long_from_vec(&st, &counts), "segtree build");
+    bench_report("segtree_long_from_vec", bench_now() - t, (double)n);
+
+    /* Mixed ops: an update, then a range sum (same sequence for each) */
+    long total = 0;
+    uint64_t s = 5;
+    t = bench_now();
+    for (int k = 0; k < SCAN_OPS; k++) {
+        size_t i = bench_rand(&s) % n, lo = bench_rand(&s) % n, hi = lo + bench_rand(&s) % (n - lo) + 1;
+        vec_long_set(&counts, i, vec_long_get(&counts, i) + 1);
+        total += scan_range(&counts, lo, hi);
+    }
+    bench_report("update + range: vec_long_get scan", bench_now() - t, SCAN_OPS);
+    long expect = total;
+
+    total = 0;
+    s = 5;
+    t = bench_now();
+    for (int k = 0; k < TREE_OPS; k++) {
+        size_t i = bench_rand(&s) % n, lo = bench_rand(&s) % n, hi = lo + bench_rand(&s) % (n - lo) + 1;
+        fenwick_long_add(&f, i, 1);
+        total += fenwick_long_range(&f, lo, hi);
+        if (k == SCAN_OPS - 1) BENCH_CHECK(total == expect, "fenwick vs scan");
+    }
+    bench_report("update + range: fenwick_long", bench_now() - t, TREE_OPS);
+    long fen_total = total;
+
+    total = 0;
+    s = 5;
+    t = bench_now();
+    for (int k = 0; k < TREE_OPS; k++) {
+        size_t i = bench_rand(&s) % n, lo = bench_rand(&s) % n, hi = lo + bench_rand(&s) % (n - lo) + 1;
+        segtree_long_set(&st, i, segtree_long_get(&st, i) + 1);
+        total += segtree_long_query(&st, lo, hi);
+        if (k == SCAN_OPS - 1) BENCH_CHECK(total == expect, "segtree vs scan");
+    }
+    bench_report("update + range: segtree_long", bench_now() - t, TREE_OPS);
+    BENCH_CHECK(total == fen_total, "fenwick vs segtree");
+
+    /* Bring the vector up to date and compare element by element */
+    vec_long now;
+    vec_long_init(&now);
+    BENCH_CHECK(fenwick_long_to_vec(&f, &now) && now.len == n, "fenwick to_vec");
+    for (size_t i = 0; i < n; i++) BENCH_CHECK(now.data[i] == segtree_long_get(&st, i), "fenwick vs segtree elements");
+    for (size_t i = 0; i < n; i += n / 64 + 1) BENCH_CHECK(fenwick_long_get(&f, i) == now.data[i], "fenwick get");
+
+    /* lower_bound on the prefix sum: which bucket holds the k-th item */
+    long sum_all = fenwick_long_prefix(&f, n);
+    size_t hits = 0;
+    s = 9;
+    t = bench_now();
+    for (int k = 0; k < SCAN_OPS; k++) {
+        long target = (long)(bench_rand(&s) % (uint64_t)sum_all) + 1;
+        long acc = 0;
+        size_t i = 0;
+        while (i < n && (acc += now.data[i]) < target) i++;
+        hits += i;
+    }
+    bench_report("lower_bound: linear scan", bench_now() - t, SCAN_OPS);
+    size_t expect_hits = hits;
+    hits = 0;
+    s = 9;
+    t = bench_now();
+    for (int k = 0; k < TREE_OPS; k++) {
+        long target = (long)(bench_rand(&s) % (uint64_t)sum_all) + 1;
+        hits += fenwick_long_lower_bound(&f, target);
+        if (k == SCAN_OPS - 1) BENCH_CHECK(hits == expect_hits, "fenwick lower_bound");
+    }
+    bench_report("lower_bound: fenwick_long", bench_now() - t, TREE_OPS);
+    size_t fen_hits = hits;
+    hits = 0;
+    s = 9;
+    t = bench_now();
+    for (int k = 0; k < TREE_OPS; k++) {
+        long target = (long)(bench_rand(&s) % (uint64_t)sum_all) + 1;
+        hits += segtree_long_lower_bound(&st, target);
+    }
+    bench_report("lower_bound: segtree_long", bench_now() - t, TREE_OPS);
+    BENCH_CHECK(hits == fen_hits && fenwick_long_lower_bound(&f, sum_all + 1) == n && segtree_long_lower_bound(&st, sum_all + 1) == n,
+                "lower_bound");
+
+    /* Batch updates: n / 2 random adds */
+    size_t k = n / 2;
+    size_t* idx = (size_t*)malloc(k * sizeof(size_t));
+    long* delta = (long*)malloc(k * sizeof(long));
+    long* vals = (long*)malloc(k * sizeof(long));
+    for (size_t j = 0; j < k; j++) {
+        idx[j] = bench_rand(&s) % n;
+        delta[j] = (long)(bench_rand(&s) % 7);
+    }
+    fenwick_long g;
+    BENCH_CHECK(fenwick_long_from_vec(&g, &now), "copy");
+    t = bench_now();
+    for (size_t j = 0; j < k; j++) fenwick_long_add(&g, idx[j], delta[j]);
+    bench_report("batch: fenwick_long_add loop", bench_now() - t, (double)k);
+    t = bench_now();
+    BENCH_CHECK(fenwick_long_add_batch(&f, idx, delta, k), "add_batch");
+    bench_report("batch: fenwick_long_add_batch", bench_now() - t, (double)k);
+    for (size_t i = 0; i <= n; i += n / 64 + 1) BENCH_CHECK(fenwick_long_prefix(&f, i) == fenwick_long_prefix(&g, i), "add_batch result");
+
+    for (size_t j = 0; j < k; j++) now.data[idx[j]] += delta[j];
+    for (size_t j = 0; j < k; j++) vals[j] = now.data[idx[j]];
+    segtree_long sg;
+    BENCH_CHECK(segtree_long_from_vec(&sg, &counts), "copy");
+    t = bench_now();
+    for (size_t j = 0; j < k; j++) segtree_long_set(&sg, idx[j], vals[j]);
+    bench_report("batch: segtree_long_set loop", bench_now() - t, (double)k);
+    t = bench_now();
+    BENCH_CHECK(segtree_long_set_batch(&st, idx, vals, k), "set_batch");
+    bench_report("batch: segtree_long_set_batch", bench_now() - t, (double)k);
+    for (size_t i = 1; i <= n; i += n / 64 + 1)
+        BENCH_CHECK(segtree_long_prefix(&st, i) == fenwick_long_prefix(&f, i), "set_batch result");
+
+    /* Min over ranges, and a non-power-of-two size */
+    segtree_min_long mn;
+    BENCH_CHECK(segtree_min_long_from_vec(&mn, &now), "min build");
+    for (int q = 0; q < 100; q++) {
+        size_t lo = bench_rand(&s) % n, hi = lo + bench_rand(&s) % (n - lo > 1000 ? 1000 : n - lo) + 1;
+        long m = now.data[lo];
+        for (size_t i = lo; i < hi; i++) m = now.data[i] < m ? now.data[i] : m;
+        BENCH_CHECK(segtree_min_long_query(&mn, lo, hi) == m, "min query");
+    }
+    segtree_min_long_free(&mn);
+    fenwick_long h;
+    fenwick_long_init(&h, 0);
+    long small[7] = { 3, 0, 4, 1, 5, 9, 2 };
+    for (int i = 0; i < 7; i++) fenwick_long_push(&h, small[i]);
+    BENCH_CHECK(fenwick_long_prefix(&h, 7) == 24 && fenwick_long_range(&h, 2, 5) == 10 && fenwick_long_lower_bound(&h, 8) == 3 &&
+                    fenwick_long_lower_bound(&h, 14) == 5,
+                "push");
+    BENCH_CHECK(segtree_min_long_from_array(&mn, small, 7) && segtree_min_long_all(&mn) == 0 && segtree_min_long_query(&mn, 2, 7) == 1,
+                "min, odd size");
+
+    segtree_min_long_free(&mn);
+    fenwick_long_free(&h);
+    free(idx);
+    free(delta);
+    free(vals);
+    fenwick_long_free(&f);
+    fenwick_long_free(&g);
+    segtree_long_free(&st);
+    segtree_long_free(&sg);
+    vec_long_free(&now);
+    vec_long_free(&counts);
+    return 0;
+}
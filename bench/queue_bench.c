@@ -0,0 +1,103 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * FIFO throughput: queue_int (circular buffer) vs the previous vec_int-backed
+ * queue, whose dequeue was vec_int_remove(&v, 0). Fill n then drain, a
+ * steady state of n queued items with one enqueue and one dequeue per step,
+ * and batch enqueue_n / dequeue_n.
+ * usage: queue_bench [n]   (n items, default 100000)
+ */
+
+DEFINE_VEC(int)
+DEFINE_QUEUE(int)
+
+#define STEADY_OLD 10000
+#define STEADY_NEW 50000000
+#define BATCH 256
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 100000);
+    printf("%zu items\n", n);
+
+    /* Fill then drain */
+    vec_int old;
+    vec_int_init(&old);
+    long long s1 = 0, s2 = 0;
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) vec_int_push(&old, (int)i);
+    while (old.len > 0) {
+        s1 += vec_int_get(&old, 0);
+        vec_int_remove(&old, 0);
+    }
+    bench_report("fill + drain: vec_int remove(0)", bench_now() - t, (double)n);
+    queue_int q;
+    queue_int_init(&q);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) queue_int_enqueue(&q, (int)i);
+    while (!queue_int_empty(&q)) s2 += queue_int_dequeue(&q);
+    bench_report("fill + drain: queue_int", bench_now() - t, (double)n);
+    BENCH_CHECK(s1 == s2, "drain order");
+
+    /* Steady state: n items queued, enqueue one and dequeue one per step */
+    for (size_t i = 0; i < n; i++) vec_int_push(&old, (int)i);
+    s1 = s2 = 0;
+    t = bench_now();
+    for (int i = 0; i < STEADY_OLD; i++) {
+        vec_int_push(&old, (int)n + i);
+        s1 += vec_int_get(&old, 0);
+        vec_int_remove(&old, 0);
+    }
+    bench_report("steady: vec_int remove(0)", bench_now() - t, STEADY_OLD);
+    for (size_t i = 0; i < n; i++) queue_int_enqueue(&q, (int)i);
+    t = bench_now();
+    for (int i = 0; i < STEADY_NEW; i++) {
+        queue_int_enqueue(&q, (int)n + i);
+        int v = queue_int_dequeue(&q);
+        if (i < STEADY_OLD) s2 += v;
+    }
+    bench_report("steady: queue_int", bench_now() - t, STEADY_NEW);
+    BENCH_CHECK(s1 == s2 && queue_int_size(&q) == n, "steady state");
+    BENCH_CHECK(queue_int_front(&q) == (int)n + STEADY_NEW - (int)n && queue_int_rear(&q) == (int)n + STEADY_NEW - 1, "wrapped ends");
+    vec_int_free(&old);
+
+    /* Batches of BATCH through a queue that stays about n long */
+    int in[BATCH], out[BATCH];
+    size_t rounds = STEADY_NEW / BATCH;
+    s1 = s2 = 0;
+    int next = 0;
+    queue_int_dequeue_n(&q, NULL, queue_int_size(&q));
+    for (size_t i = 0; i < n; i++) queue_int_enqueue(&q, (int)(i - n));
+    t = bench_now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (int j = 0; j < BATCH; j++) queue_int_enqueue(&q, next++);
+        for (int j = 0; j < BATCH; j++) s1 += queue_int_dequeue(&q);
+    }
+    bench_report("batch: enqueue / dequeue loop", bench_now() - t, (double)rounds * BATCH);
+    queue_int_dequeue_n(&q, NULL, queue_int_size(&q));
+    for (size_t i = 0; i < n; i++) queue_int_enqueue(&q, (int)(i - n));
+    next = 0;
+    t = bench_now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (int j = 0; j < BATCH; j++) in[j] = next++;
+        queue_int_enqueue_n(&q, in, BATCH);
+        queue_int_dequeue_n(&q, out, BATCH);
+        for (int j = 0; j < BATCH; j++) s2 += out[j];
+    }
+    bench_report("batch: enqueue_n / dequeue_n", bench_now() - t, (double)rounds * BATCH);
+    BENCH_CHECK(queue_int_size(&q) == n && s1 == s2, "batch");
+
+    /* Growth while wrapped keeps the order */
+    queue_int w;
+    queue_int_init(&w);
+    for (int i = 0; i < 10; i++) queue_int_enqueue(&w, i);
+    for (int i = 0; i < 8; i++) queue_int_dequeue(&w);
+    for (int i = 10; i < 100; i++) queue_int_enqueue(&w, i);
+    int got[100];
+    BENCH_CHECK(queue_int_dequeue_n(&w, got, 100) == 92 && got[0] == 8 && got[91] == 99 && queue_int_empty(&w), "growth order");
+    queue_int_shrink_to_fit(&w);
+    BENCH_CHECK(w.cap == 0 && w.data == NULL, "shrink_to_fit");
+    queue_int_free(&w);
+    queue_int_free(&q);
+    return 0;
+}
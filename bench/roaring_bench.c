@@ -0,0 +1,123 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Set_int (BST) vs Roaring: memory, build, lookup and set algebra.
+ * usage: roaring_bench [n]   (n random ids per set, default 1000000)
+ */
+
+DEFINE_SET(int, int, "%d")
+DEFINE_ROARING_SET(int, int)
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 1000000);
+    uint64_t seed = 42;
+    int* ids_a = malloc(n * sizeof(int));
+    int* ids_b = malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) {
+        ids_a[i] = (int)(bench_rand(&seed) % (n * 4));
+        ids_b[i] = (int)(bench_rand(&seed) % (n * 4));
+    }
+    printf("Roaring vs Set_int, %zu random ids in [0, %zu)\n", n, n * 4);
+
+    Set_int sa, sb;
+    set_init_int(&sa);
+    set_init_int(&sb);
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) set_add_int(&sa, ids_a[i]);
+    bench_report("Set_int add", bench_now() - t, (double)n);
+    for (size_t i = 0; i < n; i++) set_add_int(&sb, ids_b[i]);
+
+    Roaring ra, rb;
+    roaring_init(&ra);
+    roaring_init(&rb);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) roaring_add(&ra, (uint32_t)ids_a[i]);
+    bench_report("Roaring add", bench_now() - t, (double)n);
+    for (size_t i = 0; i < n; i++) roaring_add(&rb, (uint32_t)ids_b[i]);
+    BENCH_CHECK(roaring_cardinality(&ra) == sa.size, "cardinality");
+
+    size_t hits_set = 0, hits_roaring = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) hits_set += set_contains_int(&sa, ids_b[i]);
+    bench_report("Set_int contains", bench_now() - t, (double)n);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) hits_roaring += roaring_contains(&ra, (uint32_t)ids_b[i]);
+    bench_report("Roaring contains", bench_now() - t, (double)n);
+    BENCH_CHECK(hits_set == hits_roaring, "contains");
+
+    /* set_intersection re-inserts sorted values, degrading the BST to O(k^2) */
+    size_t inter_size = 0;
+    if (n <= 100000) {
+        t = bench_now();
+        Set_int si = set_intersection_int(&sa, &sb);
+        bench_report("Set_int intersection", bench_now() - t, (double)n);
+        inter_size = si.size;
+    } else {
+        printf("  %-36s skipped above 100000 ids (quadratic)\n", "Set_int intersection");
+        SetIter_int it;
+        set_iter_init_int(&it, &sa);
+        int x;
+        while (set_iter_next_int(&it, &x)) inter_size += set_contains_int(&sb, x);
+        set_iter_free_int(&it);
+    }
+    t = bench_now();
+    Roaring ri = roaring_and(&ra, &rb);
+    bench_report("Roaring and", bench_now() - t, (double)n);
+    BENCH_CHECK(roaring_cardinality(&ri) == inter_size, "intersection");
+
+    t = bench_now();
+    Roaring ru = roaring_or(&ra, &rb);
+    bench_report("Roaring or", bench_now() - t, (double)n);
+    t = bench_now();
+    Roaring rx = roaring_xor(&ra, &rb);
+    bench_report("Roaring xor", bench_now() - t, (double)n);
+    BENCH_CHECK(roaring_cardinality(&ru) == roaring_cardinality(&rx) + roaring_cardinality(&ri), "or/xor/and");
+
+    uint32_t v;
+    BENCH_CHECK(roaring_select(&ra, 10, &v) && roaring_rank(&ra, v) == 11, "rank/select");
+    size_t bytes = roaring_serialized_size(&ra);
+    uint8_t* buf = malloc(bytes);
+    roaring_serialize(&ra, buf);
+    Roaring rd;
+    roaring_init(&rd);
+    BENCH_CHECK(roaring_deserialize(&rd, buf, bytes), "deserialize");
+    Roaring rdiff = roaring_xor(&ra, &rd);
+    BENCH_CHECK(roaring_empty(&rdiff), "serialization round trip");
+
+    /* Corrupt payloads: an unsorted array container, a bitmap whose popcount disagrees with card */
+    Roaring small;
+    roaring_init(&small);
+    roaring_add(&small, 1);
+    roaring_add(&small, 2);
+    uint8_t sbuf[64];
+    size_t sbytes = roaring_serialize(&small, sbuf);
+    uint8_t tmp = sbuf[16];
+    sbuf[16] = sbuf[18];
+    sbuf[18] = tmp;
+    BENCH_CHECK(!roaring_deserialize(&rd, sbuf, sbytes), "reject unsorted array");
+    for (uint32_t i = 0; i < 5000; i++) roaring_add(&small, i * 3);
+    size_t dbytes = roaring_serialized_size(&small);
+    uint8_t* dbuf = malloc(dbytes);
+    roaring_serialize(&small, dbuf);
+    dbuf[16] ^= 0x02;   /* clears value 1 but leaves card alone */
+    BENCH_CHECK(!roaring_deserialize(&rd, dbuf, dbytes), "reject bitmap card mismatch");
+    free(dbuf);
+    roaring_free(&small);
+
+    Set_int back = roaring_to_set_int(&ra);
+    BENCH_CHECK(set_is_equal_int(&back, &sa), "to_set");
+
+    size_t set_bytes = sa.size * sizeof(SetNode_int);
+    roaring_shrink_to_fit(&ra);
+    printf("  Memory: Set_int %zu bytes (%.1f B/id, excl. malloc headers), Roaring %zu bytes (%.2f B/id), serialized %zu bytes\n",
+           set_bytes, (double)set_bytes / sa.size, roaring_memory_usage(&ra),
+           (double)roaring_memory_usage(&ra) / sa.size, bytes);
+
+    free(buf);
+    free(ids_a);
+    free(ids_b);
+    roaring_free(&ra); roaring_free(&rb); roaring_free(&ri); roaring_free(&ru);
+    roaring_free(&rx); roaring_free(&rd); roaring_free(&rdiff);
+    return 0;
+}
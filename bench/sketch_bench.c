@@ -0,0 +1,160 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Sketches vs exact structures on a skewed event stream: HyperLogLog vs
+ * Set_int for distinct counts, Count-Min / Space-Saving vs
+ * HashMap_string_long for frequencies, and 4-shard merges.
+ * usage: sketch_bench [n]   (n events, default 2000000)
+ */
+
+DEFINE_SET(int, int, "%d")
+HASHMAP_STRING_LONG
+SKETCH_INT
+SKETCH_STRING
+
+#define SHARDS 4
+#define TOP 10
+
+static int skewed_id(uint64_t* seed, size_t distinct) {
+    double u = (double)(bench_rand(seed) >> 11) / 9007199254740992.0;
+    return (int)pow((double)distinct, u) - 1;   // log-uniform: low ids dominate
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 2000000);
+    size_t distinct = n / 4 + 1;
+    uint64_t seed = 99;
+    int* ids = malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) ids[i] = (int)((long long)skewed_id(&seed, distinct) * 7919 % (long long)distinct);
+    char** names = malloc(distinct * sizeof(char*));
+    for (size_t i = 0; i < distinct; i++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "user:%zu", i);
+        names[i] = malloc(strlen(buf) + 1);
+        strcpy(names[i], buf);
+    }
+    printf("Sketches vs exact, %zu events over up to %zu ids\n", n, distinct);
+
+    /* ---- distinct count ---- */
+    Set_int set;
+    set_init_int(&set);
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) set_add_int(&set, ids[i]);
+    bench_report("Set_int add", bench_now() - t, (double)n);
+
+    HyperLogLog hll;
+    hll_init(&hll, HLL_DEFAULT_PRECISION);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) hll_add_int(&hll, ids[i]);
+    bench_report("HyperLogLog add", bench_now() - t, (double)n);
+
+    double est = hll_estimate(&hll);
+    double rel = fabs(est - (double)set.size) / (double)set.size;
+    double bound = 1.04 / sqrt((double)hll.count);
+    printf("  distinct exact %zu, HLL %.0f (error %.3f%%, std error %.3f%%)\n", set.size, est, rel * 100, bound * 100);
+    printf("  memory: Set_int %zu bytes, HLL %zu bytes\n", set.size * sizeof(SetNode_int), hll_memory_usage(&hll));
+    BENCH_CHECK(rel < 4 * bound, "HLL within 4 standard errors");
+
+    HyperLogLog shards[SHARDS];
+    for (int s = 0; s < SHARDS; s++) hll_init(&shards[s], HLL_DEFAULT_PRECISION);
+    for (size_t i = 0; i < n; i++) hll_add_int(&shards[i % SHARDS], ids[i]);
+    for (int s = 1; s < SHARDS; s++) hll_merge(&shards[0], &shards[s]);
+    BENCH_CHECK(memcmp(shards[0].registers, hll.registers, hll.count) == 0, "HLL merge equals single sketch");
+
+    /* ---- frequencies ---- */
+    HashMap_string_long freq;
+    hashmap_init_string_long(&freq);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        long c = 0;
+        hashmap_get_string_long(&freq, names[ids[i]], &c);
+        hashmap_put_string_long(&freq, names[ids[i]], c + 1);
+    }
+    bench_report("HashMap_string_long count", bench_now() - t, (double)n);
+
+    CountMin cms;
+    cms_init_error(&cms, 0.0005, 0.01);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) cms_add_string(&cms, names[ids[i]], 1);
+    bench_report("CountMin add", bench_now() - t, (double)n);
+
+    SpaceSaving_string ss;
+    spacesaving_init_string(&ss, 256);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) spacesaving_add_string(&ss, names[ids[i]], 1);
+    bench_report("SpaceSaving add", bench_now() - t, (double)n);
+
+    printf("  memory: HashMap %zu bytes (without key strings), CountMin %zu bytes, SpaceSaving %zu bytes\n",
+           freq.capacity * sizeof(HashNode_string_long*) + freq.size * sizeof(HashNode_string_long),
+           cms_memory_usage(&cms), spacesaving_memory_usage_string(&ss));
+
+    size_t over = 0;
+    for (size_t i = 0; i < distinct; i++) {
+        long exact = 0;
+        hashmap_get_string_long(&freq, names[i], &exact);
+        uint32_t e = cms_estimate_string(&cms, names[i]);
+        BENCH_CHECK((long)e >= exact, "CountMin never undercounts");
+        over += (double)e - (double)exact > 0.0005 * (double)n;
+    }
+    printf("  CountMin keys over eps*N: %zu of %zu (delta 1%%)\n", over, distinct);
+    BENCH_CHECK(over <= distinct / 50 + 1, "CountMin error bound");
+
+    /* Exact top-k for the Space-Saving check */
+    const char* top_keys[TOP];
+    long top_counts[TOP];
+    size_t ntop = 0;
+    for (size_t b = 0; b < freq.capacity; b++) {
+        for (HashNode_string_long* e = freq.buckets[b]; e; e = e->next) {
+            size_t j = ntop < TOP ? ntop++ : TOP;
+            while (j > 0 && top_counts[j - 1] < e->value) {
+                if (j < TOP) { top_keys[j] = top_keys[j - 1]; top_counts[j] = top_counts[j - 1]; }
+                j--;
+            }
+            if (j < TOP) { top_keys[j] = e->key; top_counts[j] = e->value; }
+        }
+    }
+    SpaceSavingEntry_string heavy[TOP];
+    size_t nh = spacesaving_top_string(&ss, heavy, TOP);
+    for (size_t i = 0; i < nh; i++) printf("  #%zu %-12s ~%llu (exact %ld)\n", i + 1, heavy[i].key,
+                                           (unsigned long long)heavy[i].count, top_counts[i]);
+    for (size_t i = 0; i < ntop; i++) {
+        uint64_t err, c = spacesaving_estimate_string(&ss, (char*)top_keys[i], &err);
+        BENCH_CHECK(c >= (uint64_t)top_counts[i] && c - err <= (uint64_t)top_counts[i], "SpaceSaving bounds");
+    }
+
+    CountMin cms_shards[SHARDS];
+    SpaceSaving_string ss_shards[SHARDS];
+    for (int s = 0; s < SHARDS; s++) {
+        cms_init_error(&cms_shards[s], 0.0005, 0.01);
+        spacesaving_init_string(&ss_shards[s], 256);
+    }
+    for (size_t i = 0; i < n; i++) {
+        cms_add_string(&cms_shards[i % SHARDS], names[ids[i]], 1);
+        spacesaving_add_string(&ss_shards[i % SHARDS], names[ids[i]], 1);
+    }
+    for (int s = 1; s < SHARDS; s++) {
+        cms_merge(&cms_shards[0], &cms_shards[s]);
+        spacesaving_merge_string(&ss_shards[0], &ss_shards[s]);
+    }
+    BENCH_CHECK(memcmp(cms_shards[0].counters, cms.counters, cms.width * cms.depth * sizeof(uint32_t)) == 0,
+                "CountMin merge equals single sketch");
+    for (size_t i = 0; i < ntop; i++) {
+        uint64_t err, c = spacesaving_estimate_string(&ss_shards[0], (char*)top_keys[i], &err);
+        BENCH_CHECK(c >= (uint64_t)top_counts[i] && c - err <= (uint64_t)top_counts[i], "merged SpaceSaving bounds");
+    }
+
+    for (int s = 0; s < SHARDS; s++) {
+        hll_free(&shards[s]);
+        cms_free(&cms_shards[s]);
+        spacesaving_free_string(&ss_shards[s]);
+    }
+    spacesaving_free_string(&ss);
+    cms_free(&cms);
+    hll_free(&hll);
+    hashmap_destroy_string_long(&freq);
+    for (size_t i = 0; i < distinct; i++) free(names[i]);
+    free(names);
+    free(ids);
+    return 0;
+}
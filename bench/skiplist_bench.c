@@ -0,0 +1,137 @@
+#include "stl.h"
+#include "bench.h"
+#include <threads.h>
+
+/*
+ * Concurrent skip list vs Set_int behind one global mutex.
+ * Mixed workload: 90% contains, 10% insert (Set_T has no remove), over
+ * 1..8 threads. The skip list also runs a 80/10/10 contains/insert/remove mix,
+ * and a stress case of 8 threads inserting and removing STRESS_KEYS keys.
+ * usage: skiplist_bench [ops_per_thread]   (default 1000000)
+ */
+
+DEFINE_SET(int, int, "%d")
+DEFINE_CONCURRENT_SKIPLIST(int, int)
+
+#define KEY_RANGE (1 << 20)
+
+static ConcurrentSkipList_int g_list;
+static Set_int g_set;
+static mtx_t g_lock;
+static size_t g_ops;
+static int g_remove_pct;
+
+typedef struct {
+    uint64_t seed;
+    size_t hits;
+} WorkerArg;
+
+static int skiplist_worker(void* p) {
+    WorkerArg* w = p;
+    for (size_t i = 0; i < g_ops; i++) {
+        uint64_t r = bench_rand(&w->seed);
+        int key = (int)(r % KEY_RANGE);
+        int pct = (int)((r >> 32) % 100);
+        if (pct < 10) skiplist_insert_int(&g_list, key);
+        else if (pct < 10 + g_remove_pct) skiplist_remove_int(&g_list, key);
+        else w->hits += skiplist_contains_int(&g_list, key);
+    }
+    return 0;
+}
+
+#define STRESS_KEYS 64
+
+// Inserts and removes over a few keys, so towers are unlinked while still being built
+static int stress_worker(void* p) {
+    WorkerArg* w = p;
+    for (size_t i = 0; i < g_ops; i++) {
+        uint64_t r = bench_rand(&w->seed);
+        int key = (int)(r % STRESS_KEYS);
+        if ((r >> 32) & 1) skiplist_insert_int(&g_list, key);
+        else skiplist_remove_int(&g_list, key);
+    }
+    return 0;
+}
+
+typedef struct {
+    int prev;
+    size_t count;
+    bool ordered;
+} StressCheck;
+
+static bool stress_visit(int key, void* ctx) {
+    StressCheck* c = ctx;
+    if (key <= c->prev) c->ordered = false;
+    c->prev = key;
+    c->count++;
+    return true;
+}
+
+static int locked_set_worker(void* p) {
+    WorkerArg* w = p;
+    for (size_t i = 0; i < g_ops; i++) {
+        uint64_t r = bench_rand(&w->seed);
+        int key = (int)(r % KEY_RANGE);
+        int pct = (int)((r >> 32) % 100);
+        mtx_lock(&g_lock);
+        if (pct < 10) set_add_int(&g_set, key);
+        else w->hits += set_contains_int(&g_set, key);
+        mtx_unlock(&g_lock);
+    }
+    return 0;
+}
+
+static double run(int (*fn)(void*), int nthreads) {
+    thrd_t threads[16];
+    WorkerArg args[16];
+    double t = bench_now();
+    for (int i = 0; i < nthreads; i++) {
+        args[i].seed = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+        args[i].hits = 0;
+        thrd_create(&threads[i], fn, &args[i]);
+    }
+    for (int i = 0; i < nthreads; i++) thrd_join(threads[i], NULL);
+    return bench_now() - t;
+}
+
+int main(int argc, char** argv) {
+    g_ops = bench_arg(argc, argv, 1000000);
+    mtx_init(&g_lock, mtx_plain);
+    printf("Concurrent skip list vs mutex-protected Set_int, %zu ops/thread, keys in [0, %d)\n", g_ops, KEY_RANGE);
+
+    for (int nthreads = 1; nthreads <= 8; nthreads *= 2) {
+        char label[64];
+        double total = (double)g_ops * nthreads;
+        uint64_t seed = 7;
+
+        set_init_int(&g_set);
+        for (int i = 0; i < KEY_RANGE / 2; i++) set_add_int(&g_set, (int)(bench_rand(&seed) % KEY_RANGE));
+        snprintf(label, sizeof(label), "Set_int + mutex, %d threads", nthreads);
+        bench_report(label, run(locked_set_worker, nthreads), total);
+
+        for (g_remove_pct = 0; g_remove_pct <= 10; g_remove_pct += 10) {
+            seed = 7;
+            skiplist_init_int(&g_list);
+            for (int i = 0; i < KEY_RANGE / 2; i++) skiplist_insert_int(&g_list, (int)(bench_rand(&seed) % KEY_RANGE));
+            snprintf(label, sizeof(label), "skiplist %s, %d threads", g_remove_pct ? "80/10/10" : "90/10", nthreads);
+            bench_report(label, run(skiplist_worker, nthreads), total);
+            skiplist_destroy_int(&g_list);
+        }
+    }
+
+    /* Contended insert/remove on STRESS_KEYS keys; run under ASan to catch reclamation bugs */
+    size_t ops = g_ops;
+    g_ops = ops / 4;
+    skiplist_init_int(&g_list);
+    bench_report("skiplist stress, 8 threads", run(stress_worker, 8), (double)g_ops * 8);
+    StressCheck sc = { -1, 0, true };
+    skiplist_range_int(&g_list, 0, STRESS_KEYS, stress_visit, &sc);
+    size_t present = 0;
+    for (int k = 0; k < STRESS_KEYS; k++) present += skiplist_contains_int(&g_list, k);
+    BENCH_CHECK(sc.ordered && sc.count == present && skiplist_size_int(&g_list) == present, "stress consistency");
+    skiplist_destroy_int(&g_list);
+    g_ops = ops;
+
+    mtx_destroy(&g_lock);
+    return 0;
+}
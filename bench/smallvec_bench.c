@@ -0,0 +1,97 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Short-vector-heavy workload: vec_int vs smallvec_int_8, and stack_int vs
+ * smallstack_int_8. Allocations are counted as capacity changes.
+ * usage: smallvec_bench [n]   (n short vectors, default 2000000)
+ */
+
+DEFINE_VEC(int)
+DEFINE_STACK(int)
+DEFINE_SMALLVEC(int, 8)
+DEFINE_SMALLSTACK(int, 8)
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 2000000);
+    uint64_t seed = 5;
+    unsigned char* sizes = malloc(n);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = bench_rand(&seed);
+        sizes[i] = (unsigned char)((r % 10 == 0) ? 9 + (r >> 8) % 24 : (r >> 8) % 9);   // 90% hold 0..8
+    }
+    printf("%zu short vectors (90%% with <= 8 elements)\n", n);
+
+    long long sum_vec = 0, sum_small = 0;
+    size_t allocs_vec = 0, allocs_small = 0;
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        vec_int v;
+        vec_int_init(&v);
+        size_t cap = 0;
+        for (int k = 0; k < sizes[i]; k++) {
+            vec_int_push(&v, k * (int)i);
+            if (v.cap != cap) { cap = v.cap; allocs_vec++; }
+        }
+        for (size_t k = 0; k < v.len; k++) sum_vec += vec_int_get(&v, k);
+        vec_int_free(&v);
+    }
+    double t_vec = bench_now() - t;
+    bench_report("vec_int", t_vec, (double)n);
+
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        smallvec_int_8 v;
+        smallvec_int_8_init(&v);
+        size_t cap = v.cap;
+        for (int k = 0; k < sizes[i]; k++) {
+            smallvec_int_8_push(&v, k * (int)i);
+            if (v.cap != cap) { cap = v.cap; allocs_small++; }
+        }
+        for (size_t k = 0; k < v.len; k++) sum_small += smallvec_int_8_get(&v, k);
+        smallvec_int_8_free(&v);
+    }
+    double t_small = bench_now() - t;
+    bench_report("smallvec_int_8", t_small, (double)n);
+    BENCH_CHECK(sum_vec == sum_small, "sum");
+    printf("  allocations: vec_int %zu, smallvec_int_8 %zu (%.1f%% avoided), speedup %.2fx\n",
+           allocs_vec, allocs_small, 100.0 * (double)(allocs_vec - allocs_small) / (double)allocs_vec, t_vec / t_small);
+
+    /* Short-lived stacks, e.g. an expression evaluator per request */
+    long long acc_stack = 0, acc_small = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        stack_int s;
+        stack_int_init(&s);
+        for (int k = 0; k < sizes[i]; k++) stack_int_push(&s, k);
+        while (!stack_int_empty(&s)) acc_stack += stack_int_pop(&s);
+        stack_int_free(&s);
+    }
+    double t_stack = bench_now() - t;
+    bench_report("stack_int", t_stack, (double)n);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        smallstack_int_8 s;
+        smallstack_int_8_init(&s);
+        for (int k = 0; k < sizes[i]; k++) smallstack_int_8_push(&s, k);
+        while (!smallstack_int_8_empty(&s)) acc_small += smallstack_int_8_pop(&s);
+        smallstack_int_8_free(&s);
+    }
+    double t_sstack = bench_now() - t;
+    bench_report("smallstack_int_8", t_sstack, (double)n);
+    BENCH_CHECK(acc_stack == acc_small, "stack");
+    printf("  stack speedup %.2fx\n", t_stack / t_sstack);
+
+    /* API parity on a vector that spills */
+    smallvec_int_8 v;
+    smallvec_int_8_init(&v);
+    for (int k = 0; k < 20; k++) smallvec_int_8_push(&v, k);
+    smallvec_int_8_insert(&v, 0, -1);
+    smallvec_int_8_remove(&v, 5);
+    smallvec_int_8_set(&v, 1, 42);
+    BENCH_CHECK(v.len == 20 && smallvec_int_8_on_heap(&v) && smallvec_int_8_get(&v, 0) == -1 &&
+                smallvec_int_8_get(&v, 1) == 42 && smallvec_int_8_get(&v, 5) == 5, "spilled vector");
+    smallvec_int_8_free(&v);
+    free(sizes);
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Array of structs (vec_Account) vs structure of arrays (soa_Account):
+ * filtering on one field, a two-field reduction, and a full-record scan.
+ * usage: soa_vec_bench [n]   (n records, default 10000000)
+ */
+
+typedef struct {
+    int id;
+    int branch;
+    float rate;
+    double balance;
+    char* owner;
+} Account;
+
+DEFINE_VEC(Account)
+DEFINE_SOA_VEC(Account, (int, id), (int, branch), (float, rate), (double, balance), (char*, owner))
+DEFINE_SOA_VEC_CONVERT(Account)
+
+#define ROUNDS 10
+#define BRANCHES 100
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 10000000);
+    uint64_t seed = 37;
+    static char owner_name[] = "owner";
+    vec_Account aos;
+    vec_Account_init(&aos);
+    vec_Account_reserve(&aos, n);
+    for (size_t i = 0; i < n; i++) {
+        Account a = { (int)i, (int)(bench_rand(&seed) % BRANCHES), (float)(bench_rand(&seed) % 1000) / 100.0f,
+                      (double)(bench_rand(&seed) % 1000000) / 100.0, owner_name };
+        vec_Account_push(&aos, a);
+    }
+    soa_Account soa;
+    soa_Account_init(&soa);
+    double t = bench_now();
+    soa_Account_from_vec(&soa, &aos);
+    bench_report("vec -> soa conversion", bench_now() - t, (double)n);
+    printf("%zu records: %zu bytes each as a struct, %zu bytes of fields; filter reads 4\n",
+           n, sizeof(Account), soa_Account_record_size());
+
+    /* Round trip and per-record API agree with the AoS copy */
+    vec_Account back;
+    vec_Account_init(&back);
+    soa_Account_to_vec(&soa, &back);
+    for (size_t i = 0; i < n; i += n / 1000 + 1) {
+        Account a = soa_Account_get(&soa, i);
+        BENCH_CHECK(a.id == aos.data[i].id && a.branch == aos.data[i].branch && a.rate == aos.data[i].rate
+                    && a.balance == aos.data[i].balance && a.owner == aos.data[i].owner, "soa get");
+        BENCH_CHECK(memcmp(&back.data[i].balance, &aos.data[i].balance, sizeof(double)) == 0
+                    && back.data[i].id == aos.data[i].id && back.data[i].owner == owner_name, "to_vec");
+    }
+    vec_Account_free(&back);
+
+    /* Single-field filter: how many accounts are in branch 42 */
+    size_t want = 0;
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        size_t c = 0;
+        for (size_t i = 0; i < n; i++) c += aos.data[i].branch == 42;
+        want = c;
+    }
+    double aos_filter = bench_now() - t;
+    bench_report("AoS filter branch == 42", aos_filter, (double)n * ROUNDS);
+    size_t got = 0;
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        size_t c = 0;
+        const int* branch = soa.branch;
+        for (size_t i = 0; i < n; i++) c += branch[i] == 42;
+        got = c;
+    }
+    double soa_filter = bench_now() - t;
+    bench_report("SoA filter branch == 42", soa_filter, (double)n * ROUNDS);
+    BENCH_CHECK(got == want, "filter count");
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) got = numeric_count_int(soa.branch, soa.len, 42);
+    bench_report("SoA filter via numeric_count_int", bench_now() - t, (double)n * ROUNDS);
+    BENCH_CHECK(got == want, "numeric_count_int on a field");
+    printf("  SoA filter speedup: %.1fx\n", aos_filter / soa_filter);
+
+    /* Two fields: total interest = sum(balance * rate) */
+    double aos_sum = 0, soa_sum = 0;
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        double s = 0;
+        for (size_t i = 0; i < n; i++) s += aos.data[i].balance * aos.data[i].rate;
+        aos_sum = s;
+    }
+    bench_report("AoS sum(balance * rate)", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        double s = 0;
+        for (size_t i = 0; i < n; i++) s += soa.balance[i] * soa.rate[i];
+        soa_sum = s;
+    }
+    bench_report("SoA sum(balance * rate)", bench_now() - t, (double)n * ROUNDS);
+    BENCH_CHECK(aos_sum == soa_sum, "two-field sum");
+
+    /* Whole records: SoA has to gather from every array */
+    long long aos_ids = 0, soa_ids = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        Account a = vec_Account_get(&aos, i);
+        aos_ids += a.id + a.branch;
+    }
+    bench_report("AoS vec_Account_get", bench_now() - t, (double)n);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        Account a = soa_Account_get(&soa, i);
+        soa_ids += a.id + a.branch;
+    }
+    bench_report("SoA soa_Account_get", bench_now() - t, (double)n);
+    BENCH_CHECK(aos_ids == soa_ids, "record scan");
+
+    /* remove / swap_remove keep the arrays in step */
+    Account last = soa_Account_get(&soa, soa.len - 1);
+    Account third = soa_Account_get(&soa, 3);
+    soa_Account_remove(&soa, 2);
+    BENCH_CHECK(soa.id[2] == third.id && soa.balance[2] == third.balance, "remove");
+    soa_Account_swap_remove(&soa, 0);
+    BENCH_CHECK(soa.id[0] == last.id && soa.rate[0] == last.rate && soa.len == n - 2, "swap_remove");
+    Account x = { -1, 7, 1.5f, 2.5, NULL };
+    soa_Account_set(&soa, 1, x);
+    BENCH_CHECK(soa.id[1] == -1 && soa.branch[1] == 7 && soa.owner[1] == NULL, "set");
+
+    soa_Account_free(&soa);
+    vec_Account_free(&aos);
+    return 0;
+}
@@ -0,0 +1,221 @@
+#define _GNU_SOURCE
+#include "stl.h"
+#include "bench.h"
+#include <threads.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Passing ints from a producer thread to a consumer thread: queue_int behind
+ * a mutex and two condition variables vs spsc_queue_int (one at a time and
+ * in batches), then round-trip latency with an echo thread. Threads are
+ * pinned to CPUs 0 and 1 (the same CPU on a single-core machine; the
+ * spinning variant only runs with two or more CPUs).
+ * usage: spsc_queue_bench [n]   (n items, default 10000000)
+ */
+
+DEFINE_QUEUE(int)
+DEFINE_SPSC_QUEUE(int)
+
+#define CAPACITY 4096
+#define BATCH 64
+#define ROUND_TRIPS 100000
+
+static int g_ncpu = 1;
+
+static void pin(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % g_ncpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+/* ---------- Mutex + condition variables around queue_int ---------- */
+
+typedef struct {
+    queue_int q;
+    mtx_t mu;
+    cnd_t not_empty, not_full;
+} LockedQueue;
+
+static void locked_init(LockedQueue* l) {
+    queue_int_init(&l->q);
+    mtx_init(&l->mu, mtx_plain);
+    cnd_init(&l->not_empty);
+    cnd_init(&l->not_full);
+}
+
+static void locked_push(LockedQueue* l, int v) {
+    mtx_lock(&l->mu);
+    while (queue_int_size(&l->q) >= CAPACITY) cnd_wait(&l->not_full, &l->mu);
+    queue_int_enqueue(&l->q, v);
+    cnd_signal(&l->not_empty);
+    mtx_unlock(&l->mu);
+}
+
+static int locked_pop(LockedQueue* l) {
+    mtx_lock(&l->mu);
+    while (queue_int_empty(&l->q)) cnd_wait(&l->not_empty, &l->mu);
+    int v = queue_int_dequeue(&l->q);
+    cnd_signal(&l->not_full);
+    mtx_unlock(&l->mu);
+    return v;
+}
+
+static void locked_free(LockedQueue* l) {
+    queue_int_free(&l->q);
+    mtx_destroy(&l->mu);
+    cnd_destroy(&l->not_empty);
+    cnd_destroy(&l->not_full);
+}
+
+/* ---------- Throughput ---------- */
+
+typedef enum { MODE_LOCKED, MODE_SPSC, MODE_SPSC_BATCH } Mode;
+
+static size_t g_n;
+static Mode g_mode;
+static LockedQueue g_locked;
+static spsc_queue_int g_spsc;
+
+static int producer(void* arg) {
+    (void)arg;
+    pin(0);
+    if (g_mode == MODE_LOCKED) {
+        for (size_t i = 0; i < g_n; i++) locked_push(&g_locked, (int)i);
+    } else if (g_mode == MODE_SPSC) {
+        for (size_t i = 0; i < g_n; i++) spsc_queue_int_push_wait(&g_spsc, (int)i);
+    } else {
+        int buf[BATCH];
+        for (size_t i = 0; i < g_n; i += BATCH) {
+            size_t k = g_n - i < BATCH ? g_n - i : BATCH;
+            for (size_t j = 0; j < k; j++) buf[j] = (int)(i + j);
+            spsc_queue_int_push_n_wait(&g_spsc, buf, k);
+        }
+    }
+    return 0;
+}
+
+// Consumes g_n items on the calling thread; returns their sum
+static long long consume(void) {
+    pin(1);
+    long long sum = 0;
+    if (g_mode == MODE_LOCKED) {
+        for (size_t i = 0; i < g_n; i++) sum += locked_pop(&g_locked);
+    } else if (g_mode == MODE_SPSC) {
+        for (size_t i = 0; i < g_n; i++) sum += spsc_queue_int_pop_wait(&g_spsc);
+    } else {
+        int buf[BATCH];
+        for (size_t got = 0; got < g_n;) {
+            size_t k = spsc_queue_int_pop_n_wait(&g_spsc, buf, BATCH);
+            for (size_t j = 0; j < k; j++) sum += buf[j];
+            got += k;
+        }
+    }
+    return sum;
+}
+
+static void throughput(const char* label, Mode mode, int flags) {
+    g_mode = mode;
+    if (mode == MODE_LOCKED) locked_init(&g_locked);
+    else BENCH_CHECK(spsc_queue_int_init(&g_spsc, CAPACITY, flags), "init");
+    thrd_t t;
+    double start = bench_now();
+    thrd_create(&t, producer, NULL);
+    long long sum = consume();
+    thrd_join(t, NULL);
+    bench_report(label, bench_now() - start, (double)g_n);
+    BENCH_CHECK(sum == (long long)g_n * ((long long)g_n - 1) / 2, "items lost or reordered");
+    if (mode == MODE_LOCKED) locked_free(&g_locked);
+    else spsc_queue_int_free(&g_spsc);
+}
+
+/* ---------- Round trips ---------- */
+
+static LockedQueue g_ping_l, g_pong_l;
+static spsc_queue_int g_ping, g_pong;
+
+static int echo(void* arg) {
+    (void)arg;
+    pin(1);
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        if (g_mode == MODE_LOCKED) locked_push(&g_pong_l, locked_pop(&g_ping_l));
+        else spsc_queue_int_push_wait(&g_pong, spsc_queue_int_pop_wait(&g_ping));
+    }
+    return 0;
+}
+
+static void round_trip(const char* label, Mode mode, int flags) {
+    g_mode = mode;
+    if (mode == MODE_LOCKED) {
+        locked_init(&g_ping_l);
+        locked_init(&g_pong_l);
+    } else {
+        BENCH_CHECK(spsc_queue_int_init(&g_ping, 16, flags) && spsc_queue_int_init(&g_pong, 16, flags), "init");
+    }
+    thrd_t t;
+    thrd_create(&t, echo, NULL);
+    pin(0);
+    double start = bench_now();
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        int back;
+        if (mode == MODE_LOCKED) {
+            locked_push(&g_ping_l, i);
+            back = locked_pop(&g_pong_l);
+        } else {
+            spsc_queue_int_push_wait(&g_ping, i);
+            back = spsc_queue_int_pop_wait(&g_pong);
+        }
+        BENCH_CHECK(back == i, "echo");
+    }
+    double secs = bench_now() - start;
+    thrd_join(t, NULL);
+    printf("  %-36s %9.3f us/round trip\n", label, secs * 1e6 / ROUND_TRIPS);
+    if (mode == MODE_LOCKED) {
+        locked_free(&g_ping_l);
+        locked_free(&g_pong_l);
+    } else {
+        spsc_queue_int_free(&g_ping);
+        spsc_queue_int_free(&g_pong);
+    }
+}
+
+int main(int argc, char** argv) {
+    g_n = bench_arg(argc, argv, 10000000);
+#ifdef __linux__
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    g_ncpu = n > 0 ? (int)n : 1;
+#endif
+    printf("%zu items, capacity %d, %d CPU(s)\n", g_n, CAPACITY, g_ncpu);
+
+    throughput("queue_int + mutex/condvar", MODE_LOCKED, 0);
+    throughput("spsc_queue_int push/pop_wait", MODE_SPSC, SPSC_QUEUE_BLOCKING);
+    throughput("spsc_queue_int batches of 64", MODE_SPSC_BATCH, SPSC_QUEUE_BLOCKING);
+    if (g_ncpu > 1) {
+        throughput("spsc_queue_int spinning", MODE_SPSC, 0);
+        throughput("spsc_queue_int spinning, batches", MODE_SPSC_BATCH, 0);
+    }
+
+    printf("Round trips (%d)\n", ROUND_TRIPS);
+    round_trip("queue_int + mutex/condvar", MODE_LOCKED, 0);
+    round_trip("spsc_queue_int (blocking)", MODE_SPSC, SPSC_QUEUE_BLOCKING);
+    if (g_ncpu > 1) round_trip("spsc_queue_int (spinning)", MODE_SPSC, 0);
+
+    /* Single-threaded edge cases: full, empty, wrap-around batches */
+    spsc_queue_int q;
+    BENCH_CHECK(spsc_queue_int_init(&q, 5, 0) && spsc_queue_int_capacity(&q) == 8, "capacity");
+    int v, in[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }, out[10];
+    BENCH_CHECK(!spsc_queue_int_pop(&q, &v) && spsc_queue_int_push_n(&q, in, 10) == 8 && !spsc_queue_int_push(&q, 8), "full");
+    BENCH_CHECK(spsc_queue_int_pop_n(&q, out, 5) == 5 && out[4] == 4 && spsc_queue_int_push_n(&q, in, 4) == 4, "wrap");
+    BENCH_CHECK(spsc_queue_int_pop_n(&q, out, 10) == 7 && out[2] == 7 && out[3] == 0 && out[6] == 3, "wrapped order");
+    BENCH_CHECK(spsc_queue_int_size(&q) == 0, "empty");
+    spsc_queue_int_free(&q);
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Copying vs zero-copy access: vec_T_get vs vec_T_at_ptr on vec_vec_float
+ * rows and on a 256-byte struct, push vs emplace_back, stack/queue peeks,
+ * and handing a buffer between owners with release/from_buffer vs a copy.
+ * usage: vec_access_bench [n]   (n elements, default 1000000)
+ */
+
+typedef struct {
+    int id;
+    double values[31];
+} Big;
+
+DEFINE_VEC(float)
+DEFINE_VEC(vec_float)
+DEFINE_VEC(Big)
+DEFINE_VEC(int)
+DEFINE_STACK(Big)
+DEFINE_QUEUE(Big)
+
+#define ROUNDS 10
+#define ROWS 1000
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 1000000);
+    printf("Element access, %zu elements, %d rounds\n", n, ROUNDS);
+
+    /* Rows of a vec_vec_float: get copies the row header, at_ptr does not */
+    vec_vec_float m;
+    vec_vec_float_init(&m);
+    size_t cols = n / ROWS + 1;
+    for (size_t r = 0; r < ROWS; r++) {
+        vec_float row;
+        vec_float_init(&row);
+        for (size_t c = 0; c < cols; c++) vec_float_push(&row, (float)(r + c));
+        vec_vec_float_push(&m, row);
+    }
+    double by_get = 0, by_ptr = 0;
+    double t = bench_now();
+    for (int k = 0; k < ROUNDS; k++)
+        for (size_t r = 0; r < ROWS; r++)
+            for (size_t c = 0; c < cols; c++) {
+                vec_float row = vec_vec_float_get(&m, r);
+                by_get += vec_float_get(&row, c);
+            }
+    bench_report("vec_vec_float_get per element", bench_now() - t, (double)ROWS * cols * ROUNDS);
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++)
+        for (size_t r = 0; r < ROWS; r++)
+            for (size_t c = 0; c < cols; c++) by_ptr += *vec_float_at_ptr(vec_vec_float_at_ptr(&m, r), c);
+    bench_report("vec_vec_float_at_ptr per element", bench_now() - t, (double)ROWS * cols * ROUNDS);
+    BENCH_CHECK(by_get == by_ptr, "row access");
+
+    /* In-place update through at_ptr is visible; through get it is not */
+    *vec_float_at_ptr(vec_vec_float_at_ptr(&m, 3), 0) = -1.0f;
+    BENCH_CHECK(m.data[3].data[0] == -1.0f, "write through at_ptr");
+    for (size_t r = 0; r < ROWS; r++) vec_float_free(&m.data[r]);
+    vec_vec_float_free(&m);
+
+    /* Large structs: push by value vs emplace_back, get vs at_ptr */
+    vec_Big a, b;
+    vec_Big_init(&a);
+    vec_Big_init(&b);
+    /* Touch the pages first so neither loop pays the first-use page faults */
+    vec_Big_resize(&a, n);
+    vec_Big_resize(&b, n);
+    a.len = b.len = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        Big x;
+        x.id = (int)i;
+        for (int j = 0; j < 31; j++) x.values[j] = (double)(i + (size_t)j);
+        vec_Big_push(&a, x);
+    }
+    bench_report("vec_Big_push (256-byte struct)", bench_now() - t, (double)n);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        Big* x = vec_Big_emplace_back(&b);
+        x->id = (int)i;
+        for (int j = 0; j < 31; j++) x->values[j] = (double)(i + (size_t)j);
+    }
+    bench_report("vec_Big_emplace_back", bench_now() - t, (double)n);
+    BENCH_CHECK(a.len == b.len, "emplace_back length");
+    for (size_t i = 0; i < n; i++)
+        BENCH_CHECK(a.data[i].id == b.data[i].id && memcmp(a.data[i].values, b.data[i].values, sizeof(a.data[i].values)) == 0,
+                    "emplace_back contents");
+
+    long long ids_get = 0, ids_ptr = 0;
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++)
+        for (size_t i = 0; i < n; i++) {
+            Big x = vec_Big_get(&a, i);
+            ids_get += x.id + (long long)x.values[30];
+        }
+    bench_report("vec_Big_get", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++)
+        for (size_t i = 0; i < n; i++) {
+            const Big* x = vec_Big_at_ptr(&a, i);
+            ids_ptr += x->id + (long long)x->values[30];
+        }
+    bench_report("vec_Big_at_ptr", bench_now() - t, (double)n * ROUNDS);
+    BENCH_CHECK(ids_get == ids_ptr, "struct access");
+    BENCH_CHECK(vec_Big_back_ptr(&a)->id == (int)n - 1 && vec_Big_at_ptr(&a, n) == NULL, "back_ptr / range");
+
+    /* Slices: a window of the vector, then a window of the window */
+    slice_Big s = vec_Big_slice(&a, n / 4, n / 2);
+    slice_Big inner = slice_Big_sub(s, 10, 20);
+    BENCH_CHECK(inner.len == 20 && slice_Big_at_ptr(inner, 0)->id == (int)(n / 4 + 10), "slices");
+    BENCH_CHECK(vec_Big_slice(&a, n, 1).data == NULL && slice_Big_sub(s, s.len, 0).len == 0, "slice bounds");
+    vec_Big_free(&b);
+
+    /* Stack / queue: peek by value vs by pointer */
+    stack_Big st;
+    stack_Big_init(&st);
+    for (size_t i = 0; i < 1000; i++) *stack_Big_emplace(&st) = a.data[i];
+    long long sum_peek = 0, sum_ptr = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) sum_peek += stack_Big_peek(&st).values[(i & 15)];
+    bench_report("stack_Big_peek", bench_now() - t, (double)n);
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) sum_ptr += stack_Big_peek_ptr(&st)->values[(i & 15)];
+    bench_report("stack_Big_peek_ptr", bench_now() - t, (double)n);
+    BENCH_CHECK(sum_peek == sum_ptr, "stack peek");
+    Big top;
+    BENCH_CHECK(stack_Big_pop_into(&st, &top) && top.id == 999 && stack_Big_size(&st) == 999, "pop_into");
+    stack_Big_free(&st);
+
+    queue_Big q;
+    queue_Big_init(&q);
+    for (size_t i = 0; i < 100; i++) *queue_Big_emplace(&q) = a.data[i];
+    Big front;
+    BENCH_CHECK(queue_Big_front_ptr(&q)->id == 0 && queue_Big_rear_ptr(&q)->id == 99, "queue ptrs");
+    BENCH_CHECK(queue_Big_dequeue_into(&q, &front) && front.id == 0 && queue_Big_front_ptr(&q)->id == 1,
+                "dequeue_into");
+    queue_Big_free(&q);
+    vec_Big_free(&a);
+
+    /* Ownership transfer: release + from_buffer vs copying into a new vector */
+    vec_int src;
+    vec_int_init(&src);
+    vec_int_push_n(&src, 7, n);
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++) {
+        vec_int copy;
+        vec_int_init(&copy);
+        vec_int_extend(&copy, src.data, src.len);
+        vec_int_free(&src);
+        src = copy;
+    }
+    bench_report("hand over by copy", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int k = 0; k < ROUNDS; k++) {
+        size_t len, cap = src.cap;
+        int* buf = vec_int_release(&src, &len);
+        src = vec_int_from_buffer(buf, len, cap);
+    }
+    bench_report("hand over by release/from_buffer", bench_now() - t, (double)n * ROUNDS);
+    BENCH_CHECK(src.len == n && src.data[n - 1] == 7, "from_buffer");
+    vec_int_free(&src);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Appending a known-size batch: push loop vs with_capacity, extend,
+ * append_vec and push_n, plus queue/stack bulk operations.
+ * usage: vec_bulk_bench [n]   (n ints per batch, default 1000000)
+ */
+
+DEFINE_VEC(int)
+DEFINE_QUEUE(int)
+DEFINE_STACK(int)
+
+#define ROUNDS 20
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 1000000);
+    int* src = malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) src[i] = (int)(i * 2654435761u);
+    printf("Appending %zu ints, %d rounds\n", n, ROUNDS);
+
+    size_t reallocs = 0;
+    double t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        vec_int v;
+        vec_int_init(&v);
+        size_t cap = 0;
+        for (size_t i = 0; i < n; i++) {
+            vec_int_push(&v, src[i]);
+            if (v.cap != cap) { cap = v.cap; reallocs++; }
+        }
+        BENCH_CHECK(v.len == n && v.data[n - 1] == src[n - 1], "push loop");
+        vec_int_free(&v);
+    }
+    bench_report("push loop", bench_now() - t, (double)n * ROUNDS);
+    printf("  %-36s %zu reallocs per batch\n", "", reallocs / ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        vec_int v = vec_int_with_capacity(n);
+        for (size_t i = 0; i < n; i++) vec_int_push(&v, src[i]);
+        BENCH_CHECK(v.len == n && v.cap == n, "with_capacity + push");
+        vec_int_free(&v);
+    }
+    bench_report("with_capacity + push", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        vec_int v;
+        vec_int_init(&v);
+        vec_int_extend(&v, src, n);
+        BENCH_CHECK(v.len == n && memcmp(v.data, src, n * sizeof(int)) == 0, "extend");
+        vec_int_free(&v);
+    }
+    bench_report("extend", bench_now() - t, (double)n * ROUNDS);
+
+    vec_int batch;
+    vec_int_init(&batch);
+    vec_int_extend(&batch, src, n);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        vec_int v;
+        vec_int_init(&v);
+        vec_int_append_vec(&v, &batch);
+        vec_int_append_vec(&v, &v);     // self-append doubles the contents
+        BENCH_CHECK(v.len == 2 * n && memcmp(v.data + n, src, n * sizeof(int)) == 0, "append_vec");
+        vec_int_free(&v);
+    }
+    bench_report("append_vec (2 batches)", bench_now() - t, 2.0 * n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        vec_int v;
+        vec_int_init(&v);
+        vec_int_push_n(&v, 7, n);
+        vec_int_resize(&v, n + n / 2);
+        BENCH_CHECK(v.len == n + n / 2 && v.data[n - 1] == 7 && v.data[n] == 0, "push_n + resize");
+        vec_int_free(&v);
+    }
+    bench_report("push_n + resize", bench_now() - t, 1.5 * n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        queue_int q;
+        queue_int_init(&q);
+        for (size_t i = 0; i < n; i++) queue_int_enqueue(&q, src[i]);
+        queue_int_free(&q);
+    }
+    bench_report("queue enqueue loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        queue_int q;
+        queue_int_init(&q);
+        queue_int_enqueue_n(&q, src, n);
+        BENCH_CHECK(queue_int_front(&q) == src[0] && queue_int_rear(&q) == src[n - 1], "enqueue_n");
+        queue_int_free(&q);
+    }
+    bench_report("queue enqueue_n", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        stack_int s;
+        stack_int_init(&s);
+        for (size_t i = 0; i < n; i++) stack_int_push(&s, src[i]);
+        stack_int_free(&s);
+    }
+    bench_report("stack push loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        stack_int s;
+        stack_int_init(&s);
+        stack_int_push_n(&s, src, n);
+        BENCH_CHECK(stack_int_peek(&s) == src[n - 1] && stack_int_size(&s) == n, "push_n");
+        stack_int_free(&s);
+    }
+    bench_report("stack push_n", bench_now() - t, (double)n * ROUNDS);
+
+    vec_int_free(&batch);
+    free(src);
+    return 0;
+}
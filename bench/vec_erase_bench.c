@@ -0,0 +1,105 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Erasing 10% of a large vec_int: per-element vec_int_remove loops vs
+ * erase_range, remove_if and swap_remove.
+ * usage: vec_erase_bench [n]   (n elements, default 10000000)
+ *
+ * The remove loops are O(n*k); they are timed on a prefix of the work and
+ * extrapolated so the benchmark finishes.
+ */
+
+DEFINE_VEC(int)
+
+#define SAMPLE 200
+
+static bool is_tenth(const int* x, void* ctx) {
+    (void)ctx;
+    return *x % 10 == 3;
+}
+
+static bool not_tenth(const int* x, void* ctx) {
+    return !is_tenth(x, ctx);
+}
+
+// Stateful: drops every third element visited, counting calls in *ctx
+static bool every_third(const int* x, void* ctx) {
+    (void)x;
+    return (*(size_t*)ctx)++ % 3 == 2;
+}
+
+static void fill(vec_int* v, size_t n) {
+    vec_int_resize(v, n);
+    for (size_t i = 0; i < n; i++) v->data[i] = (int)i;
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 10000000);
+    size_t k = n / 10;
+    printf("Erasing 10%% (%zu) of %zu ints\n", k, n);
+    vec_int v;
+    vec_int_init(&v);
+
+    /* Contiguous block in the middle */
+    fill(&v, n);
+    double t = bench_now();
+    for (size_t j = 0; j < SAMPLE; j++) vec_int_remove(&v, n / 2);
+    double per = (bench_now() - t) / SAMPLE;
+    printf("  %-36s %9.4f s  (extrapolated from %d removes)\n", "block: remove loop", per * (double)k, SAMPLE);
+
+    fill(&v, n);
+    t = bench_now();
+    vec_int_erase_range(&v, n / 2, k);
+    bench_report("block: erase_range", bench_now() - t, (double)k);
+    BENCH_CHECK(v.len == n - k && v.data[n / 2] == (int)(n / 2 + k), "erase_range");
+
+    /* Scattered: every element with value % 10 == 3 */
+    fill(&v, n);
+    t = bench_now();
+    size_t done = 0;
+    for (size_t i = 0; i < v.len && done < SAMPLE; ) {
+        if (is_tenth(&v.data[i], NULL)) { vec_int_remove(&v, i); done++; }
+        else i++;
+    }
+    per = (bench_now() - t) / SAMPLE;
+    printf("  %-36s %9.4f s  (extrapolated from %d removes)\n", "scattered: remove loop", per * (double)k, SAMPLE);
+
+    fill(&v, n);
+    t = bench_now();
+    size_t removed = vec_int_remove_if(&v, is_tenth, NULL);
+    bench_report("scattered: remove_if", bench_now() - t, (double)n);
+    BENCH_CHECK(removed == k && v.len == n - k, "remove_if count");
+    for (size_t i = 0; i < v.len; i++) BENCH_CHECK(v.data[i] % 10 != 3 && (i == 0 || v.data[i] > v.data[i - 1]), "remove_if order");
+
+    fill(&v, n);
+    t = bench_now();
+    removed = vec_int_retain(&v, not_tenth, NULL);
+    bench_report("scattered: retain", bench_now() - t, (double)n);
+    BENCH_CHECK(removed == k && v.len == n - k, "retain");
+
+    fill(&v, n);
+    t = bench_now();
+    for (size_t i = 0; i < v.len; ) {
+        if (is_tenth(&v.data[i], NULL)) vec_int_swap_remove(&v, i);
+        else i++;
+    }
+    bench_report("scattered: swap_remove (unordered)", bench_now() - t, (double)n);
+    BENCH_CHECK(v.len == n - k, "swap_remove");
+
+    fill(&v, 10);
+    int mid[] = { 100, 101 };
+    vec_int_insert_range(&v, 5, mid, 2);
+    vec_int_insert_range(&v, 0, v.data + 5, 3);   // aliased source
+    BENCH_CHECK(v.len == 15 && v.data[0] == 100 && v.data[2] == 5 && v.data[9] == 101, "insert_range");
+
+    fill(&v, 10);
+    size_t calls = 0;
+    removed = vec_int_remove_if(&v, every_third, &calls);
+    int thirds[] = { 0, 1, 3, 4, 6, 7, 9 };
+    BENCH_CHECK(calls == 10 && removed == 3 && v.len == 7 && memcmp(v.data, thirds, sizeof(thirds)) == 0,
+                "stateful predicate called once per element");
+
+    vec_int_free(&v);
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * vec_numeric kernels vs plain loops over vec_T_get / data. Before timing,
+ * every kernel is checked bit-for-bit against a plain loop where the math
+ * is exact, and the floating sum/dot against the scalar kernels, on
+ * lengths 1..40 (all tail cases) and on the full input.
+ * usage: vec_numeric_bench [n]   (n elements, default 4000000)
+ */
+
+DEFINE_VEC(int)
+DEFINE_VEC(float)
+DEFINE_VEC(double)
+DEFINE_VEC_NUMERIC(int)
+DEFINE_VEC_NUMERIC(float)
+DEFINE_VEC_NUMERIC(double)
+
+#define ROUNDS 20
+
+/* Plain-loop references, with the same rounding and wrapping as the kernels */
+#define DEFINE_REFERENCE(T) \
+static T ref_min_##T(const T* a, size_t n) { T m = a[0]; for (size_t i = 1; i < n; i++) if (a[i] < m) m = a[i]; return m; } \
+static T ref_max_##T(const T* a, size_t n) { T m = a[0]; for (size_t i = 1; i < n; i++) if (a[i] > m) m = a[i]; return m; } \
+static size_t ref_argmin_##T(const T* a, size_t n) { size_t k = 0; for (size_t i = 1; i < n; i++) if (a[i] < a[k]) k = i; return k; } \
+static size_t ref_argmax_##T(const T* a, size_t n) { size_t k = 0; for (size_t i = 1; i < n; i++) if (a[i] > a[k]) k = i; return k; } \
+static size_t ref_count_##T(const T* a, size_t n, T x) { size_t c = 0; for (size_t i = 0; i < n; i++) if (a[i] == x) c++; return c; } \
+static size_t ref_find_##T(const T* a, size_t n, T x) { for (size_t i = 0; i < n; i++) if (a[i] == x) return i; return NUMERIC_NOT_FOUND; }
+
+DEFINE_REFERENCE(int)
+DEFINE_REFERENCE(float)
+DEFINE_REFERENCE(double)
+
+#define CHECK_SEARCH(T, a, n, probe) \
+    do { \
+        if ((n) > 0) { \
+            BENCH_CHECK(numeric_min_##T(a, n) == ref_min_##T(a, n), #T " min"); \
+            BENCH_CHECK(numeric_max_##T(a, n) == ref_max_##T(a, n), #T " max"); \
+            BENCH_CHECK(numeric_argmin_##T(a, n) == ref_argmin_##T(a, n), #T " argmin"); \
+            BENCH_CHECK(numeric_argmax_##T(a, n) == ref_argmax_##T(a, n), #T " argmax"); \
+        } \
+        BENCH_CHECK(numeric_count_##T(a, n, probe) == ref_count_##T(a, n, probe), #T " count"); \
+        BENCH_CHECK(numeric_find_##T(a, n, probe) == ref_find_##T(a, n, probe), #T " find"); \
+    } while (0)
+
+/* Runs an in-place kernel on a copy and compares it with a plain loop on another copy */
+#define CHECK_INPLACE(T, a, b, n, KERNEL_CALL, LOOP_BODY, label) \
+    do { \
+        T* got = malloc(((n) + 1) * sizeof(T)); \
+        T* want = malloc(((n) + 1) * sizeof(T)); \
+        memcpy(got, a, (n) * sizeof(T)); \
+        memcpy(want, a, (n) * sizeof(T)); \
+        KERNEL_CALL; \
+        for (size_t i = 0; i < (n); i++) { LOOP_BODY; } \
+        BENCH_CHECK(memcmp(got, want, (n) * sizeof(T)) == 0, label); \
+        free(got); \
+        free(want); \
+    } while (0)
+
+static void check_int(const int* a, const int* b, size_t n) {
+    CHECK_SEARCH(int, a, n, a[n / 2]);
+    CHECK_SEARCH(int, a, n, -12345);
+    long long s = 0, d = 0;
+    for (size_t i = 0; i < n; i++) { s += a[i]; d += (long long)a[i] * b[i]; }
+    BENCH_CHECK(numeric_sum_int(a, n) == s, "int sum");
+    BENCH_CHECK(numeric_dot_int(a, b, n) == d, "int dot");
+    CHECK_INPLACE(int, a, b, n, numeric_scale_int(got, n, -3),
+                  want[i] = (int)((unsigned)want[i] * (unsigned)-3), "int scale");
+    CHECK_INPLACE(int, a, b, n, numeric_add_int(got, b, n),
+                  want[i] = (int)((unsigned)want[i] + (unsigned)b[i]), "int add");
+    CHECK_INPLACE(int, a, b, n, numeric_axpy_int(got, 7, b, n),
+                  want[i] = (int)((unsigned)want[i] + 7u * (unsigned)b[i]), "int axpy");
+    CHECK_INPLACE(int, a, b, n, numeric_clamp_int(got, n, -1000, 1000),
+                  want[i] = want[i] < -1000 ? -1000 : want[i] > 1000 ? 1000 : want[i], "int clamp");
+}
+
+#define DEFINE_CHECK_FLOATING(T) \
+static void check_##T(const T* a, const T* b, size_t n) { \
+    CHECK_SEARCH(T, a, n, a[n / 2]); \
+    CHECK_SEARCH(T, a, n, (T)-1.5); \
+    CHECK_INPLACE(T, a, b, n, numeric_scale_##T(got, n, (T)1.25), want[i] = want[i] * (T)1.25, #T " scale"); \
+    CHECK_INPLACE(T, a, b, n, numeric_add_##T(got, b, n), want[i] = want[i] + b[i], #T " add"); \
+    CHECK_INPLACE(T, a, b, n, numeric_axpy_##T(got, (T)0.75, b, n), \
+                  { T p = (T)0.75 * b[i]; want[i] = want[i] + p; }, #T " axpy"); \
+    CHECK_INPLACE(T, a, b, n, numeric_clamp_##T(got, n, (T)-10, (T)10), \
+                  want[i] = want[i] < (T)-10 ? (T)-10 : want[i] > (T)10 ? (T)10 : want[i], #T " clamp"); \
+    /* sum/dot round in a fixed lane order: both dispatch paths must agree exactly */ \
+    double s = numeric_sum_##T(a, n), d = numeric_dot_##T(a, b, n); \
+    BENCH_CHECK(memcmp(&s, &(double){ numeric_sum_##T##_scalar(a, n) }, sizeof s) == 0, #T " sum across dispatch"); \
+    BENCH_CHECK(memcmp(&d, &(double){ numeric_dot_##T##_scalar(a, b, n) }, sizeof d) == 0, #T " dot across dispatch"); \
+    double ref = 0; \
+    for (size_t i = 0; i < n; i++) ref += (double)a[i]; \
+    BENCH_CHECK(fabs(s - ref) <= 1e-9 * (fabs(ref) + (double)n), #T " sum close to sequential"); \
+}
+
+DEFINE_CHECK_FLOATING(float)
+DEFINE_CHECK_FLOATING(double)
+
+/* Every third element NaN (a[0] included), then all NaN: min/max skip them, arg* give a valid index */
+#define DEFINE_CHECK_NAN(T) \
+static void check_nan_##T(const T* a, size_t n) { \
+    T* x = malloc(n * sizeof(T)); \
+    for (size_t i = 0; i < n; i++) x[i] = i % 3 == 0 ? (T)NAN : a[i]; \
+    for (size_t len = 1; len <= n; len++) { \
+        size_t lo = len > 1 ? 1 : 0, hi = lo; \
+        for (size_t i = lo; i < len; i++) { \
+            if (x[i] < x[lo]) lo = i; \
+            if (x[i] > x[hi]) hi = i; \
+        } \
+        BENCH_CHECK(numeric_argmin_##T(x, len) == lo && numeric_argmax_##T(x, len) == hi, #T " arg* with NaN"); \
+        BENCH_CHECK(isnan(x[lo]) ? isnan(numeric_min_##T(x, len)) : numeric_min_##T(x, len) == x[lo], #T " min with NaN"); \
+        BENCH_CHECK(isnan(x[hi]) ? isnan(numeric_max_##T(x, len)) : numeric_max_##T(x, len) == x[hi], #T " max with NaN"); \
+    } \
+    for (size_t i = 0; i < n; i++) x[i] = (T)NAN; \
+    BENCH_CHECK(numeric_argmin_##T(x, n) == 0 && isnan(numeric_max_##T(x, n)), #T " all NaN"); \
+    free(x); \
+}
+
+DEFINE_CHECK_NAN(float)
+DEFINE_CHECK_NAN(double)
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 4000000);
+    uint64_t seed = 35;
+    vec_int vi, wi;
+    vec_float vf, wf;
+    vec_double vd, wd;
+    vec_int_init(&vi); vec_int_init(&wi);
+    vec_float_init(&vf); vec_float_init(&wf);
+    vec_double_init(&vd); vec_double_init(&wd);
+    for (size_t i = 0; i < n; i++) {
+        vec_int_push(&vi, (int)(bench_rand(&seed) % 2000001) - 1000000);
+        vec_int_push(&wi, (int)(bench_rand(&seed) % 2001) - 1000);
+        vec_float_push(&vf, (float)((double)(bench_rand(&seed) >> 11) / 9007199254740992.0 * 200.0 - 100.0));
+        vec_float_push(&wf, (float)((double)(bench_rand(&seed) >> 11) / 9007199254740992.0 * 2.0 - 1.0));
+        vec_double_push(&vd, (double)(bench_rand(&seed) >> 11) / 9007199254740992.0 * 200.0 - 100.0);
+        vec_double_push(&wd, (double)(bench_rand(&seed) >> 11) / 9007199254740992.0 * 2.0 - 1.0);
+    }
+    printf("Numeric kernels over %zu elements, %d rounds (%s)\n", n, ROUNDS,
+           numeric_has_avx2() ? "AVX2" : "scalar");
+
+    /* Correctness: every tail length, the full input, and the scalar path */
+    for (int pass = 0; pass < 2; pass++) {
+        numeric_use_simd(pass == 0);
+        for (size_t len = 1; len <= 40 && len <= n; len++) {
+            size_t off = len % 3;     // unaligned starts as well
+            if (off + len > n) off = 0;
+            check_int(vi.data + off, wi.data + off, len);
+            check_float(vf.data + off, wf.data + off, len);
+            check_double(vd.data + off, wd.data + off, len);
+        }
+        check_int(vi.data, wi.data, n);
+        check_float(vf.data, wf.data, n);
+        check_double(vd.data, wd.data, n);
+        check_nan_float(vf.data, n < 40 ? n : 40);
+        check_nan_double(vd.data, n < 40 ? n : 40);
+        double zeros[12] = { 5, 0.0, -0.0, 3, 0.0, 7, -0.0, 9, 4, 6, 8, 2 };
+        BENCH_CHECK(numeric_argmin_double(zeros, 12) == 1, "argmin with +0 and -0");
+    }
+    numeric_use_simd(true);
+    BENCH_CHECK(numeric_min_int(vi.data, 0) == 0 && numeric_argmax_float(vf.data, 0) == NUMERIC_NOT_FOUND,
+                "empty input");
+    printf("  bit-exact checks passed\n");
+
+    /* ---- timings: plain loop over vec_T_get, plain loop over data, kernel ---- */
+    volatile double sink = 0;
+    double t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        double s = 0;
+        for (size_t i = 0; i < n; i++) s += vec_float_get(&vf, i);
+        sink += s;
+    }
+    bench_report("float sum, vec_float_get loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        double s = 0;
+        for (size_t i = 0; i < n; i++) s += vf.data[i];
+        sink += s;
+    }
+    bench_report("float sum, data loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += vec_float_sum(&vf);
+    bench_report("vec_float_sum", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += ref_min_int(vi.data, n) + (double)ref_argmax_int(vi.data, n);
+    bench_report("int min + argmax, data loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += vec_int_min(&vi) + (double)vec_int_argmax(&vi);
+    bench_report("vec_int_min + argmax", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        double s = 0;
+        for (size_t i = 0; i < n; i++) s += vd.data[i] * wd.data[i];
+        sink += s;
+    }
+    bench_report("double dot, data loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += vec_double_dot(&vd, &wd);
+    bench_report("vec_double_dot", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++)
+        for (size_t i = 0; i < n; i++) vf.data[i] = vf.data[i] + 0.5f * wf.data[i];
+    bench_report("float axpy, data loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) vec_float_axpy(&vf, 0.5f, &wf);
+    bench_report("vec_float_axpy", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += (double)ref_count_int(vi.data, n, 4242);
+    bench_report("int count, data loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += (double)vec_int_count(&vi, 4242);
+    bench_report("vec_int_count", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += (double)ref_find_int(vi.data, n, 2000000);
+    bench_report("int find (absent), data loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) sink += (double)(vec_int_contains(&vi, 2000000) ? 1 : 0);
+    bench_report("vec_int_contains (absent)", bench_now() - t, (double)n * ROUNDS);
+
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++)
+        for (size_t i = 0; i < n; i++) vd.data[i] = vd.data[i] < -50 ? -50 : vd.data[i] > 50 ? 50 : vd.data[i];
+    bench_report("double clamp, data loop", bench_now() - t, (double)n * ROUNDS);
+    t = bench_now();
+    for (int r = 0; r < ROUNDS; r++) vec_double_clamp(&vd, -50, 50);
+    bench_report("vec_double_clamp", bench_now() - t, (double)n * ROUNDS);
+    (void)sink;
+
+    vec_int_free(&vi); vec_int_free(&wi);
+    vec_float_free(&vf); vec_float_free(&wf);
+    vec_double_free(&vd); vec_double_free(&wd);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Realloc traffic under push/pop oscillation for each VecPolicy.
+ * A policy is fixed per element type, so each one gets its own typedef.
+ * usage: vec_policy_bench [n]   (peak stack depth, default 100000)
+ */
+
+typedef int int_default;
+typedef int int_grow15;
+typedef int int_hyst;
+typedef int int_noshrink;
+
+DEFINE_VEC_EX(int_default, VEC_POLICY_DEFAULT)
+DEFINE_VEC_EX(int_grow15, VEC_POLICY_GROW_1_5)
+DEFINE_VEC_EX(int_hyst, VEC_POLICY_HYSTERESIS)
+DEFINE_VEC_EX(int_noshrink, VEC_POLICY_NO_SHRINK)
+DEFINE_STACK(int_default)
+DEFINE_STACK(int_grow15)
+DEFINE_STACK(int_hyst)
+DEFINE_STACK(int_noshrink)
+
+#define CYCLES 200
+
+/*
+ * Two workloads per policy:
+ *   drain  - fill to n, pop down to n / 32, repeat (a work stack being drained)
+ *   jitter - bounce between p / 4 and p / 2 + 1, p a power of two: one push past
+ *            a full p / 2 buffer doubles it, and popping back to p / 4 halves
+ *            it again under the default policy
+ * Counts every capacity change and the bytes each realloc had to copy.
+ */
+#define RUN_POLICY(NAME, LABEL) \
+    do { \
+        stack_##NAME s; \
+        stack_##NAME##_init(&s); \
+        size_t reallocs = 0, copied = 0, cap = 0; \
+        double t = bench_now(); \
+        for (int c = 0; c < CYCLES; c++) { \
+            while (stack_##NAME##_size(&s) < n) { \
+                stack_##NAME##_push(&s, c); \
+                if (s.data.cap != cap) { reallocs++; copied += s.data.len - 1; cap = s.data.cap; } \
+            } \
+            while (stack_##NAME##_size(&s) > n / 32) { \
+                stack_##NAME##_pop(&s); \
+                if (s.data.cap != cap) { reallocs++; copied += s.data.len; cap = s.data.cap; } \
+            } \
+        } \
+        double drain = bench_now() - t; \
+        size_t drain_reallocs = reallocs, drain_copied = copied; \
+        reallocs = copied = 0; \
+        t = bench_now(); \
+        for (int c = 0; c < CYCLES * 8; c++) { \
+            while (stack_##NAME##_size(&s) < p / 2 + 1) { \
+                stack_##NAME##_push(&s, c); \
+                if (s.data.cap != cap) { reallocs++; copied += s.data.len - 1; cap = s.data.cap; } \
+            } \
+            while (stack_##NAME##_size(&s) > p / 4) { \
+                stack_##NAME##_pop(&s); \
+                if (s.data.cap != cap) { reallocs++; copied += s.data.len; cap = s.data.cap; } \
+            } \
+        } \
+        double jitter = bench_now() - t; \
+        printf("  %-12s drain %8.4f s %7zu reallocs %9.1f MB copied | jitter %8.4f s %7zu reallocs %9.1f MB | final cap %zu\n", \
+               LABEL, drain, drain_reallocs, drain_copied * sizeof(int) / 1e6, \
+               jitter, reallocs, copied * sizeof(int) / 1e6, s.data.cap); \
+        stack_##NAME##_shrink_to_fit(&s); \
+        BENCH_CHECK(s.data.cap == s.data.len, "shrink_to_fit"); \
+        stack_##NAME##_free(&s); \
+    } while (0)
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 100000);
+    if (n < 1024) n = 1024;
+    size_t p = 1024;
+    while (p * 2 <= n) p *= 2;
+    printf("Push/pop oscillation, peak depth %zu, %d drain cycles, %d jitter cycles\n", n, CYCLES, CYCLES * 8);
+    RUN_POLICY(int_default, "default");
+    RUN_POLICY(int_grow15, "grow 1.5x");
+    RUN_POLICY(int_hyst, "hysteresis");
+    RUN_POLICY(int_noshrink, "no-shrink");
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * vec_T_sort (pdqsort), vec_T_radix_sort and vec_T_par_sort vs qsort on
+ * v.data, for int patterns, float and a struct with a custom comparator.
+ * Every result is checked against the qsort output.
+ * usage: vec_sort_bench [n]   (n elements, default 2000000)
+ */
+
+typedef struct {
+    int key;
+    int payload;
+} Record;
+
+#define RECORD_CMP(a, b) (((a).key > (b).key) - ((a).key < (b).key))
+
+DEFINE_VEC(int)
+DEFINE_VEC(float)
+DEFINE_VEC(Record)
+DEFINE_VEC_SORT(int)
+DEFINE_VEC_SORT(float)
+DEFINE_VEC_SORT_CUSTOM(Record, RECORD_CMP)
+DEFINE_VEC_RADIX_SORT(int)
+DEFINE_VEC_RADIX_SORT(float)
+
+#define PAR_THREADS 4
+
+static int cmp_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_float(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_record(const void* a, const void* b) {
+    return RECORD_CMP(*(const Record*)a, *(const Record*)b);
+}
+
+static void copy_int(vec_int* dst, const vec_int* src) {
+    dst->len = 0;
+    vec_int_extend(dst, src->data, src->len);
+}
+
+static void bench_ints(const char* pattern, const vec_int* input) {
+    size_t n = input->len;
+    vec_int v, want;
+    vec_int_init(&v);
+    vec_int_init(&want);
+    printf("int, %s\n", pattern);
+
+    copy_int(&want, input);
+    double t = bench_now();
+    qsort(want.data, n, sizeof(int), cmp_int);
+    bench_report("qsort", bench_now() - t, (double)n);
+
+    copy_int(&v, input);
+    t = bench_now();
+    vec_int_sort(&v);
+    bench_report("vec_int_sort", bench_now() - t, (double)n);
+    BENCH_CHECK(memcmp(v.data, want.data, n * sizeof(int)) == 0, "vec_int_sort");
+
+    copy_int(&v, input);
+    t = bench_now();
+    vec_int_radix_sort(&v);
+    bench_report("vec_int_radix_sort", bench_now() - t, (double)n);
+    BENCH_CHECK(memcmp(v.data, want.data, n * sizeof(int)) == 0, "vec_int_radix_sort");
+
+    copy_int(&v, input);
+    t = bench_now();
+    vec_int_par_sort(&v, PAR_THREADS);
+    bench_report("vec_int_par_sort (4 threads)", bench_now() - t, (double)n);
+    BENCH_CHECK(memcmp(v.data, want.data, n * sizeof(int)) == 0, "vec_int_par_sort");
+
+    vec_int_free(&v);
+    vec_int_free(&want);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, 2000000);
+    uint64_t seed = 36;
+    printf("Sorting %zu elements\n", n);
+
+    /* Small sizes hit the insertion sort and every partition edge case */
+    for (size_t len = 0; len < 300; len++) {
+        vec_int v;
+        vec_int_init(&v);
+        for (size_t i = 0; i < len; i++) vec_int_push(&v, (int)(bench_rand(&seed) % (len / 4 + 1)) - 5);
+        vec_int w;
+        vec_int_init(&w);
+        copy_int(&w, &v);
+        if (len > 0) qsort(w.data, len, sizeof(int), cmp_int);
+        vec_int_sort(&v);
+        BENCH_CHECK(vec_int_is_sorted(&v) && (len == 0 || memcmp(v.data, w.data, len * sizeof(int)) == 0), "small sorts");
+        vec_int_free(&v);
+        vec_int_free(&w);
+    }
+
+    vec_int input;
+    vec_int_init(&input);
+    for (size_t i = 0; i < n; i++) vec_int_push(&input, (int)bench_rand(&seed));
+    bench_ints("random", &input);
+
+    for (size_t i = 0; i < n; i++) input.data[i] = (int)i;
+    bench_ints("sorted", &input);
+
+    for (size_t i = 0; i < n; i++) input.data[i] = (int)(n - i);
+    bench_ints("reversed", &input);
+
+    for (size_t i = 0; i < n; i++) input.data[i] = (int)(bench_rand(&seed) % 16);
+    bench_ints("16 distinct values", &input);
+
+    for (size_t i = 0; i < n; i++) input.data[i] = (int)(i % 1000 == 0 ? bench_rand(&seed) : i);
+    bench_ints("sorted with 0.1% noise", &input);
+    vec_int_free(&input);
+
+    /* float: radix keys must order negatives, -0.0 and +0.0 the same way as < */
+    vec_float f, fw;
+    vec_float_init(&f);
+    vec_float_init(&fw);
+    for (size_t i = 0; i < n; i++) {
+        float x = (float)((double)(int64_t)bench_rand(&seed) / 1e15);
+        vec_float_push(&f, x);
+        vec_float_push(&fw, x);
+    }
+    printf("float, random\n");
+    double t = bench_now();
+    qsort(fw.data, n, sizeof(float), cmp_float);
+    bench_report("qsort", bench_now() - t, (double)n);
+    vec_float g;
+    vec_float_init(&g);
+    vec_float_extend(&g, f.data, n);
+    t = bench_now();
+    vec_float_sort(&g);
+    bench_report("vec_float_sort", bench_now() - t, (double)n);
+    BENCH_CHECK(memcmp(g.data, fw.data, n * sizeof(float)) == 0, "vec_float_sort");
+    t = bench_now();
+    vec_float_radix_sort(&f);
+    bench_report("vec_float_radix_sort", bench_now() - t, (double)n);
+    BENCH_CHECK(memcmp(f.data, fw.data, n * sizeof(float)) == 0, "vec_float_radix_sort");
+    vec_float_free(&f);
+    vec_float_free(&fw);
+    vec_float_free(&g);
+
+    /* struct with a custom comparator: keys must match, payloads may be permuted */
+    vec_Record r, rw;
+    vec_Record_init(&r);
+    vec_Record_init(&rw);
+    for (size_t i = 0; i < n; i++) {
+        Record x = { (int)(bench_rand(&seed) % (n / 2 + 1)), (int)i };
+        vec_Record_push(&r, x);
+        vec_Record_push(&rw, x);
+    }
+    printf("Record {int key; int payload}, custom comparator\n");
+    t = bench_now();
+    qsort(rw.data, n, sizeof(Record), cmp_record);
+    bench_report("qsort", bench_now() - t, (double)n);
+    vec_Record rp;
+    vec_Record_init(&rp);
+    vec_Record_extend(&rp, r.data, n);
+    t = bench_now();
+    vec_Record_sort(&r);
+    bench_report("vec_Record_sort", bench_now() - t, (double)n);
+    t = bench_now();
+    vec_Record_par_sort(&rp, PAR_THREADS);
+    bench_report("vec_Record_par_sort (4 threads)", bench_now() - t, (double)n);
+    long long payload_sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(r.data[i].key == rw.data[i].key && rp.data[i].key == rw.data[i].key, "vec_Record sorts");
+        payload_sum += (long long)r.data[i].payload - rp.data[i].payload;
+    }
+    BENCH_CHECK(payload_sum == 0, "vec_Record payloads preserved");
+    vec_Record_free(&r);
+    vec_Record_free(&rw);
+    vec_Record_free(&rp);
+    return 0;
+}
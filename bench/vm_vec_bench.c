@@ -0,0 +1,105 @@
+#include "vm_vec.h"
+#include "stl.h"
+#include "bench.h"
+
+/*
+ * Growth by push: vec_long (realloc) vs vm_vec_long (reserved address
+ * range, pages committed in place). Reports total time, the longest single
+ * growth stall, how often data moved, and memory handed back by
+ * VM_VEC_DECOMMIT after shrinking.
+ * usage: vm_vec_bench [n]   (n longs, default 268435456 = 2 GiB)
+ */
+
+DEFINE_VEC(long)
+DEFINE_VM_VEC(long)
+
+// Resident set size in MB from /proc (Linux); -1 elsewhere
+static double resident_mb(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return -1;
+    long pages = 0, rss = 0;
+    int ok = fscanf(f, "%ld %ld", &pages, &rss) == 2;
+    fclose(f);
+    return ok ? (double)rss * (double)vm_vec_page_size() / 1e6 : -1;
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench_arg(argc, argv, (size_t)1 << 28);
+    printf("push %zu longs (%.2f GB)\n", n, (double)n * sizeof(long) / 1e9);
+
+    /* ---- vec_long: realloc growth ---- */
+    vec_long v;
+    vec_long_init(&v);
+    size_t moves = 0;
+    double worst = 0;
+    double t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        if (v.len == v.cap) {
+            long* before = v.data;
+            double g = bench_now();
+            vec_long_push(&v, (long)i);
+            g = bench_now() - g;
+            if (g > worst) worst = g;
+            moves += before && v.data != before;
+        } else {
+            v.data[v.len++] = (long)i;
+        }
+    }
+    bench_report("vec_long_push", bench_now() - t, (double)n);
+    printf("  %-36s %9.4f s, data moved %zu times\n", "  longest growth stall", worst, moves);
+    BENCH_CHECK(v.len == n && v.data[n - 1] == (long)(n - 1), "vec contents");
+    long vec_sum = 0;
+    for (size_t i = 0; i < n; i += 4096) vec_sum += v.data[i];
+    vec_long_free(&v);
+
+    /* ---- vm_vec_long: commit in place ---- */
+    vm_vec_long w;
+    BENCH_CHECK(vm_vec_long_init(&w, 0, VM_VEC_DECOMMIT), "reserve");
+    printf("  reserved %.1f GB of address space\n", (double)w.reserved / 1e9);
+    long* first = NULL;
+    worst = 0;
+    t = bench_now();
+    for (size_t i = 0; i < n; i++) {
+        if (w.len == w.cap) {
+            double g = bench_now();
+            vm_vec_long_push(&w, (long)i);
+            g = bench_now() - g;
+            if (g > worst) worst = g;
+            if (!first) first = vm_vec_long_at_ptr(&w, 0);
+        } else {
+            w.data[w.len++] = (long)i;
+        }
+    }
+    bench_report("vm_vec_long_push", bench_now() - t, (double)n);
+    printf("  %-36s %9.4f s, data moved 0 times\n", "  longest growth stall", worst);
+    BENCH_CHECK(w.len == n && first == w.data && *first == 0, "pointer stability");
+    long vm_sum = 0;
+    for (size_t i = 0; i < n; i += 4096) vm_sum += w.data[i];
+    BENCH_CHECK(vec_sum == vm_sum, "vm_vec contents");
+
+    /* ---- decommit on shrink ---- */
+    double rss_full = resident_mb();
+    vm_vec_long_resize(&w, n / 16);
+    double rss_shrunk = resident_mb();
+    printf("  resize to n/16: RSS %.0f MB -> %.0f MB, committed %.0f MB\n", rss_full, rss_shrunk,
+           (double)w.committed / 1e6);
+    BENCH_CHECK(w.len == n / 16 && w.data[w.len - 1] == (long)(w.len - 1), "kept after decommit");
+    BENCH_CHECK(w.committed <= VM_VEC_COMMIT_MIN || w.committed <= vm_vec_round_up(n / 8 * sizeof(long), vm_vec_page_size()),
+                "decommitted");
+    vm_vec_long_resize(&w, n / 16 + 1000);
+    BENCH_CHECK(w.data == first && w.data[w.len - 1] == 0, "regrow zero-fills");
+    vm_vec_long_clear(&w);
+    BENCH_CHECK(w.committed <= VM_VEC_COMMIT_MIN, "clear decommits");
+    vm_vec_long_push(&w, 7);
+    BENCH_CHECK(w.data == first && vm_vec_long_pop(&w) == 7, "reuse after clear");
+    vm_vec_long_free(&w);
+
+    /* ---- capacity limit ---- */
+    vm_vec_long small;
+    BENCH_CHECK(vm_vec_long_init(&small, 100, 0), "small reserve");
+    size_t limit = small.max_len;
+    for (size_t i = 0; i < limit + 1; i++) vm_vec_long_push(&small, 1);
+    BENCH_CHECK(small.len == limit && !vm_vec_long_reserve(&small, limit + 1), "capacity limit");
+    vm_vec_long_free(&small);
+    return 0;
+}
@@ -0,0 +1,755 @@
+#ifndef ART_H
+#define ART_H
+
+#include "common.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Adaptive radix tree keyed by byte strings.
+ *
+ * Inner nodes come in four sizes (4, 16, 48 and 256 children) and grow or
+ * shrink as children are added and removed. Single-child chains are folded
+ * into a compressed prefix on the node below; up to ART_MAX_PREFIX_LEN bytes
+ * are stored inline and longer prefixes are checked against a leaf.
+ *
+ * Keys are arbitrary bytes (embedded zeros allowed) and may be prefixes of
+ * each other: a key ending exactly at an inner node is kept in the node's
+ * terminal slot. Iteration order is lexicographic by unsigned byte, shorter
+ * keys first.
+ *
+ * The node engine below is shared by every value type; DEFINE_ART(V,
+ * TYPE_NAME) generates the typed Art_TYPE_NAME map on top of it.
+ */
+
+#define ART_MAX_PREFIX_LEN 10
+
+typedef enum {
+    ART_NODE4 = 1,
+    ART_NODE16,
+    ART_NODE48,
+    ART_NODE256
+} ArtNodeType;
+
+// Leaf header; the typed value follows it, then the key bytes at key_off
+typedef struct {
+    uint32_t key_len;
+    uint32_t key_off;
+} ArtLeaf;
+
+typedef struct {
+    uint8_t type;
+    uint16_t num_children;
+    uint32_t partial_len;
+    unsigned char partial[ART_MAX_PREFIX_LEN];
+    ArtLeaf* terminal;          // leaf whose key ends at this node
+} ArtNode;
+
+typedef struct { ArtNode n; unsigned char keys[4]; void* children[4]; } ArtNode4;
+typedef struct { ArtNode n; unsigned char keys[16]; void* children[16]; } ArtNode16;
+typedef struct { ArtNode n; unsigned char index[256]; void* children[48]; } ArtNode48;
+typedef struct { ArtNode n; void* children[256]; } ArtNode256;
+
+typedef struct {
+    void* root;                 // ArtNode* or tagged ArtLeaf*
+    size_t size;
+} ArtTree;
+
+typedef bool (*ArtLeafFn)(ArtLeaf* leaf, void* ctx);
+
+#define ART_IS_LEAF(p) (((uintptr_t)(p) & 1) != 0)
+#define ART_TAG_LEAF(l) ((void*)((uintptr_t)(l) | 1))
+#define ART_UNTAG_LEAF(p) ((ArtLeaf*)((uintptr_t)(p) & ~(uintptr_t)1))
+
+static inline const unsigned char* art_leaf_key(const ArtLeaf* l) {
+    return (const unsigned char*)l + l->key_off;
+}
+
+static inline bool art_leaf_matches(const ArtLeaf* l, const unsigned char* key, size_t len) {
+    return l->key_len == len && memcmp(art_leaf_key(l), key, len) == 0;
+}
+
+static inline ArtLeaf* art_leaf_create(size_t leaf_size, const unsigned char* key, size_t len) {
+    ArtLeaf* l = (ArtLeaf*)malloc(leaf_size + len);
+    if (!l) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    l->key_len = (uint32_t)len;
+    l->key_off = (uint32_t)leaf_size;
+    memcpy((unsigned char*)l + leaf_size, key, len);
+    return l;
+}
+
+static inline ArtNode* art_node_create(uint8_t type) {
+    size_t size = (type == ART_NODE4) ? sizeof(ArtNode4)
+                : (type == ART_NODE16) ? sizeof(ArtNode16)
+                : (type == ART_NODE48) ? sizeof(ArtNode48) : sizeof(ArtNode256);
+    ArtNode* n = (ArtNode*)calloc(1, size);
+    if (!n) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    n->type = type;
+    return n;
+}
+
+static inline void art_copy_header(ArtNode* dst, const ArtNode* src) {
+    dst->num_children = src->num_children;
+    dst->partial_len = src->partial_len;
+    dst->terminal = src->terminal;
+    memcpy(dst->partial, src->partial, ART_MAX_PREFIX_LEN);
+}
+
+static inline size_t art_min_size(size_t a, size_t b) { return a < b ? a : b; }
+
+/* ---------- child lookup ---------- */
+
+static inline void** art_find_child(ArtNode* n, unsigned char c) {
+    switch (n->type) {
+        case ART_NODE4: {
+            ArtNode4* p = (ArtNode4*)n;
+            for (int i = 0; i < n->num_children; i++)
+                if (p->keys[i] == c) return &p->children[i];
+            return NULL;
+        }
+        case ART_NODE16: {
+            ArtNode16* p = (ArtNode16*)n;
+#if defined(__SSE2__)
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c), _mm_loadu_si128((const __m128i*)p->keys));
+            unsigned bits = (unsigned)_mm_movemask_epi8(cmp) & ((1u << n->num_children) - 1);
+            return bits ? &p->children[__builtin_ctz(bits)] : NULL;
+#else
+            for (int i = 0; i < n->num_children; i++)
+                if (p->keys[i] == c) return &p->children[i];
+            return NULL;
+#endif
+        }
+        case ART_NODE48: {
+            ArtNode48* p = (ArtNode48*)n;
+            return p->index[c] ? &p->children[p->index[c] - 1] : NULL;
+        }
+        default: {
+            ArtNode256* p = (ArtNode256*)n;
+            return p->children[c] ? &p->children[c] : NULL;
+        }
+    }
+}
+
+// Smallest leaf below n (the terminal sorts before every child)
+static inline ArtLeaf* art_minimum(const void* p) {
+    while (p) {
+        if (ART_IS_LEAF(p)) return ART_UNTAG_LEAF(p);
+        const ArtNode* n = (const ArtNode*)p;
+        if (n->terminal) return n->terminal;
+        switch (n->type) {
+            case ART_NODE4: p = ((const ArtNode4*)n)->children[0]; break;
+            case ART_NODE16: p = ((const ArtNode16*)n)->children[0]; break;
+            case ART_NODE48: {
+                const ArtNode48* n48 = (const ArtNode48*)n;
+                int i = 0;
+                while (!n48->index[i]) i++;
+                p = n48->children[n48->index[i] - 1];
+                break;
+            }
+            default: {
+                const ArtNode256* n256 = (const ArtNode256*)n;
+                int i = 0;
+                while (!n256->children[i]) i++;
+                p = n256->children[i];
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* ---------- child insertion (grows the node when full) ---------- */
+
+static inline void art_add_child(ArtNode* n, void** ref, unsigned char c, void* child);
+
+static inline void art_add_child256(ArtNode256* n, unsigned char c, void* child) {
+    n->n.num_children++;
+    n->children[c] = child;
+}
+
+static inline void art_add_child48(ArtNode48* n, void** ref, unsigned char c, void* child) {
+    if (n->n.num_children < 48) {
+        int pos = 0;
+        while (n->children[pos]) pos++;
+        n->children[pos] = child;
+        n->index[c] = (unsigned char)(pos + 1);
+        n->n.num_children++;
+        return;
+    }
+    ArtNode256* big = (ArtNode256*)art_node_create(ART_NODE256);
+    if (!big) return;
+    for (int i = 0; i < 256; i++)
+        if (n->index[i]) big->children[i] = n->children[n->index[i] - 1];
+    art_copy_header(&big->n, &n->n);
+    *ref = big;
+    free(n);
+    art_add_child256(big, c, child);
+}
+
+static inline void art_add_child16(ArtNode16* n, void** ref, unsigned char c, void* child) {
+    if (n->n.num_children < 16) {
+        int idx = 0;
+        while (idx < n->n.num_children && n->keys[idx] < c) idx++;
+        memmove(n->keys + idx + 1, n->keys + idx, n->n.num_children - idx);
+        memmove(n->children + idx + 1, n->children + idx, (n->n.num_children - idx) * sizeof(void*));
+        n->keys[idx] = c;
+        n->children[idx] = child;
+        n->n.num_children++;
+        return;
+    }
+    ArtNode48* big = (ArtNode48*)art_node_create(ART_NODE48);
+    if (!big) return;
+    memcpy(big->children, n->children, 16 * sizeof(void*));
+    for (int i = 0; i < 16; i++) big->index[n->keys[i]] = (unsigned char)(i + 1);
+    art_copy_header(&big->n, &n->n);
+    *ref = big;
+    free(n);
+    art_add_child48(big, ref, c, child);
+}
+
+static inline void art_add_child4(ArtNode4* n, void** ref, unsigned char c, void* child) {
+    if (n->n.num_children < 4) {
+        int idx = 0;
+        while (idx < n->n.num_children && n->keys[idx] < c) idx++;
+        memmove(n->keys + idx + 1, n->keys + idx, n->n.num_children - idx);
+        memmove(n->children + idx + 1, n->children + idx, (n->n.num_children - idx) * sizeof(void*));
+        n->keys[idx] = c;
+        n->children[idx] = child;
+        n->n.num_children++;
+        return;
+    }
+    ArtNode16* big = (ArtNode16*)art_node_create(ART_NODE16);
+    if (!big) return;
+    memcpy(big->children, n->children, 4 * sizeof(void*));
+    memcpy(big->keys, n->keys, 4);
+    art_copy_header(&big->n, &n->n);
+    *ref = big;
+    free(n);
+    art_add_child16(big, ref, c, child);
+}
+
+static inline void art_add_child(ArtNode* n, void** ref, unsigned char c, void* child) {
+    switch (n->type) {
+        case ART_NODE4: art_add_child4((ArtNode4*)n, ref, c, child); break;
+        case ART_NODE16: art_add_child16((ArtNode16*)n, ref, c, child); break;
+        case ART_NODE48: art_add_child48((ArtNode48*)n, ref, c, child); break;
+        default: art_add_child256((ArtNode256*)n, c, child); break;
+    }
+}
+
+/* ---------- prefix comparison ---------- */
+
+// Matching bytes between the stored part of n's prefix and key[depth..]
+static inline size_t art_check_prefix(const ArtNode* n, const unsigned char* key, size_t len, size_t depth) {
+    size_t max = art_min_size(art_min_size(n->partial_len, ART_MAX_PREFIX_LEN), len - depth);
+    size_t i = 0;
+    while (i < max && n->partial[i] == key[depth + i]) i++;
+    return i;
+}
+
+// Exact mismatch index against the whole prefix, reading long prefixes from a leaf
+static inline size_t art_prefix_mismatch(const ArtNode* n, const unsigned char* key, size_t len, size_t depth) {
+    size_t max = art_min_size(art_min_size(n->partial_len, ART_MAX_PREFIX_LEN), len - depth);
+    size_t i = 0;
+    for (; i < max; i++)
+        if (n->partial[i] != key[depth + i]) return i;
+    if (n->partial_len > ART_MAX_PREFIX_LEN) {
+        const ArtLeaf* l = art_minimum(n);
+        max = art_min_size(art_min_size(l->key_len, len) - depth, n->partial_len);
+        const unsigned char* lk = art_leaf_key(l);
+        for (; i < max; i++)
+            if (lk[depth + i] != key[depth + i]) return i;
+    }
+    return i;
+}
+
+/* ---------- engine: search / insert / erase ---------- */
+
+static inline void art_tree_init(ArtTree* t) {
+    t->root = NULL;
+    t->size = 0;
+}
+
+static inline ArtLeaf* art_tree_search(const ArtTree* t, const unsigned char* key, size_t len) {
+    void* p = t->root;
+    size_t depth = 0;
+    while (p) {
+        if (ART_IS_LEAF(p)) {
+            ArtLeaf* l = ART_UNTAG_LEAF(p);
+            return art_leaf_matches(l, key, len) ? l : NULL;
+        }
+        ArtNode* n = (ArtNode*)p;
+        if (n->partial_len) {
+            if (depth + n->partial_len > len) return NULL;
+            if (art_check_prefix(n, key, len, depth) != art_min_size(n->partial_len, ART_MAX_PREFIX_LEN)) return NULL;
+            depth += n->partial_len;   // bytes past the stored prefix are verified at the leaf
+        }
+        if (depth == len) {
+            return (n->terminal && art_leaf_matches(n->terminal, key, len)) ? n->terminal : NULL;
+        }
+        void** child = art_find_child(n, key[depth]);
+        p = child ? *child : NULL;
+        depth++;
+    }
+    return NULL;
+}
+
+// Places leaf under node n at depth d, as terminal or as child key[d]
+static inline void art_attach_leaf(ArtNode* n, void** ref, ArtLeaf* l, size_t d) {
+    if (l->key_len == d) n->terminal = l;
+    else art_add_child(n, ref, art_leaf_key(l)[d], ART_TAG_LEAF(l));
+}
+
+// Returns the leaf for key, creating it if needed (*created tells which)
+static inline ArtLeaf* art_tree_insert_at(void** ref, const unsigned char* key, size_t len, size_t depth,
+                                          size_t leaf_size, bool* created) {
+    void* p = *ref;
+    if (!p) {
+        ArtLeaf* l = art_leaf_create(leaf_size, key, len);
+        if (!l) return NULL;
+        *ref = ART_TAG_LEAF(l);
+        *created = true;
+        return l;
+    }
+    if (ART_IS_LEAF(p)) {
+        ArtLeaf* existing = ART_UNTAG_LEAF(p);
+        if (art_leaf_matches(existing, key, len)) return existing;
+        ArtNode* nn = art_node_create(ART_NODE4);
+        ArtLeaf* l = nn ? art_leaf_create(leaf_size, key, len) : NULL;
+        if (!l) {
+            free(nn);
+            return NULL;
+        }
+        const unsigned char* ek = art_leaf_key(existing);
+        size_t max = art_min_size(existing->key_len, len);
+        size_t common = 0;
+        while (depth + common < max && ek[depth + common] == key[depth + common]) common++;
+        nn->partial_len = (uint32_t)common;
+        memcpy(nn->partial, key + depth, art_min_size(common, ART_MAX_PREFIX_LEN));
+        *ref = nn;
+        art_attach_leaf(nn, ref, existing, depth + common);
+        art_attach_leaf(nn, ref, l, depth + common);
+        *created = true;
+        return l;
+    }
+    ArtNode* n = (ArtNode*)p;
+    if (n->partial_len) {
+        size_t diff = art_prefix_mismatch(n, key, len, depth);
+        if (diff < n->partial_len) {
+            /* Split the compressed prefix at diff */
+            ArtNode* nn = art_node_create(ART_NODE4);
+            ArtLeaf* l = nn ? art_leaf_create(leaf_size, key, len) : NULL;
+            if (!l) {
+                free(nn);
+                return NULL;
+            }
+            nn->partial_len = (uint32_t)diff;
+            memcpy(nn->partial, n->partial, art_min_size(diff, ART_MAX_PREFIX_LEN));
+            *ref = nn;
+            if (n->partial_len <= ART_MAX_PREFIX_LEN) {
+                art_add_child(nn, ref, n->partial[diff], n);
+                n->partial_len -= (uint32_t)(diff + 1);
+                memmove(n->partial, n->partial + diff + 1, art_min_size(n->partial_len, ART_MAX_PREFIX_LEN));
+            } else {
+                n->partial_len -= (uint32_t)(diff + 1);
+                const unsigned char* mk = art_leaf_key(art_minimum(n));
+                art_add_child(nn, ref, mk[depth + diff], n);
+                memcpy(n->partial, mk + depth + diff + 1, art_min_size(n->partial_len, ART_MAX_PREFIX_LEN));
+            }
+            art_attach_leaf(nn, ref, l, depth + diff);
+            *created = true;
+            return l;
+        }
+        depth += n->partial_len;
+    }
+    if (depth == len) {
+        if (n->terminal) return n->terminal;
+        n->terminal = art_leaf_create(leaf_size, key, len);
+        *created = n->terminal != NULL;
+        return n->terminal;
+    }
+    void** child = art_find_child(n, key[depth]);
+    if (child) return art_tree_insert_at(child, key, len, depth + 1, leaf_size, created);
+    ArtLeaf* l = art_leaf_create(leaf_size, key, len);
+    if (!l) return NULL;
+    art_add_child(n, ref, key[depth], ART_TAG_LEAF(l));
+    *created = true;
+    return l;
+}
+
+static inline ArtLeaf* art_tree_insert(ArtTree* t, const unsigned char* key, size_t len, size_t leaf_size, bool* created) {
+    *created = false;
+    ArtLeaf* l = art_tree_insert_at(&t->root, key, len, 0, leaf_size, created);
+    if (*created) t->size++;
+    return l;
+}
+
+/* ---------- child removal (shrinks or collapses the node) ---------- */
+
+// Replaces a node that has no terminal and a single child by that child
+static inline void art_collapse_into_child(ArtNode* n, void** ref, unsigned char c, void* child) {
+    if (!ART_IS_LEAF(child)) {
+        ArtNode* cn = (ArtNode*)child;
+        size_t prefix = n->partial_len;
+        if (prefix < ART_MAX_PREFIX_LEN) n->partial[prefix++] = c;
+        if (prefix < ART_MAX_PREFIX_LEN) {
+            size_t sub = art_min_size(cn->partial_len, ART_MAX_PREFIX_LEN - prefix);
+            memcpy(n->partial + prefix, cn->partial, sub);
+            prefix += sub;
+        }
+        memcpy(cn->partial, n->partial, art_min_size(prefix, ART_MAX_PREFIX_LEN));
+        cn->partial_len += n->partial_len + 1;
+    }
+    *ref = child;
+    free(n);
+}
+
+// Collapses n if it no longer needs to be an inner node
+static inline void art_maybe_collapse(ArtNode* n, void** ref) {
+    if (n->num_children == 0) {
+        *ref = n->terminal ? ART_TAG_LEAF(n->terminal) : NULL;
+        free(n);
+    } else if (n->num_children == 1 && !n->terminal && n->type == ART_NODE4) {
+        ArtNode4* n4 = (ArtNode4*)n;
+        art_collapse_into_child(n, ref, n4->keys[0], n4->children[0]);
+    }
+}
+
+static inline void art_remove_child(ArtNode* n, void** ref, unsigned char c, void** slot) {
+    switch (n->type) {
+        case ART_NODE4: {
+            ArtNode4* p = (ArtNode4*)n;
+            size_t pos = (size_t)(slot - p->children);
+            memmove(p->keys + pos, p->keys + pos + 1, n->num_children - 1 - pos);
+            memmove(p->children + pos, p->children + pos + 1, (n->num_children - 1 - pos) * sizeof(void*));
+            n->num_children--;
+            art_maybe_collapse(n, ref);
+            break;
+        }
+        case ART_NODE16: {
+            ArtNode16* p = (ArtNode16*)n;
+            size_t pos = (size_t)(slot - p->children);
+            memmove(p->keys + pos, p->keys + pos + 1, n->num_children - 1 - pos);
+            memmove(p->children + pos, p->children + pos + 1, (n->num_children - 1 - pos) * sizeof(void*));
+            n->num_children--;
+            if (n->num_children == 3) {
+                ArtNode4* small = (ArtNode4*)art_node_create(ART_NODE4);
+                if (!small) return;
+                art_copy_header(&small->n, n);
+                memcpy(small->keys, p->keys, 3);
+                memcpy(small->children, p->children, 3 * sizeof(void*));
+                *ref = small;
+                free(n);
+            }
+            break;
+        }
+        case ART_NODE48: {
+            ArtNode48* p = (ArtNode48*)n;
+            int pos = p->index[c] - 1;
+            p->index[c] = 0;
+            p->children[pos] = NULL;
+            n->num_children--;
+            if (n->num_children == 12) {
+                ArtNode16* small = (ArtNode16*)art_node_create(ART_NODE16);
+                if (!small) return;
+                art_copy_header(&small->n, n);
+                int k = 0;
+                for (int i = 0; i < 256; i++) {
+                    if (p->index[i]) {
+                        small->keys[k] = (unsigned char)i;
+                        small->children[k++] = p->children[p->index[i] - 1];
+                    }
+                }
+                *ref = small;
+                free(n);
+            }
+            break;
+        }
+        default: {
+            ArtNode256* p = (ArtNode256*)n;
+            p->children[c] = NULL;
+            n->num_children--;
+            if (n->num_children == 37) {
+                ArtNode48* small = (ArtNode48*)art_node_create(ART_NODE48);
+                if (!small) return;
+                art_copy_header(&small->n, n);
+                int k = 0;
+                for (int i = 0; i < 256; i++) {
+                    if (p->children[i]) {
+                        small->children[k] = p->children[i];
+                        small->index[i] = (unsigned char)(++k);
+                    }
+                }
+                *ref = small;
+                free(n);
+            }
+            break;
+        }
+    }
+}
+
+// Unlinks and returns the leaf for key (the caller frees it), or NULL
+static inline ArtLeaf* art_tree_erase_at(void** ref, const unsigned char* key, size_t len, size_t depth) {
+    void* p = *ref;
+    if (!p) return NULL;
+    if (ART_IS_LEAF(p)) {
+        ArtLeaf* l = ART_UNTAG_LEAF(p);
+        if (!art_leaf_matches(l, key, len)) return NULL;
+        *ref = NULL;
+        return l;
+    }
+    ArtNode* n = (ArtNode*)p;
+    if (n->partial_len) {
+        if (depth + n->partial_len > len) return NULL;
+        if (art_check_prefix(n, key, len, depth) != art_min_size(n->partial_len, ART_MAX_PREFIX_LEN)) return NULL;
+        depth += n->partial_len;
+    }
+    if (depth == len) {
+        ArtLeaf* l = n->terminal;
+        if (!l || !art_leaf_matches(l, key, len)) return NULL;
+        n->terminal = NULL;
+        if (n->num_children == 1 && n->type == ART_NODE4) art_maybe_collapse(n, ref);
+        return l;
+    }
+    void** child = art_find_child(n, key[depth]);
+    if (!child) return NULL;
+    if (ART_IS_LEAF(*child)) {
+        ArtLeaf* l = ART_UNTAG_LEAF(*child);
+        if (!art_leaf_matches(l, key, len)) return NULL;
+        art_remove_child(n, ref, key[depth], child);
+        return l;
+    }
+    ArtLeaf* l = art_tree_erase_at(child, key, len, depth + 1);
+    /* A child that collapsed to nothing leaves an empty slot behind */
+    if (l && *child == NULL) art_remove_child(n, ref, key[depth], child);
+    return l;
+}
+
+static inline ArtLeaf* art_tree_erase(ArtTree* t, const unsigned char* key, size_t len) {
+    ArtLeaf* l = art_tree_erase_at(&t->root, key, len, 0);
+    if (l) t->size--;
+    return l;
+}
+
+/* ---------- traversal ---------- */
+
+// Visits leaves under p in key order; returns false if fn stopped early
+static inline bool art_walk(void* p, ArtLeafFn fn, void* ctx) {
+    if (!p) return true;
+    if (ART_IS_LEAF(p)) return fn(ART_UNTAG_LEAF(p), ctx);
+    ArtNode* n = (ArtNode*)p;
+    if (n->terminal && !fn(n->terminal, ctx)) return false;
+    switch (n->type) {
+        case ART_NODE4:
+            for (int i = 0; i < n->num_children; i++)
+                if (!art_walk(((ArtNode4*)n)->children[i], fn, ctx)) return false;
+            break;
+        case ART_NODE16:
+            for (int i = 0; i < n->num_children; i++)
+                if (!art_walk(((ArtNode16*)n)->children[i], fn, ctx)) return false;
+            break;
+        case ART_NODE48: {
+            ArtNode48* n48 = (ArtNode48*)n;
+            for (int i = 0; i < 256; i++)
+                if (n48->index[i] && !art_walk(n48->children[n48->index[i] - 1], fn, ctx)) return false;
+            break;
+        }
+        default: {
+            ArtNode256* n256 = (ArtNode256*)n;
+            for (int i = 0; i < 256; i++)
+                if (n256->children[i] && !art_walk(n256->children[i], fn, ctx)) return false;
+            break;
+        }
+    }
+    return true;
+}
+
+// Visits every leaf whose key starts with prefix, in key order
+static inline bool art_tree_prefix_walk(const ArtTree* t, const unsigned char* prefix, size_t plen, ArtLeafFn fn, void* ctx) {
+    void* p = t->root;
+    size_t depth = 0;
+    while (p) {
+        if (ART_IS_LEAF(p)) {
+            ArtLeaf* l = ART_UNTAG_LEAF(p);
+            if (l->key_len >= plen && memcmp(art_leaf_key(l), prefix, plen) == 0) return fn(l, ctx);
+            return true;
+        }
+        if (depth == plen) return art_walk(p, fn, ctx);
+        ArtNode* n = (ArtNode*)p;
+        if (n->partial_len) {
+            size_t diff = art_prefix_mismatch(n, prefix, plen, depth);
+            if (depth + diff == plen) return art_walk(p, fn, ctx);
+            if (diff < n->partial_len) return true;
+            depth += n->partial_len;
+            if (depth == plen) return art_walk(p, fn, ctx);
+        }
+        void** child = art_find_child(n, prefix[depth]);
+        p = child ? *child : NULL;
+        depth++;
+    }
+    return true;
+}
+
+// Longest stored key that is a prefix of key[0..len), or NULL
+static inline ArtLeaf* art_tree_longest_prefix(const ArtTree* t, const unsigned char* key, size_t len) {
+    ArtLeaf* best = NULL;
+    void* p = t->root;
+    size_t depth = 0;
+    while (p) {
+        if (ART_IS_LEAF(p)) {
+            ArtLeaf* l = ART_UNTAG_LEAF(p);
+            if (l->key_len <= len && memcmp(art_leaf_key(l), key, l->key_len) == 0) best = l;
+            break;
+        }
+        ArtNode* n = (ArtNode*)p;
+        if (n->partial_len) {
+            if (depth + n->partial_len > len) break;
+            if (art_prefix_mismatch(n, key, len, depth) < n->partial_len) break;
+            depth += n->partial_len;
+        }
+        if (n->terminal) best = n->terminal;
+        if (depth == len) break;
+        void** child = art_find_child(n, key[depth]);
+        p = child ? *child : NULL;
+        depth++;
+    }
+    return best;
+}
+
+static inline void art_free_node(void* p) {
+    if (!p) return;
+    if (ART_IS_LEAF(p)) {
+        free(ART_UNTAG_LEAF(p));
+        return;
+    }
+    ArtNode* n = (ArtNode*)p;
+    free(n->terminal);
+    switch (n->type) {
+        case ART_NODE4:
+            for (int i = 0; i < n->num_children; i++) art_free_node(((ArtNode4*)n)->children[i]);
+            break;
+        case ART_NODE16:
+            for (int i = 0; i < n->num_children; i++) art_free_node(((ArtNode16*)n)->children[i]);
+            break;
+        case ART_NODE48:
+            for (int i = 0; i < 48; i++) art_free_node(((ArtNode48*)n)->children[i]);
+            break;
+        default:
+            for (int i = 0; i < 256; i++) art_free_node(((ArtNode256*)n)->children[i]);
+            break;
+    }
+    free(n);
+}
+
+static inline void art_tree_destroy(ArtTree* t) {
+    art_free_node(t->root);
+    t->root = NULL;
+    t->size = 0;
+}
+
+/* ---------- typed map: byte-string key -> V ---------- */
+
+// Helper macro to create unique names
+#define CONCAT(a, b) a##_##b
+#define MAKE_NAME(prefix, type) CONCAT(prefix, type)
+
+#define DEFINE_ART(V, TYPE_NAME) \
+typedef struct { \
+    ArtLeaf base; \
+    V value; \
+} MAKE_NAME(ArtLeaf, TYPE_NAME); \
+\
+typedef struct { \
+    ArtTree tree; \
+} MAKE_NAME(Art, TYPE_NAME); \
+\
+typedef bool (*MAKE_NAME(ArtFn, TYPE_NAME))(const unsigned char* key, size_t len, V* value, void* ctx); \
+\
+typedef struct { \
+    MAKE_NAME(ArtFn, TYPE_NAME) fn; \
+    void* ctx; \
+} MAKE_NAME(ArtVisit, TYPE_NAME); \
+\
+static inline void MAKE_NAME(art_init, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a) { \
+    art_tree_init(&a->tree); \
+} \
+\
+static inline void MAKE_NAME(art_destroy, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a) { \
+    art_tree_destroy(&a->tree); \
+} \
+\
+static inline size_t MAKE_NAME(art_size, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a) { \
+    return a->tree.size; \
+} \
+\
+/* Returns true if the key was new, false if an existing value was replaced */ \
+static inline bool MAKE_NAME(art_insert, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const void* key, size_t len, V value) { \
+    bool created; \
+    ArtLeaf* l = art_tree_insert(&a->tree, (const unsigned char*)key, len, sizeof(MAKE_NAME(ArtLeaf, TYPE_NAME)), &created); \
+    if (!l) return false; \
+    ((MAKE_NAME(ArtLeaf, TYPE_NAME)*)l)->value = value; \
+    return created; \
+} \
+\
+static inline bool MAKE_NAME(art_find, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const void* key, size_t len, V* value) { \
+    ArtLeaf* l = art_tree_search(&a->tree, (const unsigned char*)key, len); \
+    if (!l) return false; \
+    if (value) *value = ((MAKE_NAME(ArtLeaf, TYPE_NAME)*)l)->value; \
+    return true; \
+} \
+\
+static inline bool MAKE_NAME(art_erase, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const void* key, size_t len) { \
+    ArtLeaf* l = art_tree_erase(&a->tree, (const unsigned char*)key, len); \
+    free(l); \
+    return l != NULL; \
+} \
+\
+static inline bool MAKE_NAME(art_insert_str, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const char* key, V value) { \
+    return MAKE_NAME(art_insert, TYPE_NAME)(a, key, strlen(key), value); \
+} \
+\
+static inline bool MAKE_NAME(art_find_str, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const char* key, V* value) { \
+    return MAKE_NAME(art_find, TYPE_NAME)(a, key, strlen(key), value); \
+} \
+\
+static inline bool MAKE_NAME(art_erase_str, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const char* key) { \
+    return MAKE_NAME(art_erase, TYPE_NAME)(a, key, strlen(key)); \
+} \
+\
+static inline bool MAKE_NAME(art_visit_leaf, TYPE_NAME)(ArtLeaf* l, void* ctx) { \
+    MAKE_NAME(ArtVisit, TYPE_NAME)* v = (MAKE_NAME(ArtVisit, TYPE_NAME)*)ctx; \
+    return v->fn(art_leaf_key(l), l->key_len, &((MAKE_NAME(ArtLeaf, TYPE_NAME)*)l)->value, v->ctx); \
+} \
+\
+/* Visits every entry in key order; fn returns false to stop */ \
+static inline bool MAKE_NAME(art_foreach, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, MAKE_NAME(ArtFn, TYPE_NAME) fn, void* ctx) { \
+    MAKE_NAME(ArtVisit, TYPE_NAME) v = { fn, ctx }; \
+    return art_walk(a->tree.root, MAKE_NAME(art_visit_leaf, TYPE_NAME), &v); \
+} \
+\
+/* Visits entries whose key starts with prefix, in key order */ \
+static inline bool MAKE_NAME(art_prefix_foreach, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const void* prefix, size_t plen, \
+        MAKE_NAME(ArtFn, TYPE_NAME) fn, void* ctx) { \
+    MAKE_NAME(ArtVisit, TYPE_NAME) v = { fn, ctx }; \
+    return art_tree_prefix_walk(&a->tree, (const unsigned char*)prefix, plen, MAKE_NAME(art_visit_leaf, TYPE_NAME), &v); \
+} \
+\
+/* Finds the longest stored key that is a prefix of key; *match_len gets its length */ \
+static inline bool MAKE_NAME(art_longest_prefix, TYPE_NAME)(MAKE_NAME(Art, TYPE_NAME)* a, const void* key, size_t len, \
+        size_t* match_len, V* value) { \
+    ArtLeaf* l = art_tree_longest_prefix(&a->tree, (const unsigned char*)key, len); \
+    if (!l) return false; \
+    if (match_len) *match_len = l->key_len; \
+    if (value) *value = ((MAKE_NAME(ArtLeaf, TYPE_NAME)*)l)->value; \
+    return true; \
+}
+
+#endif // ART_H
@@ -0,0 +1,284 @@
+#ifndef CONCURRENT_SKIPLIST_H
+#define CONCURRENT_SKIPLIST_H
+
+#include "common.h"
+#include "epoch.h"
+
+/*
+ * Lock-free ordered set (Herlihy-Shavit skip list).
+ *
+ * Deletion marks the low bit of a node's next pointers, top level first;
+ * level 0 decides the winner. Traversals unlink marked nodes as they pass.
+ * Each node counts the levels it is still linked on; whoever unlinks the
+ * last one retires it to the list's epoch domain (see epoch.h).
+ *
+ * DEFINE_CONCURRENT_SKIPLIST(T, TYPE_NAME) orders with < and >.
+ * DEFINE_CONCURRENT_SKIPLIST_CUSTOM(T, TYPE_NAME, CMP_FUNC) takes a
+ * comparator returning <0, 0, >0, as for DEFINE_SET_CUSTOM.
+ */
+
+// Helper macro to create unique names
+#define CONCAT(a, b) a##_##b
+#define MAKE_NAME(prefix, type) CONCAT(prefix, type)
+
+#define SKIPLIST_MAX_LEVEL 24
+
+#define SKIPLIST_DEFAULT_CMP(a, b) (((a) < (b)) ? -1 : ((a) > (b)) ? 1 : 0)
+
+#define SKIPLIST_MARK(p) ((p) | (uintptr_t)1)
+#define SKIPLIST_IS_MARKED(p) (((p) & (uintptr_t)1) != 0)
+#define SKIPLIST_PTR(NodeT, p) ((NodeT*)((p) & ~(uintptr_t)1))
+
+// Per-thread generator for tower heights
+static _Thread_local uint64_t skiplist_rng_state;
+
+static inline int skiplist_random_level(void) {
+    uint64_t x = skiplist_rng_state;
+    if (x == 0) x = (uint64_t)(uintptr_t)&skiplist_rng_state | 1;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    skiplist_rng_state = x;
+    int level = 1;
+    while ((x & 1) && level < SKIPLIST_MAX_LEVEL) {
+        level++;
+        x >>= 1;
+    }
+    return level;
+}
+
+#define DEFINE_CONCURRENT_SKIPLIST(T, TYPE_NAME) \
+    DEFINE_CONCURRENT_SKIPLIST_CUSTOM(T, TYPE_NAME, SKIPLIST_DEFAULT_CMP)
+
+#define DEFINE_CONCURRENT_SKIPLIST_CUSTOM(T, TYPE_NAME, CMP_FUNC) \
+typedef struct MAKE_NAME(SkipNode, TYPE_NAME) { \
+    EpochNode retire; \
+    T key; \
+    atomic_int links; \
+    int top_level; \
+    _Atomic uintptr_t next[]; \
+} MAKE_NAME(SkipNode, TYPE_NAME); \
+\
+typedef struct { \
+    MAKE_NAME(SkipNode, TYPE_NAME)* head; \
+    atomic_size_t size; \
+    EpochDomain epoch; \
+} MAKE_NAME(ConcurrentSkipList, TYPE_NAME); \
+\
+static inline MAKE_NAME(SkipNode, TYPE_NAME)* MAKE_NAME(skiplist_create_node, TYPE_NAME)(int level) { \
+    MAKE_NAME(SkipNode, TYPE_NAME)* n = (MAKE_NAME(SkipNode, TYPE_NAME)*)malloc( \
+        sizeof(MAKE_NAME(SkipNode, TYPE_NAME)) + (size_t)level * sizeof(_Atomic uintptr_t)); \
+    if (!n) return NULL; \
+    n->top_level = level; \
+    atomic_init(&n->links, 1); \
+    for (int i = 0; i < level; i++) atomic_init(&n->next[i], (uintptr_t)0); \
+    return n; \
+} \
+\
+static inline bool MAKE_NAME(skiplist_init, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l) { \
+    l->head = MAKE_NAME(skiplist_create_node, TYPE_NAME)(SKIPLIST_MAX_LEVEL); \
+    if (!l->head) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    atomic_init(&l->size, 0); \
+    epoch_domain_init(&l->epoch); \
+    return true; \
+} \
+\
+/* Drops one level link; the last one retires the node */ \
+static inline void MAKE_NAME(skiplist_unlinked, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l, EpochSlot* slot, MAKE_NAME(SkipNode, TYPE_NAME)* n) { \
+    if (atomic_fetch_sub(&n->links, 1) == 1) epoch_retire(&l->epoch, slot, &n->retire); \
+} \
+\
+/* Fills preds/succs around key at every level, unlinking marked nodes on the way */ \
+static inline bool MAKE_NAME(skiplist_find, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l, EpochSlot* slot, T key, \
+        MAKE_NAME(SkipNode, TYPE_NAME)** preds, MAKE_NAME(SkipNode, TYPE_NAME)** succs) { \
+retry: ; \
+    MAKE_NAME(SkipNode, TYPE_NAME)* pred = l->head; \
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) { \
+        MAKE_NAME(SkipNode, TYPE_NAME)* curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), atomic_load(&pred->next[level])); \
+        while (curr) { \
+            uintptr_t succ = atomic_load(&curr->next[level]); \
+            if (SKIPLIST_IS_MARKED(succ)) { \
+                uintptr_t expected = (uintptr_t)curr; \
+                MAKE_NAME(SkipNode, TYPE_NAME)* next = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), succ); \
+                if (!atomic_compare_exchange_strong(&pred->next[level], &expected, (uintptr_t)next)) goto retry; \
+                MAKE_NAME(skiplist_unlinked, TYPE_NAME)(l, slot, curr); \
+                curr = next; \
+                continue; \
+            } \
+            if (CMP_FUNC(curr->key, key) < 0) { \
+                pred = curr; \
+                curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), succ); \
+            } else { \
+                break; \
+            } \
+        } \
+        preds[level] = pred; \
+        succs[level] = curr; \
+    } \
+    return succs[0] && CMP_FUNC(succs[0]->key, key) == 0; \
+} \
+\
+static inline bool MAKE_NAME(skiplist_insert, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l, T key) { \
+    MAKE_NAME(SkipNode, TYPE_NAME)* preds[SKIPLIST_MAX_LEVEL]; \
+    MAKE_NAME(SkipNode, TYPE_NAME)* succs[SKIPLIST_MAX_LEVEL]; \
+    int top = skiplist_random_level(); \
+    EpochSlot* slot = epoch_enter(&l->epoch); \
+    MAKE_NAME(SkipNode, TYPE_NAME)* node = NULL; \
+    for (;;) { \
+        if (MAKE_NAME(skiplist_find, TYPE_NAME)(l, slot, key, preds, succs)) { \
+            epoch_exit(slot); \
+            free(node); \
+            return false; \
+        } \
+        if (!node) { \
+            node = MAKE_NAME(skiplist_create_node, TYPE_NAME)(top); \
+            if (!node) { \
+                epoch_exit(slot); \
+                printf("Memory allocation failed\n"); \
+                return false; \
+            } \
+            node->key = key; \
+        } \
+        for (int i = 0; i < top; i++) atomic_store_explicit(&node->next[i], (uintptr_t)succs[i], memory_order_relaxed); \
+        uintptr_t expected = (uintptr_t)succs[0]; \
+        if (atomic_compare_exchange_strong(&preds[0]->next[0], &expected, (uintptr_t)node)) break; \
+    } \
+    atomic_fetch_add(&l->size, 1); \
+    for (int level = 1; level < top; level++) { \
+        for (;;) { \
+            uintptr_t old = atomic_load(&node->next[level]); \
+            if (SKIPLIST_IS_MARKED(old)) goto done; /* already being removed */ \
+            /* CAS even when old == succs[level], so a concurrent mark makes it fail */ \
+            if (!atomic_compare_exchange_strong(&node->next[level], &old, (uintptr_t)succs[level])) continue; \
+            /* Take a link reference, but never revive a node whose count reached 0 (retired) */ \
+            int links = atomic_load(&node->links); \
+            do { \
+                if (links == 0) goto done; \
+            } while (!atomic_compare_exchange_weak(&node->links, &links, links + 1)); \
+            uintptr_t expected = (uintptr_t)succs[level]; \
+            if (atomic_compare_exchange_strong(&preds[level]->next[level], &expected, (uintptr_t)node)) break; \
+            MAKE_NAME(skiplist_unlinked, TYPE_NAME)(l, slot, node); \
+            MAKE_NAME(skiplist_find, TYPE_NAME)(l, slot, key, preds, succs); \
+            if (succs[0] != node) goto done; /* removed meanwhile */ \
+        } \
+    } \
+done: \
+    epoch_exit(slot); \
+    return true; \
+} \
+\
+static inline bool MAKE_NAME(skiplist_remove, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l, T key) { \
+    MAKE_NAME(SkipNode, TYPE_NAME)* preds[SKIPLIST_MAX_LEVEL]; \
+    MAKE_NAME(SkipNode, TYPE_NAME)* succs[SKIPLIST_MAX_LEVEL]; \
+    EpochSlot* slot = epoch_enter(&l->epoch); \
+    if (!MAKE_NAME(skiplist_find, TYPE_NAME)(l, slot, key, preds, succs)) { \
+        epoch_exit(slot); \
+        return false; \
+    } \
+    MAKE_NAME(SkipNode, TYPE_NAME)* victim = succs[0]; \
+    for (int level = victim->top_level - 1; level >= 1; level--) { \
+        uintptr_t succ = atomic_load(&victim->next[level]); \
+        while (!SKIPLIST_IS_MARKED(succ)) { \
+            atomic_compare_exchange_strong(&victim->next[level], &succ, SKIPLIST_MARK(succ)); \
+        } \
+    } \
+    uintptr_t succ = atomic_load(&victim->next[0]); \
+    for (;;) { \
+        if (SKIPLIST_IS_MARKED(succ)) { \
+            epoch_exit(slot); \
+            return false; /* another thread won the removal */ \
+        } \
+        if (atomic_compare_exchange_strong(&victim->next[0], &succ, SKIPLIST_MARK(succ))) break; \
+    } \
+    atomic_fetch_sub(&l->size, 1); \
+    MAKE_NAME(skiplist_find, TYPE_NAME)(l, slot, key, preds, succs); \
+    epoch_exit(slot); \
+    return true; \
+} \
+\
+/* Wait-free lookup: skips marked nodes without unlinking them */ \
+static inline bool MAKE_NAME(skiplist_contains, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l, T key) { \
+    EpochSlot* slot = epoch_enter(&l->epoch); \
+    MAKE_NAME(SkipNode, TYPE_NAME)* pred = l->head; \
+    MAKE_NAME(SkipNode, TYPE_NAME)* curr = NULL; \
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) { \
+        curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), atomic_load(&pred->next[level])); \
+        while (curr) { \
+            uintptr_t succ = atomic_load(&curr->next[level]); \
+            if (SKIPLIST_IS_MARKED(succ)) { \
+                curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), succ); \
+            } else if (CMP_FUNC(curr->key, key) < 0) { \
+                pred = curr; \
+                curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), succ); \
+            } else { \
+                break; \
+            } \
+        } \
+    } \
+    bool found = curr && CMP_FUNC(curr->key, key) == 0; \
+    epoch_exit(slot); \
+    return found; \
+} \
+\
+/* Visits keys in [lo, hi) in order; fn returns false to stop. \
+   Weakly consistent: concurrent updates may or may not be seen. */ \
+static inline bool MAKE_NAME(skiplist_range, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l, T lo, T hi, \
+        bool (*fn)(T key, void* ctx), void* ctx) { \
+    MAKE_NAME(SkipNode, TYPE_NAME)* preds[SKIPLIST_MAX_LEVEL]; \
+    MAKE_NAME(SkipNode, TYPE_NAME)* succs[SKIPLIST_MAX_LEVEL]; \
+    EpochSlot* slot = epoch_enter(&l->epoch); \
+    MAKE_NAME(skiplist_find, TYPE_NAME)(l, slot, lo, preds, succs); \
+    MAKE_NAME(SkipNode, TYPE_NAME)* curr = succs[0]; \
+    bool completed = true; \
+    while (curr && CMP_FUNC(curr->key, hi) < 0) { \
+        uintptr_t succ = atomic_load(&curr->next[0]); \
+        if (!SKIPLIST_IS_MARKED(succ) && !fn(curr->key, ctx)) { \
+            completed = false; \
+            break; \
+        } \
+        curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), succ); \
+    } \
+    epoch_exit(slot); \
+    return completed; \
+} \
+\
+static inline size_t MAKE_NAME(skiplist_size, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l) { \
+    return atomic_load(&l->size); \
+} \
+\
+/* Frees every node; no other thread may use the list any more */ \
+static inline void MAKE_NAME(skiplist_destroy, TYPE_NAME)(MAKE_NAME(ConcurrentSkipList, TYPE_NAME)* l) { \
+    if (!l->head) return; \
+    EpochSlot* slot = epoch_enter(&l->epoch); \
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) { \
+        MAKE_NAME(SkipNode, TYPE_NAME)* pred = l->head; \
+        MAKE_NAME(SkipNode, TYPE_NAME)* curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), atomic_load(&pred->next[level])); \
+        while (curr) { \
+            uintptr_t succ = atomic_load(&curr->next[level]); \
+            MAKE_NAME(SkipNode, TYPE_NAME)* next = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), succ); \
+            if (SKIPLIST_IS_MARKED(succ)) { \
+                atomic_store(&pred->next[level], (uintptr_t)next); \
+                MAKE_NAME(skiplist_unlinked, TYPE_NAME)(l, slot, curr); \
+            } else { \
+                pred = curr; \
+            } \
+            curr = next; \
+        } \
+    } \
+    epoch_exit(slot); \
+    epoch_domain_destroy(&l->epoch); \
+    MAKE_NAME(SkipNode, TYPE_NAME)* curr = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), atomic_load(&l->head->next[0])); \
+    while (curr) { \
+        MAKE_NAME(SkipNode, TYPE_NAME)* next = SKIPLIST_PTR(MAKE_NAME(SkipNode, TYPE_NAME), atomic_load(&curr->next[0])); \
+        free(curr); \
+        curr = next; \
+    } \
+    free(l->head); \
+    l->head = NULL; \
+    atomic_store(&l->size, 0); \
+}
+
+#endif // CONCURRENT_SKIPLIST_H
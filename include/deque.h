@@ -0,0 +1,343 @@
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include "common.h"
+
+/*
+ * DEFINE_DEQUE(T) generates deque_T, a double-ended queue over fixed-size
+ * blocks, as std::deque: a map (array of block pointers) with the blocks in
+ * use in map[mb..me), and the elements running from offset first in the
+ * first block. Element i lives in block (first + i) / B at slot
+ * (first + i) % B, B being deque_T_block_len(). Push and pop at either end
+ * are O(1) (amortized for the map), indexing is O(1), and elements never
+ * move: pushing at either end only adds blocks, so pointers to elements
+ * stay valid until those elements are popped. Emptied blocks go to a small
+ * spare list and are reused before calling malloc.
+ *
+ * DEFINE_DEQUE_LIST(T, ListName) adds copies from and to a
+ * DEFINE_LIST(T, ListName) list, and DEFINE_DEQUE_QUEUE(T) from and to
+ * queue_T; each needs its container defined first.
+ */
+
+// Bytes per block; blocks hold at least DEQUE_MIN_BLOCK_LEN elements
+#define DEQUE_BLOCK_BYTES 4096
+#define DEQUE_MIN_BLOCK_LEN 16
+// Emptied blocks kept for reuse
+#define DEQUE_SPARE_BLOCKS 4
+#define DEQUE_MIN_MAP 8
+
+#define DEFINE_DEQUE(T) \
+typedef struct { \
+    T** map;            /* block pointers; map[mb..me) are in use */ \
+    size_t map_cap; \
+    size_t mb, me; \
+    size_t first;       /* slot of the front element in map[mb] */ \
+    size_t len; \
+    T* spare[DEQUE_SPARE_BLOCKS]; \
+    size_t nspare; \
+} deque_##T; \
+\
+static inline size_t deque_##T##_block_len(void) { \
+    return DEQUE_BLOCK_BYTES / sizeof(T) > DEQUE_MIN_BLOCK_LEN ? DEQUE_BLOCK_BYTES / sizeof(T) : DEQUE_MIN_BLOCK_LEN; \
+} \
+\
+static inline void deque_##T##_init(deque_##T* d) { \
+    d->map = NULL; \
+    d->map_cap = d->mb = d->me = d->first = d->len = d->nspare = 0; \
+    memset(d->spare, 0, sizeof(d->spare)); \
+} \
+\
+static inline size_t deque_##T##_size(const deque_##T* d) { \
+    return d->len; \
+} \
+\
+static inline bool deque_##T##_empty(const deque_##T* d) { \
+    return d->len == 0; \
+} \
+\
+/* A block from the spare list, or a new one */ \
+static inline T* deque_##T##_new_block(deque_##T* d) { \
+    if (d->nspare > 0) return d->spare[--d->nspare]; \
+    T* b = (T*)malloc(deque_##T##_block_len() * sizeof(T)); \
+    if (!b) printf("Memory allocation failed\n"); \
+    return b; \
+} \
+\
+static inline void deque_##T##_drop_block(deque_##T* d, T* b) { \
+    if (d->nspare < DEQUE_SPARE_BLOCKS) d->spare[d->nspare++] = b; \
+    else free(b); \
+} \
+\
+/* \
+ * Makes room for one more block pointer at the front (at_front) or back of \
+ * the map: re-centres the blocks in use if the map is at most half full, \
+ * else doubles it. \
+ */ \
+static inline bool deque_##T##_make_map_room(deque_##T* d, bool at_front) { \
+    if (at_front ? d->mb > 0 : d->me < d->map_cap) return true; \
+    size_t used = d->me - d->mb; \
+    size_t cap = d->map_cap; \
+    T** map = d->map; \
+    if (2 * (used + 1) > cap) { \
+        cap = cap < DEQUE_MIN_MAP ? DEQUE_MIN_MAP : cap; \
+        while (2 * (used + 1) > cap) cap *= 2; \
+        if (cap > SIZE_MAX / sizeof(T*)) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+        map = (T**)malloc(cap * sizeof(T*)); \
+        if (!map) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+    } \
+    size_t mb = (cap - used) / 2; \
+    if (used > 0) memmove(map + mb, d->map + d->mb, used * sizeof(T*)); \
+    if (map != d->map) { \
+        free(d->map); \
+        d->map = map; \
+        d->map_cap = cap; \
+    } \
+    d->mb = mb; \
+    d->me = mb + used; \
+    return true; \
+} \
+\
+/* Returns every block to the spare list (or frees it) and re-centres the empty map */ \
+static inline void deque_##T##_release_blocks(deque_##T* d) { \
+    for (size_t i = d->mb; i < d->me; i++) deque_##T##_drop_block(d, d->map[i]); \
+    d->mb = d->me = d->map_cap / 2; \
+    d->first = 0; \
+} \
+\
+static inline T* deque_##T##_at_ptr(deque_##T* d, size_t i) { \
+    if (i >= d->len) { \
+        printf("Index out of bounds\n"); \
+        return NULL; \
+    } \
+    size_t k = d->first + i, b = deque_##T##_block_len(); \
+    return &d->map[d->mb + k / b][k % b]; \
+} \
+\
+static inline T deque_##T##_get(deque_##T* d, size_t i) { \
+    T* p = deque_##T##_at_ptr(d, i); \
+    if (!p) { \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return *p; \
+} \
+\
+static inline void deque_##T##_set(deque_##T* d, size_t i, T item) { \
+    T* p = deque_##T##_at_ptr(d, i); \
+    if (p) *p = item; \
+} \
+\
+/* Appends an uninitialized slot and returns it to be filled in place */ \
+static inline T* deque_##T##_emplace_back(deque_##T* d) { \
+    size_t b = deque_##T##_block_len(); \
+    size_t k = d->first + d->len; \
+    if (k == (d->me - d->mb) * b) { \
+        if (!deque_##T##_make_map_room(d, false)) return NULL; \
+        T* blk = deque_##T##_new_block(d); \
+        if (!blk) return NULL; \
+        d->map[d->me++] = blk; \
+    } \
+    d->len++; \
+    return &d->map[d->mb + k / b][k % b]; \
+} \
+\
+/* Prepends an uninitialized slot and returns it to be filled in place */ \
+static inline T* deque_##T##_emplace_front(deque_##T* d) { \
+    size_t b = deque_##T##_block_len(); \
+    if (d->first == 0) { \
+        if (!deque_##T##_make_map_room(d, true)) return NULL; \
+        T* blk = deque_##T##_new_block(d); \
+        if (!blk) return NULL; \
+        d->map[--d->mb] = blk; \
+        d->first = b; \
+    } \
+    d->first--; \
+    d->len++; \
+    return &d->map[d->mb][d->first]; \
+} \
+\
+static inline void deque_##T##_push_back(deque_##T* d, T item) { \
+    T* slot = deque_##T##_emplace_back(d); \
+    if (slot) *slot = item; \
+} \
+\
+static inline void deque_##T##_push_front(deque_##T* d, T item) { \
+    T* slot = deque_##T##_emplace_front(d); \
+    if (slot) *slot = item; \
+} \
+\
+/* Removes the back element into *out (if not NULL) */ \
+static inline bool deque_##T##_pop_back_into(deque_##T* d, T* out) { \
+    if (d->len == 0) { \
+        fprintf(stderr, "Deque underflow\n"); \
+        return false; \
+    } \
+    size_t b = deque_##T##_block_len(); \
+    size_t k = d->first + --d->len; \
+    if (out) *out = d->map[d->mb + k / b][k % b]; \
+    if (d->len == 0) deque_##T##_release_blocks(d); \
+    else if (k % b == 0) deque_##T##_drop_block(d, d->map[--d->me]); \
+    return true; \
+} \
+\
+/* Removes the front element into *out (if not NULL) */ \
+static inline bool deque_##T##_pop_front_into(deque_##T* d, T* out) { \
+    if (d->len == 0) { \
+        fprintf(stderr, "Deque underflow\n"); \
+        return false; \
+    } \
+    if (out) *out = d->map[d->mb][d->first]; \
+    d->len--; \
+    if (d->len == 0) { \
+        deque_##T##_release_blocks(d); \
+    } else if (++d->first == deque_##T##_block_len()) { \
+        deque_##T##_drop_block(d, d->map[d->mb++]); \
+        d->first = 0; \
+    } \
+    return true; \
+} \
+\
+static inline T deque_##T##_pop_back(deque_##T* d) { \
+    T item = {0}; \
+    deque_##T##_pop_back_into(d, &item); \
+    return item; \
+} \
+\
+static inline T deque_##T##_pop_front(deque_##T* d) { \
+    T item = {0}; \
+    deque_##T##_pop_front_into(d, &item); \
+    return item; \
+} \
+\
+/* Pointers to the front / back element, NULL when empty */ \
+static inline T* deque_##T##_front_ptr(deque_##T* d) { \
+    return d->len ? &d->map[d->mb][d->first] : NULL; \
+} \
+\
+static inline T* deque_##T##_back_ptr(deque_##T* d) { \
+    return d->len ? deque_##T##_at_ptr(d, d->len - 1) : NULL; \
+} \
+\
+static inline T deque_##T##_front(deque_##T* d) { \
+    if (d->len == 0) { \
+        fprintf(stderr, "Deque is empty\n"); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return *deque_##T##_front_ptr(d); \
+} \
+\
+static inline T deque_##T##_back(deque_##T* d) { \
+    if (d->len == 0) { \
+        fprintf(stderr, "Deque is empty\n"); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return *deque_##T##_back_ptr(d); \
+} \
+\
+/* Appends items[0..n) with one memcpy per block */ \
+static inline bool deque_##T##_extend_back(deque_##T* d, const T* items, size_t n) { \
+    size_t b = deque_##T##_block_len(); \
+    while (n > 0) { \
+        T* slot = deque_##T##_emplace_back(d); \
+        if (!slot) return false; \
+        size_t room = b - (d->first + d->len - 1) % b; \
+        size_t k = n < room ? n : room; \
+        memcpy(slot, items, k * sizeof(T)); \
+        d->len += k - 1; \
+        items += k; \
+        n -= k; \
+    } \
+    return true; \
+} \
+\
+/* Copies elements [from, from + n) to out with one memcpy per block; false if out of range */ \
+static inline bool deque_##T##_copy_out(const deque_##T* d, size_t from, T* out, size_t n) { \
+    if (from > d->len || n > d->len - from) { \
+        printf("Index out of bounds\n"); \
+        return false; \
+    } \
+    size_t b = deque_##T##_block_len(); \
+    while (n > 0) { \
+        size_t k = d->first + from; \
+        size_t run = b - k % b < n ? b - k % b : n; \
+        memcpy(out, &d->map[d->mb + k / b][k % b], run * sizeof(T)); \
+        out += run; \
+        from += run; \
+        n -= run; \
+    } \
+    return true; \
+} \
+\
+/* Removes every element; keeps up to DEQUE_SPARE_BLOCKS blocks and the map */ \
+static inline void deque_##T##_clear(deque_##T* d) { \
+    deque_##T##_release_blocks(d); \
+    d->len = 0; \
+} \
+\
+/* Frees the spare blocks */ \
+static inline void deque_##T##_shrink_to_fit(deque_##T* d) { \
+    while (d->nspare > 0) free(d->spare[--d->nspare]); \
+} \
+\
+static inline void deque_##T##_free(deque_##T* d) { \
+    deque_##T##_clear(d); \
+    deque_##T##_shrink_to_fit(d); \
+    free(d->map); \
+    deque_##T##_init(d); \
+}
+
+/* Copies between deque_T and a DEFINE_LIST(T, ListName) list, front to back */
+#define DEFINE_DEQUE_LIST(T, ListName) \
+static inline bool deque_##T##_from_##ListName(deque_##T* d, const ListName* l) { \
+    deque_##T##_init(d); \
+    for (const ListName##Node* n = l->head; n; n = n->next) { \
+        T* slot = deque_##T##_emplace_back(d); \
+        if (!slot) return false; \
+        *slot = n->data; \
+    } \
+    return true; \
+} \
+\
+/* Appends the elements to l */ \
+static inline void deque_##T##_to_##ListName(deque_##T* d, ListName* l) { \
+    for (size_t i = 0; i < d->len; i++) ListName##_push_back(l, *deque_##T##_at_ptr(d, i)); \
+}
+
+/* Copies between deque_T and queue_T (front of the queue first), one memcpy per block */
+#define DEFINE_DEQUE_QUEUE(T) \
+static inline bool deque_##T##_from_queue(deque_##T* d, const queue_##T* q) { \
+    deque_##T##_init(d); \
+    size_t n = q->tail - q->head, done = 0, b = deque_##T##_block_len(); \
+    while (done < n) { \
+        T* slot = deque_##T##_emplace_back(d); \
+        if (!slot) return false; \
+        size_t room = b - (d->first + d->len - 1) % b; \
+        size_t k = n - done < room ? n - done : room; \
+        queue_##T##_copy_out(q, q->head + done, slot, k); \
+        d->len += k - 1; \
+        done += k; \
+    } \
+    return true; \
+} \
+\
+/* Enqueues the elements at the rear of q */ \
+static inline bool deque_##T##_to_queue(const deque_##T* d, queue_##T* q) { \
+    size_t b = deque_##T##_block_len(); \
+    for (size_t i = 0; i < d->len;) { \
+        size_t k = d->first + i; \
+        size_t run = b - k % b < d->len - i ? b - k % b : d->len - i; \
+        if (!queue_##T##_enqueue_n(q, &d->map[d->mb + k / b][k % b], run)) return false; \
+        i += run; \
+    } \
+    return true; \
+}
+
+#endif // DEQUE_H
@@ -0,0 +1,138 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include "common.h"
+#include <stdatomic.h>
+
+/*
+ * Epoch-based memory reclamation for lock-free containers.
+ *
+ * A thread brackets every access to shared nodes with epoch_enter/epoch_exit.
+ * Unlinked nodes are handed to epoch_retire and freed only after the global
+ * epoch has advanced twice, by which time no thread can still hold them.
+ *
+ * Threads do not register: epoch_enter claims a free slot and epoch_exit
+ * returns it. Each thread starts probing at its own cached slot, handed out
+ * round-robin on first use and moved to wherever the thread last got in, so
+ * a thread normally gets the same uncontended slot. Retired nodes stay with the slot, so nothing is lost
+ * when a thread exits. At most EPOCH_SLOTS threads can be inside a critical
+ * section at once; further threads spin until a slot frees up.
+ */
+
+#define EPOCH_SLOTS 64
+#define EPOCH_RECLAIM_INTERVAL 64
+
+// Intrusive link; must be the first member of every retired node
+typedef struct EpochNode {
+    struct EpochNode* next;
+} EpochNode;
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t active;   // epoch seen by the holder, 0 when idle
+    atomic_int owned;
+    EpochNode* limbo[3];                    // retired nodes, bucketed by epoch % 3
+    uint64_t limbo_epoch[3];
+    size_t pending;
+} EpochSlot;
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t global;
+    EpochSlot slots[EPOCH_SLOTS];
+} EpochDomain;
+
+// Round-robin source of first slots; SIZE_MAX marks a thread that has none yet
+static atomic_size_t epoch_next_slot;
+static _Thread_local size_t epoch_thread_slot = SIZE_MAX;
+
+static inline void epoch_free_list(EpochNode* n) {
+    while (n) {
+        EpochNode* next = n->next;
+        free(n);
+        n = next;
+    }
+}
+
+static inline void epoch_domain_init(EpochDomain* d) {
+    atomic_init(&d->global, 1);
+    for (size_t i = 0; i < EPOCH_SLOTS; i++) {
+        EpochSlot* s = &d->slots[i];
+        atomic_init(&s->active, 0);
+        atomic_init(&s->owned, 0);
+        for (int b = 0; b < 3; b++) {
+            s->limbo[b] = NULL;
+            s->limbo_epoch[b] = 0;
+        }
+        s->pending = 0;
+    }
+}
+
+// Frees every retired node; no thread may be inside a critical section
+static inline void epoch_domain_destroy(EpochDomain* d) {
+    for (size_t i = 0; i < EPOCH_SLOTS; i++) {
+        for (int b = 0; b < 3; b++) {
+            epoch_free_list(d->slots[i].limbo[b]);
+            d->slots[i].limbo[b] = NULL;
+        }
+        d->slots[i].pending = 0;
+    }
+}
+
+static inline EpochSlot* epoch_enter(EpochDomain* d) {
+    if (epoch_thread_slot == SIZE_MAX)
+        epoch_thread_slot = atomic_fetch_add_explicit(&epoch_next_slot, 1, memory_order_relaxed) % EPOCH_SLOTS;
+    for (size_t i = epoch_thread_slot;; i = (i + 1) % EPOCH_SLOTS) {
+        EpochSlot* s = &d->slots[i];
+        int expected = 0;
+        if (atomic_load_explicit(&s->owned, memory_order_relaxed) == 0 &&
+            atomic_compare_exchange_strong_explicit(&s->owned, &expected, 1,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            epoch_thread_slot = i;
+            atomic_store(&s->active, atomic_load(&d->global));
+            return s;
+        }
+    }
+}
+
+static inline void epoch_exit(EpochSlot* s) {
+    atomic_store_explicit(&s->active, 0, memory_order_release);
+    atomic_store_explicit(&s->owned, 0, memory_order_release);
+}
+
+// Advances the global epoch if every active slot has caught up with it
+static inline uint64_t epoch_try_advance(EpochDomain* d) {
+    uint64_t g = atomic_load(&d->global);
+    for (size_t i = 0; i < EPOCH_SLOTS; i++) {
+        uint64_t a = atomic_load(&d->slots[i].active);
+        if (a != 0 && a != g) return g;
+    }
+    if (atomic_compare_exchange_strong(&d->global, &g, g + 1)) return g + 1;
+    return g;
+}
+
+static inline void epoch_reclaim(EpochDomain* d, EpochSlot* s) {
+    uint64_t g = epoch_try_advance(d);
+    for (int b = 0; b < 3; b++) {
+        if (s->limbo[b] && s->limbo_epoch[b] + 2 <= g) {
+            epoch_free_list(s->limbo[b]);
+            s->limbo[b] = NULL;
+        }
+    }
+    s->pending = 0;
+}
+
+// Schedules an already unlinked node for freeing; call inside a critical section
+static inline void epoch_retire(EpochDomain* d, EpochSlot* s, EpochNode* n) {
+    uint64_t g = atomic_load(&d->global);
+    int b = (int)(g % 3);
+    if (s->limbo_epoch[b] != g) {
+        /* The bucket holds nodes from epoch g - 3 or older, already safe */
+        epoch_free_list(s->limbo[b]);
+        s->limbo[b] = NULL;
+        s->limbo_epoch[b] = g;
+    }
+    n->next = s->limbo[b];
+    s->limbo[b] = n;
+    if (++s->pending >= EPOCH_RECLAIM_INTERVAL) epoch_reclaim(d, s);
+}
+
+#endif // EPOCH_H
@@ -0,0 +1,627 @@
+#ifndef EXT_SORT_H
+#define EXT_SORT_H
+
+/*
+ * DEFINE_EXT_SORT(T) generates ext_sort_T, an external merge sort for data
+ * larger than memory. Elements are pushed into a run buffer; each full
+ * buffer is sorted in memory (vec_T_sort_array) and written to a temporary
+ * run file while the next buffer fills. finish merges the runs with a
+ * binary heap (k-way merge) and streams the result to a callback, a vec_T
+ * or a file. If there are more runs than the memory limit allows blocks
+ * for, earlier passes merge groups of runs into longer ones first.
+ *
+ * All file I/O goes through one background thread (C11 threads), double
+ * buffered: run writes overlap sorting the next run, each run being merged
+ * has its next block read while the current one is consumed, and file
+ * output is written while the next output block fills. Without C11 threads
+ * the same requests run synchronously.
+ *
+ * Needs DEFINE_VEC(T) and DEFINE_VEC_SORT(T) first (DEFINE_EXT_SORT_CUSTOM
+ * takes the comparator that was given to DEFINE_VEC_SORT_CUSTOM).
+ *
+ * POSIX only (mkstemp, pread, pwrite). Include this header first, or build
+ * with -D_DEFAULT_SOURCE, for the same reason as mmap_vec.h.
+ */
+
+#if !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "common.h"
+#include "vector.h"
+#include "vec_sort.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+
+#define EXT_SORT_DEFAULT_MEM ((size_t)256 << 20)
+// Smallest merge block; bounds the merge fan-in for a given memory limit
+#define EXT_SORT_MIN_BLOCK ((size_t)64 << 10)
+// First allocation of a run buffer; it doubles up to the memory limit
+#define EXT_SORT_INITIAL_RUN 4096
+
+typedef struct {
+    size_t mem_limit;       /* bytes for run buffers and merge blocks; 0 = EXT_SORT_DEFAULT_MEM */
+    const char* tmp_dir;    /* where run files go; NULL = $TMPDIR, else /tmp */
+} ExtSortConfig;
+
+// A sorted run inside a run file
+typedef struct {
+    uint64_t off;           /* byte offset */
+    uint64_t count;         /* elements */
+} ExtSortRun;
+
+/* ---------- Background I/O ---------- */
+
+typedef struct ExtSortIoReq {
+    struct ExtSortIoReq* next;
+    int fd;
+    bool write;
+    char* buf;
+    size_t bytes;
+    uint64_t off;
+    size_t done;            /* bytes transferred; short only at end of file */
+    int state;              /* 0 idle, 1 queued, 2 finished */
+    int err;                /* errno of a failed transfer */
+    bool failed;
+} ExtSortIoReq;
+
+typedef struct {
+#ifdef VEC_SORT_HAS_THREADS
+    thrd_t thread;
+    mtx_t mu;
+    cnd_t work;
+    cnd_t done;
+#endif
+    ExtSortIoReq* head;
+    ExtSortIoReq* tail;
+    bool running;
+    bool stop;
+} ExtSortIo;
+
+static inline void ext_sort_io_transfer(ExtSortIoReq* r) {
+    r->done = 0;
+    r->failed = false;
+    while (r->done < r->bytes) {
+        ssize_t n = r->write ? pwrite(r->fd, r->buf + r->done, r->bytes - r->done, (off_t)(r->off + r->done))
+                             : pread(r->fd, r->buf + r->done, r->bytes - r->done, (off_t)(r->off + r->done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 || (n == 0 && r->write)) {
+            r->err = n < 0 ? errno : EIO;
+            r->failed = true;
+            return;
+        }
+        if (n == 0) return;
+        r->done += (size_t)n;
+    }
+}
+
+#ifdef VEC_SORT_HAS_THREADS
+static inline int ext_sort_io_main(void* arg) {
+    ExtSortIo* io = (ExtSortIo*)arg;
+    mtx_lock(&io->mu);
+    for (;;) {
+        while (!io->head && !io->stop) cnd_wait(&io->work, &io->mu);
+        if (!io->head) break;
+        ExtSortIoReq* r = io->head;
+        io->head = r->next;
+        if (!io->head) io->tail = NULL;
+        mtx_unlock(&io->mu);
+        ext_sort_io_transfer(r);
+        mtx_lock(&io->mu);
+        r->state = 2;
+        cnd_broadcast(&io->done);
+    }
+    mtx_unlock(&io->mu);
+    return 0;
+}
+#endif
+
+static inline void ext_sort_io_start(ExtSortIo* io) {
+    io->head = io->tail = NULL;
+    io->stop = false;
+    io->running = false;
+#ifdef VEC_SORT_HAS_THREADS
+    if (mtx_init(&io->mu, mtx_plain) != thrd_success) return;
+    if (cnd_init(&io->work) != thrd_success) {
+        mtx_destroy(&io->mu);
+        return;
+    }
+    if (cnd_init(&io->done) != thrd_success) {
+        cnd_destroy(&io->work);
+        mtx_destroy(&io->mu);
+        return;
+    }
+    if (thrd_create(&io->thread, ext_sort_io_main, io) != thrd_success) {
+        cnd_destroy(&io->done);
+        cnd_destroy(&io->work);
+        mtx_destroy(&io->mu);
+        return;
+    }
+    io->running = true;
+#endif
+}
+
+// Queues r (fd, write, buf, bytes, off set by the caller); runs it now if there is no I/O thread
+static inline void ext_sort_io_submit(ExtSortIo* io, ExtSortIoReq* r) {
+    r->next = NULL;
+#ifdef VEC_SORT_HAS_THREADS
+    if (io->running) {
+        mtx_lock(&io->mu);
+        r->state = 1;
+        if (io->tail) io->tail->next = r;
+        else io->head = r;
+        io->tail = r;
+        cnd_signal(&io->work);
+        mtx_unlock(&io->mu);
+        return;
+    }
+#endif
+    (void)io;
+    ext_sort_io_transfer(r);
+    r->state = 2;
+}
+
+// Waits for r if it was submitted; false if it failed
+static inline bool ext_sort_io_wait(ExtSortIo* io, ExtSortIoReq* r) {
+    int state;
+#ifdef VEC_SORT_HAS_THREADS
+    if (io->running) {
+        /* The I/O thread sets state under mu, so it is only read under mu */
+        mtx_lock(&io->mu);
+        while (r->state == 1) cnd_wait(&io->done, &io->mu);
+        state = r->state;
+        r->state = 0;
+        mtx_unlock(&io->mu);
+    } else {
+        state = r->state;
+        r->state = 0;
+    }
+#else
+    (void)io;
+    state = r->state;
+    r->state = 0;
+#endif
+    if (state == 0) return true;
+    if (r->failed) printf("External sort I/O failed: %s\n", strerror(r->err));
+    return !r->failed;
+}
+
+// Finishes queued requests, then joins the thread
+static inline void ext_sort_io_stop(ExtSortIo* io) {
+#ifdef VEC_SORT_HAS_THREADS
+    if (io->running) {
+        mtx_lock(&io->mu);
+        io->stop = true;
+        cnd_signal(&io->work);
+        mtx_unlock(&io->mu);
+        thrd_join(io->thread, NULL);
+        cnd_destroy(&io->done);
+        cnd_destroy(&io->work);
+        mtx_destroy(&io->mu);
+    }
+#endif
+    io->running = false;
+}
+
+// Creates an anonymous file in dir (unlinked at once, so it goes away with the descriptor)
+static inline int ext_sort_temp_file(const char* dir) {
+    size_t n = strlen(dir);
+    char* path = (char*)malloc(n + sizeof("/stlc_run_XXXXXX"));
+    if (!path) {
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+    memcpy(path, dir, n);
+    memcpy(path + n, "/stlc_run_XXXXXX", sizeof("/stlc_run_XXXXXX"));
+    int fd = mkstemp(path);
+    if (fd < 0) printf("Cannot create a run file in %s: %s\n", dir, strerror(errno));
+    else unlink(path);
+    free(path);
+    return fd;
+}
+
+#define DEFINE_EXT_SORT(T) DEFINE_EXT_SORT_CUSTOM(T, VEC_SORT_DEFAULT_CMP)
+
+#define DEFINE_EXT_SORT_CUSTOM(T, CMP_FUNC) \
+/* Receives the sorted output in order, n elements at a time; false stops the merge */ \
+typedef bool (*ext_sort_##T##_emit_fn)(const T* items, size_t n, void* ctx); \
+\
+typedef struct { \
+    size_t mem_limit; \
+    char* tmp_dir; \
+    ExtSortIo io; \
+    int fd[2];                  /* run files: runs are in fd[0], merge passes alternate */ \
+    T* buf[2];                  /* run buffers: one fills while the other is written */ \
+    ExtSortIoReq wreq[2]; \
+    size_t buf_alloc[2]; \
+    size_t run_cap;             /* elements per run */ \
+    size_t len;                 /* elements in buf[cur] */ \
+    int cur; \
+    ExtSortRun* runs; \
+    size_t nruns, runs_cap; \
+    uint64_t file_end;          /* bytes used in fd[0] */ \
+    uint64_t total; \
+    bool failed; \
+} ext_sort_##T; \
+\
+/* One run being merged: two blocks, one consumed while the other is read */ \
+typedef struct { \
+    ExtSortIoReq req[2]; \
+    T* blk[2]; \
+    uint64_t next_off, end_off; \
+    const T* pos; \
+    const T* end; \
+    int cur; \
+} ExtSortReader_##T; \
+\
+typedef struct { \
+    T key; \
+    size_t src; \
+} ExtSortHeapEntry_##T; \
+\
+/* Where a merge goes: a run file (fd >= 0, async writes at off) or a callback */ \
+typedef struct { \
+    int fd; \
+    uint64_t off; \
+    ext_sort_##T##_emit_fn emit; \
+    void* ctx; \
+} ExtSortSink_##T; \
+\
+/* cfg may be NULL for the defaults */ \
+static inline bool ext_sort_##T##_init(ext_sort_##T* s, const ExtSortConfig* cfg) { \
+    memset(s, 0, sizeof(*s)); \
+    s->fd[0] = s->fd[1] = -1; \
+    s->mem_limit = cfg && cfg->mem_limit ? cfg->mem_limit : EXT_SORT_DEFAULT_MEM; \
+    const char* dir = cfg && cfg->tmp_dir ? cfg->tmp_dir : getenv("TMPDIR"); \
+    if (!dir || !*dir) dir = "/tmp"; \
+    size_t n = strlen(dir) + 1; \
+    s->tmp_dir = (char*)malloc(n); \
+    if (!s->tmp_dir) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    memcpy(s->tmp_dir, dir, n); \
+    s->run_cap = s->mem_limit / 2 / sizeof(T); \
+    if (s->run_cap == 0) s->run_cap = 1; \
+    return true; \
+} \
+\
+/* Makes room for at least one more element in buf[cur] */ \
+static inline bool ext_sort_##T##_grow_buf(ext_sort_##T* s) { \
+    int c = s->cur; \
+    size_t n = s->buf_alloc[c] ? s->buf_alloc[c] * 2 : EXT_SORT_INITIAL_RUN; \
+    if (n > s->run_cap) n = s->run_cap; \
+    T* p = (T*)realloc(s->buf[c], n * sizeof(T)); \
+    if (!p) { \
+        printf("Memory allocation failed\n"); \
+        s->failed = true; \
+        return false; \
+    } \
+    s->buf[c] = p; \
+    s->buf_alloc[c] = n; \
+    return true; \
+} \
+\
+/* Sorts buf[cur], queues its write as a new run and switches to the other buffer */ \
+static inline bool ext_sort_##T##_spill(ext_sort_##T* s) { \
+    if (s->fd[0] < 0) { \
+        s->fd[0] = ext_sort_temp_file(s->tmp_dir); \
+        if (s->fd[0] < 0) return false; \
+        ext_sort_io_start(&s->io); \
+    } \
+    if (s->nruns == s->runs_cap) { \
+        size_t cap = s->runs_cap ? s->runs_cap * 2 : 16; \
+        ExtSortRun* r = (ExtSortRun*)realloc(s->runs, cap * sizeof(*r)); \
+        if (!r) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+        s->runs = r; \
+        s->runs_cap = cap; \
+    } \
+    int c = s->cur; \
+    vec_##T##_sort_array(s->buf[c], s->len); \
+    ExtSortIoReq* w = &s->wreq[c]; \
+    w->fd = s->fd[0]; \
+    w->write = true; \
+    w->buf = (char*)s->buf[c]; \
+    w->bytes = s->len * sizeof(T); \
+    w->off = s->file_end; \
+    ext_sort_io_submit(&s->io, w); \
+    s->runs[s->nruns].off = s->file_end; \
+    s->runs[s->nruns].count = s->len; \
+    s->nruns++; \
+    s->file_end += w->bytes; \
+    s->len = 0; \
+    s->cur = c ^ 1; \
+    return ext_sort_io_wait(&s->io, &s->wreq[s->cur]); \
+} \
+\
+static inline bool ext_sort_##T##_push(ext_sort_##T* s, T val) { \
+    if (s->failed) return false; \
+    if (s->len == s->buf_alloc[s->cur]) { \
+        if (s->len == s->run_cap) { \
+            if (!ext_sort_##T##_spill(s)) { \
+                s->failed = true; \
+                return false; \
+            } \
+        } \
+        if (s->len == s->buf_alloc[s->cur] && !ext_sort_##T##_grow_buf(s)) return false; \
+    } \
+    s->buf[s->cur][s->len++] = val; \
+    s->total++; \
+    return true; \
+} \
+\
+static inline bool ext_sort_##T##_push_array(ext_sort_##T* s, const T* src, size_t n) { \
+    while (n > 0) { \
+        if (s->failed) return false; \
+        if (s->len == s->buf_alloc[s->cur]) { \
+            /* push spills or grows the buffer */ \
+            if (!ext_sort_##T##_push(s, *src++)) return false; \
+            n--; \
+            continue; \
+        } \
+        size_t k = s->buf_alloc[s->cur] - s->len; \
+        if (k > n) k = n; \
+        memcpy(s->buf[s->cur] + s->len, src, k * sizeof(T)); \
+        s->len += k; \
+        s->total += k; \
+        src += k; \
+        n -= k; \
+    } \
+    return true; \
+} \
+\
+/* Queues the read of the next block of r into blk[b] (nothing once the run is consumed) */ \
+static inline void ext_sort_##T##_reader_fill(ext_sort_##T* s, ExtSortReader_##T* r, int fd, size_t block, int b) { \
+    ExtSortIoReq* q = &r->req[b]; \
+    if (r->next_off >= r->end_off) { \
+        q->state = 0; \
+        q->done = 0; \
+        q->failed = false; \
+        return; \
+    } \
+    uint64_t left = r->end_off - r->next_off; \
+    q->fd = fd; \
+    q->write = false; \
+    q->buf = (char*)r->blk[b]; \
+    q->bytes = left < block * sizeof(T) ? (size_t)left : block * sizeof(T); \
+    q->off = r->next_off; \
+    r->next_off += q->bytes; \
+    ext_sort_io_submit(&s->io, q); \
+} \
+\
+/* Moves r to its other block; false once the run is exhausted or on a read error */ \
+static inline bool ext_sort_##T##_reader_next(ext_sort_##T* s, ExtSortReader_##T* r, int fd, size_t block) { \
+    ext_sort_##T##_reader_fill(s, r, fd, block, r->cur); \
+    r->cur ^= 1; \
+    ExtSortIoReq* q = &r->req[r->cur]; \
+    if (!ext_sort_io_wait(&s->io, q)) { \
+        s->failed = true; \
+        return false; \
+    } \
+    r->pos = r->blk[r->cur]; \
+    r->end = r->pos + q->done / sizeof(T); \
+    return r->pos != r->end; \
+} \
+\
+static inline void ext_sort_##T##_heap_down(ExtSortHeapEntry_##T* h, size_t i, size_t n) { \
+    ExtSortHeapEntry_##T x = h[i]; \
+    for (size_t child; (child = 2 * i + 1) < n; i = child) { \
+        if (child + 1 < n && CMP_FUNC(h[child + 1].key, h[child].key) < 0) child++; \
+        if (CMP_FUNC(h[child].key, x.key) >= 0) break; \
+        h[i] = h[child]; \
+    } \
+    h[i] = x; \
+} \
+\
+/* Hands out[0..n) to the sink; file sinks write it in the background */ \
+static inline bool ext_sort_##T##_flush(ext_sort_##T* s, ExtSortSink_##T* sink, ExtSortIoReq* w, T* out, size_t n) { \
+    if (n == 0) return true; \
+    if (sink->fd < 0) return sink->emit(out, n, sink->ctx); \
+    w->fd = sink->fd; \
+    w->write = true; \
+    w->buf = (char*)out; \
+    w->bytes = n * sizeof(T); \
+    w->off = sink->off; \
+    sink->off += w->bytes; \
+    ext_sort_io_submit(&s->io, w); \
+    return true; \
+} \
+\
+/* Elements per merge block when k runs are merged at once */ \
+static inline size_t ext_sort_##T##_block(const ext_sort_##T* s, size_t k) { \
+    size_t block = s->mem_limit / (2 * (k + 1)) / sizeof(T); \
+    return block ? block : 1; \
+} \
+\
+/* Merges runs[0..k) of run file fd into sink with blocks of `block` elements */ \
+static inline bool ext_sort_##T##_merge(ext_sort_##T* s, int fd, const ExtSortRun* runs, size_t k, size_t block, \
+                                        ExtSortSink_##T* sink) { \
+    ExtSortReader_##T* rd = (ExtSortReader_##T*)calloc(k, sizeof(*rd)); \
+    ExtSortHeapEntry_##T* heap = (ExtSortHeapEntry_##T*)malloc(k * sizeof(*heap)); \
+    T* mem = (T*)malloc((2 * k + 2) * block * sizeof(T)); \
+    if (!rd || !heap || !mem) { \
+        printf("Memory allocation failed\n"); \
+        free(rd); free(heap); free(mem); \
+        return false; \
+    } \
+    T* out[2] = { mem + 2 * k * block, mem + (2 * k + 1) * block }; \
+    ExtSortIoReq wreq[2]; \
+    memset(wreq, 0, sizeof(wreq)); \
+    size_t n = 0; \
+    for (size_t i = 0; i < k; i++) { \
+        ExtSortReader_##T* r = &rd[i]; \
+        r->blk[0] = mem + 2 * i * block; \
+        r->blk[1] = r->blk[0] + block; \
+        r->next_off = runs[i].off; \
+        r->end_off = runs[i].off + runs[i].count * sizeof(T); \
+        ext_sort_##T##_reader_fill(s, r, fd, block, 0); \
+        ext_sort_##T##_reader_fill(s, r, fd, block, 1); \
+    } \
+    bool ok = true; \
+    for (size_t i = 0; i < k && ok; i++) { \
+        ExtSortReader_##T* r = &rd[i]; \
+        ok = ext_sort_io_wait(&s->io, &r->req[0]); \
+        r->pos = r->blk[0]; \
+        r->end = r->pos + r->req[0].done / sizeof(T); \
+        if (ok && r->pos != r->end) { \
+            heap[n].key = *r->pos; \
+            heap[n++].src = i; \
+        } \
+    } \
+    for (size_t i = n / 2; i-- > 0;) ext_sort_##T##_heap_down(heap, i, n); \
+    int o = 0; \
+    size_t olen = 0; \
+    while (ok && n > 0) { \
+        out[o][olen++] = heap[0].key; \
+        ExtSortReader_##T* r = &rd[heap[0].src]; \
+        if (++r->pos != r->end || ext_sort_##T##_reader_next(s, r, fd, block)) heap[0].key = *r->pos; \
+        else if (s->failed) ok = false; \
+        else heap[0] = heap[--n]; \
+        if (n > 1) ext_sort_##T##_heap_down(heap, 0, n); \
+        if (olen == block) { \
+            ok = ok && ext_sort_##T##_flush(s, sink, &wreq[o], out[o], olen); \
+            o ^= 1; \
+            olen = 0; \
+            ok = ext_sort_io_wait(&s->io, &wreq[o]) && ok; \
+        } \
+    } \
+    if (ok) ok = ext_sort_##T##_flush(s, sink, &wreq[o], out[o], olen); \
+    /* Nothing may still be reading into or writing from mem */ \
+    for (int b = 0; b < 2; b++) ok = ext_sort_io_wait(&s->io, &wreq[b]) && ok; \
+    for (size_t i = 0; i < k; i++) \
+        for (int b = 0; b < 2; b++) ok = ext_sort_io_wait(&s->io, &rd[i].req[b]) && ok; \
+    free(mem); \
+    free(heap); \
+    free(rd); \
+    return ok; \
+} \
+\
+/* Sorts everything pushed and streams it to emit in order; call once, then free */ \
+static inline bool ext_sort_##T##_finish_sink(ext_sort_##T* s, ExtSortSink_##T* sink) { \
+    if (s->failed) return false; \
+    T* mem = s->buf[s->cur]; \
+    if (s->nruns == 0) { \
+        /* Everything fit in one buffer: no run files */ \
+        vec_##T##_sort_array(mem, s->len); \
+        ExtSortIoReq w; \
+        memset(&w, 0, sizeof(w)); \
+        if (sink->fd >= 0 && !s->io.running) ext_sort_io_start(&s->io); \
+        bool ok = ext_sort_##T##_flush(s, sink, &w, mem, s->len); \
+        return ext_sort_io_wait(&s->io, &w) && ok; \
+    } \
+    if (s->len > 0 && !ext_sort_##T##_spill(s)) return false; \
+    if (!ext_sort_io_wait(&s->io, &s->wreq[0]) || !ext_sort_io_wait(&s->io, &s->wreq[1])) return false; \
+    for (int b = 0; b < 2; b++) { \
+        free(s->buf[b]); \
+        s->buf[b] = NULL; \
+        s->buf_alloc[b] = 0; \
+    } \
+    /* Two blocks per input run and two output blocks must fit the memory limit */ \
+    size_t fan_in = s->mem_limit / (2 * EXT_SORT_MIN_BLOCK); \
+    fan_in = fan_in > 3 ? fan_in - 1 : 2; \
+    int src = 0; \
+    while (s->nruns > fan_in) { \
+        /* One pass: merge groups of fan_in runs into the other run file */ \
+        if (s->fd[src ^ 1] < 0 && (s->fd[src ^ 1] = ext_sort_temp_file(s->tmp_dir)) < 0) return false; \
+        size_t block = ext_sort_##T##_block(s, fan_in); \
+        ExtSortSink_##T pass = { s->fd[src ^ 1], 0, NULL, NULL }; \
+        size_t out = 0; \
+        for (size_t i = 0; i < s->nruns; i += fan_in) { \
+            size_t k = s->nruns - i < fan_in ? s->nruns - i : fan_in; \
+            ExtSortRun merged = { pass.off, 0 }; \
+            for (size_t j = 0; j < k; j++) merged.count += s->runs[i + j].count; \
+            if (!ext_sort_##T##_merge(s, s->fd[src], s->runs + i, k, block, &pass)) return false; \
+            s->runs[out++] = merged; \
+        } \
+        s->nruns = out; \
+        if (ftruncate(s->fd[src], 0) != 0) printf("Cannot truncate a run file: %s\n", strerror(errno)); \
+        src ^= 1; \
+    } \
+    return ext_sort_##T##_merge(s, s->fd[src], s->runs, s->nruns, ext_sort_##T##_block(s, s->nruns), sink); \
+} \
+\
+static inline bool ext_sort_##T##_finish(ext_sort_##T* s, ext_sort_##T##_emit_fn emit, void* ctx) { \
+    ExtSortSink_##T sink = { -1, 0, emit, ctx }; \
+    return ext_sort_##T##_finish_sink(s, &sink); \
+} \
+\
+static inline bool ext_sort_##T##_append_vec(const T* items, size_t n, void* ctx) { \
+    return vec_##T##_extend((vec_##T*)ctx, items, n); \
+} \
+\
+/* Appends the sorted elements to out */ \
+static inline bool ext_sort_##T##_finish_vec(ext_sort_##T* s, vec_##T* out) { \
+    if (!vec_##T##_reserve(out, out->len + (size_t)s->total)) return false; \
+    return ext_sort_##T##_finish(s, ext_sort_##T##_append_vec, out); \
+} \
+\
+/* Writes the sorted elements to path as a raw array of T, replacing the file */ \
+static inline bool ext_sort_##T##_finish_file(ext_sort_##T* s, const char* path) { \
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644); \
+    if (fd < 0) { \
+        printf("Cannot open %s: %s\n", path, strerror(errno)); \
+        return false; \
+    } \
+    ExtSortSink_##T sink = { fd, 0, NULL, NULL }; \
+    bool ok = ext_sort_##T##_finish_sink(s, &sink); \
+    return close(fd) == 0 && ok; \
+} \
+\
+static inline void ext_sort_##T##_free(ext_sort_##T* s) { \
+    for (int b = 0; b < 2; b++) ext_sort_io_wait(&s->io, &s->wreq[b]); \
+    ext_sort_io_stop(&s->io); \
+    for (int b = 0; b < 2; b++) { \
+        if (s->fd[b] >= 0) close(s->fd[b]); \
+        free(s->buf[b]); \
+    } \
+    free(s->runs); \
+    free(s->tmp_dir); \
+    memset(s, 0, sizeof(*s)); \
+    s->fd[0] = s->fd[1] = -1; \
+} \
+\
+/* Sorts the raw array of T in in_path into out_path */ \
+static inline bool ext_sort_##T##_sort_file(const char* in_path, const char* out_path, const ExtSortConfig* cfg) { \
+    int fd = open(in_path, O_RDONLY); \
+    if (fd < 0) { \
+        printf("Cannot open %s: %s\n", in_path, strerror(errno)); \
+        return false; \
+    } \
+    ext_sort_##T s; \
+    bool ok = ext_sort_##T##_init(&s, cfg); \
+    T chunk[65536 / sizeof(T) + 1]; \
+    size_t have = 0; \
+    while (ok) { \
+        ssize_t got = read(fd, (char*)chunk + have, sizeof(chunk) - have); \
+        if (got < 0 && errno == EINTR) continue; \
+        if (got < 0) { \
+            printf("Cannot read %s: %s\n", in_path, strerror(errno)); \
+            ok = false; \
+            break; \
+        } \
+        have += (size_t)got; \
+        if (got == 0 && have % sizeof(T) != 0) { \
+            printf("%s is not a whole number of elements\n", in_path); \
+            ok = false; \
+            break; \
+        } \
+        if (got == 0 || have == sizeof(chunk)) { \
+            ok = ext_sort_##T##_push_array(&s, chunk, have / sizeof(T)); \
+            if (got == 0) break; \
+            have = 0; \
+        } \
+    } \
+    close(fd); \
+    ok = ok && ext_sort_##T##_finish_file(&s, out_path); \
+    ext_sort_##T##_free(&s); \
+    return ok; \
+}
+
+#endif // __unix__ || __APPLE__
+
+#endif // EXT_SORT_H
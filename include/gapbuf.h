@@ -0,0 +1,173 @@
+#ifndef GAPBUF_H
+#define GAPBUF_H
+
+#include "common.h"
+#include "vector.h"
+
+/*
+ * DEFINE_GAPBUF(T) generates gapbuf_T: one array with a hole (the gap) at
+ * the edit position. Inserting or removing at the gap is O(1); editing
+ * somewhere else first moves the gap there with one memmove of the
+ * elements in between. Edits that cluster around a cursor therefore cost
+ * the distance the cursor moved, not the length of the sequence.
+ *
+ * Needs DEFINE_VEC(T) first (for the vec_T conversions).
+ */
+
+#define GAPBUF_MIN_CAP 16
+
+#define DEFINE_GAPBUF(T) \
+typedef struct { \
+    T* data; \
+    size_t cap; \
+    size_t gap_start;      /* elements before the gap; also the cursor */ \
+    size_t gap_end;        /* elements from gap_end to cap follow the gap */ \
+} gapbuf_##T; \
+\
+static inline void gapbuf_##T##_init(gapbuf_##T* g) { \
+    g->data = NULL; \
+    g->cap = g->gap_start = g->gap_end = 0; \
+} \
+\
+static inline size_t gapbuf_##T##_len(const gapbuf_##T* g) { \
+    return g->cap - (g->gap_end - g->gap_start); \
+} \
+\
+/* Makes the gap at least extra elements wide */ \
+static inline bool gapbuf_##T##_reserve_gap(gapbuf_##T* g, size_t extra) { \
+    size_t gap = g->gap_end - g->gap_start; \
+    if (gap >= extra) return true; \
+    size_t len = gapbuf_##T##_len(g); \
+    if (extra > SIZE_MAX / sizeof(T) / 2 - len) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    size_t new_cap = g->cap * 2; \
+    if (new_cap < len + extra) new_cap = len + extra; \
+    if (new_cap < GAPBUF_MIN_CAP) new_cap = GAPBUF_MIN_CAP; \
+    T* data = realloc(g->data, new_cap * sizeof(T)); \
+    if (!data) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    size_t tail = g->cap - g->gap_end; \
+    memmove(data + new_cap - tail, data + g->gap_end, tail * sizeof(T)); \
+    g->data = data; \
+    g->gap_end = new_cap - tail; \
+    g->cap = new_cap; \
+    return true; \
+} \
+\
+/* Moves the gap (the cursor) to pos, shifting the elements in between */ \
+static inline bool gapbuf_##T##_move_gap(gapbuf_##T* g, size_t pos) { \
+    if (pos > gapbuf_##T##_len(g)) { \
+        printf("Index out of bounds\n"); \
+        return false; \
+    } \
+    if (pos < g->gap_start) { \
+        size_t n = g->gap_start - pos; \
+        memmove(g->data + g->gap_end - n, g->data + pos, n * sizeof(T)); \
+        g->gap_start -= n; \
+        g->gap_end -= n; \
+    } else if (pos > g->gap_start) { \
+        size_t n = pos - g->gap_start; \
+        memmove(g->data + g->gap_start, g->data + g->gap_end, n * sizeof(T)); \
+        g->gap_start += n; \
+        g->gap_end += n; \
+    } \
+    return true; \
+} \
+\
+static inline size_t gapbuf_##T##_cursor(const gapbuf_##T* g) { \
+    return g->gap_start; \
+} \
+\
+/* Inserts n elements from src before index pos; src must not point into g */ \
+static inline bool gapbuf_##T##_insert_n(gapbuf_##T* g, size_t pos, const T* src, size_t n) { \
+    if (!gapbuf_##T##_move_gap(g, pos) || !gapbuf_##T##_reserve_gap(g, n)) return false; \
+    memcpy(g->data + g->gap_start, src, n * sizeof(T)); \
+    g->gap_start += n; \
+    return true; \
+} \
+\
+static inline void gapbuf_##T##_insert(gapbuf_##T* g, size_t pos, T val) { \
+    if (!gapbuf_##T##_move_gap(g, pos) || !gapbuf_##T##_reserve_gap(g, 1)) return; \
+    g->data[g->gap_start++] = val; \
+} \
+\
+static inline void gapbuf_##T##_push(gapbuf_##T* g, T val) { \
+    gapbuf_##T##_insert(g, gapbuf_##T##_len(g), val); \
+} \
+\
+/* Removes n elements starting at pos */ \
+static inline void gapbuf_##T##_erase(gapbuf_##T* g, size_t pos, size_t n) { \
+    size_t len = gapbuf_##T##_len(g); \
+    if (pos > len || n > len - pos) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    gapbuf_##T##_move_gap(g, pos); \
+    g->gap_end += n; \
+} \
+\
+static inline void gapbuf_##T##_remove(gapbuf_##T* g, size_t pos) { \
+    gapbuf_##T##_erase(g, pos, 1); \
+} \
+\
+static inline T* gapbuf_##T##_at_ptr(gapbuf_##T* g, size_t i) { \
+    if (i >= gapbuf_##T##_len(g)) { \
+        printf("Invalid index %zu\n", i); \
+        return NULL; \
+    } \
+    return &g->data[i < g->gap_start ? i : i + (g->gap_end - g->gap_start)]; \
+} \
+\
+static inline T gapbuf_##T##_get(gapbuf_##T* g, size_t i) { \
+    T* p = gapbuf_##T##_at_ptr(g, i); \
+    if (!p) { \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return *p; \
+} \
+\
+static inline void gapbuf_##T##_set(gapbuf_##T* g, size_t i, T val) { \
+    if (i >= gapbuf_##T##_len(g)) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    *gapbuf_##T##_at_ptr(g, i) = val; \
+} \
+\
+/* Copies the elements, in order, into out (room for len) */ \
+static inline void gapbuf_##T##_to_array(const gapbuf_##T* g, T* out) { \
+    memcpy(out, g->data, g->gap_start * sizeof(T)); \
+    memcpy(out + g->gap_start, g->data + g->gap_end, (g->cap - g->gap_end) * sizeof(T)); \
+} \
+\
+/* Initializes g with a copy of v; the gap starts at the end */ \
+static inline bool gapbuf_##T##_from_vec(gapbuf_##T* g, const vec_##T* v) { \
+    gapbuf_##T##_init(g); \
+    if (!gapbuf_##T##_reserve_gap(g, v->len + GAPBUF_MIN_CAP)) return false; \
+    memcpy(g->data, v->data, v->len * sizeof(T)); \
+    g->gap_start = v->len; \
+    return true; \
+} \
+\
+/* Appends the elements to out */ \
+static inline bool gapbuf_##T##_to_vec(const gapbuf_##T* g, vec_##T* out) { \
+    return vec_##T##_extend(out, g->data, g->gap_start) && \
+           vec_##T##_extend(out, g->data + g->gap_end, g->cap - g->gap_end); \
+} \
+\
+static inline void gapbuf_##T##_clear(gapbuf_##T* g) { \
+    g->gap_start = 0; \
+    g->gap_end = g->cap; \
+} \
+\
+static inline void gapbuf_##T##_free(gapbuf_##T* g) { \
+    free(g->data); \
+    gapbuf_##T##_init(g); \
+}
+
+#endif // GAPBUF_H
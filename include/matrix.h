@@ -0,0 +1,285 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "common.h"
+#include "vec_numeric.h"
+
+/*
+ * DEFINE_MATRIX(T) generates matrix_T: a dense row-major matrix in one
+ * MATRIX_ALIGN-aligned buffer. Each row starts `stride` elements after the
+ * previous one; stride is cols rounded up to a whole number of aligned
+ * chunks (plus one when that is a multiple of 1 KiB), so every row starts
+ * on an aligned address. Row views are plain
+ * T pointers, column views carry the stride.
+ *
+ * DEFINE_MATRIX_NUMERIC(T) (T = int, float or double) adds element-wise
+ * ops and a blocked multiply on top of the vec_numeric.h kernels.
+ * DEFINE_MATRIX_CONVERT(T) adds conversion to and from vec_vec_T and needs
+ * DEFINE_VEC(T) and DEFINE_VEC(vec_T) first.
+ */
+
+#define MATRIX_ALIGN 64
+#define MATRIX_TRANSPOSE_BLOCK 32
+#define MATRIX_MUL_BLOCK_K 128
+#define MATRIX_MUL_BLOCK_N 512
+
+// Row stride for cols elements of elem_size bytes
+static inline size_t matrix_stride_for(size_t cols, size_t elem_size) {
+    if (MATRIX_ALIGN % elem_size != 0) return cols;
+    size_t per = MATRIX_ALIGN / elem_size;
+    size_t stride = (cols + per - 1) / per * per;
+    /* Rows a multiple of 1 KiB apart map a column onto a few cache sets; pad them */
+    if (stride > per && (stride * elem_size) % 1024 == 0) stride += per;
+    return stride;
+}
+
+// Aligned buffer of at least bytes (rounded up as aligned_alloc requires)
+static inline void* matrix_alloc(size_t bytes) {
+    bytes = (bytes + MATRIX_ALIGN - 1) / MATRIX_ALIGN * MATRIX_ALIGN;
+    return aligned_alloc(MATRIX_ALIGN, bytes ? bytes : MATRIX_ALIGN);
+}
+
+#define DEFINE_MATRIX(T) \
+typedef struct { \
+    T* data; \
+    size_t rows; \
+    size_t cols; \
+    size_t stride;         /* elements from one row start to the next */ \
+    size_t row_cap;        /* rows that fit before the next reallocation */ \
+} matrix_##T; \
+\
+/* A column: element i is data[i * stride] */ \
+typedef struct { \
+    T* data; \
+    size_t len; \
+    size_t stride; \
+} matrix_##T##_col_view; \
+\
+/* rows x cols, zero-filled */ \
+static inline bool matrix_##T##_init(matrix_##T* m, size_t rows, size_t cols) { \
+    m->rows = m->cols = m->row_cap = 0; \
+    m->stride = matrix_stride_for(cols, sizeof(T)); \
+    size_t cap = rows ? rows : 1; \
+    if (m->stride && cap > SIZE_MAX / sizeof(T) / m->stride) { \
+        printf("Memory allocation failed\n"); \
+        m->data = NULL; \
+        return false; \
+    } \
+    m->data = matrix_alloc(cap * m->stride * sizeof(T)); \
+    if (!m->data) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    memset(m->data, 0, cap * m->stride * sizeof(T)); \
+    m->rows = rows; \
+    m->cols = cols; \
+    m->row_cap = cap; \
+    return true; \
+} \
+\
+static inline bool matrix_##T##_reserve_rows(matrix_##T* m, size_t rows) { \
+    if (rows <= m->row_cap) return true; \
+    if (m->stride && rows > SIZE_MAX / sizeof(T) / m->stride) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    T* data = matrix_alloc(rows * m->stride * sizeof(T)); \
+    if (!data) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    memcpy(data, m->data, m->rows * m->stride * sizeof(T)); \
+    memset(data + m->rows * m->stride, 0, (rows - m->rows) * m->stride * sizeof(T)); \
+    free(m->data); \
+    m->data = data; \
+    m->row_cap = rows; \
+    return true; \
+} \
+\
+/* Appends a row of cols elements copied from row */ \
+static inline bool matrix_##T##_append_row(matrix_##T* m, const T* row) { \
+    if (m->rows == m->row_cap && !matrix_##T##_reserve_rows(m, m->row_cap * 2)) return false; \
+    memcpy(m->data + m->rows * m->stride, row, m->cols * sizeof(T)); \
+    m->rows++; \
+    return true; \
+} \
+\
+static inline T matrix_##T##_get(const matrix_##T* m, size_t r, size_t c) { \
+    if (r >= m->rows || c >= m->cols) { \
+        printf("Invalid index (%zu, %zu)\n", r, c); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return m->data[r * m->stride + c]; \
+} \
+\
+static inline void matrix_##T##_set(matrix_##T* m, size_t r, size_t c, T val) { \
+    if (r >= m->rows || c >= m->cols) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    m->data[r * m->stride + c] = val; \
+} \
+\
+static inline T* matrix_##T##_at_ptr(matrix_##T* m, size_t r, size_t c) { \
+    if (r >= m->rows || c >= m->cols) { \
+        printf("Invalid index (%zu, %zu)\n", r, c); \
+        return NULL; \
+    } \
+    return &m->data[r * m->stride + c]; \
+} \
+\
+/* Row r as a pointer to cols contiguous elements; no copy */ \
+static inline T* matrix_##T##_row(matrix_##T* m, size_t r) { \
+    if (r >= m->rows) { \
+        printf("Invalid index %zu\n", r); \
+        return NULL; \
+    } \
+    return m->data + r * m->stride; \
+} \
+\
+static inline matrix_##T##_col_view matrix_##T##_col(matrix_##T* m, size_t c) { \
+    matrix_##T##_col_view v = { NULL, 0, m->stride }; \
+    if (c >= m->cols) { \
+        printf("Invalid index %zu\n", c); \
+        return v; \
+    } \
+    v.data = m->data + c; \
+    v.len = m->rows; \
+    return v; \
+} \
+\
+static inline T* matrix_##T##_col_at_ptr(matrix_##T##_col_view v, size_t i) { \
+    if (i >= v.len) { \
+        printf("Invalid index %zu\n", i); \
+        return NULL; \
+    } \
+    return v.data + i * v.stride; \
+} \
+\
+static inline void matrix_##T##_fill(matrix_##T* m, T val) { \
+    for (size_t r = 0; r < m->rows; r++) { \
+        T* row = m->data + r * m->stride; \
+        for (size_t c = 0; c < m->cols; c++) row[c] = val; \
+    } \
+} \
+\
+/* Initializes out as the transpose of src, tile by tile */ \
+static inline bool matrix_##T##_transpose(const matrix_##T* src, matrix_##T* out) { \
+    if (!matrix_##T##_init(out, src->cols, src->rows)) return false; \
+    const size_t B = MATRIX_TRANSPOSE_BLOCK; \
+    for (size_t r0 = 0; r0 < src->rows; r0 += B) { \
+        size_t r1 = r0 + B < src->rows ? r0 + B : src->rows; \
+        for (size_t c0 = 0; c0 < src->cols; c0 += B) { \
+            size_t c1 = c0 + B < src->cols ? c0 + B : src->cols; \
+            for (size_t r = r0; r < r1; r++) \
+                for (size_t c = c0; c < c1; c++) out->data[c * out->stride + r] = src->data[r * src->stride + c]; \
+        } \
+    } \
+    return true; \
+} \
+\
+/* Initializes out as a copy of src */ \
+static inline bool matrix_##T##_clone(const matrix_##T* src, matrix_##T* out) { \
+    if (!matrix_##T##_init(out, src->rows, src->cols)) return false; \
+    memcpy(out->data, src->data, src->rows * src->stride * sizeof(T)); \
+    return true; \
+} \
+\
+static inline void matrix_##T##_free(matrix_##T* m) { \
+    free(m->data); \
+    m->data = NULL; \
+    m->rows = m->cols = m->stride = m->row_cap = 0; \
+}
+
+/* ---------- numeric ops (T = int, float or double) ---------- */
+
+#define DEFINE_MATRIX_NUMERIC(T) \
+static inline bool matrix_##T##_same_shape(const matrix_##T* a, const matrix_##T* b) { \
+    if (a->rows != b->rows || a->cols != b->cols) { \
+        printf("Matrix shape mismatch\n"); \
+        return false; \
+    } \
+    return true; \
+} \
+\
+/* dst += src */ \
+static inline void matrix_##T##_add(matrix_##T* dst, const matrix_##T* src) { \
+    if (!matrix_##T##_same_shape(dst, src)) return; \
+    for (size_t r = 0; r < dst->rows; r++) \
+        numeric_add_##T(dst->data + r * dst->stride, src->data + r * src->stride, dst->cols); \
+} \
+\
+static inline void matrix_##T##_scale(matrix_##T* m, T alpha) { \
+    for (size_t r = 0; r < m->rows; r++) numeric_scale_##T(m->data + r * m->stride, m->cols, alpha); \
+} \
+\
+/* y += alpha * x */ \
+static inline void matrix_##T##_axpy(matrix_##T* y, T alpha, const matrix_##T* x) { \
+    if (!matrix_##T##_same_shape(y, x)) return; \
+    for (size_t r = 0; r < y->rows; r++) \
+        numeric_axpy_##T(y->data + r * y->stride, alpha, x->data + r * x->stride, y->cols); \
+} \
+\
+static inline NUMERIC_ACC_##T matrix_##T##_sum(const matrix_##T* m) { \
+    NUMERIC_ACC_##T s = 0; \
+    for (size_t r = 0; r < m->rows; r++) s += numeric_sum_##T(m->data + r * m->stride, m->cols); \
+    return s; \
+} \
+\
+/* \
+ * Initializes out = a * b. Tiles of MATRIX_MUL_BLOCK_K rows of b by \
+ * MATRIX_MUL_BLOCK_N columns stay in cache while every row of a streams \
+ * past; the inner step is an axpy of a row of the tile into a row of out. \
+ */ \
+static inline bool matrix_##T##_mul(const matrix_##T* a, const matrix_##T* b, matrix_##T* out) { \
+    if (a->cols != b->rows) { \
+        printf("Matrix shape mismatch\n"); \
+        return false; \
+    } \
+    if (!matrix_##T##_init(out, a->rows, b->cols)) return false; \
+    for (size_t k0 = 0; k0 < a->cols; k0 += MATRIX_MUL_BLOCK_K) { \
+        size_t k1 = k0 + MATRIX_MUL_BLOCK_K < a->cols ? k0 + MATRIX_MUL_BLOCK_K : a->cols; \
+        for (size_t j0 = 0; j0 < b->cols; j0 += MATRIX_MUL_BLOCK_N) { \
+            size_t nb = b->cols - j0 < MATRIX_MUL_BLOCK_N ? b->cols - j0 : MATRIX_MUL_BLOCK_N; \
+            for (size_t i = 0; i < a->rows; i++) { \
+                const T* arow = a->data + i * a->stride; \
+                T* orow = out->data + i * out->stride + j0; \
+                for (size_t k = k0; k < k1; k++) \
+                    numeric_axpy_##T(orow, arow[k], b->data + k * b->stride + j0, nb); \
+            } \
+        } \
+    } \
+    return true; \
+}
+
+/* ---------- conversion from / to vec_vec_T ---------- */
+
+#define DEFINE_MATRIX_CONVERT(T) \
+/* Initializes m from equally long rows; ragged input is refused */ \
+static inline bool matrix_##T##_from_vec_vec(matrix_##T* m, const vec_vec_##T* vv) { \
+    size_t cols = vv->len ? vv->data[0].len : 0; \
+    for (size_t r = 1; r < vv->len; r++) \
+        if (vv->data[r].len != cols) { \
+            printf("Rows have different lengths\n"); \
+            m->data = NULL; \
+            m->rows = m->cols = m->stride = m->row_cap = 0; \
+            return false; \
+        } \
+    if (!matrix_##T##_init(m, vv->len, cols)) return false; \
+    for (size_t r = 0; r < vv->len; r++) memcpy(m->data + r * m->stride, vv->data[r].data, cols * sizeof(T)); \
+    return true; \
+} \
+\
+/* Appends one vec_T per row to out */ \
+static inline bool matrix_##T##_to_vec_vec(const matrix_##T* m, vec_vec_##T* out) { \
+    for (size_t r = 0; r < m->rows; r++) { \
+        vec_##T row; \
+        vec_##T##_init(&row); \
+        if (!vec_##T##_extend(&row, m->data + r * m->stride, m->cols)) return false; \
+        vec_vec_##T##_push(out, row); \
+    } \
+    return true; \
+}
+
+#endif // MATRIX_H
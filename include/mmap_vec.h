@@ -0,0 +1,292 @@
+#ifndef MMAP_VEC_H
+#define MMAP_VEC_H
+
+/*
+ * DEFINE_MMAP_VEC(T) generates mmap_vec_T: a vec_T whose elements live in
+ * a memory-mapped file, so the array persists across runs and opening it
+ * costs no reads. Growth extends the file with ftruncate and remaps it
+ * (mremap when _GNU_SOURCE exposes it, otherwise munmap + mmap; the file
+ * contents are never copied).
+ *
+ * The file starts with a 64-byte MmapVecHeader: magic, format version,
+ * element size, length, capacity and the element type name. Opening a file
+ * written for another type or version fails.
+ *
+ * POSIX only. Under -std=c11 the POSIX calls are hidden unless a feature
+ * macro is set before the first system header: include this header first,
+ * or build with -D_DEFAULT_SOURCE (or -D_GNU_SOURCE for mremap).
+ */
+
+#if !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "common.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MMAP_VEC_MAGIC "STLCVEC"
+#define MMAP_VEC_VERSION 1u
+#define MMAP_VEC_INITIAL_CAP 1024
+#define MMAP_VEC_TYPE_NAME_LEN 32
+
+// Open flags
+#define MMAP_VEC_READ_ONLY 1    /* shared read-only mapping; the file must exist */
+#define MMAP_VEC_TRUNCATE 2     /* start empty, discarding existing contents */
+
+typedef enum {
+    MMAP_VEC_ADVISE_NORMAL,
+    MMAP_VEC_ADVISE_SEQUENTIAL,
+    MMAP_VEC_ADVISE_RANDOM,
+    MMAP_VEC_ADVISE_WILLNEED,
+    MMAP_VEC_ADVISE_DONTNEED
+} MmapVecAdvice;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t elem_size;
+    uint64_t len;
+    uint64_t cap;
+    char type_name[MMAP_VEC_TYPE_NAME_LEN];
+} MmapVecHeader;
+
+typedef char mmap_vec_header_is_64_bytes[sizeof(MmapVecHeader) == 64 ? 1 : -1];
+
+// Checks a mapped header against the expected element type; prints why it does not match
+static inline bool mmap_vec_header_check(const MmapVecHeader* h, size_t file_size, size_t elem_size, const char* type_name) {
+    if (memcmp(h->magic, MMAP_VEC_MAGIC, sizeof(h->magic)) != 0) {
+        printf("Not an mmap_vec file\n");
+        return false;
+    }
+    if (h->version != MMAP_VEC_VERSION) {
+        printf("Unsupported mmap_vec version %u\n", (unsigned)h->version);
+        return false;
+    }
+    if (h->elem_size != elem_size || strncmp(h->type_name, type_name, MMAP_VEC_TYPE_NAME_LEN - 1) != 0) {
+        printf("mmap_vec file holds %.*s (%u bytes), not %s\n", MMAP_VEC_TYPE_NAME_LEN, h->type_name,
+               (unsigned)h->elem_size, type_name);
+        return false;
+    }
+    if (h->len > h->cap || h->cap > (file_size - sizeof(MmapVecHeader)) / elem_size) {
+        printf("mmap_vec file is truncated\n");
+        return false;
+    }
+    return true;
+}
+
+static inline int mmap_vec_advice_flag(MmapVecAdvice advice) {
+    switch (advice) {
+    case MMAP_VEC_ADVISE_SEQUENTIAL: return POSIX_MADV_SEQUENTIAL;
+    case MMAP_VEC_ADVISE_RANDOM: return POSIX_MADV_RANDOM;
+    case MMAP_VEC_ADVISE_WILLNEED: return POSIX_MADV_WILLNEED;
+    case MMAP_VEC_ADVISE_DONTNEED: return POSIX_MADV_DONTNEED;
+    default: return POSIX_MADV_NORMAL;
+    }
+}
+
+// Resizes a shared mapping of fd from old_size to new_size bytes; NULL on failure
+static inline void* mmap_vec_remap(void* base, size_t old_size, size_t new_size, int fd) {
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+    (void)fd;
+    void* p = mremap(base, old_size, new_size, MREMAP_MAYMOVE);
+    return p == MAP_FAILED ? NULL : p;
+#else
+    void* p = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return NULL;
+    munmap(base, old_size);
+    return p;
+#endif
+}
+
+#define DEFINE_MMAP_VEC(T) \
+typedef struct { \
+    T* data; \
+    size_t len; \
+    size_t cap; \
+    MmapVecHeader* header; \
+    size_t map_size; \
+    int fd; \
+    bool read_only; \
+} mmap_vec_##T; \
+\
+/* Opens (or creates) the file at path; flags are MMAP_VEC_READ_ONLY / MMAP_VEC_TRUNCATE */ \
+static inline bool mmap_vec_##T##_open(mmap_vec_##T* v, const char* path, int flags) { \
+    memset(v, 0, sizeof(*v)); \
+    v->fd = -1; \
+    v->read_only = (flags & MMAP_VEC_READ_ONLY) != 0; \
+    int oflags = v->read_only ? O_RDONLY : O_RDWR | O_CREAT | ((flags & MMAP_VEC_TRUNCATE) ? O_TRUNC : 0); \
+    int fd = open(path, oflags, 0644); \
+    if (fd < 0) { \
+        printf("Cannot open %s: %s\n", path, strerror(errno)); \
+        return false; \
+    } \
+    struct stat st; \
+    if (fstat(fd, &st) != 0) { \
+        printf("Cannot stat %s: %s\n", path, strerror(errno)); \
+        close(fd); \
+        return false; \
+    } \
+    size_t size = (size_t)st.st_size; \
+    bool fresh = size == 0 && !v->read_only; \
+    if (fresh) { \
+        size = sizeof(MmapVecHeader) + (size_t)MMAP_VEC_INITIAL_CAP * sizeof(T); \
+        if (ftruncate(fd, (off_t)size) != 0) { \
+            printf("Cannot grow %s: %s\n", path, strerror(errno)); \
+            close(fd); \
+            return false; \
+        } \
+    } else if (size < sizeof(MmapVecHeader)) { \
+        printf("Not an mmap_vec file\n"); \
+        close(fd); \
+        return false; \
+    } \
+    int prot = v->read_only ? PROT_READ : PROT_READ | PROT_WRITE; \
+    void* base = mmap(NULL, size, prot, MAP_SHARED, fd, 0); \
+    if (base == MAP_FAILED) { \
+        printf("Cannot map %s: %s\n", path, strerror(errno)); \
+        close(fd); \
+        return false; \
+    } \
+    MmapVecHeader* h = (MmapVecHeader*)base; \
+    if (fresh) { \
+        memcpy(h->magic, MMAP_VEC_MAGIC, sizeof(h->magic)); \
+        h->version = MMAP_VEC_VERSION; \
+        h->elem_size = (uint32_t)sizeof(T); \
+        h->len = 0; \
+        h->cap = MMAP_VEC_INITIAL_CAP; \
+        strncpy(h->type_name, #T, MMAP_VEC_TYPE_NAME_LEN - 1); \
+    } else if (!mmap_vec_header_check(h, size, sizeof(T), #T)) { \
+        munmap(base, size); \
+        close(fd); \
+        return false; \
+    } \
+    v->fd = fd; \
+    v->header = h; \
+    v->map_size = size; \
+    v->data = (T*)(h + 1); \
+    v->len = (size_t)h->len; \
+    v->cap = (size_t)h->cap; \
+    return true; \
+} \
+\
+/* Extends the file and the mapping to hold at least n elements */ \
+static inline bool mmap_vec_##T##_reserve(mmap_vec_##T* v, size_t n) { \
+    if (n <= v->cap) return true; \
+    if (v->read_only) { \
+        printf("Vector is read-only\n"); \
+        return false; \
+    } \
+    if (n > (SIZE_MAX - sizeof(MmapVecHeader)) / sizeof(T)) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    size_t new_size = sizeof(MmapVecHeader) + n * sizeof(T); \
+    if (ftruncate(v->fd, (off_t)new_size) != 0) { \
+        printf("Cannot grow file: %s\n", strerror(errno)); \
+        return false; \
+    } \
+    void* base = mmap_vec_remap(v->header, v->map_size, new_size, v->fd); \
+    if (!base) { \
+        printf("Cannot remap file: %s\n", strerror(errno)); \
+        return false; \
+    } \
+    v->header = (MmapVecHeader*)base; \
+    v->map_size = new_size; \
+    v->data = (T*)(v->header + 1); \
+    v->cap = n; \
+    v->header->cap = n; \
+    return true; \
+} \
+\
+static inline void mmap_vec_##T##_push(mmap_vec_##T* v, T val) { \
+    if (v->len >= v->cap && !mmap_vec_##T##_reserve(v, v->cap ? v->cap * 2 : MMAP_VEC_INITIAL_CAP)) return; \
+    v->data[v->len++] = val; \
+    v->header->len = v->len; \
+} \
+\
+static inline T mmap_vec_##T##_get(mmap_vec_##T* v, size_t i) { \
+    if (i >= v->len) { \
+        printf("Invalid index %zu\n", i); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return v->data[i]; \
+} \
+\
+static inline void mmap_vec_##T##_set(mmap_vec_##T* v, size_t i, T item) { \
+    if (v->read_only) { \
+        printf("Vector is read-only\n"); \
+        return; \
+    } \
+    if (i >= v->len) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    v->data[i] = item; \
+} \
+\
+static inline T* mmap_vec_##T##_at_ptr(mmap_vec_##T* v, size_t i) { \
+    if (i >= v->len) { \
+        printf("Invalid index %zu\n", i); \
+        return NULL; \
+    } \
+    return &v->data[i]; \
+} \
+\
+static inline T mmap_vec_##T##_pop(mmap_vec_##T* v) { \
+    if (v->read_only || v->len == 0) { \
+        if (v->read_only) printf("Vector is read-only\n"); \
+        else printf("Invalid index 0\n"); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    T val = v->data[--v->len]; \
+    v->header->len = v->len; \
+    return val; \
+} \
+\
+static inline void mmap_vec_##T##_clear(mmap_vec_##T* v) { \
+    if (v->read_only) { \
+        printf("Vector is read-only\n"); \
+        return; \
+    } \
+    v->len = 0; \
+    v->header->len = 0; \
+} \
+\
+/* Writes dirty pages back to the file; wait blocks until they reach the disk */ \
+static inline bool mmap_vec_##T##_flush(mmap_vec_##T* v, bool wait) { \
+    if (v->read_only) return true; \
+    if (msync(v->header, v->map_size, wait ? MS_SYNC : MS_ASYNC) != 0) { \
+        printf("msync failed: %s\n", strerror(errno)); \
+        return false; \
+    } \
+    return true; \
+} \
+\
+/* Access-pattern hint for the whole array (advisory) */ \
+static inline void mmap_vec_##T##_advise(mmap_vec_##T* v, MmapVecAdvice advice) { \
+    posix_madvise(v->header, v->map_size, mmap_vec_advice_flag(advice)); \
+} \
+\
+/* Unmaps and closes; a writable file is trimmed to its length */ \
+static inline void mmap_vec_##T##_close(mmap_vec_##T* v) { \
+    if (!v->header) return; \
+    size_t used = sizeof(MmapVecHeader) + v->len * sizeof(T); \
+    if (!v->read_only) v->header->cap = v->len; \
+    munmap(v->header, v->map_size); \
+    if (!v->read_only && ftruncate(v->fd, (off_t)used) != 0) \
+        printf("Cannot trim file: %s\n", strerror(errno)); \
+    close(v->fd); \
+    memset(v, 0, sizeof(*v)); \
+    v->fd = -1; \
+}
+
+#endif // __unix__ || __APPLE__
+
+#endif // MMAP_VEC_H
@@ -0,0 +1,303 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include "common.h"
+#include "park.h"
+
+/*
+ * DEFINE_MPMC_QUEUE(T) generates mpmc_queue_T, a bounded lock-free queue
+ * for any number of producer and consumer threads (Vyukov's ring). Every
+ * cell carries a sequence number telling which lap of the ring it is ready
+ * for: a producer at position pos may fill cell pos & mask once its
+ * sequence is pos, and publishes it by storing pos + 1; a consumer may take
+ * it when the sequence is pos + 1 and hands it back for the next lap with
+ * pos + capacity. Claiming a position is one CAS on enqueue_pos or
+ * dequeue_pos, so threads only contend on the counter of their own side,
+ * and the cells themselves are never shared by two writers.
+ *
+ * The try_ calls never block. Queues initialized with MPMC_QUEUE_BLOCKING
+ * also get *_wait calls that spin for MPMC_QUEUE_SPIN rounds and then park
+ * the thread (park.h) until a publish on the other side wakes it.
+ */
+
+#define MPMC_QUEUE_CACHE_LINE 64
+// Busy-wait rounds before a blocking call sleeps
+#define MPMC_QUEUE_SPIN 64
+
+// Init flags
+#define MPMC_QUEUE_BLOCKING 1   /* *_wait calls may sleep; publishing wakes sleepers */
+
+/*
+ * Event count for the threads parked on one side, in one futex word: the
+ * low MPMC_QUEUE_WAITER_BITS count registered sleepers, the rest is an
+ * epoch. A sleeper registers, fences and rechecks the queue, then sleeps
+ * until the epoch moves. A publisher fences and, only if it sees
+ * registered sleepers, takes up to k of them off the count (k = items
+ * published), bumps the epoch and wakes k. Because waking consumes the
+ * registration, publishes that follow before the sleeper runs again cost
+ * no syscall. At most 2^MPMC_QUEUE_WAITER_BITS - 1 threads may sleep on
+ * one side at once.
+ */
+#define MPMC_QUEUE_WAITER_BITS 12
+#define MPMC_QUEUE_WAITER_MASK ((1u << MPMC_QUEUE_WAITER_BITS) - 1)
+
+typedef struct {
+    _Atomic uint32_t state;     /* epoch << MPMC_QUEUE_WAITER_BITS | sleepers */
+} MpmcQueueWaiter;
+
+static inline void mpmc_queue_notify(MpmcQueueWaiter* w, size_t n) {
+    atomic_thread_fence(memory_order_seq_cst);
+    uint32_t s = atomic_load_explicit(&w->state, memory_order_relaxed);
+    while (s & MPMC_QUEUE_WAITER_MASK) {
+        uint32_t k = s & MPMC_QUEUE_WAITER_MASK;
+        if (k > n) k = (uint32_t)n;
+        if (atomic_compare_exchange_weak_explicit(&w->state, &s, s - k + (1u << MPMC_QUEUE_WAITER_BITS), memory_order_release,
+                                                  memory_order_relaxed)) {
+            park_wake(&w->state, (int)k);
+            return;
+        }
+    }
+}
+
+// Registers the calling thread as a sleeper; returns the state to pass to sleep / cancel
+static inline uint32_t mpmc_queue_prepare_wait(MpmcQueueWaiter* w) {
+    uint32_t s = atomic_fetch_add_explicit(&w->state, 1, memory_order_relaxed) + 1;
+    atomic_thread_fence(memory_order_seq_cst);
+    return s;
+}
+
+// Sleeps until a notify moves the epoch past the one seen at registration
+static inline void mpmc_queue_commit_wait(MpmcQueueWaiter* w, uint32_t seen) {
+    uint32_t s = seen;
+    while (((s ^ seen) >> MPMC_QUEUE_WAITER_BITS) == 0) {
+        park_sleep(&w->state, s);
+        s = atomic_load_explicit(&w->state, memory_order_acquire);
+    }
+}
+
+// Withdraws the registration, unless a notify has already taken it (the epoch moved)
+static inline void mpmc_queue_cancel_wait(MpmcQueueWaiter* w, uint32_t seen) {
+    uint32_t s = atomic_load_explicit(&w->state, memory_order_relaxed);
+    while (((s ^ seen) >> MPMC_QUEUE_WAITER_BITS) == 0 &&
+           !atomic_compare_exchange_weak_explicit(&w->state, &s, s - 1, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+#define DEFINE_MPMC_QUEUE(T) \
+typedef struct { \
+    _Atomic size_t seq; \
+    T value; \
+} mpmc_queue_##T##_cell; \
+\
+typedef struct { \
+    _Alignas(MPMC_QUEUE_CACHE_LINE) _Atomic size_t enqueue_pos; \
+    _Alignas(MPMC_QUEUE_CACHE_LINE) _Atomic size_t dequeue_pos; \
+    /* Read-only after init */ \
+    _Alignas(MPMC_QUEUE_CACHE_LINE) mpmc_queue_##T##_cell* cells; \
+    size_t mask; \
+    int flags; \
+    _Alignas(MPMC_QUEUE_CACHE_LINE) MpmcQueueWaiter items;     /* consumers sleep here */ \
+    _Alignas(MPMC_QUEUE_CACHE_LINE) MpmcQueueWaiter space;     /* producers sleep here */ \
+} mpmc_queue_##T; \
+\
+/* capacity is rounded up to a power of two (at least 2); flags is 0 or MPMC_QUEUE_BLOCKING */ \
+static inline bool mpmc_queue_##T##_init(mpmc_queue_##T* q, size_t capacity, int flags) { \
+    size_t cap = 2; \
+    while (cap < capacity) { \
+        if (cap > SIZE_MAX / 2 / sizeof(mpmc_queue_##T##_cell)) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+        cap *= 2; \
+    } \
+    q->cells = (mpmc_queue_##T##_cell*)malloc(cap * sizeof(mpmc_queue_##T##_cell)); \
+    if (!q->cells) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    for (size_t i = 0; i < cap; i++) atomic_init(&q->cells[i].seq, i); \
+    q->mask = cap - 1; \
+    q->flags = flags; \
+    atomic_init(&q->enqueue_pos, 0); \
+    atomic_init(&q->dequeue_pos, 0); \
+    atomic_init(&q->items.state, 0); \
+    atomic_init(&q->space.state, 0); \
+    return true; \
+} \
+\
+static inline size_t mpmc_queue_##T##_capacity(const mpmc_queue_##T* q) { \
+    return q->mask + 1; \
+} \
+\
+/* \
+ * Claims up to n consecutive positions on one side: counts the cells from \
+ * *pos whose sequence is *pos + i + ready, then CASes the counter past them. \
+ * Returns how many were claimed (0 if the first cell is not ready). \
+ */ \
+static inline size_t mpmc_queue_##T##_claim(mpmc_queue_##T* q, _Atomic size_t* counter, size_t ready, size_t* pos, size_t n) { \
+    *pos = atomic_load_explicit(counter, memory_order_relaxed); \
+    for (;;) { \
+        size_t m = 0; \
+        intptr_t dif = 0; \
+        while (m < n && m <= q->mask) { \
+            size_t seq = atomic_load_explicit(&q->cells[(*pos + m) & q->mask].seq, memory_order_acquire); \
+            dif = (intptr_t)(seq - (*pos + m + ready)); \
+            if (dif != 0) break; \
+            m++; \
+        } \
+        if (m == 0) { \
+            if (dif < 0) return 0;      /* full (enqueue) or empty (dequeue) */ \
+            *pos = atomic_load_explicit(counter, memory_order_relaxed); \
+            continue; \
+        } \
+        if (atomic_compare_exchange_weak_explicit(counter, pos, *pos + m, memory_order_relaxed, memory_order_relaxed)) return m; \
+    } \
+} \
+\
+/* Adds item; false if the queue is full */ \
+static inline bool mpmc_queue_##T##_try_enqueue(mpmc_queue_##T* q, T item) { \
+    size_t pos; \
+    if (mpmc_queue_##T##_claim(q, &q->enqueue_pos, 0, &pos, 1) == 0) return false; \
+    mpmc_queue_##T##_cell* c = &q->cells[pos & q->mask]; \
+    c->value = item; \
+    atomic_store_explicit(&c->seq, pos + 1, memory_order_release); \
+    if (q->flags & MPMC_QUEUE_BLOCKING) mpmc_queue_notify(&q->items, 1); \
+    return true; \
+} \
+\
+/* Adds as many of items[0..n) as fit, in order, with one claim; returns how many */ \
+static inline size_t mpmc_queue_##T##_try_enqueue_n(mpmc_queue_##T* q, const T* items, size_t n) { \
+    size_t pos; \
+    if (n == 0) return 0; \
+    size_t m = mpmc_queue_##T##_claim(q, &q->enqueue_pos, 0, &pos, n); \
+    for (size_t i = 0; i < m; i++) { \
+        mpmc_queue_##T##_cell* c = &q->cells[(pos + i) & q->mask]; \
+        c->value = items[i]; \
+        atomic_store_explicit(&c->seq, pos + i + 1, memory_order_release); \
+    } \
+    if (m > 0 && (q->flags & MPMC_QUEUE_BLOCKING)) mpmc_queue_notify(&q->items, m); \
+    return m; \
+} \
+\
+/* Takes the front item into *out; false if the queue is empty */ \
+static inline bool mpmc_queue_##T##_try_dequeue(mpmc_queue_##T* q, T* out) { \
+    size_t pos; \
+    if (mpmc_queue_##T##_claim(q, &q->dequeue_pos, 1, &pos, 1) == 0) return false; \
+    mpmc_queue_##T##_cell* c = &q->cells[pos & q->mask]; \
+    *out = c->value; \
+    atomic_store_explicit(&c->seq, pos + q->mask + 1, memory_order_release); \
+    if (q->flags & MPMC_QUEUE_BLOCKING) mpmc_queue_notify(&q->space, 1); \
+    return true; \
+} \
+\
+/* Takes up to n consecutive items into out with one claim; returns how many */ \
+static inline size_t mpmc_queue_##T##_try_dequeue_n(mpmc_queue_##T* q, T* out, size_t n) { \
+    size_t pos; \
+    if (n == 0) return 0; \
+    size_t m = mpmc_queue_##T##_claim(q, &q->dequeue_pos, 1, &pos, n); \
+    for (size_t i = 0; i < m; i++) { \
+        mpmc_queue_##T##_cell* c = &q->cells[(pos + i) & q->mask]; \
+        out[i] = c->value; \
+        atomic_store_explicit(&c->seq, pos + i + q->mask + 1, memory_order_release); \
+    } \
+    if (m > 0 && (q->flags & MPMC_QUEUE_BLOCKING)) mpmc_queue_notify(&q->space, m); \
+    return m; \
+} \
+\
+/* Whether the next enqueue / dequeue position looks ready (true also when the view is stale) */ \
+static inline bool mpmc_queue_##T##_has_space(mpmc_queue_##T* q) { \
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed); \
+    size_t seq = atomic_load_explicit(&q->cells[pos & q->mask].seq, memory_order_acquire); \
+    return (intptr_t)(seq - pos) >= 0; \
+} \
+\
+static inline bool mpmc_queue_##T##_has_items(mpmc_queue_##T* q) { \
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed); \
+    size_t seq = atomic_load_explicit(&q->cells[pos & q->mask].seq, memory_order_acquire); \
+    return (intptr_t)(seq - (pos + 1)) >= 0; \
+} \
+\
+/* Waits until check(q) is true: spins, then parks on w if the queue is blocking. Returns whether it slept */ \
+static inline bool mpmc_queue_##T##_wait(mpmc_queue_##T* q, MpmcQueueWaiter* w, bool (*check)(mpmc_queue_##T*)) { \
+    for (int i = 0; i < MPMC_QUEUE_SPIN; i++) { \
+        if (check(q)) return false; \
+        park_cpu_relax(); \
+    } \
+    bool slept = false; \
+    while (!check(q)) { \
+        if (!(q->flags & MPMC_QUEUE_BLOCKING)) { \
+            park_yield(); \
+            continue; \
+        } \
+        uint32_t seen = mpmc_queue_prepare_wait(w); \
+        if (check(q)) { \
+            mpmc_queue_cancel_wait(w, seen); \
+            break; \
+        } \
+        mpmc_queue_commit_wait(w, seen); \
+        slept = true; \
+    } \
+    return slept; \
+} \
+\
+/* \
+ * A woken thread that finds more work left passes the wake-up on: a publish \
+ * may have woken it while the cell it then found was still being filled, so \
+ * one wake can end up covering several items. \
+ */ \
+static inline void mpmc_queue_##T##_pass_on(mpmc_queue_##T* q, MpmcQueueWaiter* w, bool (*check)(mpmc_queue_##T*)) { \
+    if (check(q)) mpmc_queue_notify(w, 1); \
+} \
+\
+/* Adds item, waiting for space */ \
+static inline void mpmc_queue_##T##_enqueue_wait(mpmc_queue_##T* q, T item) { \
+    bool slept = false; \
+    while (!mpmc_queue_##T##_try_enqueue(q, item)) slept |= mpmc_queue_##T##_wait(q, &q->space, mpmc_queue_##T##_has_space); \
+    if (slept) mpmc_queue_##T##_pass_on(q, &q->space, mpmc_queue_##T##_has_space); \
+} \
+\
+/* Adds all of items[0..n), waiting for space as needed */ \
+static inline void mpmc_queue_##T##_enqueue_n_wait(mpmc_queue_##T* q, const T* items, size_t n) { \
+    bool slept = false; \
+    while (n > 0) { \
+        size_t k = mpmc_queue_##T##_try_enqueue_n(q, items, n); \
+        items += k; \
+        n -= k; \
+        if (n > 0) slept |= mpmc_queue_##T##_wait(q, &q->space, mpmc_queue_##T##_has_space); \
+    } \
+    if (slept) mpmc_queue_##T##_pass_on(q, &q->space, mpmc_queue_##T##_has_space); \
+} \
+\
+/* Takes one item, waiting for it */ \
+static inline T mpmc_queue_##T##_dequeue_wait(mpmc_queue_##T* q) { \
+    T item; \
+    bool slept = false; \
+    while (!mpmc_queue_##T##_try_dequeue(q, &item)) slept |= mpmc_queue_##T##_wait(q, &q->items, mpmc_queue_##T##_has_items); \
+    if (slept) mpmc_queue_##T##_pass_on(q, &q->items, mpmc_queue_##T##_has_items); \
+    return item; \
+} \
+\
+/* Waits for at least one item, then takes up to n; returns how many */ \
+static inline size_t mpmc_queue_##T##_dequeue_n_wait(mpmc_queue_##T* q, T* out, size_t n) { \
+    if (n == 0) return 0; \
+    size_t k; \
+    bool slept = false; \
+    while ((k = mpmc_queue_##T##_try_dequeue_n(q, out, n)) == 0) slept |= mpmc_queue_##T##_wait(q, &q->items, mpmc_queue_##T##_has_items); \
+    if (slept) mpmc_queue_##T##_pass_on(q, &q->items, mpmc_queue_##T##_has_items); \
+    return k; \
+} \
+\
+/* Positions claimed by producers and not yet by consumers; exact only when no thread is running */ \
+static inline size_t mpmc_queue_##T##_size(mpmc_queue_##T* q) { \
+    size_t d = atomic_load_explicit(&q->dequeue_pos, memory_order_acquire); \
+    size_t e = atomic_load_explicit(&q->enqueue_pos, memory_order_acquire); \
+    return e - d < q->mask + 1 ? e - d : q->mask + 1;  /* d may be stale */ \
+} \
+\
+static inline void mpmc_queue_##T##_free(mpmc_queue_##T* q) { \
+    free(q->cells); \
+    q->cells = NULL; \
+    q->mask = 0; \
+}
+
+#endif // MPMC_QUEUE_H
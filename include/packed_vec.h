@@ -0,0 +1,521 @@
+#ifndef PACKED_VEC_H
+#define PACKED_VEC_H
+
+#include "common.h"
+#include "vec_numeric.h"
+
+/*
+ * Compressed integer vectors for columns that need far fewer bits than
+ * their type holds.
+ *
+ * DEFINE_PACKED_VEC(T) generates packed_vec_T: every element stored in the
+ * same number of bits (1..64), chosen at init. get/set are O(1); bulk
+ * unpack uses AVX2 for widths up to PACKED_VEC_SIMD_MAX_BITS. Signed T is
+ * stored in two's complement and sign-extended on the way out.
+ *
+ * DEFINE_DELTA_VEC(T) generates delta_vec_T, an append-only vector for
+ * sorted (or slowly changing) data. Values are cut into blocks of
+ * DELTA_VEC_BLOCK; each block keeps its first value, the smallest gap
+ * between neighbours, and every gap minus that minimum bit-packed at the
+ * block's own width. Random access decodes within one block.
+ *
+ * Both are for integer T only. The bitstream is a uint64_t array, bit i of
+ * the stream in word i / 64; the AVX2 kernel reads it byte-wise and so
+ * assumes little-endian (as all x86 is).
+ */
+
+#define PACKED_VEC_SIMD_MAX_BITS 25
+#define PACKED_VEC_PAD_WORDS 4     /* zeroed words past the end, for over-reads */
+#define PACKED_VEC_ITER_CHUNK 256
+#define DELTA_VEC_BLOCK 128
+
+static inline uint64_t packed_mask(unsigned bits) {
+    return bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+}
+
+static inline uint64_t packed_sign_extend(uint64_t x, unsigned bits) {
+    if (bits == 0 || bits >= 64) return x;
+    uint64_t m = (uint64_t)1 << (bits - 1);
+    return (x ^ m) - m;
+}
+
+// Whether x (a T converted to uint64_t) is representable in bits
+static inline bool packed_fits(uint64_t x, unsigned bits, bool is_signed) {
+    if (bits >= 64) return true;
+    if (!is_signed) return (x >> bits) == 0;
+    return packed_sign_extend(x & packed_mask(bits), bits) == x;
+}
+
+// Bits needed to store x (a T converted to uint64_t); at least 1
+static inline unsigned packed_width(uint64_t x, bool is_signed) {
+    if (is_signed && (x >> 63)) x = ~x;
+    unsigned w = 0;
+    while (w < 64 && (x >> w) != 0) w++;
+    w += is_signed;
+    if (w == 0) w = 1;
+    return w > 64 ? 64 : w;
+}
+
+static inline uint64_t packed_bits_get(const uint64_t* words, size_t i, unsigned bits) {
+    size_t pos = i * bits;
+    size_t w = pos >> 6;
+    unsigned s = (unsigned)(pos & 63);
+    uint64_t x = words[w] >> s;
+    if (s + bits > 64) x |= words[w + 1] << (64 - s);
+    return x & packed_mask(bits);
+}
+
+static inline void packed_bits_set(uint64_t* words, size_t i, unsigned bits, uint64_t x) {
+    if (bits == 0) return;
+    size_t pos = i * bits;
+    size_t w = pos >> 6;
+    unsigned s = (unsigned)(pos & 63);
+    uint64_t m = packed_mask(bits);
+    x &= m;
+    words[w] = (words[w] & ~(m << s)) | (x << s);
+    if (s + bits > 64) {
+        unsigned hi = 64 - s;
+        words[w + 1] = (words[w + 1] & ~(m >> hi)) | (x >> hi);
+    }
+}
+
+/*
+ * Unpacks n values starting at index first into out, an array of
+ * out_size-byte integers (1, 2, 4 or 8). sign selects sign extension.
+ */
+static inline void packed_unpack_scalar(const uint64_t* words, size_t first, size_t n, unsigned bits, bool sign,
+                                        void* out, size_t out_size) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t x = packed_bits_get(words, first + i, bits);
+        if (sign) x = packed_sign_extend(x, bits);
+        switch (out_size) {
+        case 1: ((uint8_t*)out)[i] = (uint8_t)x; break;
+        case 2: ((uint16_t*)out)[i] = (uint16_t)x; break;
+        case 4: ((uint32_t*)out)[i] = (uint32_t)x; break;
+        default: ((uint64_t*)out)[i] = x; break;
+        }
+    }
+}
+
+#ifdef NUMERIC_X86
+/*
+ * Eight values at a time. A group of 8 values starting at a multiple of 8
+ * spans exactly `bits` bytes from a byte boundary, so the byte offset and
+ * shift of each lane are the same for every group: load the group's two
+ * 4-value halves, shuffle 4 bytes per lane into place, shift and mask.
+ * Needs 1 <= bits <= PACKED_VEC_SIMD_MAX_BITS and out_size 4 or 8.
+ */
+__attribute__((target("avx2")))
+static inline void packed_unpack_avx2(const uint64_t* words, size_t first, size_t n, unsigned bits, bool sign,
+                                      void* out, size_t out_size) {
+    size_t head = (8 - (first & 7)) & 7;
+    if (head > n) head = n;
+    packed_unpack_scalar(words, first, head, bits, sign, out, out_size);
+    first += head;
+    n -= head;
+    char* dst = (char*)out + head * out_size;
+
+    uint8_t ctrl[32];
+    uint32_t shifts[8];
+    size_t hi_byte = (4 * bits) >> 3;
+    for (unsigned h = 0; h < 2; h++)
+        for (unsigned k = 0; k < 4; k++) {
+            unsigned bit = (h ? (4 * bits) & 7 : 0) + k * bits;
+            for (unsigned b = 0; b < 4; b++) ctrl[h * 16 + k * 4 + b] = (uint8_t)((bit >> 3) + b);
+            shifts[h * 4 + k] = bit & 7;
+        }
+    __m256i shuf = _mm256_loadu_si256((const __m256i*)ctrl);
+    __m256i shr = _mm256_loadu_si256((const __m256i*)shifts);
+    __m256i mask = _mm256_set1_epi32((int)packed_mask(bits));
+    __m128i ext = _mm_cvtsi32_si128((int)(32 - bits));
+
+    const uint8_t* base = (const uint8_t*)words + (first >> 3) * bits;
+    size_t groups = n / 8;
+    for (size_t g = 0; g < groups; g++, base += bits) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)base);
+        __m128i hi = _mm_loadu_si128((const __m128i*)(base + hi_byte));
+        __m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        x = _mm256_srlv_epi32(_mm256_shuffle_epi8(x, shuf), shr);
+        x = sign ? _mm256_sra_epi32(_mm256_sll_epi32(x, ext), ext) : _mm256_and_si256(x, mask);
+        if (out_size == 4) {
+            _mm256_storeu_si256((__m256i*)dst, x);
+            dst += 32;
+        } else {
+            _mm256_storeu_si256((__m256i*)dst, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+            _mm256_storeu_si256((__m256i*)(dst + 32), _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+            dst += 64;
+        }
+    }
+    packed_unpack_scalar(words, first + groups * 8, n - groups * 8, bits, sign, dst, out_size);
+}
+#endif
+
+static inline void packed_unpack(const uint64_t* words, size_t first, size_t n, unsigned bits, bool sign, void* out,
+                                 size_t out_size) {
+#ifdef NUMERIC_X86
+    if (bits >= 1 && bits <= PACKED_VEC_SIMD_MAX_BITS && out_size >= 4 && numeric_has_avx2()) {
+        packed_unpack_avx2(words, first, n, bits, sign, out, out_size);
+        return;
+    }
+#endif
+    packed_unpack_scalar(words, first, n, bits, sign, out, out_size);
+}
+
+// Words for n values of bits each, plus the zeroed padding
+static inline size_t packed_words_for(size_t n, unsigned bits) {
+    return (n * bits + 63) / 64 + PACKED_VEC_PAD_WORDS;
+}
+
+#define PACKED_IS_SIGNED(T) ((T)-1 < (T)1)
+
+/* ---------- fixed-width packed vector ---------- */
+
+#define DEFINE_PACKED_VEC(T) \
+typedef struct { \
+    uint64_t* words; \
+    size_t len; \
+    size_t cap;            /* elements that fit before the next realloc */ \
+    unsigned bits; \
+} packed_vec_##T; \
+\
+typedef struct { \
+    const packed_vec_##T* v; \
+    size_t next;           /* index of buf[0] + n */ \
+    size_t pos; \
+    size_t n; \
+    T buf[PACKED_VEC_ITER_CHUNK]; \
+} packed_vec_##T##_iter; \
+\
+/* bits is the width of every element, 1..8 * sizeof(T) */ \
+static inline bool packed_vec_##T##_init(packed_vec_##T* v, unsigned bits) { \
+    memset(v, 0, sizeof(*v)); \
+    if (bits == 0 || bits > 8 * sizeof(T)) { \
+        printf("Invalid bit width %u\n", bits); \
+        return false; \
+    } \
+    v->bits = bits; \
+    return true; \
+} \
+\
+/* Smallest width that holds every value in src */ \
+static inline unsigned packed_vec_##T##_bits_needed(const T* src, size_t n) { \
+    unsigned bits = 1; \
+    for (size_t i = 0; i < n; i++) { \
+        unsigned w = packed_width((uint64_t)src[i], PACKED_IS_SIGNED(T)); \
+        if (w > bits) bits = w; \
+    } \
+    return bits; \
+} \
+\
+static inline bool packed_vec_##T##_reserve(packed_vec_##T* v, size_t n) { \
+    if (n <= v->cap) return true; \
+    if (n > SIZE_MAX / 64) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    size_t old_words = v->words ? packed_words_for(v->cap, v->bits) : 0; \
+    size_t new_words = packed_words_for(n, v->bits); \
+    uint64_t* w = realloc(v->words, new_words * sizeof(uint64_t)); \
+    if (!w) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    memset(w + old_words, 0, (new_words - old_words) * sizeof(uint64_t)); \
+    v->words = w; \
+    v->cap = n; \
+    return true; \
+} \
+\
+static inline void packed_vec_##T##_push(packed_vec_##T* v, T val) { \
+    if (!packed_fits((uint64_t)val, v->bits, PACKED_IS_SIGNED(T))) { \
+        printf("Value does not fit in %u bits\n", v->bits); \
+        return; \
+    } \
+    if (v->len >= v->cap && !packed_vec_##T##_reserve(v, v->cap ? v->cap * 2 : 64)) return; \
+    packed_bits_set(v->words, v->len++, v->bits, (uint64_t)val); \
+} \
+\
+/* Packs src at the smallest width that fits it (v must not be initialized) */ \
+static inline bool packed_vec_##T##_from_array(packed_vec_##T* v, const T* src, size_t n) { \
+    if (!packed_vec_##T##_init(v, packed_vec_##T##_bits_needed(src, n))) return false; \
+    if (!packed_vec_##T##_reserve(v, n)) return false; \
+    for (size_t i = 0; i < n; i++) packed_bits_set(v->words, i, v->bits, (uint64_t)src[i]); \
+    v->len = n; \
+    return true; \
+} \
+\
+static inline T packed_vec_##T##_get(const packed_vec_##T* v, size_t i) { \
+    if (i >= v->len) { \
+        printf("Invalid index %zu\n", i); \
+        return 0; \
+    } \
+    uint64_t x = packed_bits_get(v->words, i, v->bits); \
+    if (PACKED_IS_SIGNED(T)) x = packed_sign_extend(x, v->bits); \
+    return (T)x; \
+} \
+\
+static inline void packed_vec_##T##_set(packed_vec_##T* v, size_t i, T val) { \
+    if (i >= v->len) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    if (!packed_fits((uint64_t)val, v->bits, PACKED_IS_SIGNED(T))) { \
+        printf("Value does not fit in %u bits\n", v->bits); \
+        return; \
+    } \
+    packed_bits_set(v->words, i, v->bits, (uint64_t)val); \
+} \
+\
+/* Decodes up to n elements starting at first into out; returns how many */ \
+static inline size_t packed_vec_##T##_unpack(const packed_vec_##T* v, size_t first, size_t n, T* out) { \
+    if (first >= v->len) return 0; \
+    if (n > v->len - first) n = v->len - first; \
+    packed_unpack(v->words, first, n, v->bits, PACKED_IS_SIGNED(T), out, sizeof(T)); \
+    return n; \
+} \
+\
+static inline void packed_vec_##T##_to_array(const packed_vec_##T* v, T* out) { \
+    packed_vec_##T##_unpack(v, 0, v->len, out); \
+} \
+\
+/* Heap bytes in use (the packed words) */ \
+static inline size_t packed_vec_##T##_bytes(const packed_vec_##T* v) { \
+    return v->words ? packed_words_for(v->cap, v->bits) * sizeof(uint64_t) : 0; \
+} \
+\
+static inline void packed_vec_##T##_clear(packed_vec_##T* v) { \
+    v->len = 0; \
+} \
+\
+static inline void packed_vec_##T##_free(packed_vec_##T* v) { \
+    free(v->words); \
+    v->words = NULL; \
+    v->len = 0; \
+    v->cap = 0; \
+} \
+\
+/* Streaming decode from index first, PACKED_VEC_ITER_CHUNK elements at a time */ \
+static inline void packed_vec_##T##_iter_init(packed_vec_##T##_iter* it, const packed_vec_##T* v, size_t first) { \
+    it->v = v; \
+    it->next = first; \
+    it->pos = 0; \
+    it->n = 0; \
+} \
+\
+static inline bool packed_vec_##T##_iter_next(packed_vec_##T##_iter* it, T* out) { \
+    if (it->pos == it->n) { \
+        it->n = packed_vec_##T##_unpack(it->v, it->next, PACKED_VEC_ITER_CHUNK, it->buf); \
+        it->next += it->n; \
+        it->pos = 0; \
+        if (it->n == 0) return false; \
+    } \
+    *out = it->buf[it->pos++]; \
+    return true; \
+}
+
+/* ---------- delta-encoded block vector ---------- */
+
+typedef struct {
+    uint64_t first;        /* first value of the block */
+    uint64_t min_gap;      /* smallest gap, as a wrapping difference */
+    size_t offset;         /* word offset of the packed gaps */
+    unsigned bits;         /* width of each gap - min_gap */
+} DeltaVecBlock;
+
+// Decodes the first n (<= DELTA_VEC_BLOCK) values of a block as uint64_t
+static inline void delta_vec_decode_block(const DeltaVecBlock* b, const uint64_t* words, size_t n, uint64_t* out) {
+    if (n == 0) return;
+    uint64_t acc = b->first;
+    out[0] = acc;
+    if (n == 1) return;
+    if (b->bits == 0) {
+        for (size_t k = 1; k < n; k++) out[k] = acc += b->min_gap;
+        return;
+    }
+    packed_unpack(words + b->offset, 0, n - 1, b->bits, false, out + 1, sizeof(uint64_t));
+    for (size_t k = 1; k < n; k++) out[k] = acc += b->min_gap + out[k];
+}
+
+#define DEFINE_DELTA_VEC(T) \
+typedef struct { \
+    DeltaVecBlock* blocks; \
+    size_t nblocks; \
+    size_t block_cap; \
+    uint64_t* words; \
+    size_t nwords;         /* words used by sealed blocks */ \
+    size_t word_cap; \
+    T tail[DELTA_VEC_BLOCK];   /* values not yet sealed into a block */ \
+    size_t tail_len; \
+    size_t len; \
+} delta_vec_##T; \
+\
+typedef struct { \
+    const delta_vec_##T* v; \
+    size_t block;          /* next block to decode */ \
+    size_t pos; \
+    size_t n; \
+    uint64_t buf[DELTA_VEC_BLOCK]; \
+} delta_vec_##T##_iter; \
+\
+static inline void delta_vec_##T##_init(delta_vec_##T* v) { \
+    memset(v, 0, sizeof(*v)); \
+} \
+\
+/* Packs the full tail into a new block */ \
+static inline bool delta_vec_##T##_seal(delta_vec_##T* v) { \
+    uint64_t gaps[DELTA_VEC_BLOCK]; \
+    size_t n = v->tail_len; \
+    uint64_t min_gap = 0, spread = 0; \
+    for (size_t k = 1; k < n; k++) { \
+        gaps[k - 1] = (uint64_t)v->tail[k] - (uint64_t)v->tail[k - 1]; \
+        if (k == 1 || (int64_t)gaps[k - 1] < (int64_t)min_gap) min_gap = gaps[k - 1]; \
+    } \
+    for (size_t k = 0; k + 1 < n; k++) { \
+        gaps[k] -= min_gap; \
+        spread |= gaps[k]; \
+    } \
+    unsigned bits = spread ? packed_width(spread, false) : 0; \
+    size_t need = packed_words_for(n - 1, bits); \
+    if (v->nblocks == v->block_cap) { \
+        size_t cap = v->block_cap ? v->block_cap * 2 : 16; \
+        DeltaVecBlock* b = realloc(v->blocks, cap * sizeof(DeltaVecBlock)); \
+        if (!b) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+        v->blocks = b; \
+        v->block_cap = cap; \
+    } \
+    if (v->nwords + need > v->word_cap) { \
+        size_t cap = v->word_cap ? v->word_cap * 2 : 256; \
+        while (cap < v->nwords + need) cap *= 2; \
+        uint64_t* w = realloc(v->words, cap * sizeof(uint64_t)); \
+        if (!w) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+        v->words = w; \
+        v->word_cap = cap; \
+    } \
+    memset(v->words + v->nwords, 0, need * sizeof(uint64_t)); \
+    for (size_t k = 0; bits && k + 1 < n; k++) packed_bits_set(v->words + v->nwords, k, bits, gaps[k]); \
+    DeltaVecBlock* b = &v->blocks[v->nblocks++]; \
+    b->first = (uint64_t)v->tail[0]; \
+    b->min_gap = min_gap; \
+    b->offset = v->nwords; \
+    b->bits = bits; \
+    /* the padding words are shared with the next block's data */ \
+    v->nwords += need - PACKED_VEC_PAD_WORDS; \
+    v->tail_len = 0; \
+    return true; \
+} \
+\
+static inline void delta_vec_##T##_push(delta_vec_##T* v, T val) { \
+    v->tail[v->tail_len++] = val; \
+    v->len++; \
+    if (v->tail_len == DELTA_VEC_BLOCK && !delta_vec_##T##_seal(v)) { \
+        v->tail_len--; \
+        v->len--; \
+    } \
+} \
+\
+static inline bool delta_vec_##T##_push_array(delta_vec_##T* v, const T* src, size_t n) { \
+    size_t before = v->len; \
+    for (size_t i = 0; i < n; i++) { \
+        delta_vec_##T##_push(v, src[i]); \
+        if (v->len != before + i + 1) return false; \
+    } \
+    return true; \
+} \
+\
+/* Decodes within one block: O(DELTA_VEC_BLOCK) */ \
+static inline T delta_vec_##T##_get(const delta_vec_##T* v, size_t i) { \
+    if (i >= v->len) { \
+        printf("Invalid index %zu\n", i); \
+        return 0; \
+    } \
+    size_t b = i / DELTA_VEC_BLOCK, r = i % DELTA_VEC_BLOCK; \
+    if (b == v->nblocks) return v->tail[r]; \
+    const DeltaVecBlock* blk = &v->blocks[b]; \
+    uint64_t acc = blk->first + r * blk->min_gap; \
+    if (blk->bits) { \
+        uint64_t gaps[DELTA_VEC_BLOCK]; \
+        packed_unpack(v->words + blk->offset, 0, r, blk->bits, false, gaps, sizeof(uint64_t)); \
+        for (size_t k = 0; k < r; k++) acc += gaps[k]; \
+    } \
+    return (T)acc; \
+} \
+\
+/* Decodes block b into out (DELTA_VEC_BLOCK slots); returns its length */ \
+static inline size_t delta_vec_##T##_decode_block(const delta_vec_##T* v, size_t b, T* out) { \
+    if (b < v->nblocks) { \
+        uint64_t buf[DELTA_VEC_BLOCK]; \
+        delta_vec_decode_block(&v->blocks[b], v->words, DELTA_VEC_BLOCK, buf); \
+        for (size_t k = 0; k < DELTA_VEC_BLOCK; k++) out[k] = (T)buf[k]; \
+        return DELTA_VEC_BLOCK; \
+    } \
+    if (b == v->nblocks) { \
+        memcpy(out, v->tail, v->tail_len * sizeof(T)); \
+        return v->tail_len; \
+    } \
+    return 0; \
+} \
+\
+static inline void delta_vec_##T##_to_array(const delta_vec_##T* v, T* out) { \
+    for (size_t b = 0; b <= v->nblocks; b++) out += delta_vec_##T##_decode_block(v, b, out); \
+} \
+\
+/* Heap bytes in use, plus the inline tail */ \
+static inline size_t delta_vec_##T##_bytes(const delta_vec_##T* v) { \
+    return v->nblocks * sizeof(DeltaVecBlock) + (v->nwords + PACKED_VEC_PAD_WORDS) * sizeof(uint64_t) + \
+           v->tail_len * sizeof(T); \
+} \
+\
+static inline void delta_vec_##T##_free(delta_vec_##T* v) { \
+    free(v->blocks); \
+    free(v->words); \
+    delta_vec_##T##_init(v); \
+} \
+\
+/* Streaming decode from index first, one block at a time */ \
+static inline void delta_vec_##T##_iter_init(delta_vec_##T##_iter* it, const delta_vec_##T* v, size_t first) { \
+    it->v = v; \
+    it->block = first / DELTA_VEC_BLOCK; \
+    it->pos = first % DELTA_VEC_BLOCK; \
+    it->n = 0; \
+    if (first >= v->len) { \
+        it->block = v->nblocks + 1; \
+        it->pos = 0; \
+    } else { \
+        size_t b = it->block++; \
+        if (b < v->nblocks) { \
+            delta_vec_decode_block(&v->blocks[b], v->words, DELTA_VEC_BLOCK, it->buf); \
+            it->n = DELTA_VEC_BLOCK; \
+        } else { \
+            for (size_t k = 0; k < v->tail_len; k++) it->buf[k] = (uint64_t)v->tail[k]; \
+            it->n = v->tail_len; \
+        } \
+    } \
+} \
+\
+static inline bool delta_vec_##T##_iter_next(delta_vec_##T##_iter* it, T* out) { \
+    if (it->pos == it->n) { \
+        const delta_vec_##T* v = it->v; \
+        size_t b = it->block; \
+        if (b < v->nblocks) { \
+            delta_vec_decode_block(&v->blocks[b], v->words, DELTA_VEC_BLOCK, it->buf); \
+            it->n = DELTA_VEC_BLOCK; \
+        } else if (b == v->nblocks && v->tail_len) { \
+            for (size_t k = 0; k < v->tail_len; k++) it->buf[k] = (uint64_t)v->tail[k]; \
+            it->n = v->tail_len; \
+        } else { \
+            return false; \
+        } \
+        it->block++; \
+        it->pos = 0; \
+    } \
+    *out = (T)it->buf[it->pos++]; \
+    return true; \
+}
+
+#endif // PACKED_VEC_H
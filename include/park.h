@@ -0,0 +1,61 @@
+#ifndef PARK_H
+#define PARK_H
+
+#include "common.h"
+#include <stdatomic.h>
+
+/*
+ * Spin, yield and sleep primitives for the blocking queues. park_sleep
+ * blocks while a 32-bit word still holds an expected value; park_wake wakes
+ * threads sleeping on the word, after the caller has changed it. On Linux
+ * both are a futex; elsewhere park_sleep only yields, so callers must
+ * always recheck their condition.
+ */
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+long syscall(long number, ...);
+#define PARK_FUTEX 1
+#endif
+#if !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+#endif
+
+static inline void park_cpu_relax(void) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+}
+
+// Gives up the rest of the time slice, where C11 threads allow it
+static inline void park_yield(void) {
+#if !defined(__STDC_NO_THREADS__)
+    thrd_yield();
+#else
+    park_cpu_relax();
+#endif
+}
+
+// Sleeps while *word == expected (may return early)
+static inline void park_sleep(_Atomic uint32_t* word, uint32_t expected) {
+#ifdef PARK_FUTEX
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+    (void)word;
+    (void)expected;
+    park_yield();
+#endif
+}
+
+// Wakes up to count threads sleeping on word
+static inline void park_wake(_Atomic uint32_t* word, int count) {
+#ifdef PARK_FUTEX
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#else
+    (void)word;
+    (void)count;
+#endif
+}
+
+#endif // PARK_H
@@ -0,0 +1,376 @@
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+#include "common.h"
+
+/*
+ * Priority queues as implicit d-ary heaps in one flat array. CMP(a, b) is
+ * a three-way comparison (< 0, 0, > 0) and the top is the element that
+ * compares smallest, so popping everything yields CMP order: PQUEUE_MIN
+ * gives a min-heap, PQUEUE_MAX a max-heap, or pass your own like
+ * DEFINE_VEC_SORT_CUSTOM. Node i has children d*i + 1 .. d*i + d; sifts
+ * move a hole instead of swapping.
+ *
+ * DEFINE_PQUEUE(T, CMP) generates pqueue_T, a binary heap kept in a vec_T
+ * (needs DEFINE_VEC(T) first). DEFINE_PQUEUE_NAMED(T, TYPE_NAME, CMP, D)
+ * picks the name and the arity: a 4-ary heap is half as deep, and the
+ * four children it compares at each level of a pop are usually one cache
+ * line, which pays off once the heap outgrows the cache.
+ *
+ * DEFINE_IPQUEUE(T, CMP) generates ipqueue_T, an indexed heap: push returns
+ * a handle that stays valid until its element leaves the queue, and the
+ * element can be re-prioritized (decrease-key) or removed through it in
+ * O(log n), as Dijkstra or A* need. DEFINE_IPQUEUE_NAMED(T, TYPE_NAME, CMP,
+ * D) as above.
+ */
+
+#define PQUEUE_MIN(a, b) (((a) < (b)) ? -1 : ((a) > (b)) ? 1 : 0)
+#define PQUEUE_MAX(a, b) (((a) > (b)) ? -1 : ((a) < (b)) ? 1 : 0)
+
+// Marks a handle whose element is not in the queue
+#define IPQUEUE_NONE SIZE_MAX
+
+#define DEFINE_PQUEUE(T, CMP) DEFINE_PQUEUE_NAMED(T, pqueue_##T, CMP, 2)
+
+#define DEFINE_PQUEUE_NAMED(T, TYPE_NAME, CMP, D) \
+typedef struct { \
+    vec_##T v;          /* heap order: v.data[0] is the top */ \
+} TYPE_NAME; \
+\
+static inline void TYPE_NAME##_init(TYPE_NAME* pq) { \
+    vec_##T##_init(&pq->v); \
+} \
+\
+/* Moves item up from the hole at i */ \
+static inline void TYPE_NAME##_sift_up(TYPE_NAME* pq, size_t i, T item) { \
+    T* a = pq->v.data; \
+    while (i > 0) { \
+        size_t parent = (i - 1) / (D); \
+        if (CMP(item, a[parent]) >= 0) break; \
+        a[i] = a[parent]; \
+        i = parent; \
+    } \
+    a[i] = item; \
+} \
+\
+/* Moves item down from the hole at i, among the first n elements */ \
+static inline void TYPE_NAME##_sift_down(TYPE_NAME* pq, size_t i, T item, size_t n) { \
+    T* a = pq->v.data; \
+    for (;;) { \
+        size_t first = (D) * i + 1; \
+        if (first >= n) break; \
+        size_t last = n - first < (D) ? n : first + (D); \
+        size_t best = first; \
+        for (size_t c = first + 1; c < last; c++) \
+            if (CMP(a[c], a[best]) < 0) best = c; \
+        if (CMP(a[best], item) >= 0) break; \
+        a[i] = a[best]; \
+        i = best; \
+    } \
+    a[i] = item; \
+} \
+\
+/* Restores heap order over all elements in O(n), bottom-up */ \
+static inline void TYPE_NAME##_heapify(TYPE_NAME* pq) { \
+    size_t n = pq->v.len; \
+    if (n < 2) return; \
+    for (size_t i = (n - 2) / (D) + 1; i-- > 0;) TYPE_NAME##_sift_down(pq, i, pq->v.data[i], n); \
+} \
+\
+/* Takes over v's buffer (v is left empty) and heapifies it in O(n) */ \
+static inline void TYPE_NAME##_from_vec(TYPE_NAME* pq, vec_##T* v) { \
+    pq->v = *v; \
+    vec_##T##_init(v); \
+    TYPE_NAME##_heapify(pq); \
+} \
+\
+/* Copies a[0..n) in and heapifies in O(n) */ \
+static inline bool TYPE_NAME##_from_array(TYPE_NAME* pq, const T* a, size_t n) { \
+    vec_##T##_init(&pq->v); \
+    if (!vec_##T##_extend(&pq->v, a, n)) return false; \
+    TYPE_NAME##_heapify(pq); \
+    return true; \
+} \
+\
+static inline bool TYPE_NAME##_reserve(TYPE_NAME* pq, size_t n) { \
+    return vec_##T##_reserve(&pq->v, n); \
+} \
+\
+static inline size_t TYPE_NAME##_size(const TYPE_NAME* pq) { \
+    return pq->v.len; \
+} \
+\
+static inline bool TYPE_NAME##_empty(const TYPE_NAME* pq) { \
+    return pq->v.len == 0; \
+} \
+\
+static inline void TYPE_NAME##_push(TYPE_NAME* pq, T item) { \
+    if (pq->v.len >= pq->v.cap && !vec_##T##_grow(&pq->v, pq->v.len + 1)) return; \
+    TYPE_NAME##_sift_up(pq, pq->v.len++, item); \
+} \
+\
+/* Pushes a[0..n): sifts each one up, or re-heapifies once when n is large next to the heap */ \
+static inline bool TYPE_NAME##_push_array(TYPE_NAME* pq, const T* a, size_t n) { \
+    size_t old = pq->v.len; \
+    if (!vec_##T##_extend(&pq->v, a, n)) return false; \
+    if (n > old / 4) { \
+        TYPE_NAME##_heapify(pq); \
+    } else { \
+        for (size_t i = old; i < old + n; i++) TYPE_NAME##_sift_up(pq, i, pq->v.data[i]); \
+    } \
+    return true; \
+} \
+\
+static inline T TYPE_NAME##_top(const TYPE_NAME* pq) { \
+    if (pq->v.len == 0) { \
+        fprintf(stderr, "Priority queue is empty\n"); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return pq->v.data[0]; \
+} \
+\
+/* Pointer to the top element, NULL when empty; do not change its priority through it */ \
+static inline const T* TYPE_NAME##_top_ptr(const TYPE_NAME* pq) { \
+    return pq->v.len ? &pq->v.data[0] : NULL; \
+} \
+\
+/* Removes the top into *out (if not NULL); false when empty */ \
+static inline bool TYPE_NAME##_pop_into(TYPE_NAME* pq, T* out) { \
+    if (pq->v.len == 0) { \
+        fprintf(stderr, "Priority queue underflow\n"); \
+        return false; \
+    } \
+    if (out) *out = pq->v.data[0]; \
+    size_t n = --pq->v.len; \
+    if (n > 0) TYPE_NAME##_sift_down(pq, 0, pq->v.data[n], n); \
+    return true; \
+} \
+\
+static inline T TYPE_NAME##_pop(TYPE_NAME* pq) { \
+    T item = {0}; \
+    TYPE_NAME##_pop_into(pq, &item); \
+    return item; \
+} \
+\
+/* Pops the top and pushes item with one sift; returns the old top (item itself if empty) */ \
+static inline T TYPE_NAME##_replace_top(TYPE_NAME* pq, T item) { \
+    if (pq->v.len == 0) return item; \
+    T top = pq->v.data[0]; \
+    TYPE_NAME##_sift_down(pq, 0, item, pq->v.len); \
+    return top; \
+} \
+\
+static inline void TYPE_NAME##_clear(TYPE_NAME* pq) { \
+    pq->v.len = 0; \
+} \
+\
+static inline void TYPE_NAME##_free(TYPE_NAME* pq) { \
+    vec_##T##_free(&pq->v); \
+}
+
+#define DEFINE_IPQUEUE(T, CMP) DEFINE_IPQUEUE_NAMED(T, ipqueue_##T, CMP, 2)
+
+#define DEFINE_IPQUEUE_NAMED(T, TYPE_NAME, CMP, D) \
+typedef struct { \
+    T item; \
+    size_t handle; \
+} TYPE_NAME##_entry; \
+\
+typedef struct { \
+    TYPE_NAME##_entry* heap;    /* heap order, entries carry their handle */ \
+    size_t* pos;                /* handle -> heap index, or IPQUEUE_NONE */ \
+    size_t* free_handles;       /* stack of handles to reuse */ \
+    size_t len; \
+    size_t cap; \
+    size_t nhandles;            /* handles ever issued (all < nhandles) */ \
+    size_t nfree; \
+} TYPE_NAME; \
+\
+static inline void TYPE_NAME##_init(TYPE_NAME* pq) { \
+    pq->heap = NULL; \
+    pq->pos = pq->free_handles = NULL; \
+    pq->len = pq->cap = pq->nhandles = pq->nfree = 0; \
+} \
+\
+/* Makes room for n elements (and handles) in total */ \
+static inline bool TYPE_NAME##_reserve(TYPE_NAME* pq, size_t n) { \
+    if (n <= pq->cap) return true; \
+    size_t cap = pq->cap ? pq->cap : 16; \
+    while (cap < n) cap = cap > SIZE_MAX / 2 ? n : cap * 2; \
+    if (cap > SIZE_MAX / sizeof(TYPE_NAME##_entry)) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    TYPE_NAME##_entry* heap = (TYPE_NAME##_entry*)realloc(pq->heap, cap * sizeof(TYPE_NAME##_entry)); \
+    if (!heap) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    pq->heap = heap; \
+    size_t* pos = (size_t*)realloc(pq->pos, cap * sizeof(size_t)); \
+    if (!pos) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    pq->pos = pos; \
+    size_t* free_handles = (size_t*)realloc(pq->free_handles, cap * sizeof(size_t)); \
+    if (!free_handles) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    pq->free_handles = free_handles; \
+    pq->cap = cap; \
+    return true; \
+} \
+\
+static inline size_t TYPE_NAME##_size(const TYPE_NAME* pq) { \
+    return pq->len; \
+} \
+\
+static inline bool TYPE_NAME##_empty(const TYPE_NAME* pq) { \
+    return pq->len == 0; \
+} \
+\
+/* Whether handle h currently names an element in the queue */ \
+static inline bool TYPE_NAME##_contains(const TYPE_NAME* pq, size_t h) { \
+    return h < pq->nhandles && pq->pos[h] != IPQUEUE_NONE; \
+} \
+\
+static inline void TYPE_NAME##_place(TYPE_NAME* pq, size_t i, TYPE_NAME##_entry e) { \
+    pq->heap[i] = e; \
+    pq->pos[e.handle] = i; \
+} \
+\
+static inline void TYPE_NAME##_sift_up(TYPE_NAME* pq, size_t i, TYPE_NAME##_entry e) { \
+    while (i > 0) { \
+        size_t parent = (i - 1) / (D); \
+        if (CMP(e.item, pq->heap[parent].item) >= 0) break; \
+        TYPE_NAME##_place(pq, i, pq->heap[parent]); \
+        i = parent; \
+    } \
+    TYPE_NAME##_place(pq, i, e); \
+} \
+\
+static inline void TYPE_NAME##_sift_down(TYPE_NAME* pq, size_t i, TYPE_NAME##_entry e) { \
+    size_t n = pq->len; \
+    for (;;) { \
+        size_t first = (D) * i + 1; \
+        if (first >= n) break; \
+        size_t last = n - first < (D) ? n : first + (D); \
+        size_t best = first; \
+        for (size_t c = first + 1; c < last; c++) \
+            if (CMP(pq->heap[c].item, pq->heap[best].item) < 0) best = c; \
+        if (CMP(pq->heap[best].item, e.item) >= 0) break; \
+        TYPE_NAME##_place(pq, i, pq->heap[best]); \
+        i = best; \
+    } \
+    TYPE_NAME##_place(pq, i, e); \
+} \
+\
+/* Adds item; returns its handle, or IPQUEUE_NONE if allocation failed */ \
+static inline size_t TYPE_NAME##_push(TYPE_NAME* pq, T item) { \
+    if (pq->len >= pq->cap && !TYPE_NAME##_reserve(pq, pq->len + 1)) return IPQUEUE_NONE; \
+    size_t h = pq->nfree ? pq->free_handles[--pq->nfree] : pq->nhandles++; \
+    TYPE_NAME##_sift_up(pq, pq->len++, (TYPE_NAME##_entry){ item, h }); \
+    return h; \
+} \
+\
+static inline T TYPE_NAME##_top(const TYPE_NAME* pq) { \
+    if (pq->len == 0) { \
+        fprintf(stderr, "Priority queue is empty\n"); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return pq->heap[0].item; \
+} \
+\
+/* Handle of the top element, IPQUEUE_NONE when empty */ \
+static inline size_t TYPE_NAME##_top_handle(const TYPE_NAME* pq) { \
+    return pq->len ? pq->heap[0].handle : IPQUEUE_NONE; \
+} \
+\
+/* The element behind handle h */ \
+static inline T TYPE_NAME##_get(const TYPE_NAME* pq, size_t h) { \
+    if (!TYPE_NAME##_contains(pq, h)) { \
+        printf("Invalid handle %zu\n", h); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return pq->heap[pq->pos[h]].item; \
+} \
+\
+/* Takes the entry at heap index i out, refilling the hole from the back; frees its handle */ \
+static inline TYPE_NAME##_entry TYPE_NAME##_take(TYPE_NAME* pq, size_t i) { \
+    TYPE_NAME##_entry e = pq->heap[i]; \
+    pq->pos[e.handle] = IPQUEUE_NONE; \
+    pq->free_handles[pq->nfree++] = e.handle; \
+    TYPE_NAME##_entry last = pq->heap[--pq->len]; \
+    if (i < pq->len) { \
+        if (i > 0 && CMP(last.item, pq->heap[(i - 1) / (D)].item) < 0) TYPE_NAME##_sift_up(pq, i, last); \
+        else TYPE_NAME##_sift_down(pq, i, last); \
+    } \
+    return e; \
+} \
+\
+/* Removes the top into *out (if not NULL) and returns its (now free) handle; IPQUEUE_NONE when empty */ \
+static inline size_t TYPE_NAME##_pop(TYPE_NAME* pq, T* out) { \
+    if (pq->len == 0) { \
+        fprintf(stderr, "Priority queue underflow\n"); \
+        return IPQUEUE_NONE; \
+    } \
+    TYPE_NAME##_entry e = TYPE_NAME##_take(pq, 0); \
+    if (out) *out = e.item; \
+    return e.handle; \
+} \
+\
+/* Removes the element behind handle h into *out (if not NULL) */ \
+static inline bool TYPE_NAME##_remove(TYPE_NAME* pq, size_t h, T* out) { \
+    if (!TYPE_NAME##_contains(pq, h)) { \
+        printf("Invalid handle %zu\n", h); \
+        return false; \
+    } \
+    TYPE_NAME##_entry e = TYPE_NAME##_take(pq, pq->pos[h]); \
+    if (out) *out = e.item; \
+    return true; \
+} \
+\
+/* Replaces the element behind h with item, moving it up or down as needed */ \
+static inline bool TYPE_NAME##_update(TYPE_NAME* pq, size_t h, T item) { \
+    if (!TYPE_NAME##_contains(pq, h)) { \
+        printf("Invalid handle %zu\n", h); \
+        return false; \
+    } \
+    size_t i = pq->pos[h]; \
+    TYPE_NAME##_entry e = { item, h }; \
+    if (CMP(item, pq->heap[i].item) < 0) TYPE_NAME##_sift_up(pq, i, e); \
+    else TYPE_NAME##_sift_down(pq, i, e); \
+    return true; \
+} \
+\
+/* update for an item that compares no greater than the current one (sift up only) */ \
+static inline bool TYPE_NAME##_decrease_key(TYPE_NAME* pq, size_t h, T item) { \
+    if (!TYPE_NAME##_contains(pq, h)) { \
+        printf("Invalid handle %zu\n", h); \
+        return false; \
+    } \
+    if (CMP(item, pq->heap[pq->pos[h]].item) > 0) { \
+        printf("decrease_key: new item compares greater\n"); \
+        return false; \
+    } \
+    TYPE_NAME##_sift_up(pq, pq->pos[h], (TYPE_NAME##_entry){ item, h }); \
+    return true; \
+} \
+\
+static inline void TYPE_NAME##_clear(TYPE_NAME* pq) { \
+    pq->len = pq->nhandles = pq->nfree = 0; \
+} \
+\
+static inline void TYPE_NAME##_free(TYPE_NAME* pq) { \
+    free(pq->heap); \
+    free(pq->pos); \
+    free(pq->free_handles); \
+    TYPE_NAME##_init(pq); \
+}
+
+#endif // PQUEUE_H
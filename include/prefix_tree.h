@@ -0,0 +1,387 @@
+#ifndef PREFIX_TREE_H
+#define PREFIX_TREE_H
+
+#include "common.h"
+#include "vector.h"
+
+/*
+ * Prefix-sum and range-query indexes over an array that keeps changing.
+ * Both build in O(n) from a vec_T and answer in O(log n); both are implicit
+ * trees in one flat array (no node pointers).
+ *
+ * DEFINE_FENWICK(T) generates fenwick_T, a Fenwick (binary indexed) tree
+ * for sums: point add, prefix and range sums, and lower_bound on the prefix
+ * sum. T needs +, - and <. One array of n + 1 elements.
+ *
+ * DEFINE_SEGTREE(T, OP) generates segtree_T, a segment tree for any
+ * associative OP(a, b) (SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX or your own;
+ * OP need not be commutative or have an identity). Nodes are stored in
+ * breadth-first (Eytzinger) order: node i has children 2i and 2i + 1, so
+ * the top levels every query passes through share a few cache lines.
+ * DEFINE_SEGTREE_NAMED(T, TYPE_NAME, OP) picks the type name, for several
+ * trees over one element type.
+ *
+ * Both need DEFINE_VEC(T) first.
+ */
+
+#define SEGTREE_SUM(a, b) ((a) + (b))
+#define SEGTREE_MIN(a, b) ((b) < (a) ? (b) : (a))
+#define SEGTREE_MAX(a, b) ((a) < (b) ? (b) : (a))
+
+// Lowest set bit of i (i > 0): the length of the range Fenwick node i covers
+#define FENWICK_LOWBIT(i) ((i) & (~(i) + 1))
+
+static inline size_t prefix_tree_log2(size_t n) {
+    size_t log = 0;
+    while (((size_t)1 << log) < n) log++;
+    return log;
+}
+
+#define DEFINE_FENWICK(T) \
+typedef struct { \
+    T* tree;            /* tree[i] = sum of elements (i - lowbit(i), i], 1-based; tree[0] unused */ \
+    size_t n; \
+    size_t cap; \
+} fenwick_##T; \
+\
+static inline bool fenwick_##T##_reserve(fenwick_##T* f, size_t n) { \
+    if (n < f->cap) return true; \
+    size_t cap = f->cap ? f->cap * 2 : 16; \
+    if (cap < n + 1) cap = n + 1; \
+    if (cap > SIZE_MAX / sizeof(T)) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    T* tree = (T*)realloc(f->tree, cap * sizeof(T)); \
+    if (!tree) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    f->tree = tree; \
+    f->cap = cap; \
+    return true; \
+} \
+\
+/* Initializes f with n zero elements */ \
+static inline bool fenwick_##T##_init(fenwick_##T* f, size_t n) { \
+    f->tree = NULL; \
+    f->n = f->cap = 0; \
+    if (!fenwick_##T##_reserve(f, n)) return false; \
+    memset(f->tree, 0, (n + 1) * sizeof(T)); \
+    f->n = n; \
+    return true; \
+} \
+\
+/* Initializes f over a[0..n) in O(n): each node passes its sum up to its parent once */ \
+static inline bool fenwick_##T##_from_array(fenwick_##T* f, const T* a, size_t n) { \
+    f->tree = NULL; \
+    f->n = f->cap = 0; \
+    if (!fenwick_##T##_reserve(f, n)) return false; \
+    memset(f->tree, 0, sizeof(T)); \
+    memcpy(f->tree + 1, a, n * sizeof(T)); \
+    for (size_t i = 1; i <= n; i++) { \
+        size_t parent = i + FENWICK_LOWBIT(i); \
+        if (parent <= n) f->tree[parent] = f->tree[parent] + f->tree[i]; \
+    } \
+    f->n = n; \
+    return true; \
+} \
+\
+static inline bool fenwick_##T##_from_vec(fenwick_##T* f, const vec_##T* v) { \
+    return fenwick_##T##_from_array(f, v->data, v->len); \
+} \
+\
+/* Sum of elements [0, i) */ \
+static inline T fenwick_##T##_prefix(const fenwick_##T* f, size_t i) { \
+    T sum = {0}; \
+    if (i > f->n) { \
+        printf("Index out of bounds\n"); \
+        return sum; \
+    } \
+    for (; i > 0; i -= FENWICK_LOWBIT(i)) sum = sum + f->tree[i]; \
+    return sum; \
+} \
+\
+/* Sum of elements [lo, hi) */ \
+static inline T fenwick_##T##_range(const fenwick_##T* f, size_t lo, size_t hi) { \
+    if (lo > hi || hi > f->n) { \
+        printf("Invalid range\n"); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    /* Walk both ends down until they meet, so the shared part is never added */ \
+    T sum = {0}; \
+    while (hi > lo) { \
+        sum = sum + f->tree[hi]; \
+        hi -= FENWICK_LOWBIT(hi); \
+    } \
+    while (lo > hi) { \
+        sum = sum - f->tree[lo]; \
+        lo -= FENWICK_LOWBIT(lo); \
+    } \
+    return sum; \
+} \
+\
+static inline void fenwick_##T##_add(fenwick_##T* f, size_t i, T delta) { \
+    if (i >= f->n) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    for (i++; i <= f->n; i += FENWICK_LOWBIT(i)) f->tree[i] = f->tree[i] + delta; \
+} \
+\
+/* Element i, in O(log n) without a separate copy of the values */ \
+static inline T fenwick_##T##_get(const fenwick_##T* f, size_t i) { \
+    if (i >= f->n) { \
+        printf("Invalid index %zu\n", i); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return fenwick_##T##_range(f, i, i + 1); \
+} \
+\
+static inline void fenwick_##T##_set(fenwick_##T* f, size_t i, T val) { \
+    if (i >= f->n) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    fenwick_##T##_add(f, i, val - fenwick_##T##_get(f, i)); \
+} \
+\
+/* Appends val in O(log n) */ \
+static inline bool fenwick_##T##_push(fenwick_##T* f, T val) { \
+    size_t i = f->n + 1; \
+    if (!fenwick_##T##_reserve(f, i)) return false; \
+    /* Node i covers (i - lowbit(i), i]: val plus the already-built nodes below it */ \
+    T sum = val; \
+    for (size_t j = i - 1, stop = i - FENWICK_LOWBIT(i); j > stop; j -= FENWICK_LOWBIT(j)) sum = sum + f->tree[j]; \
+    f->tree[i] = sum; \
+    f->n = i; \
+    return true; \
+} \
+\
+/* Adds delta[j] at idx[j] for j < k; one O(n) pass when k is large, else k point adds */ \
+static inline bool fenwick_##T##_add_batch(fenwick_##T* f, const size_t* idx, const T* delta, size_t k) { \
+    for (size_t j = 0; j < k; j++) \
+        if (idx[j] >= f->n) { \
+            printf("Index out of bounds\n"); \
+            return false; \
+        } \
+    if (k * (prefix_tree_log2(f->n) + 1) < f->n) { \
+        for (size_t j = 0; j < k; j++) fenwick_##T##_add(f, idx[j], delta[j]); \
+        return true; \
+    } \
+    T* d = (T*)calloc(f->n + 1, sizeof(T)); \
+    if (!d) { \
+        for (size_t j = 0; j < k; j++) fenwick_##T##_add(f, idx[j], delta[j]); \
+        return true; \
+    } \
+    for (size_t j = 0; j < k; j++) d[idx[j] + 1] = d[idx[j] + 1] + delta[j]; \
+    /* Build a Fenwick tree of the deltas in place and add it node by node */ \
+    for (size_t i = 1; i <= f->n; i++) { \
+        size_t parent = i + FENWICK_LOWBIT(i); \
+        if (parent <= f->n) d[parent] = d[parent] + d[i]; \
+        f->tree[i] = f->tree[i] + d[i]; \
+    } \
+    free(d); \
+    return true; \
+} \
+\
+/* Smallest i with prefix(i + 1) >= target, or n if there is none; elements must be >= 0 */ \
+static inline size_t fenwick_##T##_lower_bound(const fenwick_##T* f, T target) { \
+    size_t pos = 0; \
+    size_t step = f->n ? (size_t)1 << (prefix_tree_log2(f->n + 1) - 1) : 0; \
+    for (; step > 0; step >>= 1) { \
+        if (pos + step <= f->n && f->tree[pos + step] < target) { \
+            pos += step; \
+            target = target - f->tree[pos]; \
+        } \
+    } \
+    return pos; \
+} \
+\
+/* Appends the elements to out (undoes the build on a copy, O(n)) */ \
+static inline bool fenwick_##T##_to_vec(const fenwick_##T* f, vec_##T* out) { \
+    size_t base = out->len; \
+    if (!vec_##T##_extend(out, f->tree + 1, f->n)) return false; \
+    T* a = out->data + base; \
+    for (size_t i = f->n; i >= 1; i--) { \
+        size_t parent = i + FENWICK_LOWBIT(i); \
+        if (parent <= f->n) a[parent - 1] = a[parent - 1] - a[i - 1]; \
+    } \
+    return true; \
+} \
+\
+static inline void fenwick_##T##_free(fenwick_##T* f) { \
+    free(f->tree); \
+    f->tree = NULL; \
+    f->n = f->cap = 0; \
+}
+
+#define DEFINE_SEGTREE(T, OP) DEFINE_SEGTREE_NAMED(T, segtree_##T, OP)
+
+#define DEFINE_SEGTREE_NAMED(T, TYPE_NAME, OP) \
+typedef struct { \
+    T* tree;            /* node 1 is the root; leaf i is node size + i */ \
+    size_t n; \
+    size_t size;        /* leaves: n rounded up to a power of two */ \
+    size_t log; \
+} TYPE_NAME; \
+\
+/* Recomputes node (height h above the leaves) from its children; padding children are skipped */ \
+static inline void TYPE_NAME##_pull(TYPE_NAME* st, size_t node, size_t h) { \
+    size_t right_first = ((node - (st->size >> h)) * 2 + 1) << (h - 1); \
+    st->tree[node] = right_first < st->n ? OP(st->tree[2 * node], st->tree[2 * node + 1]) : st->tree[2 * node]; \
+} \
+\
+/* Recomputes every internal node covering at least one element, level by level */ \
+static inline void TYPE_NAME##_rebuild(TYPE_NAME* st) { \
+    for (size_t h = 1; h <= st->log; h++) \
+        for (size_t k = 0; k < (st->size >> h) && (k << h) < st->n; k++) TYPE_NAME##_pull(st, (st->size >> h) + k, h); \
+} \
+\
+static inline bool TYPE_NAME##_alloc(TYPE_NAME* st, size_t n) { \
+    st->n = n; \
+    st->log = prefix_tree_log2(n); \
+    st->size = (size_t)1 << st->log; \
+    if (st->size > SIZE_MAX / 2 / sizeof(T)) { \
+        printf("Memory allocation failed\n"); \
+        st->tree = NULL; \
+        return false; \
+    } \
+    st->tree = (T*)calloc(2 * st->size, sizeof(T)); \
+    if (!st->tree) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    return true; \
+} \
+\
+/* Initializes st over a[0..n) in O(n) */ \
+static inline bool TYPE_NAME##_from_array(TYPE_NAME* st, const T* a, size_t n) { \
+    if (!TYPE_NAME##_alloc(st, n)) return false; \
+    memcpy(st->tree + st->size, a, n * sizeof(T)); \
+    TYPE_NAME##_rebuild(st); \
+    return true; \
+} \
+\
+static inline bool TYPE_NAME##_from_vec(TYPE_NAME* st, const vec_##T* v) { \
+    return TYPE_NAME##_from_array(st, v->data, v->len); \
+} \
+\
+/* Initializes st with n copies of val */ \
+static inline bool TYPE_NAME##_init(TYPE_NAME* st, size_t n, T val) { \
+    if (!TYPE_NAME##_alloc(st, n)) return false; \
+    for (size_t i = 0; i < n; i++) st->tree[st->size + i] = val; \
+    TYPE_NAME##_rebuild(st); \
+    return true; \
+} \
+\
+static inline T TYPE_NAME##_get(const TYPE_NAME* st, size_t i) { \
+    if (i >= st->n) { \
+        printf("Invalid index %zu\n", i); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return st->tree[st->size + i]; \
+} \
+\
+static inline void TYPE_NAME##_set(TYPE_NAME* st, size_t i, T val) { \
+    if (i >= st->n) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    size_t node = st->size + i; \
+    st->tree[node] = val; \
+    for (size_t h = 1; h <= st->log; h++) TYPE_NAME##_pull(st, node >> h, h); \
+} \
+\
+/* OP over elements [lo, hi), lo < hi, combined left to right */ \
+static inline T TYPE_NAME##_query(const TYPE_NAME* st, size_t lo, size_t hi) { \
+    T left = {0}, right = {0}; \
+    if (lo >= hi || hi > st->n) { \
+        printf("Invalid range\n"); \
+        return left; \
+    } \
+    bool has_left = false, has_right = false; \
+    for (lo += st->size, hi += st->size; lo < hi; lo >>= 1, hi >>= 1) { \
+        if (lo & 1) { \
+            left = has_left ? OP(left, st->tree[lo]) : st->tree[lo]; \
+            has_left = true; \
+            lo++; \
+        } \
+        if (hi & 1) { \
+            hi--; \
+            right = has_right ? OP(st->tree[hi], right) : st->tree[hi]; \
+            has_right = true; \
+        } \
+    } \
+    if (!has_left) return right; \
+    return has_right ? OP(left, right) : left; \
+} \
+\
+/* OP over elements [0, i), i > 0 */ \
+static inline T TYPE_NAME##_prefix(const TYPE_NAME* st, size_t i) { \
+    return TYPE_NAME##_query(st, 0, i); \
+} \
+\
+/* OP over all elements (n > 0) */ \
+static inline T TYPE_NAME##_all(const TYPE_NAME* st) { \
+    return TYPE_NAME##_query(st, 0, st->n); \
+} \
+\
+/* \
+ * Smallest i with !(prefix(i + 1) < target), or n if there is none. The \
+ * prefixes must not decrease (sums of non-negative values, running max). \
+ * One root-to-leaf descent. \
+ */ \
+static inline size_t TYPE_NAME##_lower_bound(const TYPE_NAME* st, T target) { \
+    if (st->n == 0) return 0; \
+    T acc = {0}; \
+    bool has = false; \
+    size_t node = 1; \
+    for (size_t h = st->log; h > 0; h--) { \
+        size_t left = 2 * node; \
+        T cand = has ? OP(acc, st->tree[left]) : st->tree[left]; \
+        if (cand < target) { \
+            acc = cand; \
+            has = true; \
+            node = left + 1; \
+            /* The right child starts past the last element */ \
+            if (((node - (st->size >> (h - 1))) << (h - 1)) >= st->n) return st->n; \
+        } else { \
+            node = left; \
+        } \
+    } \
+    T cand = has ? OP(acc, st->tree[node]) : st->tree[node]; \
+    return cand < target ? st->n : node - st->size; \
+} \
+\
+/* Sets idx[j] to vals[j] for j < k; one O(n) rebuild when k is large, else k point sets */ \
+static inline bool TYPE_NAME##_set_batch(TYPE_NAME* st, const size_t* idx, const T* vals, size_t k) { \
+    for (size_t j = 0; j < k; j++) \
+        if (idx[j] >= st->n) { \
+            printf("Index out of bounds\n"); \
+            return false; \
+        } \
+    if (k * st->log < st->n) { \
+        for (size_t j = 0; j < k; j++) TYPE_NAME##_set(st, idx[j], vals[j]); \
+        return true; \
+    } \
+    for (size_t j = 0; j < k; j++) st->tree[st->size + idx[j]] = vals[j]; \
+    TYPE_NAME##_rebuild(st); \
+    return true; \
+} \
+\
+/* Appends the elements to out */ \
+static inline bool TYPE_NAME##_to_vec(const TYPE_NAME* st, vec_##T* out) { \
+    return vec_##T##_extend(out, st->tree + st->size, st->n); \
+} \
+\
+static inline void TYPE_NAME##_free(TYPE_NAME* st) { \
+    free(st->tree); \
+    st->tree = NULL; \
+    st->n = st->size = st->log = 0; \
+}
+
+#endif // PREFIX_TREE_H
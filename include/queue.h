@@ -2,63 +2,191 @@
 #define QUEUE_H
 
 #include "common.h"
-#include "vector.h"
+
+/*
+ * DEFINE_QUEUE(T) generates queue_T, a FIFO over a circular buffer.
+ * head and tail are free-running counters; the slot of counter i is
+ * i & (cap - 1), cap being a power of two. Enqueue and dequeue are O(1);
+ * growth copies the elements, unwrapped, into the new buffer with at most
+ * two memcpys.
+ */
+
+#define QUEUE_MIN_CAP 16
+
+// Smallest power of two >= n (and >= QUEUE_MIN_CAP), or 0 if it overflows
+static inline size_t queue_round_cap(size_t n) {
+    size_t cap = QUEUE_MIN_CAP;
+    while (cap < n) {
+        if (cap > SIZE_MAX / 2) return 0;
+        cap *= 2;
+    }
+    return cap;
+}
 
 #define DEFINE_QUEUE(T)\
-        typedef struct{\
-            vec_##T data;\
-        } queue_##T;\
-        \
-        static inline void queue_##T##_init(queue_##T *q){\
-            vec_##T##_init(&q->data);\
-        }\
-        \
-    static inline void queue_##T##_enqueue(queue_##T *q,T item){\
-        vec_##T##_push(&q->data,item);\
-    }\
+    typedef struct { \
+        T *data; \
+        size_t cap;     /* 0 or a power of two */ \
+        size_t head;    /* counter of the front element */ \
+        size_t tail;    /* counter one past the rear element */ \
+    } queue_##T; \
+    \
+    static inline void queue_##T##_init(queue_##T *q) { \
+        q->data = NULL; \
+        q->cap = q->head = q->tail = 0; \
+    } \
+    \
+    static inline size_t queue_##T##_size(queue_##T *q) { \
+        return q->tail - q->head; \
+    } \
+    \
+    static inline int queue_##T##_empty(queue_##T *q) { \
+        return q->tail == q->head; \
+    } \
+    \
+    /* Copies the n elements from counter `from` into dst, in order (at most two memcpys) */ \
+    static inline void queue_##T##_copy_out(const queue_##T *q, size_t from, T *dst, size_t n) { \
+        size_t start = from & (q->cap - 1); \
+        size_t first = q->cap - start < n ? q->cap - start : n; \
+        memcpy(dst, q->data + start, first * sizeof(T)); \
+        memcpy(dst + first, q->data, (n - first) * sizeof(T)); \
+    } \
+    \
+    /* Moves the elements into a buffer of new_cap slots (a power of two >= size), unwrapped */ \
+    static inline bool queue_##T##_realloc(queue_##T *q, size_t new_cap) { \
+        size_t len = queue_##T##_size(q); \
+        T *data = NULL; \
+        if (new_cap > 0) { \
+            if (new_cap > SIZE_MAX / sizeof(T)) { \
+                printf("Memory allocation failed\n"); \
+                return false; \
+            } \
+            data = (T *)malloc(new_cap * sizeof(T)); \
+            if (!data) { \
+                printf("Memory allocation failed\n"); \
+                return false; \
+            } \
+            if (len > 0) queue_##T##_copy_out(q, q->head, data, len); \
+        } \
+        free(q->data); \
+        q->data = data; \
+        q->cap = new_cap; \
+        q->head = 0; \
+        q->tail = len; \
+        return true; \
+    } \
+    \
+    /* Makes room for n elements in total */ \
+    static inline bool queue_##T##_reserve(queue_##T *q, size_t n) { \
+        if (n <= q->cap) return true; \
+        size_t cap = queue_round_cap(n); \
+        if (cap == 0) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+        return queue_##T##_realloc(q, cap); \
+    } \
+    \
+    static inline void queue_##T##_shrink_to_fit(queue_##T *q) { \
+        size_t len = queue_##T##_size(q); \
+        size_t cap = len ? queue_round_cap(len) : 0; \
+        if (cap < q->cap) queue_##T##_realloc(q, cap); \
+    } \
+    \
+    static inline void queue_##T##_enqueue(queue_##T *q, T item) { \
+        if (q->tail - q->head == q->cap && !queue_##T##_reserve(q, q->cap + 1)) return; \
+        q->data[q->tail++ & (q->cap - 1)] = item; \
+    } \
+    \
+    /* Enqueue n items at the rear with at most two copies */ \
+    static inline bool queue_##T##_enqueue_n(queue_##T *q, const T *items, size_t n) { \
+        if (n == 0) return true; \
+        size_t len = queue_##T##_size(q); \
+        if (n > SIZE_MAX - len || !queue_##T##_reserve(q, len + n)) return false; \
+        size_t start = q->tail & (q->cap - 1); \
+        size_t first = q->cap - start < n ? q->cap - start : n; \
+        memcpy(q->data + start, items, first * sizeof(T)); \
+        memcpy(q->data, items + first, (n - first) * sizeof(T)); \
+        q->tail += n; \
+        return true; \
+    } \
     \
     /* Dequeue: remove element from the front */ \
     static inline T queue_##T##_dequeue(queue_##T *q) { \
-        if (q->data.len == 0) { \
+        if (q->tail == q->head) { \
             fprintf(stderr, "Queue underflow\n"); \
             T tmp = {0}; \
             return tmp; \
         } \
-        T val = vec_##T##_get(&q->data, 0); \
-        vec_##T##_remove(&q->data, 0); \
-        return val; \
+        return q->data[q->head++ & (q->cap - 1)]; \
+    } \
+    \
+    /* Dequeues into *out (if not NULL) instead of returning by value */ \
+    static inline bool queue_##T##_dequeue_into(queue_##T *q, T *out) { \
+        if (q->tail == q->head) { \
+            fprintf(stderr, "Queue underflow\n"); \
+            return false; \
+        } \
+        if (out) *out = q->data[q->head & (q->cap - 1)]; \
+        q->head++; \
+        return true; \
+    } \
+    \
+    /* Dequeues up to n elements into out (if not NULL); returns how many */ \
+    static inline size_t queue_##T##_dequeue_n(queue_##T *q, T *out, size_t n) { \
+        size_t len = queue_##T##_size(q); \
+        if (n > len) n = len; \
+        if (out && n > 0) queue_##T##_copy_out(q, q->head, out, n); \
+        q->head += n; \
+        return n; \
     } \
     \
     /* Front element */ \
     static inline T queue_##T##_front(queue_##T *q) { \
-        if (q->data.len == 0) { \
+        if (q->tail == q->head) { \
             fprintf(stderr, "Queue is empty\n"); \
             T tmp = {0}; \
             return tmp; \
         } \
-        return vec_##T##_get(&q->data, 0); \
+        return q->data[q->head & (q->cap - 1)]; \
     } \
     \
     /* Rear element */ \
     static inline T queue_##T##_rear(queue_##T *q) { \
-        if (q->data.len == 0) { \
+        if (q->tail == q->head) { \
             fprintf(stderr, "Queue is empty\n"); \
             T tmp = {0}; \
             return tmp; \
         } \
-        return vec_##T##_get(&q->data, q->data.len - 1); \
+        return q->data[(q->tail - 1) & (q->cap - 1)]; \
     } \
     \
-    static inline size_t queue_##T##_size(queue_##T *q) { \
-        return q->data.len; \
+    /* Pointers to the front / rear element, NULL when empty; invalidated by enqueue/dequeue */ \
+    static inline T *queue_##T##_front_ptr(queue_##T *q) { \
+        if (q->tail == q->head) { \
+            fprintf(stderr, "Queue is empty\n"); \
+            return NULL; \
+        } \
+        return &q->data[q->head & (q->cap - 1)]; \
     } \
     \
-    static inline int queue_##T##_empty(queue_##T *q) { \
-        return q->data.len == 0; \
+    static inline T *queue_##T##_rear_ptr(queue_##T *q) { \
+        if (q->tail == q->head) { \
+            fprintf(stderr, "Queue is empty\n"); \
+            return NULL; \
+        } \
+        return &q->data[(q->tail - 1) & (q->cap - 1)]; \
+    } \
+    \
+    /* Enqueues an uninitialized slot at the rear and returns it to be filled in place */ \
+    static inline T *queue_##T##_emplace(queue_##T *q) { \
+        if (q->tail - q->head == q->cap && !queue_##T##_reserve(q, q->cap + 1)) return NULL; \
+        return &q->data[q->tail++ & (q->cap - 1)]; \
     } \
     \
     static inline void queue_##T##_free(queue_##T *q) { \
-        vec_##T##_free(&q->data); \
+        free(q->data); \
+        queue_##T##_init(q); \
     }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,1026 @@
+#ifndef ROARING_H
+#define ROARING_H
+
+#include "common.h"
+#include "set.h"
+
+/*
+ * Roaring compressed bitmap for 32-bit (Roaring) and 64-bit (Roaring64)
+ * unsigned integers.
+ *
+ * Values are bucketed by their high 16 bits into containers kept sorted by
+ * key. A container stores the low 16 bits either as a sorted uint16_t array
+ * (up to ROARING_ARRAY_MAX values) or as a 65536-bit bitmap, and switches
+ * representation automatically as its cardinality crosses the threshold.
+ * Bitmap/bitmap set algebra runs on AVX2 when the CPU supports it.
+ */
+
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_BITMAP_WORDS 1024
+#define ROARING_MAGIC 0x314D4252u /* "RBM1" little-endian */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ROARING_X86 1
+#endif
+
+typedef enum {
+    ROARING_ARRAY = 0,
+    ROARING_BITMAP = 1
+} RoaringKind;
+
+typedef enum {
+    ROARING_OP_AND,
+    ROARING_OP_OR,
+    ROARING_OP_ANDNOT,
+    ROARING_OP_XOR
+} RoaringOp;
+
+typedef struct {
+    uint16_t key;     // high 16 bits shared by every value in the container
+    uint8_t kind;     // RoaringKind
+    uint32_t card;    // number of values, 1..65536
+    uint32_t cap;     // allocated array slots (array containers only)
+    union {
+        uint16_t* array;
+        uint64_t* words;
+    } data;
+} RoaringContainer;
+
+typedef struct {
+    RoaringContainer* containers;
+    size_t len;
+    size_t cap;
+} Roaring;
+
+/* ---------- bit helpers ---------- */
+
+static inline unsigned roaring_popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static inline unsigned roaring_ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+/* ---------- bitmap word kernels ---------- */
+
+#define ROARING_WORDS_LOOP(EXPR) \
+    for (size_t i = 0; i < ROARING_BITMAP_WORDS; i++) { \
+        uint64_t w = (EXPR); \
+        dst[i] = w; \
+        card += roaring_popcount64(w); \
+    }
+
+static inline uint32_t roaring_words_op_scalar(uint64_t* dst, const uint64_t* a, const uint64_t* b, RoaringOp op) {
+    uint32_t card = 0;
+    switch (op) {
+        case ROARING_OP_AND:    ROARING_WORDS_LOOP(a[i] & b[i]); break;
+        case ROARING_OP_OR:     ROARING_WORDS_LOOP(a[i] | b[i]); break;
+        case ROARING_OP_ANDNOT: ROARING_WORDS_LOOP(a[i] & ~b[i]); break;
+        case ROARING_OP_XOR:    ROARING_WORDS_LOOP(a[i] ^ b[i]); break;
+    }
+    return card;
+}
+
+#ifdef ROARING_X86
+#define ROARING_AVX2_LOOP(INTRIN) \
+    for (size_t i = 0; i < ROARING_BITMAP_WORDS; i += 4) { \
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i)); \
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i)); \
+        _mm256_storeu_si256((__m256i*)(dst + i), INTRIN); \
+    }
+
+__attribute__((target("avx2,popcnt")))
+static inline uint32_t roaring_words_op_avx2(uint64_t* dst, const uint64_t* a, const uint64_t* b, RoaringOp op) {
+    switch (op) {
+        case ROARING_OP_AND:    ROARING_AVX2_LOOP(_mm256_and_si256(va, vb)); break;
+        case ROARING_OP_OR:     ROARING_AVX2_LOOP(_mm256_or_si256(va, vb)); break;
+        case ROARING_OP_ANDNOT: ROARING_AVX2_LOOP(_mm256_andnot_si256(vb, va)); break;
+        case ROARING_OP_XOR:    ROARING_AVX2_LOOP(_mm256_xor_si256(va, vb)); break;
+    }
+    uint64_t card = 0;
+    for (size_t i = 0; i < ROARING_BITMAP_WORDS; i++) {
+        card += (uint64_t)_mm_popcnt_u64(dst[i]);
+    }
+    return (uint32_t)card;
+}
+#endif
+
+// Computes dst = a OP b over one bitmap container and returns its cardinality
+static inline uint32_t roaring_words_op(uint64_t* dst, const uint64_t* a, const uint64_t* b, RoaringOp op) {
+#ifdef ROARING_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return roaring_words_op_avx2(dst, a, b, op);
+    }
+#endif
+    return roaring_words_op_scalar(dst, a, b, op);
+}
+
+/* ---------- containers ---------- */
+
+static inline void roaring_container_free(RoaringContainer* c) {
+    if (c->kind == ROARING_ARRAY) free(c->data.array);
+    else free(c->data.words);
+    c->data.array = NULL;
+    c->card = 0;
+    c->cap = 0;
+}
+
+// Index of the first array slot >= low
+static inline uint32_t roaring_array_lower_bound(const uint16_t* arr, uint32_t n, uint16_t low) {
+    uint32_t lo = 0, hi = n;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (arr[mid] < low) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static inline bool roaring_container_contains(const RoaringContainer* c, uint16_t low) {
+    if (c->kind == ROARING_BITMAP) {
+        return (c->data.words[low >> 6] >> (low & 63)) & 1;
+    }
+    uint32_t i = roaring_array_lower_bound(c->data.array, c->card, low);
+    return i < c->card && c->data.array[i] == low;
+}
+
+static inline bool roaring_container_to_bitmap(RoaringContainer* c) {
+    uint64_t* words = (uint64_t*)calloc(ROARING_BITMAP_WORDS, sizeof(uint64_t));
+    if (!words) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    for (uint32_t i = 0; i < c->card; i++) {
+        uint16_t v = c->data.array[i];
+        words[v >> 6] |= 1ULL << (v & 63);
+    }
+    free(c->data.array);
+    c->data.words = words;
+    c->kind = ROARING_BITMAP;
+    c->cap = 0;
+    return true;
+}
+
+static inline bool roaring_container_to_array(RoaringContainer* c) {
+    uint16_t* arr = (uint16_t*)malloc((c->card ? c->card : 1) * sizeof(uint16_t));
+    if (!arr) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ROARING_BITMAP_WORDS; i++) {
+        uint64_t w = c->data.words[i];
+        while (w) {
+            arr[n++] = (uint16_t)(i * 64 + roaring_ctz64(w));
+            w &= w - 1;
+        }
+    }
+    free(c->data.words);
+    c->data.array = arr;
+    c->kind = ROARING_ARRAY;
+    c->cap = c->card;
+    return true;
+}
+
+// Keeps the container in whichever representation is smaller
+static inline void roaring_container_normalize(RoaringContainer* c) {
+    if (c->kind == ROARING_BITMAP && c->card <= ROARING_ARRAY_MAX) roaring_container_to_array(c);
+    else if (c->kind == ROARING_ARRAY && c->card > ROARING_ARRAY_MAX) roaring_container_to_bitmap(c);
+}
+
+static inline bool roaring_container_add(RoaringContainer* c, uint16_t low) {
+    if (c->kind == ROARING_BITMAP) {
+        uint64_t bit = 1ULL << (low & 63);
+        if (c->data.words[low >> 6] & bit) return false;
+        c->data.words[low >> 6] |= bit;
+        c->card++;
+        return true;
+    }
+    uint32_t i = roaring_array_lower_bound(c->data.array, c->card, low);
+    if (i < c->card && c->data.array[i] == low) return false;
+    if (c->card >= ROARING_ARRAY_MAX) {
+        if (!roaring_container_to_bitmap(c)) return false;
+        return roaring_container_add(c, low);
+    }
+    if (c->card >= c->cap) {
+        uint32_t new_cap = (c->cap == 0) ? 4 : c->cap * 2;
+        if (new_cap > ROARING_ARRAY_MAX) new_cap = ROARING_ARRAY_MAX;
+        uint16_t* new_arr = (uint16_t*)realloc(c->data.array, new_cap * sizeof(uint16_t));
+        if (!new_arr) {
+            printf("Memory allocation failed\n");
+            return false;
+        }
+        c->data.array = new_arr;
+        c->cap = new_cap;
+    }
+    memmove(c->data.array + i + 1, c->data.array + i, (c->card - i) * sizeof(uint16_t));
+    c->data.array[i] = low;
+    c->card++;
+    return true;
+}
+
+static inline bool roaring_container_remove(RoaringContainer* c, uint16_t low) {
+    if (c->kind == ROARING_BITMAP) {
+        uint64_t bit = 1ULL << (low & 63);
+        if (!(c->data.words[low >> 6] & bit)) return false;
+        c->data.words[low >> 6] &= ~bit;
+        c->card--;
+        if (c->card <= ROARING_ARRAY_MAX) roaring_container_to_array(c);
+        return true;
+    }
+    uint32_t i = roaring_array_lower_bound(c->data.array, c->card, low);
+    if (i >= c->card || c->data.array[i] != low) return false;
+    memmove(c->data.array + i, c->data.array + i + 1, (c->card - i - 1) * sizeof(uint16_t));
+    c->card--;
+    return true;
+}
+
+// Number of values in the container that are <= low
+static inline uint32_t roaring_container_rank(const RoaringContainer* c, uint16_t low) {
+    if (c->kind == ROARING_ARRAY) {
+        uint32_t i = roaring_array_lower_bound(c->data.array, c->card, low);
+        return i + (i < c->card && c->data.array[i] == low);
+    }
+    uint32_t rank = 0;
+    uint32_t word = low >> 6;
+    for (uint32_t i = 0; i < word; i++) rank += roaring_popcount64(c->data.words[i]);
+    uint64_t mask = ((low & 63) == 63) ? ~0ULL : ((1ULL << ((low & 63) + 1)) - 1);
+    return rank + roaring_popcount64(c->data.words[word] & mask);
+}
+
+// k-th smallest low value in the container (k < card)
+static inline uint16_t roaring_container_select(const RoaringContainer* c, uint32_t k) {
+    if (c->kind == ROARING_ARRAY) return c->data.array[k];
+    for (uint32_t i = 0; i < ROARING_BITMAP_WORDS; i++) {
+        uint64_t w = c->data.words[i];
+        uint32_t pc = roaring_popcount64(w);
+        if (k < pc) {
+            while (k--) w &= w - 1;
+            return (uint16_t)(i * 64 + roaring_ctz64(w));
+        }
+        k -= pc;
+    }
+    return 0;
+}
+
+static inline void roaring_container_fill_words(const RoaringContainer* c, uint64_t* words) {
+    if (c->kind == ROARING_BITMAP) {
+        memcpy(words, c->data.words, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+        return;
+    }
+    memset(words, 0, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    for (uint32_t i = 0; i < c->card; i++) {
+        uint16_t v = c->data.array[i];
+        words[v >> 6] |= 1ULL << (v & 63);
+    }
+}
+
+// Merges two sorted arrays; returns the result cardinality
+static inline uint32_t roaring_array_op(uint16_t* dst, const uint16_t* a, uint32_t na, const uint16_t* b, uint32_t nb, RoaringOp op) {
+    uint32_t i = 0, j = 0, n = 0;
+    bool keep_a = (op != ROARING_OP_AND);
+    bool keep_b = (op == ROARING_OP_OR || op == ROARING_OP_XOR);
+    bool keep_both = (op == ROARING_OP_AND || op == ROARING_OP_OR);
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            if (keep_a) dst[n++] = a[i];
+            i++;
+        } else if (a[i] > b[j]) {
+            if (keep_b) dst[n++] = b[j];
+            j++;
+        } else {
+            if (keep_both) dst[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    if (keep_a) while (i < na) dst[n++] = a[i++];
+    if (keep_b) while (j < nb) dst[n++] = b[j++];
+    return n;
+}
+
+// Computes out = a OP b; false if out of memory. An empty result has card 0 and nothing allocated
+static inline bool roaring_container_op(RoaringContainer* out, const RoaringContainer* a, const RoaringContainer* b, RoaringOp op) {
+    out->key = a->key;
+    out->cap = 0;
+    if (a->kind == ROARING_ARRAY && b->kind == ROARING_ARRAY) {
+        uint32_t max = (op == ROARING_OP_AND) ? (a->card < b->card ? a->card : b->card)
+                     : (op == ROARING_OP_ANDNOT) ? a->card : a->card + b->card;
+        uint16_t* arr = (uint16_t*)malloc((max ? max : 1) * sizeof(uint16_t));
+        if (!arr) {
+            printf("Memory allocation failed\n");
+            return false;
+        }
+        out->kind = ROARING_ARRAY;
+        out->data.array = arr;
+        out->card = roaring_array_op(arr, a->data.array, a->card, b->data.array, b->card, op);
+        out->cap = max;
+        if (out->card == 0) {
+            roaring_container_free(out);
+            return true;
+        }
+        roaring_container_normalize(out);
+        return true;
+    }
+    if (op == ROARING_OP_AND && (a->kind == ROARING_ARRAY || b->kind == ROARING_ARRAY)) {
+        const RoaringContainer* arr_c = (a->kind == ROARING_ARRAY) ? a : b;
+        const RoaringContainer* bm_c = (a->kind == ROARING_ARRAY) ? b : a;
+        uint16_t* arr = (uint16_t*)malloc(arr_c->card * sizeof(uint16_t));
+        if (!arr) {
+            printf("Memory allocation failed\n");
+            return false;
+        }
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < arr_c->card; i++) {
+            uint16_t v = arr_c->data.array[i];
+            if ((bm_c->data.words[v >> 6] >> (v & 63)) & 1) arr[n++] = v;
+        }
+        out->kind = ROARING_ARRAY;
+        out->data.array = arr;
+        out->card = n;
+        out->cap = arr_c->card;
+        if (n == 0) {
+            roaring_container_free(out);
+            return true;
+        }
+        return true;
+    }
+    /* Mixed or bitmap operands: run the word kernel on bitmap views */
+    uint64_t* words = (uint64_t*)malloc(ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    uint64_t tmp_a[ROARING_BITMAP_WORDS];
+    uint64_t tmp_b[ROARING_BITMAP_WORDS];
+    if (!words) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    const uint64_t* wa = a->data.words;
+    const uint64_t* wb = b->data.words;
+    if (a->kind == ROARING_ARRAY) { roaring_container_fill_words(a, tmp_a); wa = tmp_a; }
+    if (b->kind == ROARING_ARRAY) { roaring_container_fill_words(b, tmp_b); wb = tmp_b; }
+    out->kind = ROARING_BITMAP;
+    out->data.words = words;
+    out->card = roaring_words_op(words, wa, wb, op);
+    if (out->card == 0) {
+        roaring_container_free(out);
+        return true;
+    }
+    roaring_container_normalize(out);
+    return true;
+}
+
+static inline bool roaring_container_copy(RoaringContainer* dst, const RoaringContainer* src) {
+    *dst = *src;
+    if (src->kind == ROARING_ARRAY) {
+        dst->data.array = (uint16_t*)malloc(src->card * sizeof(uint16_t));
+        if (!dst->data.array) {
+            printf("Memory allocation failed\n");
+            return false;
+        }
+        memcpy(dst->data.array, src->data.array, src->card * sizeof(uint16_t));
+        dst->cap = src->card;
+    } else {
+        dst->data.words = (uint64_t*)malloc(ROARING_BITMAP_WORDS * sizeof(uint64_t));
+        if (!dst->data.words) {
+            printf("Memory allocation failed\n");
+            return false;
+        }
+        memcpy(dst->data.words, src->data.words, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    }
+    return true;
+}
+
+/* ---------- Roaring (32-bit) ---------- */
+
+static inline void roaring_init(Roaring* r) {
+    r->containers = NULL;
+    r->len = 0;
+    r->cap = 0;
+}
+
+static inline void roaring_clear(Roaring* r) {
+    for (size_t i = 0; i < r->len; i++) roaring_container_free(&r->containers[i]);
+    r->len = 0;
+}
+
+static inline void roaring_free(Roaring* r) {
+    roaring_clear(r);
+    free(r->containers);
+    r->containers = NULL;
+    r->cap = 0;
+}
+
+// Index of the first container whose key >= key
+static inline size_t roaring_lower_bound(const Roaring* r, uint16_t key) {
+    size_t lo = 0, hi = r->len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->containers[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static inline bool roaring_reserve_containers(Roaring* r, size_t n) {
+    if (n <= r->cap) return true;
+    size_t new_cap = (r->cap == 0) ? 4 : r->cap * 2;
+    if (new_cap < n) new_cap = n;
+    RoaringContainer* new_c = (RoaringContainer*)realloc(r->containers, new_cap * sizeof(RoaringContainer));
+    if (!new_c) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    r->containers = new_c;
+    r->cap = new_cap;
+    return true;
+}
+
+// Appends a container that sorts after every existing one (takes ownership; freed on failure)
+static inline bool roaring_append_container(Roaring* r, RoaringContainer* c) {
+    if (!roaring_reserve_containers(r, r->len + 1)) {
+        roaring_container_free(c);
+        return false;
+    }
+    r->containers[r->len++] = *c;
+    return true;
+}
+
+static inline bool roaring_add(Roaring* r, uint32_t x) {
+    uint16_t key = (uint16_t)(x >> 16);
+    size_t i = roaring_lower_bound(r, key);
+    if (i == r->len || r->containers[i].key != key) {
+        /* Fill the new container first, so a failed allocation leaves r untouched */
+        if (!roaring_reserve_containers(r, r->len + 1)) return false;
+        RoaringContainer c;
+        c.key = key;
+        c.kind = ROARING_ARRAY;
+        c.card = 0;
+        c.cap = 0;
+        c.data.array = NULL;
+        if (!roaring_container_add(&c, (uint16_t)x)) return false;
+        memmove(r->containers + i + 1, r->containers + i, (r->len - i) * sizeof(RoaringContainer));
+        r->containers[i] = c;
+        r->len++;
+        return true;
+    }
+    return roaring_container_add(&r->containers[i], (uint16_t)x);
+}
+
+static inline bool roaring_contains(const Roaring* r, uint32_t x) {
+    uint16_t key = (uint16_t)(x >> 16);
+    size_t i = roaring_lower_bound(r, key);
+    if (i == r->len || r->containers[i].key != key) return false;
+    return roaring_container_contains(&r->containers[i], (uint16_t)x);
+}
+
+static inline bool roaring_remove(Roaring* r, uint32_t x) {
+    uint16_t key = (uint16_t)(x >> 16);
+    size_t i = roaring_lower_bound(r, key);
+    if (i == r->len || r->containers[i].key != key) return false;
+    if (!roaring_container_remove(&r->containers[i], (uint16_t)x)) return false;
+    if (r->containers[i].card == 0) {
+        roaring_container_free(&r->containers[i]);
+        memmove(r->containers + i, r->containers + i + 1, (r->len - i - 1) * sizeof(RoaringContainer));
+        r->len--;
+    }
+    return true;
+}
+
+static inline uint64_t roaring_cardinality(const Roaring* r) {
+    uint64_t card = 0;
+    for (size_t i = 0; i < r->len; i++) card += r->containers[i].card;
+    return card;
+}
+
+static inline bool roaring_empty(const Roaring* r) {
+    return r->len == 0;
+}
+
+// Number of values <= x
+static inline uint64_t roaring_rank(const Roaring* r, uint32_t x) {
+    uint16_t key = (uint16_t)(x >> 16);
+    uint64_t rank = 0;
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        if (c->key < key) rank += c->card;
+        else if (c->key == key) return rank + roaring_container_rank(c, (uint16_t)x);
+        else break;
+    }
+    return rank;
+}
+
+// k-th smallest value (0-based); returns false if k >= cardinality
+static inline bool roaring_select(const Roaring* r, uint64_t k, uint32_t* out) {
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        if (k < c->card) {
+            *out = ((uint32_t)c->key << 16) | roaring_container_select(c, (uint32_t)k);
+            return true;
+        }
+        k -= c->card;
+    }
+    return false;
+}
+
+// Initializes out with a copy of r; false if out of memory (out is then left empty)
+static inline bool roaring_copy(Roaring* out, const Roaring* r) {
+    roaring_init(out);
+    if (!roaring_reserve_containers(out, r->len)) return false;
+    for (size_t i = 0; i < r->len; i++) {
+        if (!roaring_container_copy(&out->containers[i], &r->containers[i])) {
+            roaring_free(out);
+            return false;
+        }
+        out->len++;
+    }
+    return true;
+}
+
+// Initializes out with a OP b; false if out of memory (out is then left empty)
+static inline bool roaring_op_into(Roaring* out, const Roaring* a, const Roaring* b, RoaringOp op) {
+    Roaring result;
+    roaring_init(&result);
+    size_t i = 0, j = 0;
+    bool keep_a = (op != ROARING_OP_AND);
+    bool keep_b = (op == ROARING_OP_OR || op == ROARING_OP_XOR);
+    bool ok = true;
+    while (ok && i < a->len && j < b->len) {
+        const RoaringContainer* ca = &a->containers[i];
+        const RoaringContainer* cb = &b->containers[j];
+        RoaringContainer c;
+        if (ca->key < cb->key) {
+            if (keep_a) ok = roaring_container_copy(&c, ca) && roaring_append_container(&result, &c);
+            i++;
+        } else if (ca->key > cb->key) {
+            if (keep_b) ok = roaring_container_copy(&c, cb) && roaring_append_container(&result, &c);
+            j++;
+        } else {
+            ok = roaring_container_op(&c, ca, cb, op);
+            if (ok && c.card > 0) ok = roaring_append_container(&result, &c);
+            i++;
+            j++;
+        }
+    }
+    for (; ok && keep_a && i < a->len; i++) {
+        RoaringContainer c;
+        ok = roaring_container_copy(&c, &a->containers[i]) && roaring_append_container(&result, &c);
+    }
+    for (; ok && keep_b && j < b->len; j++) {
+        RoaringContainer c;
+        ok = roaring_container_copy(&c, &b->containers[j]) && roaring_append_container(&result, &c);
+    }
+    if (!ok) roaring_free(&result);
+    *out = result;
+    return ok;
+}
+
+// a OP b as a new bitmap; on allocation failure the result is returned empty
+static inline Roaring roaring_op(const Roaring* a, const Roaring* b, RoaringOp op) {
+    Roaring result;
+    roaring_op_into(&result, a, b, op);
+    return result;
+}
+
+static inline Roaring roaring_and(const Roaring* a, const Roaring* b) { return roaring_op(a, b, ROARING_OP_AND); }
+static inline Roaring roaring_or(const Roaring* a, const Roaring* b) { return roaring_op(a, b, ROARING_OP_OR); }
+static inline Roaring roaring_andnot(const Roaring* a, const Roaring* b) { return roaring_op(a, b, ROARING_OP_ANDNOT); }
+static inline Roaring roaring_xor(const Roaring* a, const Roaring* b) { return roaring_op(a, b, ROARING_OP_XOR); }
+
+// Calls fn for every value in ascending order; returns false if fn stopped early
+static inline bool roaring_foreach(const Roaring* r, bool (*fn)(uint32_t value, void* ctx), void* ctx) {
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        uint32_t high = (uint32_t)c->key << 16;
+        if (c->kind == ROARING_ARRAY) {
+            for (uint32_t j = 0; j < c->card; j++)
+                if (!fn(high | c->data.array[j], ctx)) return false;
+        } else {
+            for (uint32_t w = 0; w < ROARING_BITMAP_WORDS; w++) {
+                uint64_t bits = c->data.words[w];
+                while (bits) {
+                    if (!fn(high | (w * 64 + roaring_ctz64(bits)), ctx)) return false;
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Writes all values in ascending order to out (sized for roaring_cardinality)
+static inline size_t roaring_to_array(const Roaring* r, uint32_t* out) {
+    size_t n = 0;
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        uint32_t high = (uint32_t)c->key << 16;
+        if (c->kind == ROARING_ARRAY) {
+            for (uint32_t j = 0; j < c->card; j++) out[n++] = high | c->data.array[j];
+        } else {
+            for (uint32_t w = 0; w < ROARING_BITMAP_WORDS; w++) {
+                uint64_t bits = c->data.words[w];
+                while (bits) {
+                    out[n++] = high | (w * 64 + roaring_ctz64(bits));
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+    return n;
+}
+
+// Heap bytes held by the bitmap, including the container directory
+static inline size_t roaring_memory_usage(const Roaring* r) {
+    size_t bytes = sizeof(Roaring) + r->cap * sizeof(RoaringContainer);
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        bytes += (c->kind == ROARING_ARRAY) ? c->cap * sizeof(uint16_t)
+                                            : ROARING_BITMAP_WORDS * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+// Releases slack in array containers and the container directory
+static inline void roaring_shrink_to_fit(Roaring* r) {
+    for (size_t i = 0; i < r->len; i++) {
+        RoaringContainer* c = &r->containers[i];
+        if (c->kind == ROARING_ARRAY && c->cap > c->card) {
+            uint16_t* arr = (uint16_t*)realloc(c->data.array, c->card * sizeof(uint16_t));
+            if (arr) {
+                c->data.array = arr;
+                c->cap = c->card;
+            }
+        }
+    }
+    if (r->cap > r->len && r->len > 0) {
+        RoaringContainer* cs = (RoaringContainer*)realloc(r->containers, r->len * sizeof(RoaringContainer));
+        if (cs) {
+            r->containers = cs;
+            r->cap = r->len;
+        }
+    }
+}
+
+/* ---------- serialization ----------
+ * Little-endian layout:
+ *   u32 magic, u32 container count,
+ *   per container: u16 key, u16 kind, u32 cardinality,
+ *   then per container: card x u16 (array) or 1024 x u64 (bitmap).
+ */
+
+static inline void roaring_put_u16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void roaring_put_u32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static inline void roaring_put_u64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static inline uint16_t roaring_get_u16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t roaring_get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+static inline uint64_t roaring_get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static inline size_t roaring_serialized_size(const Roaring* r) {
+    size_t bytes = 8 + r->len * 8;
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        bytes += (c->kind == ROARING_ARRAY) ? c->card * 2 : ROARING_BITMAP_WORDS * 8;
+    }
+    return bytes;
+}
+
+// Writes roaring_serialized_size(r) bytes to buf and returns that count
+static inline size_t roaring_serialize(const Roaring* r, uint8_t* buf) {
+    uint8_t* p = buf;
+    roaring_put_u32(p, ROARING_MAGIC); p += 4;
+    roaring_put_u32(p, (uint32_t)r->len); p += 4;
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        roaring_put_u16(p, c->key); p += 2;
+        roaring_put_u16(p, c->kind); p += 2;
+        roaring_put_u32(p, c->card); p += 4;
+    }
+    for (size_t i = 0; i < r->len; i++) {
+        const RoaringContainer* c = &r->containers[i];
+        if (c->kind == ROARING_ARRAY) {
+            for (uint32_t j = 0; j < c->card; j++) { roaring_put_u16(p, c->data.array[j]); p += 2; }
+        } else {
+            for (uint32_t j = 0; j < ROARING_BITMAP_WORDS; j++) { roaring_put_u64(p, c->data.words[j]); p += 8; }
+        }
+    }
+    return (size_t)(p - buf);
+}
+
+// Rebuilds r (which must be initialized) from a serialized buffer
+static inline bool roaring_deserialize(Roaring* r, const uint8_t* buf, size_t len) {
+    roaring_clear(r);
+    if (len < 8 || roaring_get_u32(buf) != ROARING_MAGIC) {
+        printf("Invalid roaring buffer\n");
+        return false;
+    }
+    size_t n = roaring_get_u32(buf + 4);
+    if (n > 65536 || len < 8 + n * 8) {
+        printf("Invalid roaring buffer\n");
+        return false;
+    }
+    if (!roaring_reserve_containers(r, n)) return false;
+    const uint8_t* hdr = buf + 8;
+    const uint8_t* p = buf + 8 + n * 8;
+    const uint8_t* end = buf + len;
+    for (size_t i = 0; i < n; i++, hdr += 8) {
+        RoaringContainer c;
+        c.key = roaring_get_u16(hdr);
+        c.kind = (uint8_t)roaring_get_u16(hdr + 2);
+        c.card = roaring_get_u32(hdr + 4);
+        c.cap = 0;
+        size_t payload = (c.kind == ROARING_ARRAY) ? (size_t)c.card * 2 : ROARING_BITMAP_WORDS * 8;
+        bool bad_key = (i > 0 && c.key <= r->containers[i - 1].key);
+        if (c.kind > ROARING_BITMAP || c.card == 0 || c.card > 65536 || bad_key ||
+            (c.kind == ROARING_ARRAY && c.card > ROARING_ARRAY_MAX) || (size_t)(end - p) < payload) {
+            printf("Invalid roaring buffer\n");
+            roaring_clear(r);
+            return false;
+        }
+        if (c.kind == ROARING_ARRAY) {
+            c.data.array = (uint16_t*)malloc(c.card * sizeof(uint16_t));
+            if (!c.data.array) { printf("Memory allocation failed\n"); roaring_clear(r); return false; }
+            for (uint32_t j = 0; j < c.card; j++) c.data.array[j] = roaring_get_u16(p + 2 * j);
+            c.cap = c.card;
+        } else {
+            c.data.words = (uint64_t*)malloc(ROARING_BITMAP_WORDS * sizeof(uint64_t));
+            if (!c.data.words) { printf("Memory allocation failed\n"); roaring_clear(r); return false; }
+            for (uint32_t j = 0; j < ROARING_BITMAP_WORDS; j++) c.data.words[j] = roaring_get_u64(p + 8 * j);
+        }
+        /* The payload must match the header: arrays strictly increasing, bitmaps holding card bits */
+        bool bad_payload = false;
+        if (c.kind == ROARING_ARRAY) {
+            for (uint32_t j = 1; j < c.card && !bad_payload; j++) bad_payload = c.data.array[j] <= c.data.array[j - 1];
+        } else {
+            uint32_t bits = 0;
+            for (uint32_t j = 0; j < ROARING_BITMAP_WORDS; j++) bits += roaring_popcount64(c.data.words[j]);
+            bad_payload = bits != c.card;
+        }
+        if (bad_payload) {
+            printf("Invalid roaring buffer\n");
+            roaring_container_free(&c);
+            roaring_clear(r);
+            return false;
+        }
+        p += payload;
+        r->containers[r->len++] = c;
+    }
+    return true;
+}
+
+/* ---------- Roaring64: 32-bit high key -> Roaring of low 32 bits ---------- */
+
+typedef struct {
+    uint32_t key;
+    Roaring bits;
+} Roaring64Bucket;
+
+typedef struct {
+    Roaring64Bucket* buckets;
+    size_t len;
+    size_t cap;
+} Roaring64;
+
+static inline void roaring64_init(Roaring64* r) {
+    r->buckets = NULL;
+    r->len = 0;
+    r->cap = 0;
+}
+
+static inline void roaring64_free(Roaring64* r) {
+    for (size_t i = 0; i < r->len; i++) roaring_free(&r->buckets[i].bits);
+    free(r->buckets);
+    r->buckets = NULL;
+    r->len = 0;
+    r->cap = 0;
+}
+
+static inline size_t roaring64_lower_bound(const Roaring64* r, uint32_t key) {
+    size_t lo = 0, hi = r->len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->buckets[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static inline bool roaring64_reserve(Roaring64* r, size_t n) {
+    if (n <= r->cap) return true;
+    size_t new_cap = (r->cap == 0) ? 4 : r->cap * 2;
+    if (new_cap < n) new_cap = n;
+    Roaring64Bucket* nb = (Roaring64Bucket*)realloc(r->buckets, new_cap * sizeof(Roaring64Bucket));
+    if (!nb) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    r->buckets = nb;
+    r->cap = new_cap;
+    return true;
+}
+
+static inline bool roaring64_add(Roaring64* r, uint64_t x) {
+    uint32_t key = (uint32_t)(x >> 32);
+    size_t i = roaring64_lower_bound(r, key);
+    if (i == r->len || r->buckets[i].key != key) {
+        /* Fill the new bucket first, so a failed allocation leaves r untouched */
+        if (!roaring64_reserve(r, r->len + 1)) return false;
+        Roaring bits;
+        roaring_init(&bits);
+        if (!roaring_add(&bits, (uint32_t)x)) {
+            roaring_free(&bits);
+            return false;
+        }
+        memmove(r->buckets + i + 1, r->buckets + i, (r->len - i) * sizeof(Roaring64Bucket));
+        r->buckets[i].key = key;
+        r->buckets[i].bits = bits;
+        r->len++;
+        return true;
+    }
+    return roaring_add(&r->buckets[i].bits, (uint32_t)x);
+}
+
+static inline bool roaring64_contains(const Roaring64* r, uint64_t x) {
+    uint32_t key = (uint32_t)(x >> 32);
+    size_t i = roaring64_lower_bound(r, key);
+    return i < r->len && r->buckets[i].key == key && roaring_contains(&r->buckets[i].bits, (uint32_t)x);
+}
+
+static inline bool roaring64_remove(Roaring64* r, uint64_t x) {
+    uint32_t key = (uint32_t)(x >> 32);
+    size_t i = roaring64_lower_bound(r, key);
+    if (i == r->len || r->buckets[i].key != key) return false;
+    if (!roaring_remove(&r->buckets[i].bits, (uint32_t)x)) return false;
+    if (roaring_empty(&r->buckets[i].bits)) {
+        roaring_free(&r->buckets[i].bits);
+        memmove(r->buckets + i, r->buckets + i + 1, (r->len - i - 1) * sizeof(Roaring64Bucket));
+        r->len--;
+    }
+    return true;
+}
+
+static inline uint64_t roaring64_cardinality(const Roaring64* r) {
+    uint64_t card = 0;
+    for (size_t i = 0; i < r->len; i++) card += roaring_cardinality(&r->buckets[i].bits);
+    return card;
+}
+
+static inline uint64_t roaring64_rank(const Roaring64* r, uint64_t x) {
+    uint32_t key = (uint32_t)(x >> 32);
+    uint64_t rank = 0;
+    for (size_t i = 0; i < r->len && r->buckets[i].key <= key; i++) {
+        if (r->buckets[i].key < key) rank += roaring_cardinality(&r->buckets[i].bits);
+        else rank += roaring_rank(&r->buckets[i].bits, (uint32_t)x);
+    }
+    return rank;
+}
+
+static inline bool roaring64_select(const Roaring64* r, uint64_t k, uint64_t* out) {
+    for (size_t i = 0; i < r->len; i++) {
+        uint64_t card = roaring_cardinality(&r->buckets[i].bits);
+        if (k < card) {
+            uint32_t low;
+            roaring_select(&r->buckets[i].bits, k, &low);
+            *out = ((uint64_t)r->buckets[i].key << 32) | low;
+            return true;
+        }
+        k -= card;
+    }
+    return false;
+}
+
+// Appends bits under key (takes ownership); an empty bitmap is dropped. False if out of memory
+static inline bool roaring64_append(Roaring64* r, uint32_t key, Roaring* bits) {
+    if (roaring_empty(bits)) {
+        roaring_free(bits);
+        return true;
+    }
+    if (!roaring64_reserve(r, r->len + 1)) {
+        roaring_free(bits);
+        return false;
+    }
+    r->buckets[r->len].key = key;
+    r->buckets[r->len].bits = *bits;
+    r->len++;
+    return true;
+}
+
+// a OP b as a new bitmap; on allocation failure the result is returned empty
+static inline Roaring64 roaring64_op(const Roaring64* a, const Roaring64* b, RoaringOp op) {
+    Roaring64 result;
+    roaring64_init(&result);
+    size_t i = 0, j = 0;
+    bool keep_a = (op != ROARING_OP_AND);
+    bool keep_b = (op == ROARING_OP_OR || op == ROARING_OP_XOR);
+    bool ok = true;
+    while (ok && (i < a->len || j < b->len)) {
+        Roaring bits;
+        if (j == b->len || (i < a->len && a->buckets[i].key < b->buckets[j].key)) {
+            if (keep_a) ok = roaring_copy(&bits, &a->buckets[i].bits) && roaring64_append(&result, a->buckets[i].key, &bits);
+            i++;
+        } else if (i == a->len || a->buckets[i].key > b->buckets[j].key) {
+            if (keep_b) ok = roaring_copy(&bits, &b->buckets[j].bits) && roaring64_append(&result, b->buckets[j].key, &bits);
+            j++;
+        } else {
+            ok = roaring_op_into(&bits, &a->buckets[i].bits, &b->buckets[j].bits, op) &&
+                 roaring64_append(&result, a->buckets[i].key, &bits);
+            i++;
+            j++;
+        }
+    }
+    if (!ok) roaring64_free(&result);
+    return result;
+}
+
+static inline Roaring64 roaring64_and(const Roaring64* a, const Roaring64* b) { return roaring64_op(a, b, ROARING_OP_AND); }
+static inline Roaring64 roaring64_or(const Roaring64* a, const Roaring64* b) { return roaring64_op(a, b, ROARING_OP_OR); }
+static inline Roaring64 roaring64_andnot(const Roaring64* a, const Roaring64* b) { return roaring64_op(a, b, ROARING_OP_ANDNOT); }
+static inline Roaring64 roaring64_xor(const Roaring64* a, const Roaring64* b) { return roaring64_op(a, b, ROARING_OP_XOR); }
+
+static inline size_t roaring64_memory_usage(const Roaring64* r) {
+    size_t bytes = sizeof(Roaring64) + r->cap * sizeof(Roaring64Bucket);
+    for (size_t i = 0; i < r->len; i++) bytes += roaring_memory_usage(&r->buckets[i].bits) - sizeof(Roaring);
+    return bytes;
+}
+
+/* ---------- conversion to and from DEFINE_SET sets ----------
+ * DEFINE_ROARING_SET(T, TYPE_NAME) needs DEFINE_SET(T, TYPE_NAME, ...) first.
+ * Values are stored as (uint32_t)value; for signed T, negative values sort
+ * after positive ones inside the bitmap but come back in set order.
+ */
+
+#define DEFINE_ROARING_SET(T, TYPE_NAME) \
+static inline Roaring MAKE_NAME(roaring_from_set, TYPE_NAME)(MAKE_NAME(Set, TYPE_NAME)* s) { \
+    Roaring r; \
+    roaring_init(&r); \
+    MAKE_NAME(SetIter, TYPE_NAME) it; \
+    MAKE_NAME(set_iter_init, TYPE_NAME)(&it, s); \
+    T val; \
+    while (MAKE_NAME(set_iter_next, TYPE_NAME)(&it, &val)) roaring_add(&r, (uint32_t)val); \
+    MAKE_NAME(set_iter_free, TYPE_NAME)(&it); \
+    return r; \
+} \
+\
+static inline MAKE_NAME(SetNode, TYPE_NAME)* MAKE_NAME(roaring_build_balanced, TYPE_NAME)(const T* arr, size_t lo, size_t hi) { \
+    if (lo >= hi) return NULL; \
+    size_t mid = lo + (hi - lo) / 2; \
+    MAKE_NAME(SetNode, TYPE_NAME)* n = MAKE_NAME(create_node, TYPE_NAME)(arr[mid]); \
+    n->left = MAKE_NAME(roaring_build_balanced, TYPE_NAME)(arr, lo, mid); \
+    n->right = MAKE_NAME(roaring_build_balanced, TYPE_NAME)(arr, mid + 1, hi); \
+    return n; \
+} \
+\
+/* Builds a balanced tree directly, so sorted input does not degrade the BST */ \
+static inline MAKE_NAME(Set, TYPE_NAME) MAKE_NAME(roaring_to_set, TYPE_NAME)(const Roaring* r) { \
+    MAKE_NAME(Set, TYPE_NAME) s; \
+    MAKE_NAME(set_init, TYPE_NAME)(&s); \
+    size_t n = (size_t)roaring_cardinality(r); \
+    if (n == 0) return s; \
+    uint32_t* raw = (uint32_t*)malloc(n * sizeof(uint32_t)); \
+    T* vals = (T*)malloc(n * sizeof(T)); \
+    if (!raw || !vals) { \
+        printf("Memory allocation failed\n"); \
+        free(raw); free(vals); \
+        return s; \
+    } \
+    roaring_to_array(r, raw); \
+    size_t split = n; \
+    if ((T)-1 < (T)0) { \
+        size_t lo = 0, hi = n; \
+        while (lo < hi) { \
+            size_t mid = lo + (hi - lo) / 2; \
+            if (raw[mid] < 0x80000000u) lo = mid + 1; \
+            else hi = mid; \
+        } \
+        split = lo; \
+    } \
+    for (size_t i = split; i < n; i++) vals[i - split] = (T)raw[i]; \
+    for (size_t i = 0; i < split; i++) vals[n - split + i] = (T)raw[i]; \
+    s.root = MAKE_NAME(roaring_build_balanced, TYPE_NAME)(vals, 0, n); \
+    s.size = n; \
+    free(raw); \
+    free(vals); \
+    return s; \
+}
+
+#endif // ROARING_H
@@ -0,0 +1,398 @@
+#ifndef ROPE_H
+#define ROPE_H
+
+#include "common.h"
+#include "vector.h"
+
+/*
+ * DEFINE_ROPE(T) generates rope_T: a sequence split into chunks of up to
+ * ROPE_CHUNK elements, kept in a treap ordered by position. Each node holds
+ * one chunk and the element count of its subtree, so finding index i,
+ * inserting or removing anywhere, splitting at a position and concatenating
+ * two ropes all take O(log n) expected time plus O(ROPE_CHUNK) work inside
+ * one chunk. Good for very long sequences edited at scattered positions.
+ *
+ * Needs DEFINE_VEC(T) first (for the vec_T conversions).
+ */
+
+#define ROPE_CHUNK 512
+
+#define DEFINE_ROPE(T) \
+typedef struct rope_##T##_node { \
+    struct rope_##T##_node* left; \
+    struct rope_##T##_node* right; \
+    size_t size;           /* elements in this subtree */ \
+    uint32_t prio;         /* treap priority: parents >= children */ \
+    uint32_t count;        /* elements in this node's chunk */ \
+    T items[ROPE_CHUNK]; \
+} rope_##T##_node; \
+\
+typedef struct { \
+    rope_##T##_node* root; \
+    uint64_t seed; \
+} rope_##T; \
+\
+static inline void rope_##T##_init(rope_##T* r) { \
+    r->root = NULL; \
+    r->seed = 0x9E3779B97F4A7C15ULL; \
+} \
+\
+static inline size_t rope_##T##_len(const rope_##T* r) { \
+    return r->root ? r->root->size : 0; \
+} \
+\
+static inline size_t rope_##T##_size_of(const rope_##T##_node* n) { \
+    return n ? n->size : 0; \
+} \
+\
+static inline void rope_##T##_update(rope_##T##_node* n) { \
+    n->size = rope_##T##_size_of(n->left) + n->count + rope_##T##_size_of(n->right); \
+} \
+\
+static inline rope_##T##_node* rope_##T##_new_node(rope_##T* r) { \
+    rope_##T##_node* n = malloc(sizeof(rope_##T##_node)); \
+    if (!n) { \
+        printf("Memory allocation failed\n"); \
+        return NULL; \
+    } \
+    uint64_t x = r->seed; \
+    x ^= x >> 12; \
+    x ^= x << 25; \
+    x ^= x >> 27; \
+    r->seed = x; \
+    n->left = n->right = NULL; \
+    n->size = n->count = 0; \
+    n->prio = (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32); \
+    return n; \
+} \
+\
+/* Concatenates two treaps, every element of a before every element of b */ \
+static inline rope_##T##_node* rope_##T##_merge(rope_##T##_node* a, rope_##T##_node* b) { \
+    if (!a) return b; \
+    if (!b) return a; \
+    if (a->prio >= b->prio) { \
+        a->right = rope_##T##_merge(a->right, b); \
+        rope_##T##_update(a); \
+        return a; \
+    } \
+    b->left = rope_##T##_merge(a, b->left); \
+    rope_##T##_update(b); \
+    return b; \
+} \
+\
+/* Splits t into its first pos elements (*l) and the rest (*r), cutting a chunk if needed */ \
+static inline bool rope_##T##_split_node(rope_##T* r, rope_##T##_node* t, size_t pos, rope_##T##_node** lo, \
+                                        rope_##T##_node** hi) { \
+    if (!t) { \
+        *lo = *hi = NULL; \
+        return true; \
+    } \
+    size_t ls = rope_##T##_size_of(t->left); \
+    if (pos <= ls) { \
+        bool ok = rope_##T##_split_node(r, t->left, pos, lo, &t->left); \
+        rope_##T##_update(t); \
+        *hi = t; \
+        return ok; \
+    } \
+    if (pos >= ls + t->count) { \
+        bool ok = rope_##T##_split_node(r, t->right, pos - ls - t->count, &t->right, hi); \
+        rope_##T##_update(t); \
+        *lo = t; \
+        return ok; \
+    } \
+    /* The cut falls inside this chunk: its upper part becomes a new node */ \
+    size_t keep = pos - ls; \
+    rope_##T##_node* m = rope_##T##_new_node(r); \
+    if (!m) { \
+        *lo = t; \
+        *hi = NULL; \
+        return false; \
+    } \
+    m->count = t->count - (uint32_t)keep; \
+    memcpy(m->items, t->items + keep, m->count * sizeof(T)); \
+    t->count = (uint32_t)keep; \
+    rope_##T##_update(m); \
+    *hi = rope_##T##_merge(m, t->right); \
+    t->right = NULL; \
+    rope_##T##_update(t); \
+    *lo = t; \
+    return true; \
+} \
+\
+/* Builds a treap over src in O(n): full chunks, linked by a right-spine stack */ \
+static inline rope_##T##_node* rope_##T##_build(rope_##T* r, const T* src, size_t n) { \
+    rope_##T##_node* spine[64 * 2]; \
+    size_t depth = 0; \
+    for (size_t i = 0; i < n; i += ROPE_CHUNK) { \
+        rope_##T##_node* c = rope_##T##_new_node(r); \
+        if (!c) break; \
+        c->count = (uint32_t)(n - i < ROPE_CHUNK ? n - i : ROPE_CHUNK); \
+        memcpy(c->items, src + i, c->count * sizeof(T)); \
+        c->size = c->count; \
+        rope_##T##_node* last = NULL; \
+        while (depth && spine[depth - 1]->prio < c->prio) { \
+            last = spine[--depth]; \
+            rope_##T##_update(last); \
+        } \
+        c->left = last; \
+        rope_##T##_update(c); \
+        if (depth) spine[depth - 1]->right = c; \
+        if (depth < sizeof(spine) / sizeof(spine[0])) spine[depth++] = c; \
+    } \
+    while (depth > 1) rope_##T##_update(spine[--depth]); \
+    if (depth) rope_##T##_update(spine[0]); \
+    return depth ? spine[0] : NULL; \
+} \
+\
+static inline rope_##T##_node* rope_##T##_find(const rope_##T* r, size_t* i) { \
+    rope_##T##_node* n = r->root; \
+    while (n) { \
+        size_t ls = rope_##T##_size_of(n->left); \
+        if (*i < ls) { \
+            n = n->left; \
+        } else if (*i < ls + n->count) { \
+            *i -= ls; \
+            return n; \
+        } else { \
+            *i -= ls + n->count; \
+            n = n->right; \
+        } \
+    } \
+    return NULL; \
+} \
+\
+static inline T* rope_##T##_at_ptr(rope_##T* r, size_t i) { \
+    if (i >= rope_##T##_len(r)) { \
+        printf("Invalid index %zu\n", i); \
+        return NULL; \
+    } \
+    rope_##T##_node* n = rope_##T##_find(r, &i); \
+    return &n->items[i]; \
+} \
+\
+static inline T rope_##T##_get(rope_##T* r, size_t i) { \
+    T* p = rope_##T##_at_ptr(r, i); \
+    if (!p) { \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return *p; \
+} \
+\
+static inline void rope_##T##_set(rope_##T* r, size_t i, T val) { \
+    if (i >= rope_##T##_len(r)) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    *rope_##T##_at_ptr(r, i) = val; \
+} \
+\
+/* Puts node m first in treap t */ \
+static inline rope_##T##_node* rope_##T##_prepend_node(rope_##T##_node* t, rope_##T##_node* m) { \
+    return rope_##T##_merge(m, t); \
+} \
+\
+/* \
+ * Restores the heap order at t after an insert below it: only the child \
+ * that was inserted into can outrank t, and one rotation lifts it. \
+ */ \
+static inline rope_##T##_node* rope_##T##_rotate_up(rope_##T##_node* t) { \
+    rope_##T##_node* c = t->left; \
+    if (c && c->prio > t->prio) { \
+        t->left = c->right; \
+        rope_##T##_update(t); \
+        c->right = t; \
+    } else if ((c = t->right) && c->prio > t->prio) { \
+        t->right = c->left; \
+        rope_##T##_update(t); \
+        c->left = t; \
+    } else { \
+        return t; \
+    } \
+    rope_##T##_update(c); \
+    return c; \
+} \
+\
+/* Inserts val before index pos of subtree t; a full chunk splits in two */ \
+static inline rope_##T##_node* rope_##T##_insert_at(rope_##T* r, rope_##T##_node* t, size_t pos, T val, bool* ok) { \
+    if (!t) { \
+        rope_##T##_node* n = rope_##T##_new_node(r); \
+        if (!n) { \
+            *ok = false; \
+            return NULL; \
+        } \
+        n->items[0] = val; \
+        n->count = 1; \
+        n->size = 1; \
+        return n; \
+    } \
+    size_t ls = rope_##T##_size_of(t->left); \
+    if (pos < ls) { \
+        t->left = rope_##T##_insert_at(r, t->left, pos, val, ok); \
+    } else if (pos > ls + t->count || (pos == ls + t->count && t->count == ROPE_CHUNK)) { \
+        t->right = rope_##T##_insert_at(r, t->right, pos - ls - t->count, val, ok); \
+    } else { \
+        size_t at = pos - ls; \
+        if (t->count == ROPE_CHUNK) { \
+            rope_##T##_node* m = rope_##T##_new_node(r); \
+            if (!m) { \
+                *ok = false; \
+                return t; \
+            } \
+            size_t half = ROPE_CHUNK / 2; \
+            m->count = ROPE_CHUNK - (uint32_t)half; \
+            memcpy(m->items, t->items + half, m->count * sizeof(T)); \
+            t->count = (uint32_t)half; \
+            if (at > half) { \
+                at -= half; \
+                memmove(m->items + at + 1, m->items + at, (m->count - at) * sizeof(T)); \
+                m->items[at] = val; \
+                m->count++; \
+            } else { \
+                memmove(t->items + at + 1, t->items + at, (t->count - at) * sizeof(T)); \
+                t->items[at] = val; \
+                t->count++; \
+            } \
+            rope_##T##_update(m); \
+            t->right = rope_##T##_prepend_node(t->right, m); \
+        } else { \
+            memmove(t->items + at + 1, t->items + at, (t->count - at) * sizeof(T)); \
+            t->items[at] = val; \
+            t->count++; \
+        } \
+    } \
+    rope_##T##_update(t); \
+    return rope_##T##_rotate_up(t); \
+} \
+\
+static inline void rope_##T##_insert(rope_##T* r, size_t pos, T val) { \
+    if (pos > rope_##T##_len(r)) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    bool ok = true; \
+    r->root = rope_##T##_insert_at(r, r->root, pos, val, &ok); \
+} \
+\
+static inline void rope_##T##_push(rope_##T* r, T val) { \
+    rope_##T##_insert(r, rope_##T##_len(r), val); \
+} \
+\
+/* Removes index pos of subtree t; an emptied chunk is unlinked */ \
+static inline rope_##T##_node* rope_##T##_remove_at(rope_##T##_node* t, size_t pos) { \
+    size_t ls = rope_##T##_size_of(t->left); \
+    if (pos < ls) { \
+        t->left = rope_##T##_remove_at(t->left, pos); \
+    } else if (pos >= ls + t->count) { \
+        t->right = rope_##T##_remove_at(t->right, pos - ls - t->count); \
+    } else { \
+        size_t at = pos - ls; \
+        memmove(t->items + at, t->items + at + 1, (t->count - at - 1) * sizeof(T)); \
+        if (--t->count == 0) { \
+            rope_##T##_node* rest = rope_##T##_merge(t->left, t->right); \
+            free(t); \
+            return rest; \
+        } \
+    } \
+    rope_##T##_update(t); \
+    return t; \
+} \
+\
+static inline void rope_##T##_remove(rope_##T* r, size_t pos) { \
+    if (pos >= rope_##T##_len(r)) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    r->root = rope_##T##_remove_at(r->root, pos); \
+} \
+\
+static inline void rope_##T##_free_node(rope_##T##_node* t) { \
+    while (t) { \
+        rope_##T##_free_node(t->left); \
+        rope_##T##_node* right = t->right; \
+        free(t); \
+        t = right; \
+    } \
+} \
+\
+/* Inserts n elements from src before index pos */ \
+static inline bool rope_##T##_insert_n(rope_##T* r, size_t pos, const T* src, size_t n) { \
+    if (pos > rope_##T##_len(r)) { \
+        printf("Index out of bounds\n"); \
+        return false; \
+    } \
+    rope_##T##_node* mid = rope_##T##_build(r, src, n); \
+    if (n && !mid) return false; \
+    rope_##T##_node *lo, *hi; \
+    bool ok = rope_##T##_split_node(r, r->root, pos, &lo, &hi); \
+    r->root = rope_##T##_merge(rope_##T##_merge(lo, mid), hi); \
+    return ok; \
+} \
+\
+/* Removes n elements starting at pos */ \
+static inline void rope_##T##_erase(rope_##T* r, size_t pos, size_t n) { \
+    size_t len = rope_##T##_len(r); \
+    if (pos > len || n > len - pos) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    rope_##T##_node *lo, *rest, *mid, *hi; \
+    rope_##T##_split_node(r, r->root, pos, &lo, &rest); \
+    rope_##T##_split_node(r, rest, n, &mid, &hi); \
+    rope_##T##_free_node(mid); \
+    r->root = rope_##T##_merge(lo, hi); \
+} \
+\
+/* Moves every element of b to the end of a; b is left empty */ \
+static inline void rope_##T##_concat(rope_##T* a, rope_##T* b) { \
+    a->root = rope_##T##_merge(a->root, b->root); \
+    b->root = NULL; \
+} \
+\
+/* Moves the elements from pos on into out (initialized here) */ \
+static inline bool rope_##T##_split(rope_##T* r, size_t pos, rope_##T* out) { \
+    rope_##T##_init(out); \
+    if (pos > rope_##T##_len(r)) { \
+        printf("Index out of bounds\n"); \
+        return false; \
+    } \
+    return rope_##T##_split_node(r, r->root, pos, &r->root, &out->root); \
+} \
+\
+static inline T* rope_##T##_copy_out(const rope_##T##_node* t, T* out) { \
+    while (t) { \
+        out = rope_##T##_copy_out(t->left, out); \
+        memcpy(out, t->items, t->count * sizeof(T)); \
+        out += t->count; \
+        t = t->right; \
+    } \
+    return out; \
+} \
+\
+/* Copies the elements, in order, into out (room for len) */ \
+static inline void rope_##T##_to_array(const rope_##T* r, T* out) { \
+    rope_##T##_copy_out(r->root, out); \
+} \
+\
+/* Initializes r with a copy of v */ \
+static inline bool rope_##T##_from_vec(rope_##T* r, const vec_##T* v) { \
+    rope_##T##_init(r); \
+    r->root = rope_##T##_build(r, v->data, v->len); \
+    return rope_##T##_len(r) == v->len; \
+} \
+\
+/* Appends the elements to out */ \
+static inline bool rope_##T##_to_vec(const rope_##T* r, vec_##T* out) { \
+    size_t len = rope_##T##_len(r); \
+    if (!vec_##T##_reserve(out, out->len + len)) return false; \
+    rope_##T##_to_array(r, out->data + out->len); \
+    out->len += len; \
+    return true; \
+} \
+\
+static inline void rope_##T##_free(rope_##T* r) { \
+    rope_##T##_free_node(r->root); \
+    r->root = NULL; \
+}
+
+#endif // ROPE_H
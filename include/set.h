@@ -4,12 +4,99 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <math.h>
 
+#if !defined(__STDC_NO_THREADS__) && !defined(__STDC_NO_ATOMICS__)
+#include <threads.h>
+#include <stdatomic.h>
+#define SET_HAS_THREADS 1
+#endif
+
 // Helper macro to create unique names
 #define CONCAT(a, b) a##_##b
 #define MAKE_NAME(prefix, type) CONCAT(prefix, type)
 
+// Power sets are enumerated over a 64-bit mask, so at most 63 elements
+#define SET_POWER_SET_MAX_ELEMS 63
+
+// Index of the lowest set bit (x must be non-zero)
+static inline unsigned set_ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+// Split [0, total) into nchunks disjoint ranges and return the i-th one
+static inline void set_power_set_chunk(uint64_t total, size_t nchunks, size_t i, uint64_t* lo, uint64_t* hi) {
+    uint64_t base = total / nchunks, rem = total % nchunks;
+    *lo = i * base + (i < rem ? i : rem);
+    *hi = *lo + base + (i < rem ? 1 : 0);
+}
+
+// Parallel power set: each worker enumerates a disjoint Gray-code range;
+// fn must be thread-safe and returning false from any worker stops all of them
+#ifdef SET_HAS_THREADS
+#define SET_DEFINE_POWER_SET_PARALLEL(T, TYPE_NAME) \
+typedef struct { \
+    MAKE_NAME(PowerSetIter, TYPE_NAME) it; \
+    MAKE_NAME(PowerSetFn, TYPE_NAME) fn; \
+    void* ctx; \
+    atomic_bool* stop; \
+} MAKE_NAME(PowerSetWorker, TYPE_NAME); \
+\
+static inline int MAKE_NAME(power_set_worker_run, TYPE_NAME)(void* arg) { \
+    MAKE_NAME(PowerSetWorker, TYPE_NAME)* w = (MAKE_NAME(PowerSetWorker, TYPE_NAME)*)arg; \
+    while (!atomic_load_explicit(w->stop, memory_order_relaxed) && MAKE_NAME(set_power_set_next, TYPE_NAME)(&w->it)) { \
+        if (!w->fn(&w->it, w->ctx)) { \
+            atomic_store(w->stop, true); \
+            break; \
+        } \
+    } \
+    return 0; \
+} \
+\
+static inline bool MAKE_NAME(set_power_set_parallel, TYPE_NAME)(MAKE_NAME(Set, TYPE_NAME)* A, size_t nthreads, MAKE_NAME(PowerSetFn, TYPE_NAME) fn, void* ctx) { \
+    MAKE_NAME(PowerSetIter, TYPE_NAME) all; \
+    if (!MAKE_NAME(set_power_set_iter_init, TYPE_NAME)(&all, A)) return false; \
+    if (nthreads == 0) nthreads = 1; \
+    if (nthreads > all.hi) nthreads = (size_t)all.hi; \
+    MAKE_NAME(PowerSetWorker, TYPE_NAME)* workers = (MAKE_NAME(PowerSetWorker, TYPE_NAME)*)malloc(nthreads * sizeof(*workers)); \
+    thrd_t* threads = (thrd_t*)malloc(nthreads * sizeof(thrd_t)); \
+    bool* spawned = (bool*)calloc(nthreads, sizeof(bool)); \
+    if (!workers || !threads || !spawned) { \
+        printf("Memory allocation failed\n"); \
+        free(workers); free(threads); free(spawned); \
+        MAKE_NAME(set_power_set_iter_free, TYPE_NAME)(&all); \
+        return false; \
+    } \
+    atomic_bool stop; \
+    atomic_init(&stop, false); \
+    for (size_t i = 0; i < nthreads; i++) { \
+        uint64_t lo, hi; \
+        set_power_set_chunk(all.hi, nthreads, i, &lo, &hi); \
+        MAKE_NAME(set_power_set_iter_range, TYPE_NAME)(&workers[i].it, all.elems, all.n, lo, hi); \
+        workers[i].fn = fn; \
+        workers[i].ctx = ctx; \
+        workers[i].stop = &stop; \
+        /* Fall back to running the chunk on this thread if spawning fails */ \
+        spawned[i] = thrd_create(&threads[i], MAKE_NAME(power_set_worker_run, TYPE_NAME), &workers[i]) == thrd_success; \
+        if (!spawned[i]) MAKE_NAME(power_set_worker_run, TYPE_NAME)(&workers[i]); \
+    } \
+    for (size_t i = 0; i < nthreads; i++) \
+        if (spawned[i]) thrd_join(threads[i], NULL); \
+    free(workers); free(threads); free(spawned); \
+    MAKE_NAME(set_power_set_iter_free, TYPE_NAME)(&all); \
+    return !atomic_load(&stop); \
+}
+#else
+#define SET_DEFINE_POWER_SET_PARALLEL(T, TYPE_NAME)
+#endif
+
 // For primitive types that support <, >, == operators
 #define DEFINE_SET(T, TYPE_NAME, FORMAT) \
 typedef struct MAKE_NAME(SetNode, TYPE_NAME) { \
@@ -161,6 +248,207 @@ static inline void MAKE_NAME(set_cartesian_product, TYPE_NAME)(MAKE_NAME(Set, TY
     } \
     printf("}\n"); \
     free(arrA); free(arrB); \
+} \
+\
+/* In-order iterator: walks the tree with an explicit stack, no flattening. \
+   If the stack cannot grow, failed is set and next returns false from then on. */ \
+typedef struct { \
+    MAKE_NAME(SetNode, TYPE_NAME)** stack; \
+    size_t top; \
+    size_t cap; \
+    bool failed; \
+} MAKE_NAME(SetIter, TYPE_NAME); \
+\
+static inline void MAKE_NAME(set_iter_push_left, TYPE_NAME)(MAKE_NAME(SetIter, TYPE_NAME)* it, MAKE_NAME(SetNode, TYPE_NAME)* node) { \
+    while (node) { \
+        if (it->top >= it->cap) { \
+            size_t new_cap = (it->cap == 0) ? 16 : it->cap * 2; \
+            MAKE_NAME(SetNode, TYPE_NAME)** new_stack = (MAKE_NAME(SetNode, TYPE_NAME)**)realloc(it->stack, new_cap * sizeof(*new_stack)); \
+            if (!new_stack) { \
+                printf("Memory allocation failed\n"); \
+                it->failed = true; \
+                return; \
+            } \
+            it->stack = new_stack; \
+            it->cap = new_cap; \
+        } \
+        it->stack[it->top++] = node; \
+        node = node->left; \
+    } \
+} \
+\
+static inline void MAKE_NAME(set_iter_init, TYPE_NAME)(MAKE_NAME(SetIter, TYPE_NAME)* it, MAKE_NAME(Set, TYPE_NAME)* s) { \
+    it->stack = NULL; \
+    it->top = 0; \
+    it->cap = 0; \
+    it->failed = false; \
+    MAKE_NAME(set_iter_push_left, TYPE_NAME)(it, s->root); \
+} \
+\
+/* false at the end, or once the iterator has failed (see set_iter_failed) */ \
+static inline bool MAKE_NAME(set_iter_next, TYPE_NAME)(MAKE_NAME(SetIter, TYPE_NAME)* it, T* out) { \
+    if (it->failed || it->top == 0) return false; \
+    MAKE_NAME(SetNode, TYPE_NAME)* node = it->stack[--it->top]; \
+    *out = node->data; \
+    MAKE_NAME(set_iter_push_left, TYPE_NAME)(it, node->right); \
+    return true; \
+} \
+\
+/* True if the traversal stopped early because memory ran out */ \
+static inline bool MAKE_NAME(set_iter_failed, TYPE_NAME)(const MAKE_NAME(SetIter, TYPE_NAME)* it) { \
+    return it->failed; \
+} \
+\
+static inline void MAKE_NAME(set_iter_free, TYPE_NAME)(MAKE_NAME(SetIter, TYPE_NAME)* it) { \
+    free(it->stack); \
+    it->stack = NULL; \
+    it->top = it->cap = 0; \
+} \
+\
+/* Power set iterator: visits masks gray(lo) .. gray(hi - 1), bit j selects elems[j]. \
+   After the first step exactly one element changes per step (changed/added). */ \
+typedef struct { \
+    T* elems; \
+    size_t n; \
+    uint64_t k; \
+    uint64_t lo; \
+    uint64_t hi; \
+    uint64_t mask; \
+    size_t changed; \
+    bool added; \
+    bool started; \
+    bool owns_elems; \
+} MAKE_NAME(PowerSetIter, TYPE_NAME); \
+\
+typedef bool (*MAKE_NAME(PowerSetFn, TYPE_NAME))(const MAKE_NAME(PowerSetIter, TYPE_NAME)* it, void* ctx); \
+\
+static inline void MAKE_NAME(set_power_set_iter_range, TYPE_NAME)(MAKE_NAME(PowerSetIter, TYPE_NAME)* it, T* elems, size_t n, uint64_t lo, uint64_t hi) { \
+    it->elems = elems; \
+    it->n = n; \
+    it->lo = lo; \
+    it->hi = hi; \
+    it->k = lo; \
+    it->mask = 0; \
+    it->changed = SIZE_MAX; \
+    it->added = false; \
+    it->started = false; \
+    it->owns_elems = false; \
+} \
+\
+static inline bool MAKE_NAME(set_power_set_iter_init, TYPE_NAME)(MAKE_NAME(PowerSetIter, TYPE_NAME)* it, MAKE_NAME(Set, TYPE_NAME)* A) { \
+    if (A->size > SET_POWER_SET_MAX_ELEMS) { \
+        printf("Power set too large (%zu elements)\n", A->size); \
+        MAKE_NAME(set_power_set_iter_range, TYPE_NAME)(it, NULL, 0, 0, 0); \
+        return false; \
+    } \
+    size_t i = 0; \
+    T* arr = (T*)malloc(sizeof(T) * (A->size ? A->size : 1)); \
+    if (!arr) { \
+        printf("Memory allocation failed\n"); \
+        MAKE_NAME(set_power_set_iter_range, TYPE_NAME)(it, NULL, 0, 0, 0); \
+        return false; \
+    } \
+    MAKE_NAME(node_to_array, TYPE_NAME)(A->root, arr, &i); \
+    MAKE_NAME(set_power_set_iter_range, TYPE_NAME)(it, arr, i, 0, 1ULL << i); \
+    it->owns_elems = true; \
+    return true; \
+} \
+\
+static inline bool MAKE_NAME(set_power_set_next, TYPE_NAME)(MAKE_NAME(PowerSetIter, TYPE_NAME)* it) { \
+    if (!it->started) { \
+        if (it->lo >= it->hi) return false; \
+        it->started = true; \
+        it->mask = it->lo ^ (it->lo >> 1); \
+        it->changed = SIZE_MAX; \
+        return true; \
+    } \
+    if (it->k + 1 >= it->hi) return false; \
+    it->k++; \
+    unsigned bit = set_ctz64(it->k); \
+    it->mask ^= 1ULL << bit; \
+    it->changed = bit; \
+    it->added = (it->mask >> bit) & 1; \
+    return true; \
+} \
+\
+static inline bool MAKE_NAME(set_power_set_iter_contains, TYPE_NAME)(const MAKE_NAME(PowerSetIter, TYPE_NAME)* it, size_t j) { \
+    return (it->mask >> j) & 1; \
+} \
+\
+static inline void MAKE_NAME(set_power_set_iter_free, TYPE_NAME)(MAKE_NAME(PowerSetIter, TYPE_NAME)* it) { \
+    if (it->owns_elems) free(it->elems); \
+    it->elems = NULL; \
+    it->owns_elems = false; \
+} \
+\
+/* Calls fn for every subset in Gray-code order; returns false if fn stopped early */ \
+static inline bool MAKE_NAME(set_power_set_foreach, TYPE_NAME)(MAKE_NAME(Set, TYPE_NAME)* A, MAKE_NAME(PowerSetFn, TYPE_NAME) fn, void* ctx) { \
+    MAKE_NAME(PowerSetIter, TYPE_NAME) it; \
+    if (!MAKE_NAME(set_power_set_iter_init, TYPE_NAME)(&it, A)) return false; \
+    bool completed = true; \
+    while (MAKE_NAME(set_power_set_next, TYPE_NAME)(&it)) { \
+        if (!fn(&it, ctx)) { completed = false; break; } \
+    } \
+    MAKE_NAME(set_power_set_iter_free, TYPE_NAME)(&it); \
+    return completed; \
+} \
+\
+SET_DEFINE_POWER_SET_PARALLEL(T, TYPE_NAME) \
+\
+/* Cartesian product iterator: pairs (a, b) in order, both sets walked lazily */ \
+typedef struct { \
+    MAKE_NAME(Set, TYPE_NAME)* B; \
+    MAKE_NAME(SetIter, TYPE_NAME) ia; \
+    MAKE_NAME(SetIter, TYPE_NAME) ib; \
+    T a; \
+    bool has_a; \
+} MAKE_NAME(CartesianIter, TYPE_NAME); \
+\
+static inline void MAKE_NAME(set_cartesian_iter_init, TYPE_NAME)(MAKE_NAME(CartesianIter, TYPE_NAME)* it, MAKE_NAME(Set, TYPE_NAME)* A, MAKE_NAME(Set, TYPE_NAME)* B) { \
+    it->B = B; \
+    MAKE_NAME(set_iter_init, TYPE_NAME)(&it->ia, A); \
+    MAKE_NAME(set_iter_init, TYPE_NAME)(&it->ib, B); \
+    it->has_a = (B->root != NULL) && MAKE_NAME(set_iter_next, TYPE_NAME)(&it->ia, &it->a); \
+} \
+\
+static inline bool MAKE_NAME(set_cartesian_iter_failed, TYPE_NAME)(const MAKE_NAME(CartesianIter, TYPE_NAME)* it) { \
+    return it->ia.failed || it->ib.failed; \
+} \
+\
+/* false at the end, or once either walk has failed (see set_cartesian_iter_failed) */ \
+static inline bool MAKE_NAME(set_cartesian_next, TYPE_NAME)(MAKE_NAME(CartesianIter, TYPE_NAME)* it, T* a, T* b) { \
+    while (it->has_a) { \
+        if (MAKE_NAME(set_iter_next, TYPE_NAME)(&it->ib, b)) { \
+            *a = it->a; \
+            return true; \
+        } \
+        if (MAKE_NAME(set_cartesian_iter_failed, TYPE_NAME)(it)) return false; \
+        it->has_a = MAKE_NAME(set_iter_next, TYPE_NAME)(&it->ia, &it->a); \
+        it->ib.top = 0; \
+        MAKE_NAME(set_iter_push_left, TYPE_NAME)(&it->ib, it->B->root); \
+    } \
+    return false; \
+} \
+\
+static inline void MAKE_NAME(set_cartesian_iter_free, TYPE_NAME)(MAKE_NAME(CartesianIter, TYPE_NAME)* it) { \
+    MAKE_NAME(set_iter_free, TYPE_NAME)(&it->ia); \
+    MAKE_NAME(set_iter_free, TYPE_NAME)(&it->ib); \
+    it->has_a = false; \
+} \
+\
+/* Calls fn for every pair; returns false if fn stopped early or memory ran out */ \
+static inline bool MAKE_NAME(set_cartesian_foreach, TYPE_NAME)(MAKE_NAME(Set, TYPE_NAME)* A, MAKE_NAME(Set, TYPE_NAME)* B, bool (*fn)(T a, T b, void* ctx), void* ctx) { \
+    MAKE_NAME(CartesianIter, TYPE_NAME) it; \
+    MAKE_NAME(set_cartesian_iter_init, TYPE_NAME)(&it, A, B); \
+    T a; \
+    T b; \
+    bool completed = true; \
+    while (MAKE_NAME(set_cartesian_next, TYPE_NAME)(&it, &a, &b)) { \
+        if (!fn(a, b, ctx)) { completed = false; break; } \
+    } \
+    if (MAKE_NAME(set_cartesian_iter_failed, TYPE_NAME)(&it)) completed = false; \
+    MAKE_NAME(set_cartesian_iter_free, TYPE_NAME)(&it); \
+    return completed; \
 }
 
 // For complex types like structs that need custom comparison and printing
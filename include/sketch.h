@@ -0,0 +1,449 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include "common.h"
+#include "hashmap.h"
+
+/*
+ * Probabilistic sketches for distinct counts and frequencies.
+ *
+ * HyperLogLog  - distinct count in 2^p bytes, relative error ~1.04/sqrt(2^p)
+ * CountMin     - per-key frequency that never undercounts; overcounts by at
+ *                most eps * total with probability 1 - delta
+ * SpaceSaving  - top-k heavy hitters in k entries; any key seen more than
+ *                total / k times is guaranteed to be tracked
+ *
+ * All three are mergeable: sketches built on separate threads or shards with
+ * the same parameters can be combined into one.
+ *
+ * Keys are hashed with the hashmap.h hash functions, then run through a
+ * 64-bit finalizer so that weak hashes (hash_int is the identity) still
+ * spread evenly. DEFINE_SKETCH(T, TYPE_NAME, HASH_FUNC, K_EQUAL) generates
+ * the typed entry points.
+ */
+
+#define HLL_MIN_PRECISION 4
+#define HLL_MAX_PRECISION 18
+#define HLL_DEFAULT_PRECISION 14
+
+// splitmix64 finalizer
+static inline uint64_t sketch_mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static inline int sketch_clz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? __builtin_clzll(x) : 64;
+#else
+    int n = 0;
+    if (!x) return 64;
+    while (!(x & 0x8000000000000000ULL)) { x <<= 1; n++; }
+    return n;
+#endif
+}
+
+/* ---------- HyperLogLog ---------- */
+
+typedef struct {
+    uint8_t* registers;
+    uint8_t precision;
+    size_t count;               // 2^precision
+} HyperLogLog;
+
+static inline bool hll_init(HyperLogLog* h, int precision) {
+    if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+        printf("HyperLogLog precision must be between %d and %d\n", HLL_MIN_PRECISION, HLL_MAX_PRECISION);
+        return false;
+    }
+    h->precision = (uint8_t)precision;
+    h->count = (size_t)1 << precision;
+    h->registers = (uint8_t*)calloc(h->count, 1);
+    if (!h->registers) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    return true;
+}
+
+static inline void hll_add_hash(HyperLogLog* h, uint64_t hash) {
+    size_t idx = (size_t)(hash >> (64 - h->precision));
+    uint64_t rest = (hash << h->precision) | ((uint64_t)1 << (h->precision - 1));
+    uint8_t rank = (uint8_t)(sketch_clz64(rest) + 1);
+    if (rank > h->registers[idx]) h->registers[idx] = rank;
+}
+
+static inline double hll_estimate(const HyperLogLog* h) {
+    double m = (double)h->count;
+    double alpha = (h->count == 16) ? 0.673 : (h->count == 32) ? 0.697 : (h->count == 64) ? 0.709 : 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < h->count; i++) {
+        sum += ldexp(1.0, -h->registers[i]);
+        zeros += h->registers[i] == 0;
+    }
+    double e = alpha * m * m / sum;
+    /* Small-range correction: linear counting while registers are still empty */
+    if (e <= 2.5 * m && zeros) e = m * log(m / (double)zeros);
+    return e;
+}
+
+// Folds src into dst (register-wise max); both need the same precision
+static inline bool hll_merge(HyperLogLog* dst, const HyperLogLog* src) {
+    if (dst->precision != src->precision) {
+        printf("Cannot merge HyperLogLogs of different precision\n");
+        return false;
+    }
+    for (size_t i = 0; i < dst->count; i++)
+        if (src->registers[i] > dst->registers[i]) dst->registers[i] = src->registers[i];
+    return true;
+}
+
+static inline void hll_clear(HyperLogLog* h) {
+    memset(h->registers, 0, h->count);
+}
+
+static inline size_t hll_memory_usage(const HyperLogLog* h) {
+    return sizeof(HyperLogLog) + h->count;
+}
+
+static inline void hll_free(HyperLogLog* h) {
+    free(h->registers);
+    h->registers = NULL;
+    h->count = 0;
+}
+
+/* ---------- Count-Min ---------- */
+
+typedef struct {
+    uint32_t* counters;         // depth rows of width counters
+    size_t width;
+    size_t depth;
+    uint64_t total;
+} CountMin;
+
+static inline bool cms_init(CountMin* c, size_t width, size_t depth) {
+    if (width == 0 || depth == 0) {
+        printf("CountMin width and depth must be positive\n");
+        return false;
+    }
+    c->counters = (uint32_t*)calloc(width * depth, sizeof(uint32_t));
+    if (!c->counters) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    c->width = width;
+    c->depth = depth;
+    c->total = 0;
+    return true;
+}
+
+// Sizes the sketch so estimates exceed the true count by at most eps * total with probability 1 - delta
+static inline bool cms_init_error(CountMin* c, double eps, double delta) {
+    if (eps <= 0.0 || delta <= 0.0 || delta >= 1.0) {
+        printf("CountMin needs eps > 0 and 0 < delta < 1\n");
+        return false;
+    }
+    return cms_init(c, (size_t)ceil(exp(1.0) / eps), (size_t)ceil(log(1.0 / delta)));
+}
+
+// Row i uses h1 + i * h2 (Kirsch-Mitzenmacher double hashing)
+static inline size_t cms_column(const CountMin* c, uint64_t hash, size_t row) {
+    uint64_t h1 = hash, h2 = (hash >> 32) | (hash << 32) | 1;
+    return (size_t)((h1 + row * h2) % c->width);
+}
+
+static inline void cms_add_hash(CountMin* c, uint64_t hash, uint32_t count) {
+    for (size_t r = 0; r < c->depth; r++) {
+        uint32_t* cell = &c->counters[r * c->width + cms_column(c, hash, r)];
+        *cell = (*cell > UINT32_MAX - count) ? UINT32_MAX : *cell + count;
+    }
+    c->total += count;
+}
+
+static inline uint32_t cms_estimate_hash(const CountMin* c, uint64_t hash) {
+    uint32_t best = UINT32_MAX;
+    for (size_t r = 0; r < c->depth; r++) {
+        uint32_t v = c->counters[r * c->width + cms_column(c, hash, r)];
+        if (v < best) best = v;
+    }
+    return best;
+}
+
+// Adds src's counters into dst; both need the same width and depth
+static inline bool cms_merge(CountMin* dst, const CountMin* src) {
+    if (dst->width != src->width || dst->depth != src->depth) {
+        printf("Cannot merge CountMin sketches of different dimensions\n");
+        return false;
+    }
+    for (size_t i = 0; i < dst->width * dst->depth; i++) {
+        uint32_t a = dst->counters[i], b = src->counters[i];
+        dst->counters[i] = (a > UINT32_MAX - b) ? UINT32_MAX : a + b;
+    }
+    dst->total += src->total;
+    return true;
+}
+
+static inline void cms_clear(CountMin* c) {
+    memset(c->counters, 0, c->width * c->depth * sizeof(uint32_t));
+    c->total = 0;
+}
+
+static inline size_t cms_memory_usage(const CountMin* c) {
+    return sizeof(CountMin) + c->width * c->depth * sizeof(uint32_t);
+}
+
+static inline void cms_free(CountMin* c) {
+    free(c->counters);
+    c->counters = NULL;
+    c->width = c->depth = 0;
+    c->total = 0;
+}
+
+/* ---------- typed wrappers and Space-Saving ---------- */
+
+#define SKETCH_EMPTY_SLOT UINT32_MAX
+
+#define DEFINE_SKETCH(T, TYPE_NAME, HASH_FUNC, K_EQUAL) \
+static inline uint64_t MAKE_NAME(sketch_hash, TYPE_NAME)(T key) { \
+    return sketch_mix64((uint64_t)HASH_FUNC(key)); \
+} \
+\
+static inline void MAKE_NAME(hll_add, TYPE_NAME)(HyperLogLog* h, T key) { \
+    hll_add_hash(h, MAKE_NAME(sketch_hash, TYPE_NAME)(key)); \
+} \
+\
+static inline void MAKE_NAME(cms_add, TYPE_NAME)(CountMin* c, T key, uint32_t count) { \
+    cms_add_hash(c, MAKE_NAME(sketch_hash, TYPE_NAME)(key), count); \
+} \
+\
+static inline uint32_t MAKE_NAME(cms_estimate, TYPE_NAME)(const CountMin* c, T key) { \
+    return cms_estimate_hash(c, MAKE_NAME(sketch_hash, TYPE_NAME)(key)); \
+} \
+\
+/* count overestimates the true frequency by at most error */ \
+typedef struct { \
+    T key; \
+    uint64_t count; \
+    uint64_t error; \
+    uint64_t hash; \
+    uint32_t slot; \
+} MAKE_NAME(SpaceSavingEntry, TYPE_NAME); \
+\
+/* Min-heap on count, plus an open-addressed index of heap positions */ \
+typedef struct { \
+    MAKE_NAME(SpaceSavingEntry, TYPE_NAME)* heap; \
+    size_t size; \
+    size_t capacity; \
+    uint32_t* index; \
+    size_t index_mask; \
+    uint64_t total; \
+} MAKE_NAME(SpaceSaving, TYPE_NAME); \
+\
+static inline bool MAKE_NAME(spacesaving_init, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* s, size_t k) { \
+    if (k == 0 || k >= SKETCH_EMPTY_SLOT / 2) { \
+        printf("SpaceSaving capacity out of range\n"); \
+        return false; \
+    } \
+    size_t slots = 4; \
+    while (slots < 2 * k) slots <<= 1; \
+    s->heap = (MAKE_NAME(SpaceSavingEntry, TYPE_NAME)*)malloc(k * sizeof(MAKE_NAME(SpaceSavingEntry, TYPE_NAME))); \
+    s->index = (uint32_t*)malloc(slots * sizeof(uint32_t)); \
+    if (!s->heap || !s->index) { \
+        printf("Memory allocation failed\n"); \
+        free(s->heap); \
+        free(s->index); \
+        return false; \
+    } \
+    memset(s->index, 0xff, slots * sizeof(uint32_t)); \
+    s->size = 0; \
+    s->capacity = k; \
+    s->index_mask = slots - 1; \
+    s->total = 0; \
+    return true; \
+} \
+\
+static inline void MAKE_NAME(spacesaving_free, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* s) { \
+    free(s->heap); \
+    free(s->index); \
+    s->heap = NULL; \
+    s->index = NULL; \
+    s->size = s->capacity = 0; \
+} \
+\
+static inline size_t MAKE_NAME(spacesaving_memory_usage, TYPE_NAME)(const MAKE_NAME(SpaceSaving, TYPE_NAME)* s) { \
+    return sizeof(*s) + s->capacity * sizeof(MAKE_NAME(SpaceSavingEntry, TYPE_NAME)) + (s->index_mask + 1) * sizeof(uint32_t); \
+} \
+\
+/* Index slot holding key, or the empty slot where it would go */ \
+static inline size_t MAKE_NAME(spacesaving_probe, TYPE_NAME)(const MAKE_NAME(SpaceSaving, TYPE_NAME)* s, T key, uint64_t hash) { \
+    size_t i = (size_t)hash & s->index_mask; \
+    while (s->index[i] != SKETCH_EMPTY_SLOT) { \
+        const MAKE_NAME(SpaceSavingEntry, TYPE_NAME)* e = &s->heap[s->index[i]]; \
+        if (e->hash == hash && K_EQUAL(e->key, key)) break; \
+        i = (i + 1) & s->index_mask; \
+    } \
+    return i; \
+} \
+\
+/* Backward-shift deletion keeps probe chains intact without tombstones */ \
+static inline void MAKE_NAME(spacesaving_unindex, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* s, size_t hole) { \
+    size_t i = hole; \
+    for (;;) { \
+        i = (i + 1) & s->index_mask; \
+        if (s->index[i] == SKETCH_EMPTY_SLOT) break; \
+        size_t home = (size_t)s->heap[s->index[i]].hash & s->index_mask; \
+        if (((i - home) & s->index_mask) >= ((i - hole) & s->index_mask)) { \
+            s->index[hole] = s->index[i]; \
+            s->heap[s->index[hole]].slot = (uint32_t)hole; \
+            hole = i; \
+        } \
+    } \
+    s->index[hole] = SKETCH_EMPTY_SLOT; \
+} \
+\
+static inline void MAKE_NAME(spacesaving_swap, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* s, size_t a, size_t b) { \
+    MAKE_NAME(SpaceSavingEntry, TYPE_NAME) tmp = s->heap[a]; \
+    s->heap[a] = s->heap[b]; \
+    s->heap[b] = tmp; \
+    s->index[s->heap[a].slot] = (uint32_t)a; \
+    s->index[s->heap[b].slot] = (uint32_t)b; \
+} \
+\
+static inline void MAKE_NAME(spacesaving_sift_up, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* s, size_t i) { \
+    while (i > 0 && s->heap[(i - 1) / 2].count > s->heap[i].count) { \
+        MAKE_NAME(spacesaving_swap, TYPE_NAME)(s, i, (i - 1) / 2); \
+        i = (i - 1) / 2; \
+    } \
+} \
+\
+static inline void MAKE_NAME(spacesaving_sift_down, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* s, size_t i) { \
+    for (;;) { \
+        size_t l = 2 * i + 1, r = l + 1, m = i; \
+        if (l < s->size && s->heap[l].count < s->heap[m].count) m = l; \
+        if (r < s->size && s->heap[r].count < s->heap[m].count) m = r; \
+        if (m == i) return; \
+        MAKE_NAME(spacesaving_swap, TYPE_NAME)(s, i, m); \
+        i = m; \
+    } \
+} \
+\
+static inline void MAKE_NAME(spacesaving_add, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* s, T key, uint64_t count) { \
+    uint64_t hash = MAKE_NAME(sketch_hash, TYPE_NAME)(key); \
+    size_t slot = MAKE_NAME(spacesaving_probe, TYPE_NAME)(s, key, hash); \
+    s->total += count; \
+    if (s->index[slot] != SKETCH_EMPTY_SLOT) { \
+        size_t pos = s->index[slot]; \
+        s->heap[pos].count += count; \
+        MAKE_NAME(spacesaving_sift_down, TYPE_NAME)(s, pos); \
+        return; \
+    } \
+    if (s->size < s->capacity) { \
+        size_t pos = s->size++; \
+        s->heap[pos] = (MAKE_NAME(SpaceSavingEntry, TYPE_NAME)){ key, count, 0, hash, (uint32_t)slot }; \
+        s->index[slot] = (uint32_t)pos; \
+        MAKE_NAME(spacesaving_sift_up, TYPE_NAME)(s, pos); \
+        return; \
+    } \
+    /* Full: the new key takes over the minimum entry and inherits its count as error */ \
+    uint64_t min = s->heap[0].count; \
+    MAKE_NAME(spacesaving_unindex, TYPE_NAME)(s, s->heap[0].slot); \
+    slot = MAKE_NAME(spacesaving_probe, TYPE_NAME)(s, key, hash); \
+    s->heap[0] = (MAKE_NAME(SpaceSavingEntry, TYPE_NAME)){ key, min + count, min, hash, (uint32_t)slot }; \
+    s->index[slot] = 0; \
+    MAKE_NAME(spacesaving_sift_down, TYPE_NAME)(s, 0); \
+} \
+\
+/* Smallest count an untracked key could have (0 until the summary is full) */ \
+static inline uint64_t MAKE_NAME(spacesaving_min, TYPE_NAME)(const MAKE_NAME(SpaceSaving, TYPE_NAME)* s) { \
+    return s->size == s->capacity ? s->heap[0].count : 0; \
+} \
+\
+/* Upper bound on key's frequency; *error (if given) bounds the overcount */ \
+static inline uint64_t MAKE_NAME(spacesaving_estimate, TYPE_NAME)(const MAKE_NAME(SpaceSaving, TYPE_NAME)* s, T key, uint64_t* error) { \
+    uint64_t hash = MAKE_NAME(sketch_hash, TYPE_NAME)(key); \
+    size_t slot = MAKE_NAME(spacesaving_probe, TYPE_NAME)(s, key, hash); \
+    if (s->index[slot] != SKETCH_EMPTY_SLOT) { \
+        if (error) *error = s->heap[s->index[slot]].error; \
+        return s->heap[s->index[slot]].count; \
+    } \
+    uint64_t min = MAKE_NAME(spacesaving_min, TYPE_NAME)(s); \
+    if (error) *error = min; \
+    return min; \
+} \
+\
+static inline int MAKE_NAME(spacesaving_cmp_desc, TYPE_NAME)(const void* a, const void* b) { \
+    uint64_t x = ((const MAKE_NAME(SpaceSavingEntry, TYPE_NAME)*)a)->count; \
+    uint64_t y = ((const MAKE_NAME(SpaceSavingEntry, TYPE_NAME)*)b)->count; \
+    return (x < y) - (x > y); \
+} \
+\
+/* Copies up to max entries into out, highest count first; returns the number copied */ \
+static inline size_t MAKE_NAME(spacesaving_top, TYPE_NAME)(const MAKE_NAME(SpaceSaving, TYPE_NAME)* s, \
+        MAKE_NAME(SpaceSavingEntry, TYPE_NAME)* out, size_t max) { \
+    MAKE_NAME(SpaceSavingEntry, TYPE_NAME)* tmp = (MAKE_NAME(SpaceSavingEntry, TYPE_NAME)*)malloc((s->size ? s->size : 1) * sizeof(*tmp)); \
+    if (!tmp) { \
+        printf("Memory allocation failed\n"); \
+        return 0; \
+    } \
+    memcpy(tmp, s->heap, s->size * sizeof(*tmp)); \
+    qsort(tmp, s->size, sizeof(*tmp), MAKE_NAME(spacesaving_cmp_desc, TYPE_NAME)); \
+    size_t n = s->size < max ? s->size : max; \
+    memcpy(out, tmp, n * sizeof(*tmp)); \
+    free(tmp); \
+    return n; \
+} \
+\
+/* Folds src into dst: counts are summed, a key missing on one side is charged that side's minimum as error */ \
+static inline bool MAKE_NAME(spacesaving_merge, TYPE_NAME)(MAKE_NAME(SpaceSaving, TYPE_NAME)* dst, const MAKE_NAME(SpaceSaving, TYPE_NAME)* src) { \
+    size_t n = dst->size + src->size; \
+    MAKE_NAME(SpaceSavingEntry, TYPE_NAME)* all = (MAKE_NAME(SpaceSavingEntry, TYPE_NAME)*)malloc((n ? n : 1) * sizeof(*all)); \
+    if (!all) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    uint64_t dst_min = MAKE_NAME(spacesaving_min, TYPE_NAME)(dst); \
+    size_t m = 0; \
+    for (size_t i = 0; i < dst->size; i++) { \
+        all[m] = dst->heap[i]; \
+        uint64_t err; \
+        all[m].count += MAKE_NAME(spacesaving_estimate, TYPE_NAME)(src, all[m].key, &err); \
+        all[m].error += err; \
+        m++; \
+    } \
+    for (size_t i = 0; i < src->size; i++) { \
+        size_t slot = MAKE_NAME(spacesaving_probe, TYPE_NAME)(dst, src->heap[i].key, src->heap[i].hash); \
+        if (dst->index[slot] != SKETCH_EMPTY_SLOT) continue; \
+        all[m] = src->heap[i]; \
+        all[m].count += dst_min; \
+        all[m].error += dst_min; \
+        m++; \
+    } \
+    qsort(all, m, sizeof(*all), MAKE_NAME(spacesaving_cmp_desc, TYPE_NAME)); \
+    if (m > dst->capacity) m = dst->capacity; \
+    uint64_t total = dst->total + src->total; \
+    memset(dst->index, 0xff, (dst->index_mask + 1) * sizeof(uint32_t)); \
+    /* Laid out in ascending order, the survivors already form a valid min-heap */ \
+    dst->size = 0; \
+    for (size_t i = m; i-- > 0;) { \
+        size_t pos = dst->size++; \
+        dst->heap[pos] = all[i]; \
+        size_t slot = MAKE_NAME(spacesaving_probe, TYPE_NAME)(dst, all[i].key, all[i].hash); \
+        dst->heap[pos].slot = (uint32_t)slot; \
+        dst->index[slot] = (uint32_t)pos; \
+    } \
+    dst->total = total; \
+    free(all); \
+    return true; \
+}
+
+// Convenient macros for the hashmap.h key types
+#define SKETCH_INT DEFINE_SKETCH(int, int, hash_int, INT_EQUAL)
+#define SKETCH_LONG DEFINE_SKETCH(long, long, hash_long, LONG_EQUAL)
+#define SKETCH_STRING DEFINE_SKETCH(char*, string, hash_string, STRING_EQUAL)
+
+#endif // SKETCH_H
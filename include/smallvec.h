@@ -0,0 +1,174 @@
+#ifndef SMALLVEC_H
+#define SMALLVEC_H
+
+#include "common.h"
+
+/*
+ * DEFINE_SMALLVEC(T, N) generates smallvec_T_N: a vec_T that keeps up to N
+ * elements inside the struct and only allocates when it outgrows them.
+ * The inline array and the heap pointer share storage; cap > N means heap.
+ * Once on the heap it stays there until free.
+ *
+ * DEFINE_SMALLSTACK(T, N) builds the stack API on top of it.
+ */
+
+#define DEFINE_SMALLVEC(T, N) \
+typedef struct { \
+ size_t len; \
+ size_t cap; \
+ union { \
+ T inline_buf[N]; \
+ T *heap; \
+ } u; \
+ } smallvec_##T##_##N; \
+\
+static inline void smallvec_##T##_##N##_init(smallvec_##T##_##N *v) { \
+ v->len = 0; \
+ v->cap = N; \
+ } \
+\
+static inline T *smallvec_##T##_##N##_data(smallvec_##T##_##N *v) { \
+return v->cap > N ? v->u.heap : v->u.inline_buf; \
+ } \
+\
+static inline bool smallvec_##T##_##N##_on_heap(const smallvec_##T##_##N *v) { \
+return v->cap > N; \
+ } \
+\
+/* Moves to (or grows) the heap buffer so that cap >= min_cap */ \
+static inline bool smallvec_##T##_##N##_grow(smallvec_##T##_##N *v, size_t min_cap) { \
+size_t new_cap = v->cap * 2; \
+if (new_cap < min_cap) new_cap = min_cap; \
+if (new_cap > SIZE_MAX / sizeof(T)) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+if (v->cap > N) { \
+ T *new_data = realloc(v->u.heap, new_cap * sizeof(T)); \
+if (!new_data) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+ v->u.heap = new_data; \
+ } else { \
+ T *new_data = malloc(new_cap * sizeof(T)); \
+if (!new_data) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+ memcpy(new_data, v->u.inline_buf, v->len * sizeof(T)); \
+ v->u.heap = new_data; \
+ } \
+ v->cap = new_cap; \
+return true; \
+ } \
+\
+static inline bool smallvec_##T##_##N##_reserve(smallvec_##T##_##N *v, size_t n) { \
+return n <= v->cap || smallvec_##T##_##N##_grow(v, n); \
+ } \
+\
+static inline void smallvec_##T##_##N##_push(smallvec_##T##_##N *v, T val) { \
+if (v->len >= v->cap && !smallvec_##T##_##N##_grow(v, v->len + 1)) return; \
+ smallvec_##T##_##N##_data(v)[v->len++] = val; \
+ } \
+\
+static inline T smallvec_##T##_##N##_get(smallvec_##T##_##N *v, size_t i) { \
+if (i >= v->len) { \
+printf("Invalid index %zu\n", i); \
+ T tmp = {0}; return tmp; \
+ } \
+return smallvec_##T##_##N##_data(v)[i]; \
+ } \
+\
+static inline void smallvec_##T##_##N##_set(smallvec_##T##_##N *v, size_t i, T item) { \
+if (i >= v->len) { \
+printf("Index out of bounds\n"); \
+return; \
+ } \
+ smallvec_##T##_##N##_data(v)[i] = item; \
+ } \
+\
+static inline void smallvec_##T##_##N##_insert(smallvec_##T##_##N *v, size_t i, T item) { \
+if (i > v->len) { \
+printf("Index out of bounds\n"); \
+return; \
+ } \
+if (v->len >= v->cap && !smallvec_##T##_##N##_grow(v, v->len + 1)) return; \
+ T *d = smallvec_##T##_##N##_data(v); \
+ memmove(d + i + 1, d + i, (v->len - i) * sizeof(T)); \
+ d[i] = item; \
+ v->len++; \
+ } \
+\
+static inline void smallvec_##T##_##N##_remove(smallvec_##T##_##N *v, size_t i) { \
+if (i >= v->len) { \
+printf("Index out of bounds\n"); \
+return; \
+ } \
+ T *d = smallvec_##T##_##N##_data(v); \
+ memmove(d + i, d + i + 1, (v->len - i - 1) * sizeof(T)); \
+ v->len--; \
+ } \
+\
+static inline T smallvec_##T##_##N##_pop(smallvec_##T##_##N *v) { \
+if (v->len == 0) { \
+printf("Invalid index 0\n"); \
+ T tmp = {0}; return tmp; \
+ } \
+return smallvec_##T##_##N##_data(v)[--v->len]; \
+ } \
+\
+static inline void smallvec_##T##_##N##_clear(smallvec_##T##_##N *v) { \
+ v->len = 0; \
+ } \
+\
+static inline void smallvec_##T##_##N##_free(smallvec_##T##_##N *v) { \
+if (v->cap > N) free(v->u.heap); \
+ v->len = 0; \
+ v->cap = N; \
+ }
+
+#define DEFINE_SMALLSTACK(T, N) \
+    typedef struct { \
+        smallvec_##T##_##N data; \
+    } smallstack_##T##_##N; \
+    \
+    static inline void smallstack_##T##_##N##_init(smallstack_##T##_##N *s) { \
+        smallvec_##T##_##N##_init(&s->data); \
+    } \
+    \
+    static inline void smallstack_##T##_##N##_push(smallstack_##T##_##N *s, T value) { \
+        smallvec_##T##_##N##_push(&s->data, value); \
+    } \
+    \
+    static inline T smallstack_##T##_##N##_pop(smallstack_##T##_##N *s) { \
+        if (s->data.len == 0) { \
+            printf("Stack underflow\n"); \
+            T tmp = {0}; \
+            return tmp; \
+        } \
+        return smallvec_##T##_##N##_pop(&s->data); \
+    } \
+    \
+    static inline T smallstack_##T##_##N##_peek(smallstack_##T##_##N *s) { \
+        if (s->data.len == 0) { \
+            printf("Stack is empty\n"); \
+            T tmp = {0}; \
+            return tmp; \
+        } \
+        return smallvec_##T##_##N##_data(&s->data)[s->data.len - 1]; \
+    } \
+    \
+    static inline int smallstack_##T##_##N##_empty(smallstack_##T##_##N *s) { \
+        return s->data.len == 0; \
+    } \
+    \
+    static inline size_t smallstack_##T##_##N##_size(smallstack_##T##_##N *s) { \
+        return s->data.len; \
+    } \
+    \
+    static inline void smallstack_##T##_##N##_free(smallstack_##T##_##N *s) { \
+        smallvec_##T##_##N##_free(&s->data); \
+    }
+
+#endif // SMALLVEC_H
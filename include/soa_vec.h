@@ -0,0 +1,202 @@
+#ifndef SOA_VEC_H
+#define SOA_VEC_H
+
+#include "common.h"
+
+/*
+ * DEFINE_SOA_VEC(Name, (T1, f1), (T2, f2), ...) generates soa_Name, a
+ * vector of the struct type Name stored as one array per field: member f1
+ * is a T1* holding every record's f1, and so on. All arrays share len and
+ * cap, and push/get/set/remove update them together. A scan over one field
+ * only reads that field's array.
+ *
+ * Name must be an existing struct type with members f1, f2, ... (up to
+ * SOA_MAX_FIELDS of them). DEFINE_SOA_VEC_CONVERT(Name) adds conversion
+ * to and from vec_Name and needs DEFINE_VEC(Name) first.
+ */
+
+#define SOA_MAX_FIELDS 16
+
+/* ---------- field list iteration ---------- */
+
+#define SOA_EXPAND(x) x
+#define SOA_CAT(a, b) SOA_CAT_(a, b)
+#define SOA_CAT_(a, b) a##b
+#define SOA_UNPACK(T, f) T, f
+
+// M(Name, T, f) for one (T, f) pair
+#define SOA_APPLY(M, Name, pair) SOA_APPLY_(M, Name, SOA_UNPACK pair)
+#define SOA_APPLY_(M, Name, ...) SOA_EXPAND(M(Name, __VA_ARGS__))
+
+#define SOA_NARGS(...) SOA_EXPAND(SOA_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+#define SOA_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+
+// Expands M(Name, T, f) once per field
+#define SOA_FOR_EACH(M, Name, ...) SOA_CAT(SOA_FE_, SOA_NARGS(__VA_ARGS__))(M, Name, __VA_ARGS__)
+#define SOA_FE_1(M, N, x) SOA_APPLY(M, N, x)
+#define SOA_FE_2(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_1(M, N, __VA_ARGS__))
+#define SOA_FE_3(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_2(M, N, __VA_ARGS__))
+#define SOA_FE_4(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_3(M, N, __VA_ARGS__))
+#define SOA_FE_5(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_4(M, N, __VA_ARGS__))
+#define SOA_FE_6(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_5(M, N, __VA_ARGS__))
+#define SOA_FE_7(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_6(M, N, __VA_ARGS__))
+#define SOA_FE_8(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_7(M, N, __VA_ARGS__))
+#define SOA_FE_9(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_8(M, N, __VA_ARGS__))
+#define SOA_FE_10(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_9(M, N, __VA_ARGS__))
+#define SOA_FE_11(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_10(M, N, __VA_ARGS__))
+#define SOA_FE_12(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_11(M, N, __VA_ARGS__))
+#define SOA_FE_13(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_12(M, N, __VA_ARGS__))
+#define SOA_FE_14(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_13(M, N, __VA_ARGS__))
+#define SOA_FE_15(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_14(M, N, __VA_ARGS__))
+#define SOA_FE_16(M, N, x, ...) SOA_APPLY(M, N, x) SOA_EXPAND(SOA_FE_15(M, N, __VA_ARGS__))
+
+/* ---------- per-field statements (s, n, i, item, r are in scope) ---------- */
+
+#define SOA_FIELD_DECL(Name, T, f) T *f;
+#define SOA_FIELD_INIT(Name, T, f) s->f = NULL;
+#define SOA_FIELD_FREE(Name, T, f) free(s->f); s->f = NULL;
+#define SOA_FIELD_REALLOC(Name, T, f) \
+    if (n > SIZE_MAX / sizeof(T)) ok = false; \
+    else { \
+        T *p_##f = (T *)realloc(s->f, n * sizeof(T)); \
+        if (p_##f) s->f = p_##f; \
+        else ok = false; \
+    }
+#define SOA_FIELD_STORE(Name, T, f) s->f[i] = item.f;
+#define SOA_FIELD_LOAD(Name, T, f) r.f = s->f[i];
+#define SOA_FIELD_ERASE(Name, T, f) memmove(s->f + i, s->f + i + 1, (s->len - i - 1) * sizeof(T));
+#define SOA_FIELD_MOVE_LAST(Name, T, f) s->f[i] = s->f[s->len - 1];
+#define SOA_FIELD_SIZE(Name, T, f) + sizeof(T)
+
+#define DEFINE_SOA_VEC(Name, ...) \
+typedef struct { \
+ size_t len; \
+ size_t cap; \
+ SOA_FOR_EACH(SOA_FIELD_DECL, Name, __VA_ARGS__) \
+ } soa_##Name; \
+\
+static inline void soa_##Name##_init(soa_##Name *s) { \
+ s->len = 0; \
+ s->cap = 0; \
+ SOA_FOR_EACH(SOA_FIELD_INIT, Name, __VA_ARGS__) \
+ } \
+\
+/* Bytes per record across all field arrays */ \
+static inline size_t soa_##Name##_record_size(void) { \
+return 0 SOA_FOR_EACH(SOA_FIELD_SIZE, Name, __VA_ARGS__); \
+ } \
+\
+/* Sets every field array's capacity to at least n. If one realloc fails the \
+   others keep their (larger) blocks, but cap stays at the old value. */ \
+static inline bool soa_##Name##_reserve(soa_##Name *s, size_t n) { \
+if (n <= s->cap) return true; \
+bool ok = true; \
+ SOA_FOR_EACH(SOA_FIELD_REALLOC, Name, __VA_ARGS__) \
+if (!ok) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+ s->cap = n; \
+return true; \
+ } \
+\
+static inline void soa_##Name##_push(soa_##Name *s, Name item) { \
+if (s->len >= s->cap && !soa_##Name##_reserve(s, s->cap ? s->cap * 2 : 4)) return; \
+size_t i = s->len++; \
+ SOA_FOR_EACH(SOA_FIELD_STORE, Name, __VA_ARGS__) \
+ } \
+\
+/* Reassembles record i; members of Name not listed as fields are zero */ \
+static inline Name soa_##Name##_get(const soa_##Name *s, size_t i) { \
+ Name r; \
+ memset(&r, 0, sizeof(r)); \
+if (i >= s->len) { \
+printf("Invalid index %zu\n", i); \
+return r; \
+ } \
+ SOA_FOR_EACH(SOA_FIELD_LOAD, Name, __VA_ARGS__) \
+return r; \
+ } \
+\
+static inline void soa_##Name##_set(soa_##Name *s, size_t i, Name item) { \
+if (i >= s->len) { \
+printf("Index out of bounds\n"); \
+return; \
+ } \
+ SOA_FOR_EACH(SOA_FIELD_STORE, Name, __VA_ARGS__) \
+ } \
+\
+static inline void soa_##Name##_remove(soa_##Name *s, size_t i) { \
+if (i >= s->len) { \
+printf("Index out of bounds\n"); \
+return; \
+ } \
+ SOA_FOR_EACH(SOA_FIELD_ERASE, Name, __VA_ARGS__) \
+ s->len--; \
+ } \
+\
+/* O(1) removal: moves the last record into slot i */ \
+static inline void soa_##Name##_swap_remove(soa_##Name *s, size_t i) { \
+if (i >= s->len) { \
+printf("Index out of bounds\n"); \
+return; \
+ } \
+ SOA_FOR_EACH(SOA_FIELD_MOVE_LAST, Name, __VA_ARGS__) \
+ s->len--; \
+ } \
+\
+static inline void soa_##Name##_clear(soa_##Name *s) { \
+ s->len = 0; \
+ } \
+\
+static inline void soa_##Name##_free(soa_##Name *s) { \
+ SOA_FOR_EACH(SOA_FIELD_FREE, Name, __VA_ARGS__) \
+ s->len = 0; \
+ s->cap = 0; \
+ } \
+\
+/* Appends n records from an array of structs, one reserve for all of them */ \
+static inline bool soa_##Name##_push_array(soa_##Name *s, const Name *src, size_t n) { \
+if (n > SIZE_MAX - s->len) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+if (s->len + n > s->cap && !soa_##Name##_reserve(s, s->len + n)) return false; \
+for (size_t k = 0; k < n; k++) { \
+size_t i = s->len + k; \
+ Name item = src[k]; \
+ SOA_FOR_EACH(SOA_FIELD_STORE, Name, __VA_ARGS__) \
+ } \
+ s->len += n; \
+return true; \
+ } \
+\
+/* Writes all len records to dst as an array of structs */ \
+static inline void soa_##Name##_to_array(const soa_##Name *s, Name *dst) { \
+for (size_t i = 0; i < s->len; i++) { \
+ Name r; \
+ memset(&r, 0, sizeof(r)); \
+ SOA_FOR_EACH(SOA_FIELD_LOAD, Name, __VA_ARGS__) \
+ dst[i] = r; \
+ } \
+ }
+
+#define DEFINE_SOA_VEC_CONVERT(Name) \
+/* Appends every record of v */ \
+static inline bool soa_##Name##_from_vec(soa_##Name *s, const vec_##Name *v) { \
+return soa_##Name##_push_array(s, v->data, v->len); \
+ } \
+\
+/* Appends every record of s to out */ \
+static inline bool soa_##Name##_to_vec(const soa_##Name *s, vec_##Name *out) { \
+if (s->len > SIZE_MAX - out->len) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+if (!vec_##Name##_reserve(out, out->len + s->len)) return false; \
+ soa_##Name##_to_array(s, out->data + out->len); \
+ out->len += s->len; \
+return true; \
+ }
+
+#endif // SOA_VEC_H
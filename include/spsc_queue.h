@@ -0,0 +1,236 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include "common.h"
+#include "park.h"
+
+/*
+ * DEFINE_SPSC_QUEUE(T) generates spsc_queue_T, a bounded ring buffer for
+ * exactly one producer thread and one consumer thread. push and pop are
+ * wait-free: one release store of the thread's own index, and a load of
+ * the other thread's index only when the cached copy says the ring looks
+ * full (producer) or empty (consumer). The producer's and the consumer's
+ * fields sit on separate cache lines, so the two threads only share a
+ * line when one of them actually has to look at the other's index.
+ *
+ * push_wait / pop_wait and the batch variants block: they spin for
+ * SPSC_QUEUE_SPIN rounds, then sleep on a futex (Linux; elsewhere they
+ * yield). Waking a sleeper costs the other side a fence and a load per
+ * publish, so it is only done for queues initialized with
+ * SPSC_QUEUE_BLOCKING; without it the waits keep spinning and yielding.
+ */
+
+#define SPSC_QUEUE_CACHE_LINE 64
+// Busy-wait rounds before a blocking call sleeps
+#define SPSC_QUEUE_SPIN 64
+
+// Init flags
+#define SPSC_QUEUE_BLOCKING 1   /* push_wait / pop_wait may sleep; publishing wakes sleepers */
+
+/*
+ * One side of the sleep handshake. The sleeper announces itself, then
+ * rechecks; the publisher stores its index, then checks for a sleeper.
+ * The seq_cst fences on both sides guarantee at least one sees the other.
+ */
+typedef struct {
+    _Atomic uint32_t word;      /* bumped on every wake; the futex word */
+    atomic_int sleeping;
+} SpscQueueWaiter;
+
+// Clearing the flag here means later publishes skip the wake until the sleeper sets it again
+static inline void spsc_queue_notify(SpscQueueWaiter* w) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&w->sleeping, memory_order_relaxed) && atomic_exchange_explicit(&w->sleeping, 0, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&w->word, 1, memory_order_release);
+        park_wake(&w->word, 1);
+    }
+}
+
+#define DEFINE_SPSC_QUEUE(T) \
+typedef struct { \
+    /* Producer line */ \
+    _Alignas(SPSC_QUEUE_CACHE_LINE) _Atomic size_t tail; \
+    size_t cached_head;         /* producer's last view of head */ \
+    /* Consumer line */ \
+    _Alignas(SPSC_QUEUE_CACHE_LINE) _Atomic size_t head; \
+    size_t cached_tail;         /* consumer's last view of tail */ \
+    /* Read-only after init */ \
+    _Alignas(SPSC_QUEUE_CACHE_LINE) T* data; \
+    size_t mask; \
+    int flags; \
+    _Alignas(SPSC_QUEUE_CACHE_LINE) SpscQueueWaiter items;     /* consumer sleeps here */ \
+    _Alignas(SPSC_QUEUE_CACHE_LINE) SpscQueueWaiter space;     /* producer sleeps here */ \
+} spsc_queue_##T; \
+\
+/* capacity is rounded up to a power of two; flags is 0 or SPSC_QUEUE_BLOCKING */ \
+static inline bool spsc_queue_##T##_init(spsc_queue_##T* q, size_t capacity, int flags) { \
+    size_t cap = 2; \
+    while (cap < capacity) { \
+        if (cap > SIZE_MAX / 2 / sizeof(T)) { \
+            printf("Memory allocation failed\n"); \
+            return false; \
+        } \
+        cap *= 2; \
+    } \
+    q->data = (T*)malloc(cap * sizeof(T)); \
+    if (!q->data) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    q->mask = cap - 1; \
+    q->flags = flags; \
+    atomic_init(&q->tail, 0); \
+    atomic_init(&q->head, 0); \
+    q->cached_head = q->cached_tail = 0; \
+    atomic_init(&q->items.word, 0); \
+    atomic_init(&q->items.sleeping, 0); \
+    atomic_init(&q->space.word, 0); \
+    atomic_init(&q->space.sleeping, 0); \
+    return true; \
+} \
+\
+static inline size_t spsc_queue_##T##_capacity(const spsc_queue_##T* q) { \
+    return q->mask + 1; \
+} \
+\
+/* Free slots as seen by the producer (refreshes the cached head only if needed) */ \
+static inline size_t spsc_queue_##T##_free_slots(spsc_queue_##T* q, size_t t, size_t want) { \
+    size_t cap = q->mask + 1; \
+    size_t free_slots = cap - (t - q->cached_head); \
+    if (free_slots < want) { \
+        q->cached_head = atomic_load_explicit(&q->head, memory_order_acquire); \
+        free_slots = cap - (t - q->cached_head); \
+    } \
+    return free_slots; \
+} \
+\
+/* Items available to the consumer (refreshes the cached tail only if needed) */ \
+static inline size_t spsc_queue_##T##_ready(spsc_queue_##T* q, size_t h, size_t want) { \
+    size_t ready = q->cached_tail - h; \
+    if (ready < want) { \
+        q->cached_tail = atomic_load_explicit(&q->tail, memory_order_acquire); \
+        ready = q->cached_tail - h; \
+    } \
+    return ready; \
+} \
+\
+/* Producer only. false if the queue is full */ \
+static inline bool spsc_queue_##T##_push(spsc_queue_##T* q, T item) { \
+    size_t t = atomic_load_explicit(&q->tail, memory_order_relaxed); \
+    if (spsc_queue_##T##_free_slots(q, t, 1) == 0) return false; \
+    q->data[t & q->mask] = item; \
+    atomic_store_explicit(&q->tail, t + 1, memory_order_release); \
+    if (q->flags & SPSC_QUEUE_BLOCKING) spsc_queue_notify(&q->items); \
+    return true; \
+} \
+\
+/* Producer only. Pushes as many of items[0..n) as fit, with one publish; returns how many */ \
+static inline size_t spsc_queue_##T##_push_n(spsc_queue_##T* q, const T* items, size_t n) { \
+    size_t t = atomic_load_explicit(&q->tail, memory_order_relaxed); \
+    size_t free_slots = spsc_queue_##T##_free_slots(q, t, n); \
+    if (n > free_slots) n = free_slots; \
+    if (n == 0) return 0; \
+    size_t start = t & q->mask; \
+    size_t first = q->mask + 1 - start < n ? q->mask + 1 - start : n; \
+    memcpy(q->data + start, items, first * sizeof(T)); \
+    memcpy(q->data, items + first, (n - first) * sizeof(T)); \
+    atomic_store_explicit(&q->tail, t + n, memory_order_release); \
+    if (q->flags & SPSC_QUEUE_BLOCKING) spsc_queue_notify(&q->items); \
+    return n; \
+} \
+\
+/* Consumer only. false if the queue is empty */ \
+static inline bool spsc_queue_##T##_pop(spsc_queue_##T* q, T* out) { \
+    size_t h = atomic_load_explicit(&q->head, memory_order_relaxed); \
+    if (spsc_queue_##T##_ready(q, h, 1) == 0) return false; \
+    *out = q->data[h & q->mask]; \
+    atomic_store_explicit(&q->head, h + 1, memory_order_release); \
+    if (q->flags & SPSC_QUEUE_BLOCKING) spsc_queue_notify(&q->space); \
+    return true; \
+} \
+\
+/* Consumer only. Pops up to n items into out, with one publish; returns how many */ \
+static inline size_t spsc_queue_##T##_pop_n(spsc_queue_##T* q, T* out, size_t n) { \
+    size_t h = atomic_load_explicit(&q->head, memory_order_relaxed); \
+    size_t ready = spsc_queue_##T##_ready(q, h, n); \
+    if (n > ready) n = ready; \
+    if (n == 0) return 0; \
+    size_t start = h & q->mask; \
+    size_t first = q->mask + 1 - start < n ? q->mask + 1 - start : n; \
+    memcpy(out, q->data + start, first * sizeof(T)); \
+    memcpy(out + first, q->data, (n - first) * sizeof(T)); \
+    atomic_store_explicit(&q->head, h + n, memory_order_release); \
+    if (q->flags & SPSC_QUEUE_BLOCKING) spsc_queue_notify(&q->space); \
+    return n; \
+} \
+\
+/* Waits until check(q) is true: spins, then sleeps on w if the queue is blocking */ \
+static inline void spsc_queue_##T##_wait(spsc_queue_##T* q, SpscQueueWaiter* w, bool (*check)(spsc_queue_##T*)) { \
+    for (int i = 0; i < SPSC_QUEUE_SPIN; i++) { \
+        if (check(q)) return; \
+        park_cpu_relax(); \
+    } \
+    while (!check(q)) { \
+        if (!(q->flags & SPSC_QUEUE_BLOCKING)) { \
+            park_yield(); \
+            continue; \
+        } \
+        uint32_t seen = atomic_load_explicit(&w->word, memory_order_acquire); \
+        atomic_store_explicit(&w->sleeping, 1, memory_order_relaxed); \
+        atomic_thread_fence(memory_order_seq_cst); \
+        if (!check(q)) park_sleep(&w->word, seen); \
+        atomic_store_explicit(&w->sleeping, 0, memory_order_relaxed); \
+    } \
+} \
+\
+static inline bool spsc_queue_##T##_has_space(spsc_queue_##T* q) { \
+    return spsc_queue_##T##_free_slots(q, atomic_load_explicit(&q->tail, memory_order_relaxed), 1) > 0; \
+} \
+\
+static inline bool spsc_queue_##T##_has_items(spsc_queue_##T* q) { \
+    return spsc_queue_##T##_ready(q, atomic_load_explicit(&q->head, memory_order_relaxed), 1) > 0; \
+} \
+\
+/* Producer only. Pushes item, waiting for space */ \
+static inline void spsc_queue_##T##_push_wait(spsc_queue_##T* q, T item) { \
+    while (!spsc_queue_##T##_push(q, item)) spsc_queue_##T##_wait(q, &q->space, spsc_queue_##T##_has_space); \
+} \
+\
+/* Producer only. Pushes all of items[0..n), waiting for space as needed */ \
+static inline void spsc_queue_##T##_push_n_wait(spsc_queue_##T* q, const T* items, size_t n) { \
+    while (n > 0) { \
+        size_t k = spsc_queue_##T##_push_n(q, items, n); \
+        items += k; \
+        n -= k; \
+        if (n > 0) spsc_queue_##T##_wait(q, &q->space, spsc_queue_##T##_has_space); \
+    } \
+} \
+\
+/* Consumer only. Pops one item, waiting for it */ \
+static inline T spsc_queue_##T##_pop_wait(spsc_queue_##T* q) { \
+    T item; \
+    while (!spsc_queue_##T##_pop(q, &item)) spsc_queue_##T##_wait(q, &q->items, spsc_queue_##T##_has_items); \
+    return item; \
+} \
+\
+/* Consumer only. Waits for at least one item, then pops up to n; returns how many */ \
+static inline size_t spsc_queue_##T##_pop_n_wait(spsc_queue_##T* q, T* out, size_t n) { \
+    if (n == 0) return 0; \
+    size_t k; \
+    while ((k = spsc_queue_##T##_pop_n(q, out, n)) == 0) spsc_queue_##T##_wait(q, &q->items, spsc_queue_##T##_has_items); \
+    return k; \
+} \
+\
+/* Items queued; exact only when neither thread is running */ \
+static inline size_t spsc_queue_##T##_size(spsc_queue_##T* q) { \
+    size_t h = atomic_load_explicit(&q->head, memory_order_acquire); \
+    return atomic_load_explicit(&q->tail, memory_order_acquire) - h; \
+} \
+\
+static inline void spsc_queue_##T##_free(spsc_queue_##T* q) { \
+    free(q->data); \
+    q->data = NULL; \
+    q->mask = 0; \
+}
+
+#endif // SPSC_QUEUE_H
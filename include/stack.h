@@ -17,6 +17,19 @@
         vec_##T##_push(&s->data, value); \
     } \
     \
+    /* Push n values in order, so items[n - 1] ends up on top */ \
+    static inline bool stack_##T##_push_n(stack_##T *s, const T *items, size_t n) { \
+        return vec_##T##_extend(&s->data, items, n); \
+    } \
+    \
+    static inline bool stack_##T##_reserve(stack_##T *s, size_t n) { \
+        return vec_##T##_reserve(&s->data, n); \
+    } \
+    \
+    static inline void stack_##T##_shrink_to_fit(stack_##T *s) { \
+        vec_##T##_shrink_to_fit(&s->data); \
+    } \
+    \
     static inline T stack_##T##_pop(stack_##T *s) { \
         if (s->data.len == 0) { \
             printf("Stack underflow\n"); \
@@ -26,16 +39,8 @@
         T value = s->data.data[s->data.len - 1]; \
         s->data.len--; \
         \
-        /* Shrink if necessary */ \
-        if (s->data.len > 0 && s->data.len <= s->data.cap / 4) { \
-            size_t new_cap = s->data.cap / 2; \
-            if (new_cap < 4) new_cap = 4; \
-            T *new_data = realloc(s->data.data, new_cap * sizeof(T)); \
-            if (new_data) { \
-                s->data.data = new_data; \
-                s->data.cap = new_cap; \
-            } \
-        } \
+        /* Shrink according to the vec_T policy */ \
+        vec_##T##_maybe_shrink(&s->data); \
         \
         return value; \
     } \
@@ -53,6 +58,32 @@
         return stack_##T##_peek(s); \
     } \
     \
+    /* Pointer to the top element, NULL when empty; invalidated by push/pop */ \
+    static inline T *stack_##T##_peek_ptr(stack_##T *s) { \
+        if (s->data.len == 0) { \
+            printf("Stack is empty\n"); \
+            return NULL; \
+        } \
+        return &s->data.data[s->data.len - 1]; \
+    } \
+    \
+    /* Pushes an uninitialized slot and returns it to be filled in place */ \
+    static inline T *stack_##T##_emplace(stack_##T *s) { \
+        return vec_##T##_emplace_back(&s->data); \
+    } \
+    \
+    /* Pops into *out (if not NULL) instead of returning by value */ \
+    static inline bool stack_##T##_pop_into(stack_##T *s, T *out) { \
+        if (s->data.len == 0) { \
+            printf("Stack underflow\n"); \
+            return false; \
+        } \
+        if (out) *out = s->data.data[s->data.len - 1]; \
+        s->data.len--; \
+        vec_##T##_maybe_shrink(&s->data); \
+        return true; \
+    } \
+    \
     static inline int stack_##T##_empty(stack_##T *s) { \
         return s->data.len == 0; \
     } \
@@ -4,10 +4,29 @@
 
 #include "common.h"
 #include "vector.h"
+#include "vec_numeric.h"
+#include "vec_sort.h"
+#include "smallvec.h"
+#include "soa_vec.h"
+#include "packed_vec.h"
+#include "matrix.h"
+#include "gapbuf.h"
+#include "rope.h"
+#include "prefix_tree.h"
 #include "list.h"
 #include "hashmap.h"
 #include "queue.h"
+#include "pqueue.h"
+#include "deque.h"
 #include "set.h"
 #include "stack.h"
+#include "roaring.h"
+#include "art.h"
+#include "sketch.h"
+#ifndef __STDC_NO_ATOMICS__
+#include "concurrent_skiplist.h"
+#include "spsc_queue.h"
+#include "mpmc_queue.h"
+#endif
 
 #endif
@@ -0,0 +1,578 @@
+#ifndef VEC_NUMERIC_H
+#define VEC_NUMERIC_H
+
+#include "common.h"
+#include "vector.h"
+
+/*
+ * Numeric kernels for int, float and double arrays, and vec_T wrappers for
+ * them (DEFINE_VEC_NUMERIC(T) after DEFINE_VEC(T)).
+ *
+ * Each kernel has an AVX2 body and a scalar body; the AVX2 one is picked at
+ * run time when the CPU supports it. The two bodies perform the same
+ * operations in the same order, so results are bit-identical whichever runs:
+ *   - element-wise kernels (scale, add, axpy, clamp) and comparisons are
+ *     exact per element (axpy is a multiply then an add, never fused)
+ *   - float/double sum and dot accumulate in double over 8 fixed lanes
+ *     (lane j takes elements 8k + j), combine the lanes pairwise, then add
+ *     the tail in order. This differs in the last bits from a plain
+ *     sequential loop but not between CPUs.
+ *   - int sum and dot accumulate in 64 bits and are exact
+ * Int scale/add/axpy wrap on overflow. Float min/max skip NaNs (an all-NaN
+ * array gives NaN). The one exception to bit-identity: when both +0 and -0
+ * are the minimum (maximum), min (max) may return either. argmin/argmax
+ * return the first index that compares equal to it (0 if every element is
+ * NaN), which is the same on both paths.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NUMERIC_X86 1
+#endif
+
+#define NUMERIC_NOT_FOUND SIZE_MAX
+
+// Result type of sum and dot
+#define NUMERIC_ACC_int long long
+#define NUMERIC_ACC_float double
+#define NUMERIC_ACC_double double
+
+/*
+ * -1: not probed yet, 0: scalar, 1: AVX2. Atomic so that threads may run
+ * kernels (and flip the switch) concurrently; relaxed is enough because the
+ * value is a pure hint. Being static, it is per translation unit: the
+ * numeric_use_simd switch only affects kernels called from the same file.
+ */
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+static _Atomic int numeric_simd_level = -1;
+#define NUMERIC_SIMD_LOAD() atomic_load_explicit(&numeric_simd_level, memory_order_relaxed)
+#define NUMERIC_SIMD_STORE(v) atomic_store_explicit(&numeric_simd_level, (v), memory_order_relaxed)
+#else
+static volatile int numeric_simd_level = -1;
+#define NUMERIC_SIMD_LOAD() numeric_simd_level
+#define NUMERIC_SIMD_STORE(v) (numeric_simd_level = (v))
+#endif
+
+static inline bool numeric_has_avx2(void) {
+    int level = NUMERIC_SIMD_LOAD();
+    if (level < 0) {
+#ifdef NUMERIC_X86
+        level = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+        level = 0;
+#endif
+        NUMERIC_SIMD_STORE(level);
+    }
+    return level == 1;
+}
+
+// Forces the scalar kernels (false) or restores run-time detection (true), for this translation unit
+static inline void numeric_use_simd(bool enable) {
+    NUMERIC_SIMD_STORE(enable ? -1 : 0);
+}
+
+static inline size_t numeric_ctz(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctz(x);
+#else
+    size_t n = 0;
+    while (!(x & 1u)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+static inline size_t numeric_popcount(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcount(x);
+#else
+    size_t n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+#endif
+}
+
+/* ---------- scalar kernels (all types) ---------- */
+
+// Wrapping arithmetic for int; plain arithmetic for floating types
+#define NUMERIC_WRAP_ADD_int(a, b) ((int)((unsigned)(a) + (unsigned)(b)))
+#define NUMERIC_WRAP_MUL_int(a, b) ((int)((unsigned)(a) * (unsigned)(b)))
+#define NUMERIC_WRAP_ADD_float(a, b) ((a) + (b))
+#define NUMERIC_WRAP_MUL_float(a, b) ((a) * (b))
+#define NUMERIC_WRAP_ADD_double(a, b) ((a) + (b))
+#define NUMERIC_WRAP_MUL_double(a, b) ((a) * (b))
+
+#define NUMERIC_IS_NAN_int(x) 0
+#define NUMERIC_IS_NAN_float(x) isnan(x)
+#define NUMERIC_IS_NAN_double(x) isnan(x)
+
+#define NUMERIC_DEFINE_SCALAR(T) \
+/* Starts from the first non-NaN element; comparisons with NaN are false, so later NaNs are skipped */ \
+static inline T numeric_min_##T##_scalar(const T* a, size_t n) { \
+    size_t i = 0; \
+    while (i + 1 < n && NUMERIC_IS_NAN_##T(a[i])) i++; \
+    T m = a[i]; \
+    for (i++; i < n; i++) m = a[i] < m ? a[i] : m; \
+    return m; \
+} \
+\
+static inline T numeric_max_##T##_scalar(const T* a, size_t n) { \
+    size_t i = 0; \
+    while (i + 1 < n && NUMERIC_IS_NAN_##T(a[i])) i++; \
+    T m = a[i]; \
+    for (i++; i < n; i++) m = a[i] > m ? a[i] : m; \
+    return m; \
+} \
+\
+static inline size_t numeric_find_##T##_scalar(const T* a, size_t n, T value) { \
+    for (size_t i = 0; i < n; i++) \
+        if (a[i] == value) return i; \
+    return NUMERIC_NOT_FOUND; \
+} \
+\
+static inline size_t numeric_count_##T##_scalar(const T* a, size_t n, T value) { \
+    size_t c = 0; \
+    for (size_t i = 0; i < n; i++) c += a[i] == value; \
+    return c; \
+} \
+\
+static inline void numeric_scale_##T##_scalar(T* x, size_t n, T alpha) { \
+    for (size_t i = 0; i < n; i++) x[i] = NUMERIC_WRAP_MUL_##T(x[i], alpha); \
+} \
+\
+static inline void numeric_add_##T##_scalar(T* dst, const T* src, size_t n) { \
+    for (size_t i = 0; i < n; i++) dst[i] = NUMERIC_WRAP_ADD_##T(dst[i], src[i]); \
+} \
+\
+static inline void numeric_axpy_##T##_scalar(T* y, T alpha, const T* x, size_t n) { \
+    for (size_t i = 0; i < n; i++) { \
+        T p = NUMERIC_WRAP_MUL_##T(alpha, x[i]); \
+        y[i] = NUMERIC_WRAP_ADD_##T(y[i], p); \
+    } \
+} \
+\
+static inline void numeric_clamp_##T##_scalar(T* x, size_t n, T lo, T hi) { \
+    for (size_t i = 0; i < n; i++) { \
+        T t = x[i] < hi ? x[i] : hi; \
+        x[i] = t > lo ? t : lo; \
+    } \
+}
+
+NUMERIC_DEFINE_SCALAR(int)
+NUMERIC_DEFINE_SCALAR(float)
+NUMERIC_DEFINE_SCALAR(double)
+
+static inline long long numeric_sum_int_scalar(const int* a, size_t n) {
+    long long s = 0;
+    for (size_t i = 0; i < n; i++) s += a[i];
+    return s;
+}
+
+static inline long long numeric_dot_int_scalar(const int* a, const int* b, size_t n) {
+    long long s = 0;
+    for (size_t i = 0; i < n; i++) s += (long long)a[i] * b[i];
+    return s;
+}
+
+// The 8-lane order shared with the AVX2 kernels: (l0+l4 + l2+l6) + (l1+l5 + l3+l7)
+static inline double numeric_combine_lanes(const double acc[8]) {
+    double s0 = acc[0] + acc[4], s1 = acc[1] + acc[5], s2 = acc[2] + acc[6], s3 = acc[3] + acc[7];
+    return (s0 + s2) + (s1 + s3);
+}
+
+#define NUMERIC_DEFINE_SCALAR_FLOATING(T) \
+static inline double numeric_sum_##T##_scalar(const T* a, size_t n) { \
+    double acc[8] = { 0 }; \
+    size_t i = 0; \
+    for (; i + 8 <= n; i += 8) \
+        for (int j = 0; j < 8; j++) acc[j] += (double)a[i + j]; \
+    double s = numeric_combine_lanes(acc); \
+    for (; i < n; i++) s += (double)a[i]; \
+    return s; \
+} \
+\
+static inline double numeric_dot_##T##_scalar(const T* a, const T* b, size_t n) { \
+    double acc[8] = { 0 }; \
+    size_t i = 0; \
+    for (; i + 8 <= n; i += 8) \
+        for (int j = 0; j < 8; j++) { \
+            double p = (double)a[i + j] * (double)b[i + j]; \
+            acc[j] += p; \
+        } \
+    double s = numeric_combine_lanes(acc); \
+    for (; i < n; i++) { \
+        double p = (double)a[i] * (double)b[i]; \
+        s += p; \
+    } \
+    return s; \
+}
+
+NUMERIC_DEFINE_SCALAR_FLOATING(float)
+NUMERIC_DEFINE_SCALAR_FLOATING(double)
+
+/* ---------- AVX2 kernels ---------- */
+
+#ifdef NUMERIC_X86
+
+#define NUMERIC_INT_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define NUMERIC_INT_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+#define NUMERIC_INT_SET1(x) _mm256_set1_epi32(x)
+#define NUMERIC_INT_MIN(a, b) _mm256_min_epi32(a, b)
+#define NUMERIC_INT_MAX(a, b) _mm256_max_epi32(a, b)
+#define NUMERIC_INT_ADD(a, b) _mm256_add_epi32(a, b)
+#define NUMERIC_INT_MUL(a, b) _mm256_mullo_epi32(a, b)
+#define NUMERIC_INT_EQMASK(a, b) (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))
+
+#define NUMERIC_FLOAT_LOAD(p) _mm256_loadu_ps(p)
+#define NUMERIC_FLOAT_STORE(p, v) _mm256_storeu_ps(p, v)
+#define NUMERIC_FLOAT_SET1(x) _mm256_set1_ps(x)
+#define NUMERIC_FLOAT_MIN(a, b) _mm256_min_ps(a, b)
+#define NUMERIC_FLOAT_MAX(a, b) _mm256_max_ps(a, b)
+#define NUMERIC_FLOAT_ADD(a, b) _mm256_add_ps(a, b)
+#define NUMERIC_FLOAT_MUL(a, b) _mm256_mul_ps(a, b)
+#define NUMERIC_FLOAT_EQMASK(a, b) (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))
+
+#define NUMERIC_DOUBLE_LOAD(p) _mm256_loadu_pd(p)
+#define NUMERIC_DOUBLE_STORE(p, v) _mm256_storeu_pd(p, v)
+#define NUMERIC_DOUBLE_SET1(x) _mm256_set1_pd(x)
+#define NUMERIC_DOUBLE_MIN(a, b) _mm256_min_pd(a, b)
+#define NUMERIC_DOUBLE_MAX(a, b) _mm256_max_pd(a, b)
+#define NUMERIC_DOUBLE_ADD(a, b) _mm256_add_pd(a, b)
+#define NUMERIC_DOUBLE_MUL(a, b) _mm256_mul_pd(a, b)
+#define NUMERIC_DOUBLE_EQMASK(a, b) (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))
+
+/* Element-wise and search kernels; reductions fold vector lanes first, then the tail */
+#define NUMERIC_DEFINE_AVX2(T, VT, LANES, P) \
+__attribute__((target("avx2"))) \
+static inline T numeric_min_##T##_avx2(const T* a, size_t n) { \
+    size_t i = 0; \
+    while (i + 1 < n && NUMERIC_IS_NAN_##T(a[i])) i++; \
+    if (n - i < LANES) return numeric_min_##T##_scalar(a + i, n - i); \
+    /* m starts NaN-free, and P##_MIN(x, m) returns m when x is NaN */ \
+    VT m = P##_SET1(a[i]); \
+    for (; i + LANES <= n; i += LANES) m = P##_MIN(P##_LOAD(a + i), m); \
+    T lanes[LANES]; \
+    P##_STORE(lanes, m); \
+    T r = numeric_min_##T##_scalar(lanes, LANES); \
+    for (; i < n; i++) r = a[i] < r ? a[i] : r; \
+    return r; \
+} \
+\
+__attribute__((target("avx2"))) \
+static inline T numeric_max_##T##_avx2(const T* a, size_t n) { \
+    size_t i = 0; \
+    while (i + 1 < n && NUMERIC_IS_NAN_##T(a[i])) i++; \
+    if (n - i < LANES) return numeric_max_##T##_scalar(a + i, n - i); \
+    /* m starts NaN-free, and P##_MAX(x, m) returns m when x is NaN */ \
+    VT m = P##_SET1(a[i]); \
+    for (; i + LANES <= n; i += LANES) m = P##_MAX(P##_LOAD(a + i), m); \
+    T lanes[LANES]; \
+    P##_STORE(lanes, m); \
+    T r = numeric_max_##T##_scalar(lanes, LANES); \
+    for (; i < n; i++) r = a[i] > r ? a[i] : r; \
+    return r; \
+} \
+\
+__attribute__((target("avx2"))) \
+static inline size_t numeric_find_##T##_avx2(const T* a, size_t n, T value) { \
+    VT v = P##_SET1(value); \
+    size_t i = 0; \
+    for (; i + LANES <= n; i += LANES) { \
+        unsigned mask = P##_EQMASK(P##_LOAD(a + i), v); \
+        if (mask) return i + numeric_ctz(mask); \
+    } \
+    size_t r = numeric_find_##T##_scalar(a + i, n - i, value); \
+    return r == NUMERIC_NOT_FOUND ? r : i + r; \
+} \
+\
+__attribute__((target("avx2"))) \
+static inline size_t numeric_count_##T##_avx2(const T* a, size_t n, T value) { \
+    VT v = P##_SET1(value); \
+    size_t c = 0, i = 0; \
+    for (; i + LANES <= n; i += LANES) c += numeric_popcount(P##_EQMASK(P##_LOAD(a + i), v)); \
+    return c + numeric_count_##T##_scalar(a + i, n - i, value); \
+} \
+\
+__attribute__((target("avx2"))) \
+static inline void numeric_scale_##T##_avx2(T* x, size_t n, T alpha) { \
+    VT va = P##_SET1(alpha); \
+    size_t i = 0; \
+    for (; i + LANES <= n; i += LANES) P##_STORE(x + i, P##_MUL(P##_LOAD(x + i), va)); \
+    numeric_scale_##T##_scalar(x + i, n - i, alpha); \
+} \
+\
+__attribute__((target("avx2"))) \
+static inline void numeric_add_##T##_avx2(T* dst, const T* src, size_t n) { \
+    size_t i = 0; \
+    for (; i + LANES <= n; i += LANES) P##_STORE(dst + i, P##_ADD(P##_LOAD(dst + i), P##_LOAD(src + i))); \
+    numeric_add_##T##_scalar(dst + i, src + i, n - i); \
+} \
+\
+__attribute__((target("avx2"))) \
+static inline void numeric_axpy_##T##_avx2(T* y, T alpha, const T* x, size_t n) { \
+    VT va = P##_SET1(alpha); \
+    size_t i = 0; \
+    for (; i + LANES <= n; i += LANES) P##_STORE(y + i, P##_ADD(P##_LOAD(y + i), P##_MUL(va, P##_LOAD(x + i)))); \
+    numeric_axpy_##T##_scalar(y + i, alpha, x + i, n - i); \
+} \
+\
+__attribute__((target("avx2"))) \
+static inline void numeric_clamp_##T##_avx2(T* x, size_t n, T lo, T hi) { \
+    VT vlo = P##_SET1(lo), vhi = P##_SET1(hi); \
+    size_t i = 0; \
+    for (; i + LANES <= n; i += LANES) P##_STORE(x + i, P##_MAX(P##_MIN(P##_LOAD(x + i), vhi), vlo)); \
+    numeric_clamp_##T##_scalar(x + i, n - i, lo, hi); \
+}
+
+NUMERIC_DEFINE_AVX2(int, __m256i, 8, NUMERIC_INT)
+NUMERIC_DEFINE_AVX2(float, __m256, 8, NUMERIC_FLOAT)
+NUMERIC_DEFINE_AVX2(double, __m256d, 4, NUMERIC_DOUBLE)
+
+__attribute__((target("avx2")))
+static inline long long numeric_hsum_epi64(__m256i v) {
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx2")))
+static inline long long numeric_sum_int_avx2(const int* a, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    return numeric_hsum_epi64(_mm256_add_epi64(acc0, acc1)) + numeric_sum_int_scalar(a + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static inline long long numeric_dot_int_avx2(const int* a, const int* b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(a + i)));
+        __m256i vb = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(b + i)));
+        acc = _mm256_add_epi64(acc, _mm256_mul_epi32(va, vb));
+    }
+    return numeric_hsum_epi64(acc) + numeric_dot_int_scalar(a + i, b + i, n - i);
+}
+
+// Folds two 4-lane accumulators in the numeric_combine_lanes order
+__attribute__((target("avx2")))
+static inline double numeric_combine_pd(__m256d acc0, __m256d acc1) {
+    __m256d s = _mm256_add_pd(acc0, acc1);
+    __m128d t = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    return _mm_cvtsd_f64(t) + _mm_cvtsd_f64(_mm_unpackhi_pd(t, t));
+}
+
+__attribute__((target("avx2")))
+static inline double numeric_sum_float_avx2(const float* a, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(a + i);
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    double s = numeric_combine_pd(acc0, acc1);
+    for (; i < n; i++) s += (double)a[i];
+    return s;
+}
+
+__attribute__((target("avx2")))
+static inline double numeric_sum_double_avx2(const double* a, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4));
+    }
+    double s = numeric_combine_pd(acc0, acc1);
+    for (; i < n; i++) s += a[i];
+    return s;
+}
+
+__attribute__((target("avx2")))
+static inline double numeric_dot_float_avx2(const float* a, const float* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i), vb = _mm256_loadu_ps(b + i);
+        __m256d p0 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(va)), _mm256_cvtps_pd(_mm256_castps256_ps128(vb)));
+        __m256d p1 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(va, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(vb, 1)));
+        acc0 = _mm256_add_pd(acc0, p0);
+        acc1 = _mm256_add_pd(acc1, p1);
+    }
+    double s = numeric_combine_pd(acc0, acc1);
+    for (; i < n; i++) {
+        double p = (double)a[i] * (double)b[i];
+        s += p;
+    }
+    return s;
+}
+
+__attribute__((target("avx2")))
+static inline double numeric_dot_double_avx2(const double* a, const double* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    double s = numeric_combine_pd(acc0, acc1);
+    for (; i < n; i++) {
+        double p = a[i] * b[i];
+        s += p;
+    }
+    return s;
+}
+
+#define NUMERIC_DISPATCH(NAME, T, ...) \
+    return numeric_has_avx2() ? NAME##_##T##_avx2(__VA_ARGS__) : NAME##_##T##_scalar(__VA_ARGS__)
+#else
+#define NUMERIC_DISPATCH(NAME, T, ...) return NAME##_##T##_scalar(__VA_ARGS__)
+#endif // NUMERIC_X86
+
+/* ---------- dispatched kernels on raw arrays ---------- */
+
+#define NUMERIC_DEFINE_KERNELS(T) \
+static inline NUMERIC_ACC_##T numeric_sum_##T(const T* a, size_t n) { \
+    NUMERIC_DISPATCH(numeric_sum, T, a, n); \
+} \
+\
+static inline NUMERIC_ACC_##T numeric_dot_##T(const T* a, const T* b, size_t n) { \
+    NUMERIC_DISPATCH(numeric_dot, T, a, b, n); \
+} \
+\
+/* min/max of an empty array is 0 */ \
+static inline T numeric_min_##T(const T* a, size_t n) { \
+    if (n == 0) return 0; \
+    NUMERIC_DISPATCH(numeric_min, T, a, n); \
+} \
+\
+static inline T numeric_max_##T(const T* a, size_t n) { \
+    if (n == 0) return 0; \
+    NUMERIC_DISPATCH(numeric_max, T, a, n); \
+} \
+\
+static inline size_t numeric_find_##T(const T* a, size_t n, T value) { \
+    NUMERIC_DISPATCH(numeric_find, T, a, n, value); \
+} \
+\
+static inline size_t numeric_count_##T(const T* a, size_t n, T value) { \
+    NUMERIC_DISPATCH(numeric_count, T, a, n, value); \
+} \
+\
+static inline bool numeric_contains_##T(const T* a, size_t n, T value) { \
+    return numeric_find_##T(a, n, value) != NUMERIC_NOT_FOUND; \
+} \
+\
+/* \
+ * First index of the minimum / maximum, NaNs skipped: 0 if every element is \
+ * NaN, NUMERIC_NOT_FOUND only if empty. \
+ */ \
+static inline size_t numeric_argmin_##T(const T* a, size_t n) { \
+    if (n == 0) return NUMERIC_NOT_FOUND; \
+    size_t i = numeric_find_##T(a, n, numeric_min_##T(a, n)); \
+    return i == NUMERIC_NOT_FOUND ? 0 : i; \
+} \
+\
+static inline size_t numeric_argmax_##T(const T* a, size_t n) { \
+    if (n == 0) return NUMERIC_NOT_FOUND; \
+    size_t i = numeric_find_##T(a, n, numeric_max_##T(a, n)); \
+    return i == NUMERIC_NOT_FOUND ? 0 : i; \
+} \
+\
+static inline void numeric_scale_##T(T* x, size_t n, T alpha) { \
+    NUMERIC_DISPATCH(numeric_scale, T, x, n, alpha); \
+} \
+\
+static inline void numeric_add_##T(T* dst, const T* src, size_t n) { \
+    NUMERIC_DISPATCH(numeric_add, T, dst, src, n); \
+} \
+\
+/* y[i] += alpha * x[i] */ \
+static inline void numeric_axpy_##T(T* y, T alpha, const T* x, size_t n) { \
+    NUMERIC_DISPATCH(numeric_axpy, T, y, alpha, x, n); \
+} \
+\
+static inline void numeric_clamp_##T(T* x, size_t n, T lo, T hi) { \
+    NUMERIC_DISPATCH(numeric_clamp, T, x, n, lo, hi); \
+}
+
+NUMERIC_DEFINE_KERNELS(int)
+NUMERIC_DEFINE_KERNELS(float)
+NUMERIC_DEFINE_KERNELS(double)
+
+/* ---------- vec_T wrappers (T = int, float or double) ---------- */
+
+#define DEFINE_VEC_NUMERIC(T) \
+static inline NUMERIC_ACC_##T vec_##T##_sum(const vec_##T *v) { \
+return numeric_sum_##T(v->data, v->len); \
+ } \
+\
+static inline T vec_##T##_min(const vec_##T *v) { \
+if (v->len == 0) printf("Vector is empty\n"); \
+return numeric_min_##T(v->data, v->len); \
+ } \
+\
+static inline T vec_##T##_max(const vec_##T *v) { \
+if (v->len == 0) printf("Vector is empty\n"); \
+return numeric_max_##T(v->data, v->len); \
+ } \
+\
+static inline size_t vec_##T##_argmin(const vec_##T *v) { \
+return numeric_argmin_##T(v->data, v->len); \
+ } \
+\
+static inline size_t vec_##T##_argmax(const vec_##T *v) { \
+return numeric_argmax_##T(v->data, v->len); \
+ } \
+\
+static inline NUMERIC_ACC_##T vec_##T##_dot(const vec_##T *a, const vec_##T *b) { \
+if (a->len != b->len) { \
+printf("Vector length mismatch\n"); \
+return 0; \
+ } \
+return numeric_dot_##T(a->data, b->data, a->len); \
+ } \
+\
+static inline void vec_##T##_axpy(vec_##T *y, T alpha, const vec_##T *x) { \
+if (y->len != x->len) { \
+printf("Vector length mismatch\n"); \
+return; \
+ } \
+ numeric_axpy_##T(y->data, alpha, x->data, y->len); \
+ } \
+\
+static inline void vec_##T##_scale(vec_##T *v, T alpha) { \
+ numeric_scale_##T(v->data, v->len, alpha); \
+ } \
+\
+static inline void vec_##T##_add(vec_##T *dst, const vec_##T *src) { \
+if (dst->len != src->len) { \
+printf("Vector length mismatch\n"); \
+return; \
+ } \
+ numeric_add_##T(dst->data, src->data, dst->len); \
+ } \
+\
+static inline size_t vec_##T##_count(const vec_##T *v, T value) { \
+return numeric_count_##T(v->data, v->len, value); \
+ } \
+\
+static inline size_t vec_##T##_find(const vec_##T *v, T value) { \
+return numeric_find_##T(v->data, v->len, value); \
+ } \
+\
+static inline bool vec_##T##_contains(const vec_##T *v, T value) { \
+return numeric_contains_##T(v->data, v->len, value); \
+ } \
+\
+static inline void vec_##T##_clamp(vec_##T *v, T lo, T hi) { \
+ numeric_clamp_##T(v->data, v->len, lo, hi); \
+ }
+
+#endif // VEC_NUMERIC_H
@@ -0,0 +1,424 @@
+#ifndef VEC_SORT_H
+#define VEC_SORT_H
+
+#include "common.h"
+#include "vector.h"
+
+#if !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+#define VEC_SORT_HAS_THREADS 1
+#endif
+
+/*
+ * Sorting for vec_T, generated per element type so the comparison inlines.
+ *
+ * DEFINE_VEC_SORT(T) orders with <. DEFINE_VEC_SORT_CUSTOM(T, CMP_FUNC)
+ * takes a comparator returning <0, 0, >0, as for DEFINE_SET_CUSTOM; it may
+ * be a function or a macro taking two T values. Either generates:
+ *   vec_T_sort       pattern-defeating quicksort (unstable, in place)
+ *   vec_T_par_sort   sample sort over C11 threads for large vectors
+ *   vec_T_is_sorted
+ *
+ * DEFINE_VEC_RADIX_SORT(T) generates vec_T_radix_sort, an LSD radix sort
+ * for integer, float and double element types (stable, O(n) extra memory).
+ */
+
+#define VEC_SORT_DEFAULT_CMP(a, b) (((a) < (b)) ? -1 : ((a) > (b)) ? 1 : 0)
+
+#define VEC_SORT_INSERTION_THRESHOLD 24
+#define VEC_SORT_NINTHER_THRESHOLD 128
+#define VEC_SORT_PARTIAL_INSERTION_LIMIT 8
+
+// vec_T_par_sort sorts smaller vectors on the calling thread
+#define VEC_SORT_PARALLEL_MIN ((size_t)1 << 20)
+#define VEC_SORT_MAX_THREADS 64
+// Samples taken per bucket when choosing sample sort splitters
+#define VEC_SORT_OVERSAMPLE 32
+
+#define VEC_SORT_SWAP(T, a, b) do { T vec_sort_tmp_ = *(a); *(a) = *(b); *(b) = vec_sort_tmp_; } while (0)
+
+static inline int vec_sort_log2(size_t n) {
+    int log = 0;
+    while (n >>= 1) log++;
+    return log;
+}
+
+#ifdef VEC_SORT_HAS_THREADS
+// Runs fn on each of n workers (stride bytes apart), one thread each;
+// a worker whose thread cannot be spawned runs on the calling thread
+static inline void vec_sort_parallel_run(size_t n, int (*fn)(void*), void* workers, size_t stride) {
+    thrd_t threads[VEC_SORT_MAX_THREADS];
+    bool spawned[VEC_SORT_MAX_THREADS];
+    for (size_t i = 0; i < n; i++) {
+        void* arg = (char*)workers + i * stride;
+        spawned[i] = thrd_create(&threads[i], fn, arg) == thrd_success;
+        if (!spawned[i]) fn(arg);
+    }
+    for (size_t i = 0; i < n; i++)
+        if (spawned[i]) thrd_join(threads[i], NULL);
+}
+#endif
+
+#define DEFINE_VEC_SORT(T) DEFINE_VEC_SORT_CUSTOM(T, VEC_SORT_DEFAULT_CMP)
+
+#define DEFINE_VEC_SORT_CUSTOM(T, CMP_FUNC) \
+static inline void vec_##T##_insertion_sort(T* begin, T* end, bool leftmost) { \
+    if (begin == end) return; \
+    for (T* cur = begin + 1; cur != end; cur++) { \
+        T* sift = cur; \
+        T* sift_1 = cur - 1; \
+        if (CMP_FUNC(*sift, *sift_1) < 0) { \
+            T tmp = *sift; \
+            /* Unless leftmost, *(begin - 1) is a sentinel no greater than any element */ \
+            do { *sift-- = *sift_1; } while ((!leftmost || sift != begin) && (--sift_1, CMP_FUNC(tmp, *sift_1) < 0)); \
+            *sift = tmp; \
+        } \
+    } \
+} \
+\
+/* Insertion sort that gives up after a few moves; true if it finished */ \
+static inline bool vec_##T##_partial_insertion_sort(T* begin, T* end) { \
+    if (begin == end) return true; \
+    size_t limit = 0; \
+    for (T* cur = begin + 1; cur != end; cur++) { \
+        T* sift = cur; \
+        T* sift_1 = cur - 1; \
+        if (CMP_FUNC(*sift, *sift_1) < 0) { \
+            T tmp = *sift; \
+            do { *sift-- = *sift_1; } while (sift != begin && (--sift_1, CMP_FUNC(tmp, *sift_1) < 0)); \
+            *sift = tmp; \
+            limit += (size_t)(cur - sift); \
+        } \
+        if (limit > VEC_SORT_PARTIAL_INSERTION_LIMIT) return false; \
+    } \
+    return true; \
+} \
+\
+static inline void vec_##T##_sift_down(T* a, size_t i, size_t n) { \
+    T x = a[i]; \
+    for (size_t child; (child = 2 * i + 1) < n; i = child) { \
+        if (child + 1 < n && CMP_FUNC(a[child], a[child + 1]) < 0) child++; \
+        if (CMP_FUNC(x, a[child]) >= 0) break; \
+        a[i] = a[child]; \
+    } \
+    a[i] = x; \
+} \
+\
+static inline void vec_##T##_heap_sort(T* begin, T* end) { \
+    size_t n = (size_t)(end - begin); \
+    for (size_t i = n / 2; i-- > 0;) vec_##T##_sift_down(begin, i, n); \
+    for (size_t i = n; i-- > 1;) { \
+        VEC_SORT_SWAP(T, begin, begin + i); \
+        vec_##T##_sift_down(begin, 0, i); \
+    } \
+} \
+\
+static inline void vec_##T##_sort2(T* a, T* b) { \
+    if (CMP_FUNC(*b, *a) < 0) VEC_SORT_SWAP(T, a, b); \
+} \
+\
+static inline void vec_##T##_sort3(T* a, T* b, T* c) { \
+    vec_##T##_sort2(a, b); \
+    vec_##T##_sort2(b, c); \
+    vec_##T##_sort2(a, b); \
+} \
+\
+/* Partitions around *begin into [< pivot] pivot [>= pivot]; returns the pivot position */ \
+static inline T* vec_##T##_partition_right(T* begin, T* end, bool* already_partitioned) { \
+    T pivot = *begin; \
+    T* first = begin; \
+    T* last = end; \
+    while ((++first, CMP_FUNC(*first, pivot)) < 0); \
+    if (first - 1 == begin) while (first < last && (--last, CMP_FUNC(*last, pivot)) >= 0); \
+    else while ((--last, CMP_FUNC(*last, pivot)) >= 0); \
+    *already_partitioned = first >= last; \
+    while (first < last) { \
+        VEC_SORT_SWAP(T, first, last); \
+        while ((++first, CMP_FUNC(*first, pivot)) < 0); \
+        while ((--last, CMP_FUNC(*last, pivot)) >= 0); \
+    } \
+    T* pivot_pos = first - 1; \
+    *begin = *pivot_pos; \
+    *pivot_pos = pivot; \
+    return pivot_pos; \
+} \
+\
+/* Partitions into [<= pivot] pivot [> pivot]; used when the pivot equals its predecessor */ \
+static inline T* vec_##T##_partition_left(T* begin, T* end) { \
+    T pivot = *begin; \
+    T* first = begin; \
+    T* last = end; \
+    while ((--last, CMP_FUNC(pivot, *last)) < 0); \
+    if (last + 1 == end) while (first < last && (++first, CMP_FUNC(pivot, *first)) >= 0); \
+    else while ((++first, CMP_FUNC(pivot, *first)) >= 0); \
+    while (first < last) { \
+        VEC_SORT_SWAP(T, first, last); \
+        while ((--last, CMP_FUNC(pivot, *last)) < 0); \
+        while ((++first, CMP_FUNC(pivot, *first)) >= 0); \
+    } \
+    *begin = *last; \
+    *last = pivot; \
+    return last; \
+} \
+\
+static inline void vec_##T##_pdqsort_loop(T* begin, T* end, int bad_allowed, bool leftmost) { \
+    for (;;) { \
+        size_t size = (size_t)(end - begin); \
+        if (size < VEC_SORT_INSERTION_THRESHOLD) { \
+            vec_##T##_insertion_sort(begin, end, leftmost); \
+            return; \
+        } \
+        size_t s2 = size / 2; \
+        if (size > VEC_SORT_NINTHER_THRESHOLD) { \
+            vec_##T##_sort3(begin, begin + s2, end - 1); \
+            vec_##T##_sort3(begin + 1, begin + (s2 - 1), end - 2); \
+            vec_##T##_sort3(begin + 2, begin + (s2 + 1), end - 3); \
+            vec_##T##_sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1)); \
+            VEC_SORT_SWAP(T, begin, begin + s2); \
+        } else { \
+            vec_##T##_sort3(begin + s2, begin, end - 1); \
+        } \
+        /* Many equal elements: put them all on the left and skip them */ \
+        if (!leftmost && CMP_FUNC(*(begin - 1), *begin) >= 0) { \
+            begin = vec_##T##_partition_left(begin, end) + 1; \
+            continue; \
+        } \
+        bool already_partitioned; \
+        T* pivot_pos = vec_##T##_partition_right(begin, end, &already_partitioned); \
+        size_t l_size = (size_t)(pivot_pos - begin); \
+        size_t r_size = (size_t)(end - (pivot_pos + 1)); \
+        if (l_size < size / 8 || r_size < size / 8) { \
+            /* Bad split: fall back to heap sort eventually, else break up patterns */ \
+            if (--bad_allowed == 0) { \
+                vec_##T##_heap_sort(begin, end); \
+                return; \
+            } \
+            if (l_size >= VEC_SORT_INSERTION_THRESHOLD) { \
+                VEC_SORT_SWAP(T, begin, begin + l_size / 4); \
+                VEC_SORT_SWAP(T, pivot_pos - 1, pivot_pos - l_size / 4); \
+                if (l_size > VEC_SORT_NINTHER_THRESHOLD) { \
+                    VEC_SORT_SWAP(T, begin + 1, begin + (l_size / 4 + 1)); \
+                    VEC_SORT_SWAP(T, begin + 2, begin + (l_size / 4 + 2)); \
+                    VEC_SORT_SWAP(T, pivot_pos - 2, pivot_pos - (l_size / 4 + 1)); \
+                    VEC_SORT_SWAP(T, pivot_pos - 3, pivot_pos - (l_size / 4 + 2)); \
+                } \
+            } \
+            if (r_size >= VEC_SORT_INSERTION_THRESHOLD) { \
+                VEC_SORT_SWAP(T, pivot_pos + 1, pivot_pos + (1 + r_size / 4)); \
+                VEC_SORT_SWAP(T, end - 1, end - r_size / 4); \
+                if (r_size > VEC_SORT_NINTHER_THRESHOLD) { \
+                    VEC_SORT_SWAP(T, pivot_pos + 2, pivot_pos + (2 + r_size / 4)); \
+                    VEC_SORT_SWAP(T, pivot_pos + 3, pivot_pos + (3 + r_size / 4)); \
+                    VEC_SORT_SWAP(T, end - 2, end - (1 + r_size / 4)); \
+                    VEC_SORT_SWAP(T, end - 3, end - (2 + r_size / 4)); \
+                } \
+            } \
+        } else if (already_partitioned && vec_##T##_partial_insertion_sort(begin, pivot_pos) \
+                   && vec_##T##_partial_insertion_sort(pivot_pos + 1, end)) { \
+            /* Input looked sorted and the guess was right */ \
+            return; \
+        } \
+        vec_##T##_pdqsort_loop(begin, pivot_pos, bad_allowed, leftmost); \
+        begin = pivot_pos + 1; \
+        leftmost = false; \
+    } \
+} \
+\
+static inline void vec_##T##_sort_array(T* a, size_t n) { \
+    if (n > 1) vec_##T##_pdqsort_loop(a, a + n, vec_sort_log2(n), true); \
+} \
+\
+static inline void vec_##T##_sort(vec_##T* v) { \
+    vec_##T##_sort_array(v->data, v->len); \
+} \
+\
+static inline bool vec_##T##_is_sorted(const vec_##T* v) { \
+    for (size_t i = 1; i < v->len; i++) \
+        if (CMP_FUNC(v->data[i], v->data[i - 1]) < 0) return false; \
+    return true; \
+} \
+\
+VEC_DEFINE_PAR_SORT(T, CMP_FUNC)
+
+/*
+ * Sample sort: splitters from a sorted sample cut the input into one bucket
+ * per thread; threads count and scatter their slice into the buckets, then
+ * each thread sorts one bucket.
+ */
+#ifdef VEC_SORT_HAS_THREADS
+#define VEC_DEFINE_PAR_SORT(T, CMP_FUNC) \
+typedef struct { \
+    T* data; \
+    T* tmp; \
+    uint8_t* bucket; \
+    const T* splitters; \
+    size_t nsplit; \
+    size_t lo, hi; \
+    size_t counts[VEC_SORT_MAX_THREADS]; \
+} VecSortWorker_##T; \
+\
+/* Number of splitters <= x, so equal elements share a bucket */ \
+static inline size_t vec_##T##_bucket_of(const T* splitters, size_t nsplit, T x) { \
+    size_t lo = 0, hi = nsplit; \
+    while (lo < hi) { \
+        size_t mid = (lo + hi) / 2; \
+        if (CMP_FUNC(x, splitters[mid]) < 0) hi = mid; \
+        else lo = mid + 1; \
+    } \
+    return lo; \
+} \
+\
+static inline int vec_##T##_par_classify(void* arg) { \
+    VecSortWorker_##T* w = (VecSortWorker_##T*)arg; \
+    memset(w->counts, 0, sizeof(w->counts)); \
+    for (size_t i = w->lo; i < w->hi; i++) { \
+        size_t b = vec_##T##_bucket_of(w->splitters, w->nsplit, w->data[i]); \
+        w->bucket[i] = (uint8_t)b; \
+        w->counts[b]++; \
+    } \
+    return 0; \
+} \
+\
+/* counts[] holds this slice's start offset in each bucket by now */ \
+static inline int vec_##T##_par_scatter(void* arg) { \
+    VecSortWorker_##T* w = (VecSortWorker_##T*)arg; \
+    for (size_t i = w->lo; i < w->hi; i++) w->tmp[w->counts[w->bucket[i]]++] = w->data[i]; \
+    return 0; \
+} \
+\
+static inline int vec_##T##_par_sort_bucket(void* arg) { \
+    VecSortWorker_##T* w = (VecSortWorker_##T*)arg; \
+    vec_##T##_sort_array(w->tmp + w->lo, w->hi - w->lo); \
+    memcpy(w->data + w->lo, w->tmp + w->lo, (w->hi - w->lo) * sizeof(T)); \
+    return 0; \
+} \
+\
+static inline void vec_##T##_par_sort(vec_##T* v, size_t nthreads) { \
+    size_t n = v->len; \
+    if (nthreads > VEC_SORT_MAX_THREADS) nthreads = VEC_SORT_MAX_THREADS; \
+    if (nthreads < 2 || n < VEC_SORT_PARALLEL_MIN) { \
+        vec_##T##_sort(v); \
+        return; \
+    } \
+    size_t nsample = nthreads * VEC_SORT_OVERSAMPLE; \
+    T* tmp = (T*)malloc(n * sizeof(T)); \
+    uint8_t* bucket = (uint8_t*)malloc(n); \
+    T* sample = (T*)malloc(nsample * sizeof(T)); \
+    VecSortWorker_##T* w = (VecSortWorker_##T*)malloc(nthreads * sizeof(*w)); \
+    if (!tmp || !bucket || !sample || !w) { \
+        /* Still sort, just on this thread */ \
+        free(tmp); free(bucket); free(sample); free(w); \
+        vec_##T##_sort(v); \
+        return; \
+    } \
+    for (size_t i = 0; i < nsample; i++) sample[i] = v->data[i * (n / nsample)]; \
+    vec_##T##_sort_array(sample, nsample); \
+    size_t nsplit = nthreads - 1; \
+    for (size_t i = 0; i < nsplit; i++) sample[i] = sample[(i + 1) * VEC_SORT_OVERSAMPLE]; \
+    for (size_t t = 0; t < nthreads; t++) { \
+        w[t].data = v->data; \
+        w[t].tmp = tmp; \
+        w[t].bucket = bucket; \
+        w[t].splitters = sample; \
+        w[t].nsplit = nsplit; \
+        w[t].lo = n / nthreads * t; \
+        w[t].hi = t + 1 == nthreads ? n : n / nthreads * (t + 1); \
+    } \
+    vec_sort_parallel_run(nthreads, vec_##T##_par_classify, w, sizeof(*w)); \
+    /* Bucket b starts after all smaller buckets; within it, slices go in thread order */ \
+    size_t starts[VEC_SORT_MAX_THREADS + 1]; \
+    size_t pos = 0; \
+    for (size_t b = 0; b < nthreads; b++) { \
+        starts[b] = pos; \
+        for (size_t t = 0; t < nthreads; t++) { \
+            size_t c = w[t].counts[b]; \
+            w[t].counts[b] = pos; \
+            pos += c; \
+        } \
+    } \
+    starts[nthreads] = n; \
+    vec_sort_parallel_run(nthreads, vec_##T##_par_scatter, w, sizeof(*w)); \
+    for (size_t b = 0; b < nthreads; b++) { \
+        w[b].lo = starts[b]; \
+        w[b].hi = starts[b + 1]; \
+    } \
+    vec_sort_parallel_run(nthreads, vec_##T##_par_sort_bucket, w, sizeof(*w)); \
+    free(w); \
+    free(sample); \
+    free(bucket); \
+    free(tmp); \
+}
+#else
+#define VEC_DEFINE_PAR_SORT(T, CMP_FUNC) \
+static inline void vec_##T##_par_sort(vec_##T* v, size_t nthreads) { \
+    (void)nthreads; \
+    vec_##T##_sort(v); \
+}
+#endif
+
+/* ---------- LSD radix sort ---------- */
+
+// Order-preserving unsigned keys: negative floats have every bit flipped,
+// positive floats only the sign bit, so -0.0 sorts before +0.0
+static inline uint64_t vec_radix_key_float(float x) {
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u ^ ((u >> 31) ? 0xFFFFFFFFu : 0x80000000u);
+}
+
+static inline uint64_t vec_radix_key_double(double x) {
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u ^ ((u >> 63) ? ~(uint64_t)0 : (uint64_t)1 << 63);
+}
+
+static inline uint64_t vec_radix_key_integer(uint64_t x) {
+    return x;
+}
+
+#define VEC_RADIX_IS_FLOATING(T) _Generic((T)0, float: 1, double: 1, default: 0)
+
+#define DEFINE_VEC_RADIX_SORT(T) \
+static inline uint64_t vec_##T##_radix_key(T x) { \
+    uint64_t k = _Generic(x, float: vec_radix_key_float, double: vec_radix_key_double, \
+                          default: vec_radix_key_integer)(x); \
+    /* Signed integers: flip the sign bit so negatives come first */ \
+    if (!VEC_RADIX_IS_FLOATING(T) && (T)-1 < (T)1) k ^= (uint64_t)1 << (sizeof(T) * 8 - 1); \
+    return k; \
+} \
+\
+/* One byte per pass, skipping bytes that are the same in every key; false if out of memory */ \
+static inline bool vec_##T##_radix_sort(vec_##T* v) { \
+    size_t n = v->len; \
+    if (n < 2) return true; \
+    T* tmp = (T*)malloc(n * sizeof(T)); \
+    if (!tmp) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    size_t counts[sizeof(T)][256]; \
+    memset(counts, 0, sizeof(counts)); \
+    for (size_t i = 0; i < n; i++) { \
+        uint64_t k = vec_##T##_radix_key(v->data[i]); \
+        for (size_t b = 0; b < sizeof(T); b++) counts[b][(k >> (8 * b)) & 0xFF]++; \
+    } \
+    T* src = v->data; \
+    T* dst = tmp; \
+    for (size_t b = 0; b < sizeof(T); b++) { \
+        size_t* c = counts[b]; \
+        if (c[(vec_##T##_radix_key(src[0]) >> (8 * b)) & 0xFF] == n) continue; \
+        size_t sum = 0; \
+        for (int d = 0; d < 256; d++) { \
+            size_t cnt = c[d]; \
+            c[d] = sum; \
+            sum += cnt; \
+        } \
+        for (size_t i = 0; i < n; i++) dst[c[(vec_##T##_radix_key(src[i]) >> (8 * b)) & 0xFF]++] = src[i]; \
+        T* t = src; src = dst; dst = t; \
+    } \
+    if (src != v->data) memcpy(v->data, src, n * sizeof(T)); \
+    free(tmp); \
+    return true; \
+}
+
+#endif // VEC_SORT_H
@@ -3,7 +3,29 @@
 
 #include "common.h"
 
-#define DEFINE_VEC(T) \
+/*
+ * Growth/shrink policy, fixed per instantiation with DEFINE_VEC_EX(T, POLICY).
+ *   initial_cap          capacity of the first allocation (and the shrink floor)
+ *   grow_num / grow_den  growth factor when full (2/1 doubles, 3/2 is 1.5x)
+ *   shrink_div           after a removal, halve cap once len <= cap / shrink_div;
+ *                        0 never shrinks automatically (use vec_T_shrink_to_fit)
+ * Larger shrink_div widens the gap between shrinking and regrowing.
+ */
+typedef struct {
+    size_t initial_cap;
+    size_t grow_num;
+    size_t grow_den;
+    size_t shrink_div;
+} VecPolicy;
+
+#define VEC_POLICY_DEFAULT ((VecPolicy){ 4, 2, 1, 4 })
+#define VEC_POLICY_GROW_1_5 ((VecPolicy){ 4, 3, 2, 4 })
+#define VEC_POLICY_HYSTERESIS ((VecPolicy){ 4, 2, 1, 16 })
+#define VEC_POLICY_NO_SHRINK ((VecPolicy){ 4, 2, 1, 0 })
+
+#define DEFINE_VEC(T) DEFINE_VEC_EX(T, VEC_POLICY_DEFAULT)
+
+#define DEFINE_VEC_EX(T, POLICY) \
 typedef struct { \
  T *data; \
 size_t cap; \
@@ -16,20 +38,106 @@ static inline void vec_##T##_init(vec_##T *v) { \
  v->data = NULL; \
  } \
 \
-static inline void vec_##T##_push(vec_##T *v, T val) { \
-if (v->len >= v->cap) { \
-size_t new_cap = (v->cap == 0) ? 4 : v->cap * 2; \
+/* Grows capacity to at least min_cap (and at least one policy step) with one realloc */ \
+static inline bool vec_##T##_grow(vec_##T *v, size_t min_cap) { \
+const VecPolicy policy = POLICY; \
+size_t new_cap = (v->cap == 0) ? policy.initial_cap : v->cap / policy.grow_den * policy.grow_num \
+ + v->cap % policy.grow_den * policy.grow_num / policy.grow_den; \
+if (new_cap <= v->cap) new_cap = v->cap + 1; \
+if (new_cap < min_cap) new_cap = min_cap; \
+if (new_cap > SIZE_MAX / sizeof(T)) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
  T *new_data = realloc(v->data, new_cap * sizeof(T)); \
 if (!new_data) { \
 printf("Memory allocation failed\n"); \
-return; \
+return false; \
  } \
  v->data = new_data; \
  v->cap = new_cap; \
+return true; \
  } \
+\
+static inline void vec_##T##_push(vec_##T *v, T val) { \
+if (v->len >= v->cap && !vec_##T##_grow(v, v->len + 1)) return; \
  v->data[v->len++] = val; \
  } \
 \
+/* Sets capacity to at least n without changing len */ \
+static inline bool vec_##T##_reserve(vec_##T *v, size_t n) { \
+if (n <= v->cap) return true; \
+if (n > SIZE_MAX / sizeof(T)) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+ T *new_data = realloc(v->data, n * sizeof(T)); \
+if (!new_data) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+ v->data = new_data; \
+ v->cap = n; \
+return true; \
+ } \
+\
+static inline vec_##T vec_##T##_with_capacity(size_t n) { \
+ vec_##T v; \
+ vec_##T##_init(&v); \
+ vec_##T##_reserve(&v, n); \
+return v; \
+ } \
+\
+/* Sets len to n; new elements are zero-filled */ \
+static inline bool vec_##T##_resize(vec_##T *v, size_t n) { \
+if (n > v->cap && !vec_##T##_grow(v, n)) return false; \
+if (n > v->len) memset(v->data + v->len, 0, (n - v->len) * sizeof(T)); \
+ v->len = n; \
+return true; \
+ } \
+\
+/* Appends n elements from src with one allocation and one memcpy; src may point into v */ \
+static inline bool vec_##T##_extend(vec_##T *v, const T *src, size_t n) { \
+if (n == 0) return true; \
+if (n > SIZE_MAX - v->len) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+if (v->len + n > v->cap) { \
+bool inside = v->data && src >= v->data && src < v->data + v->len; \
+size_t offset = inside ? (size_t)(src - v->data) : 0; \
+if (!vec_##T##_grow(v, v->len + n)) return false; \
+if (inside) src = v->data + offset; \
+ } \
+ memcpy(v->data + v->len, src, n * sizeof(T)); \
+ v->len += n; \
+return true; \
+ } \
+\
+static inline bool vec_##T##_append_vec(vec_##T *v, const vec_##T *other) { \
+if (other == v) { \
+size_t n = v->len; \
+if (n == 0) return true; \
+if (2 * n > v->cap && !vec_##T##_grow(v, 2 * n)) return false; \
+ memcpy(v->data + n, v->data, n * sizeof(T)); \
+ v->len = 2 * n; \
+return true; \
+ } \
+return vec_##T##_extend(v, other->data, other->len); \
+ } \
+\
+/* Appends n copies of val */ \
+static inline bool vec_##T##_push_n(vec_##T *v, T val, size_t n) { \
+if (n > SIZE_MAX - v->len) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+if (v->len + n > v->cap && !vec_##T##_grow(v, v->len + n)) return false; \
+for (size_t j = 0; j < n; j++) v->data[v->len + j] = val; \
+ v->len += n; \
+return true; \
+ } \
+\
 static inline T vec_##T##_get(vec_##T *v, size_t i) { \
 if (i >= v->len) { \
 printf("Invalid index %zu\n", i); \
@@ -46,26 +154,132 @@ return; \
  v->data[i] = item; \
  } \
 \
+/* Pointer to element i with no copy; NULL when out of range. Invalidated by growth. */ \
+static inline T *vec_##T##_at_ptr(vec_##T *v, size_t i) { \
+if (i >= v->len) { \
+printf("Invalid index %zu\n", i); \
+return NULL; \
+ } \
+return &v->data[i]; \
+ } \
+\
+static inline T *vec_##T##_back_ptr(vec_##T *v) { \
+if (v->len == 0) { \
+printf("Vector is empty\n"); \
+return NULL; \
+ } \
+return &v->data[v->len - 1]; \
+ } \
+\
+/* Appends an uninitialized slot and returns it for the caller to fill in place */ \
+static inline T *vec_##T##_emplace_back(vec_##T *v) { \
+if (v->len >= v->cap && !vec_##T##_grow(v, v->len + 1)) return NULL; \
+return &v->data[v->len++]; \
+ } \
+\
+/* Takes ownership of a malloc'd buffer holding len elements in room for cap */ \
+static inline vec_##T vec_##T##_from_buffer(T *buf, size_t len, size_t cap) { \
+ vec_##T v; \
+ vec_##T##_init(&v); \
+if (!buf || len > cap) { \
+if (len > cap) printf("Invalid buffer length %zu\n", len); \
+return v; \
+ } \
+ v.data = buf; \
+ v.len = len; \
+ v.cap = cap; \
+return v; \
+ } \
+\
+/* Hands the buffer to the caller (who must free it) and leaves v empty */ \
+static inline T *vec_##T##_release(vec_##T *v, size_t *len_out) { \
+ T *buf = v->data; \
+if (len_out) *len_out = v->len; \
+ vec_##T##_init(v); \
+return buf; \
+ } \
+\
+/* Non-owning view of len contiguous elements */ \
+typedef struct { \
+ T *data; \
+size_t len; \
+ } slice_##T; \
+\
+/* View of n elements starting at i; valid until v reallocates or is freed */ \
+static inline slice_##T vec_##T##_slice(vec_##T *v, size_t i, size_t n) { \
+ slice_##T s = { NULL, 0 }; \
+if (i > v->len || n > v->len - i) { \
+printf("Index out of bounds\n"); \
+return s; \
+ } \
+ s.data = v->data + i; \
+ s.len = n; \
+return s; \
+ } \
+\
+static inline slice_##T vec_##T##_as_slice(vec_##T *v) { \
+ slice_##T s = { v->data, v->len }; \
+return s; \
+ } \
+\
+static inline slice_##T slice_##T##_sub(slice_##T s, size_t i, size_t n) { \
+ slice_##T r = { NULL, 0 }; \
+if (i > s.len || n > s.len - i) { \
+printf("Index out of bounds\n"); \
+return r; \
+ } \
+ r.data = s.data + i; \
+ r.len = n; \
+return r; \
+ } \
+\
+static inline T *slice_##T##_at_ptr(slice_##T s, size_t i) { \
+if (i >= s.len) { \
+printf("Invalid index %zu\n", i); \
+return NULL; \
+ } \
+return &s.data[i]; \
+ } \
+\
 static inline void vec_##T##_insert(vec_##T *v, size_t i, T item) { \
 if (i > v->len) { \
 printf("Index out of bounds\n"); \
 return; \
  } \
-if (v->len >= v->cap) { \
-size_t new_cap = (v->cap == 0) ? 4 : v->cap * 2; \
- T *new_data = realloc(v->data, new_cap * sizeof(T)); \
-if (!new_data) { \
-printf("Memory allocation failed\n"); \
-return; \
+if (v->len >= v->cap && !vec_##T##_grow(v, v->len + 1)) return; \
+memmove(v->data + i + 1, v->data + i, (v->len - i) * sizeof(T)); \
+ v->data[i] = item; \
+ v->len++; \
  } \
+\
+/* Applies the policy's automatic shrink after a removal */ \
+static inline void vec_##T##_maybe_shrink(vec_##T *v) { \
+const VecPolicy policy = POLICY; \
+if (policy.shrink_div == 0 || v->len == 0 || v->len > v->cap / policy.shrink_div) return; \
+size_t new_cap = v->cap / 2; \
+if (new_cap < policy.initial_cap) new_cap = policy.initial_cap; \
+if (new_cap >= v->cap) return; \
+ T *new_data = realloc(v->data, new_cap * sizeof(T)); \
+if (new_data) { \
  v->data = new_data; \
  v->cap = new_cap; \
  } \
-for (size_t j = v->len; j > i; j--) { \
- v->data[j] = v->data[j - 1]; \
  } \
- v->data[i] = item; \
- v->len++; \
+\
+/* Releases unused capacity (all of it when empty) */ \
+static inline void vec_##T##_shrink_to_fit(vec_##T *v) { \
+if (v->len == v->cap) return; \
+if (v->len == 0) { \
+free(v->data); \
+ v->data = NULL; \
+ v->cap = 0; \
+return; \
+ } \
+ T *new_data = realloc(v->data, v->len * sizeof(T)); \
+if (new_data) { \
+ v->data = new_data; \
+ v->cap = v->len; \
+ } \
  } \
 \
 static inline void vec_##T##_remove(vec_##T *v, size_t i) { \
@@ -73,19 +287,93 @@ if (i >= v->len) { \
 printf("Index out of bounds\n"); \
 return; \
  } \
-for (size_t j = i; j < v->len - 1; j++) { \
- v->data[j] = v->data[j + 1]; \
- } \
+memmove(v->data + i, v->data + i + 1, (v->len - i - 1) * sizeof(T)); \
  v->len--; \
-if (v->len > 0 && v->len <= v->cap / 4) { \
-size_t new_cap = v->cap / 2; \
-if (new_cap < 4) new_cap = 4; \
- T *new_data = realloc(v->data, new_cap * sizeof(T)); \
-if (new_data) { \
- v->data = new_data; \
- v->cap = new_cap; \
+ vec_##T##_maybe_shrink(v); \
+ } \
+\
+/* Inserts n elements from src before index i; src may point into v */ \
+static inline bool vec_##T##_insert_range(vec_##T *v, size_t i, const T *src, size_t n) { \
+if (i > v->len) { \
+printf("Index out of bounds\n"); \
+return false; \
+ } \
+if (n == 0) return true; \
+if (n > SIZE_MAX - v->len) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+ T *copy = NULL; \
+if (v->data && src >= v->data && src < v->data + v->len) { \
+ copy = malloc(n * sizeof(T)); \
+if (!copy) { \
+printf("Memory allocation failed\n"); \
+return false; \
+ } \
+ memcpy(copy, src, n * sizeof(T)); \
+ src = copy; \
+ } \
+if (v->len + n > v->cap && !vec_##T##_grow(v, v->len + n)) { \
+free(copy); \
+return false; \
+ } \
+ memmove(v->data + i + n, v->data + i, (v->len - i) * sizeof(T)); \
+ memcpy(v->data + i, src, n * sizeof(T)); \
+ v->len += n; \
+free(copy); \
+return true; \
+ } \
+\
+/* Removes the n elements starting at index i; capacity is kept */ \
+static inline void vec_##T##_erase_range(vec_##T *v, size_t i, size_t n) { \
+if (i > v->len || n > v->len - i) { \
+printf("Index out of bounds\n"); \
+return; \
+ } \
+if (n == 0) return; \
+ memmove(v->data + i, v->data + i + n, (v->len - i - n) * sizeof(T)); \
+ v->len -= n; \
  } \
+\
+/* O(1) removal that moves the last element into slot i; order is not kept */ \
+static inline T vec_##T##_swap_remove(vec_##T *v, size_t i) { \
+if (i >= v->len) { \
+printf("Index out of bounds\n"); \
+ T tmp = {0}; return tmp; \
  } \
+ T val = v->data[i]; \
+ v->data[i] = v->data[--v->len]; \
+return val; \
+ } \
+\
+/* \
+ * Single-pass compaction: drops elements where pred(elem, ctx) == drop_if, \
+ * moving kept runs with memmove. pred is called exactly once per element, \
+ * in order, so stateful predicates are safe. \
+ */ \
+static inline size_t vec_##T##_compact(vec_##T *v, bool (*pred)(const T *, void *), void *ctx, bool drop_if) { \
+size_t w = 0, start = 0; \
+for (size_t r = 0; r < v->len; r++) { \
+if (pred(&v->data[r], ctx) != drop_if) continue; \
+if (start != w) memmove(v->data + w, v->data + start, (r - start) * sizeof(T)); \
+ w += r - start; \
+ start = r + 1; \
+ } \
+if (start != w) memmove(v->data + w, v->data + start, (v->len - start) * sizeof(T)); \
+ w += v->len - start; \
+size_t removed = v->len - w; \
+ v->len = w; \
+return removed; \
+ } \
+\
+/* Removes every element for which pred returns true; returns how many were removed */ \
+static inline size_t vec_##T##_remove_if(vec_##T *v, bool (*pred)(const T *, void *), void *ctx) { \
+return vec_##T##_compact(v, pred, ctx, true); \
+ } \
+\
+/* Keeps only the elements for which pred returns true; returns how many were removed */ \
+static inline size_t vec_##T##_retain(vec_##T *v, bool (*pred)(const T *, void *), void *ctx) { \
+return vec_##T##_compact(v, pred, ctx, false); \
  } \
 \
 static inline void vec_##T##_free(vec_##T *v) { \
@@ -0,0 +1,210 @@
+#ifndef VM_VEC_H
+#define VM_VEC_H
+
+/*
+ * DEFINE_VM_VEC(T) generates vm_vec_T: a vector that reserves its maximum
+ * size as inaccessible address space at init (mmap PROT_NONE) and commits
+ * pages in place as it grows (mprotect). data never moves, so growth never
+ * copies and element pointers stay valid until vm_vec_T_free. Reserved but
+ * uncommitted space costs address space only, not memory.
+ *
+ * With VM_VEC_DECOMMIT, shrinking hands whole pages back to the OS
+ * (madvise MADV_DONTNEED); a decommitted page reads as zero when reused.
+ *
+ * POSIX only. Under -std=c11 the POSIX calls are hidden unless a feature
+ * macro is set before the first system header: include this header first,
+ * or build with -D_DEFAULT_SOURCE.
+ */
+
+#if !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "common.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define VM_VEC_DEFAULT_RESERVE ((size_t)1 << 36)   /* 64 GiB of address space */
+#define VM_VEC_COMMIT_MIN ((size_t)64 << 10)       /* smallest commit step, bytes */
+
+// Init flags
+#define VM_VEC_DECOMMIT 1    /* once len <= cap / 4, release pages beyond 2 * len */
+
+static inline size_t vm_vec_page_size(void) {
+    static size_t page;
+    if (!page) {
+        long p = sysconf(_SC_PAGESIZE);
+        page = p > 0 ? (size_t)p : 4096;
+    }
+    return page;
+}
+
+static inline size_t vm_vec_round_up(size_t bytes, size_t page) {
+    return (bytes + page - 1) / page * page;
+}
+
+// Makes [base + from, base + to) readable and writable
+static inline bool vm_vec_commit(char* base, size_t from, size_t to) {
+    if (mprotect(base + from, to - from, PROT_READ | PROT_WRITE) != 0) {
+        printf("Cannot commit memory: %s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// Returns [base + from, base + to) to the OS and makes it inaccessible again
+static inline void vm_vec_decommit(char* base, size_t from, size_t to) {
+#ifdef MADV_DONTNEED
+    madvise(base + from, to - from, MADV_DONTNEED);
+#endif
+    mprotect(base + from, to - from, PROT_NONE);
+}
+
+#define DEFINE_VM_VEC(T) \
+typedef struct { \
+    T* data; \
+    size_t len; \
+    size_t cap;            /* committed elements */ \
+    size_t max_len;        /* reserved elements; cap never exceeds it */ \
+    size_t committed;      /* committed bytes, a multiple of the page size */ \
+    size_t reserved;       /* reserved bytes */ \
+    int flags; \
+} vm_vec_##T; \
+\
+/* Reserves room for max_len elements (0 = VM_VEC_DEFAULT_RESERVE bytes); commits nothing yet */ \
+static inline bool vm_vec_##T##_init(vm_vec_##T* v, size_t max_len, int flags) { \
+    memset(v, 0, sizeof(*v)); \
+    size_t page = vm_vec_page_size(); \
+    if (max_len == 0) max_len = VM_VEC_DEFAULT_RESERVE / sizeof(T); \
+    if (max_len > (SIZE_MAX - page) / sizeof(T)) { \
+        printf("Memory allocation failed\n"); \
+        return false; \
+    } \
+    size_t bytes = vm_vec_round_up(max_len * sizeof(T), page); \
+    void* base = mmap(NULL, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); \
+    if (base == MAP_FAILED) { \
+        printf("Cannot reserve %zu bytes: %s\n", bytes, strerror(errno)); \
+        return false; \
+    } \
+    v->data = (T*)base; \
+    v->max_len = bytes / sizeof(T); \
+    v->reserved = bytes; \
+    v->flags = flags; \
+    return true; \
+} \
+\
+/* Commits at least n elements; fails past max_len */ \
+static inline bool vm_vec_##T##_reserve(vm_vec_##T* v, size_t n) { \
+    if (n <= v->cap) return true; \
+    if (n > v->max_len) { \
+        printf("Vector capacity exceeded (%zu > %zu)\n", n, v->max_len); \
+        return false; \
+    } \
+    size_t want = n * sizeof(T); \
+    if (want < v->committed * 2) want = v->committed * 2; \
+    if (want < VM_VEC_COMMIT_MIN) want = VM_VEC_COMMIT_MIN; \
+    want = vm_vec_round_up(want, vm_vec_page_size()); \
+    if (want > v->reserved) want = v->reserved; \
+    if (!vm_vec_commit((char*)v->data, v->committed, want)) return false; \
+    v->committed = want; \
+    v->cap = want / sizeof(T); \
+    return true; \
+} \
+\
+/* Shrinks the committed range to the pages covering n elements (never below len) */ \
+static inline void vm_vec_##T##_release_to(vm_vec_##T* v, size_t n) { \
+    if (n < v->len) n = v->len; \
+    size_t keep = vm_vec_round_up(n * sizeof(T), vm_vec_page_size()); \
+    if (keep >= v->committed) return; \
+    vm_vec_decommit((char*)v->data, keep, v->committed); \
+    v->committed = keep; \
+    v->cap = keep / sizeof(T); \
+} \
+\
+static inline void vm_vec_##T##_maybe_shrink(vm_vec_##T* v) { \
+    if (!(v->flags & VM_VEC_DECOMMIT) || v->len > v->cap / 4) return; \
+    if (v->committed <= VM_VEC_COMMIT_MIN) return; \
+    vm_vec_##T##_release_to(v, v->len * 2); \
+} \
+\
+static inline void vm_vec_##T##_push(vm_vec_##T* v, T val) { \
+    if (v->len >= v->cap && !vm_vec_##T##_reserve(v, v->len + 1)) return; \
+    v->data[v->len++] = val; \
+} \
+\
+/* Appends an uninitialized slot and returns it for the caller to fill in place */ \
+static inline T* vm_vec_##T##_emplace_back(vm_vec_##T* v) { \
+    if (v->len >= v->cap && !vm_vec_##T##_reserve(v, v->len + 1)) return NULL; \
+    return &v->data[v->len++]; \
+} \
+\
+/* Sets len to n; new elements are zero-filled */ \
+static inline bool vm_vec_##T##_resize(vm_vec_##T* v, size_t n) { \
+    if (n > v->cap && !vm_vec_##T##_reserve(v, n)) return false; \
+    if (n > v->len) memset(v->data + v->len, 0, (n - v->len) * sizeof(T)); \
+    v->len = n; \
+    vm_vec_##T##_maybe_shrink(v); \
+    return true; \
+} \
+\
+static inline T vm_vec_##T##_get(vm_vec_##T* v, size_t i) { \
+    if (i >= v->len) { \
+        printf("Invalid index %zu\n", i); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    return v->data[i]; \
+} \
+\
+static inline void vm_vec_##T##_set(vm_vec_##T* v, size_t i, T item) { \
+    if (i >= v->len) { \
+        printf("Index out of bounds\n"); \
+        return; \
+    } \
+    v->data[i] = item; \
+} \
+\
+/* Pointer to element i; stays valid while i < len, across any amount of growth */ \
+static inline T* vm_vec_##T##_at_ptr(vm_vec_##T* v, size_t i) { \
+    if (i >= v->len) { \
+        printf("Invalid index %zu\n", i); \
+        return NULL; \
+    } \
+    return &v->data[i]; \
+} \
+\
+static inline T vm_vec_##T##_pop(vm_vec_##T* v) { \
+    if (v->len == 0) { \
+        printf("Vector is empty\n"); \
+        T tmp = {0}; \
+        return tmp; \
+    } \
+    T val = v->data[--v->len]; \
+    vm_vec_##T##_maybe_shrink(v); \
+    return val; \
+} \
+\
+static inline void vm_vec_##T##_clear(vm_vec_##T* v) { \
+    v->len = 0; \
+    vm_vec_##T##_maybe_shrink(v); \
+} \
+\
+/* Decommits every page past len, whatever the flags */ \
+static inline void vm_vec_##T##_shrink_to_fit(vm_vec_##T* v) { \
+    vm_vec_##T##_release_to(v, v->len); \
+} \
+\
+static inline void vm_vec_##T##_free(vm_vec_##T* v) { \
+    if (v->data) munmap(v->data, v->reserved); \
+    memset(v, 0, sizeof(*v)); \
+}
+
+#endif // __unix__ || __APPLE__
+
+#endif // VM_VEC_H